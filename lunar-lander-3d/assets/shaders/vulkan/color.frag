@@ -0,0 +1,10 @@
+#version 450
+// Interpolated vertex color
+
+layout(location = 0) in vec4 inColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = inColor;
+}
@@ -0,0 +1,18 @@
+#version 450
+// Instanced lander: shared mesh, per-instance model matrix and tint
+
+layout(push_constant) uniform PushConstants {
+    mat4 viewProjection;
+} pc;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in mat4 inModel;   // Locations 2-5
+layout(location = 6) in vec4 inTint;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    gl_Position = pc.viewProjection * inModel * vec4(inPosition, 1.0);
+    outColor = inColor * inTint;
+}
@@ -0,0 +1,12 @@
+#version 450
+// Terrain overview texture
+
+layout(set = 0, binding = 0) uniform sampler2D overview;
+
+layout(location = 0) in vec2 inUV;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texture(overview, inUV);
+}
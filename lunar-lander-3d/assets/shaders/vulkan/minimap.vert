@@ -0,0 +1,16 @@
+#version 450
+// Screen-space textured quad for the minimap
+
+layout(push_constant) uniform PushConstants {
+    mat4 projection;
+} pc;
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inUV;
+
+layout(location = 0) out vec2 outUV;
+
+void main() {
+    gl_Position = pc.projection * vec4(inPosition, 0.0, 1.0);
+    outUV = inUV;
+}
@@ -0,0 +1,16 @@
+#version 450
+// Colored geometry: terrain, flames, trajectory lines and HUD quads
+
+layout(push_constant) uniform PushConstants {
+    mat4 viewProjection;
+} pc;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    gl_Position = pc.viewProjection * vec4(inPosition, 1.0);
+    outColor = inColor;
+}
@@ -0,0 +1,467 @@
+// AssetManager.cpp
+// Implementation of the asynchronous asset loader
+
+#include "AssetManager.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Largest single pread; bigger files are read in several calls
+static const size_t kReadChunkSize = 1 << 20;
+
+// Worker threads when Initialize() is not given a count
+static const int kMaxDefaultWorkers = 4;
+
+// Font atlases hold 16 x 16 cells, character code = row * 16 + column
+static const int kFontGridSize = 16;
+
+// Decode an uncompressed or RLE TGA (types 2, 3, 10 and 11) into RGBA rows
+// from the top
+static bool DecodeTga(const uint8_t* data, size_t size, const std::string& name, AssetData& result) {
+    if (size < 18) {
+        std::cerr << "Truncated TGA file: " << name << std::endl;
+        return false;
+    }
+
+    int idLength = data[0];
+    int colorMapType = data[1];
+    int imageType = data[2];
+    int width = data[12] | (data[13] << 8);
+    int height = data[14] | (data[15] << 8);
+    int bitsPerPixel = data[16];
+    bool topDown = (data[17] & 0x20) != 0;
+
+    bool gray = imageType == 3 || imageType == 11;
+    bool rle = imageType == 10 || imageType == 11;
+    int bytesPerPixel = bitsPerPixel / 8;
+    bool supported = colorMapType == 0 && (imageType == 2 || imageType == 3 || rle) &&
+                     (gray ? bitsPerPixel == 8 : (bitsPerPixel == 24 || bitsPerPixel == 32));
+    if (!supported || width <= 0 || height <= 0) {
+        std::cerr << "Unsupported TGA format: " << name << std::endl;
+        return false;
+    }
+
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    const uint8_t* source = data + 18 + idLength;
+    const uint8_t* end = data + size;
+    result.width = width;
+    result.height = height;
+    result.pixels.resize(pixelCount * 4);
+
+    size_t pixel = 0;
+    while (pixel < pixelCount) {
+        // Raw images are one long raw packet
+        size_t count = pixelCount - pixel;
+        bool repeat = false;
+        if (rle) {
+            if (source >= end) break;
+            count = std::min<size_t>((*source & 0x7F) + 1, pixelCount - pixel);
+            repeat = (*source & 0x80) != 0;
+            source++;
+        }
+
+        for (size_t i = 0; i < count; i++, pixel++) {
+            if (source + bytesPerPixel > end) {
+                std::cerr << "Truncated TGA file: " << name << std::endl;
+                return false;
+            }
+
+            // Stored bottom row first unless the descriptor says otherwise
+            size_t x = pixel % width;
+            size_t y = pixel / width;
+            size_t row = topDown ? y : height - 1 - y;
+            uint8_t* target = &result.pixels[(row * width + x) * 4];
+            if (gray) {
+                target[0] = target[1] = target[2] = source[0];
+                target[3] = 255;
+            } else {
+                target[0] = source[2];
+                target[1] = source[1];
+                target[2] = source[0];
+                target[3] = bytesPerPixel == 4 ? source[3] : 255;
+            }
+
+            if (!repeat || i + 1 == count) {
+                source += bytesPerPixel;
+            }
+        }
+    }
+
+    if (pixel < pixelCount) {
+        std::cerr << "Truncated TGA file: " << name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Read the next header field of a PGM file, skipping whitespace and comments
+static bool ReadPgmField(const uint8_t*& source, const uint8_t* end, int& value) {
+    while (source < end && (std::isspace(*source) || *source == '#')) {
+        if (*source == '#') {
+            while (source < end && *source != '\n') source++;
+        } else {
+            source++;
+        }
+    }
+
+    value = 0;
+    const uint8_t* start = source;
+    while (source < end && *source >= '0' && *source <= '9') {
+        value = value * 10 + (*source - '0');
+        source++;
+    }
+    return source != start;
+}
+
+// Decode a binary PGM (P5) into heights scaled to 0..1
+static bool DecodePgm(const uint8_t* data, size_t size, const std::string& name, AssetData& result) {
+    const uint8_t* end = data + size;
+    const uint8_t* source = data + 2;
+    int width = 0, height = 0, maxValue = 0;
+    if (size < 2 || data[0] != 'P' || data[1] != '5' ||
+        !ReadPgmField(source, end, width) || !ReadPgmField(source, end, height) ||
+        !ReadPgmField(source, end, maxValue) || width <= 0 || height <= 0 || maxValue <= 0 ||
+        maxValue > 65535) {
+        std::cerr << "Not a binary PGM heightmap: " << name << std::endl;
+        return false;
+    }
+    source++;  // Single whitespace before the samples
+
+    // Samples above 255 take two bytes, most significant first
+    size_t sampleSize = maxValue > 255 ? 2 : 1;
+    size_t sampleCount = static_cast<size_t>(width) * height;
+    if (source > end || static_cast<size_t>(end - source) < sampleCount * sampleSize) {
+        std::cerr << "Truncated PGM heightmap: " << name << std::endl;
+        return false;
+    }
+
+    result.width = width;
+    result.height = height;
+    result.heights.resize(sampleCount);
+    float scale = 1.0f / maxValue;
+    for (size_t i = 0; i < sampleCount; i++) {
+        int value = sampleSize == 2 ? (source[i * 2] << 8) | source[i * 2 + 1] : source[i];
+        result.heights[i] = std::min(value, maxValue) * scale;
+    }
+    return true;
+}
+
+// Advance of each glyph in a font atlas: its rightmost covered column plus a
+// pixel of spacing (half a cell for empty cells such as the space)
+static bool MeasureGlyphs(const std::string& name, AssetData& result) {
+    if (result.width % kFontGridSize != 0 || result.height % kFontGridSize != 0) {
+        std::cerr << "Font atlas is not a 16 x 16 grid: " << name << std::endl;
+        return false;
+    }
+
+    int cellWidth = result.width / kFontGridSize;
+    int cellHeight = result.height / kFontGridSize;
+    for (int character = 0; character < 256; character++) {
+        int cellX = (character % kFontGridSize) * cellWidth;
+        int cellY = (character / kFontGridSize) * cellHeight;
+
+        int right = -1;
+        for (int y = 0; y < cellHeight; y++) {
+            const uint8_t* row = &result.pixels[(static_cast<size_t>(cellY + y) * result.width + cellX) * 4];
+            for (int x = right + 1; x < cellWidth; x++) {
+                if (row[x * 4 + 3] != 0) {
+                    right = x;
+                }
+            }
+        }
+
+        int advance = right >= 0 ? right + 2 : cellWidth / 2;
+        result.glyphAdvance[character] = static_cast<uint8_t>(std::min(advance, 255));
+    }
+    return true;
+}
+
+Asset::Asset(AssetType type, const std::string& path)
+    : mType(type)
+    , mPath(path)
+    , mState(AssetState::Queued)
+{
+    std::fill(mGpuObjects, mGpuObjects + kMaxGpuObjects, 0u);
+}
+
+bool Asset::HasGpuObjects() const {
+    for (int i = 0; i < kMaxGpuObjects; i++) {
+        if (mGpuObjects[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+AssetManager::AssetManager()
+    : mStopping(false)
+    , mPendingCount(0)
+    , mReleaseQueue(std::make_shared<ReleaseQueue>())
+{
+}
+
+AssetManager::~AssetManager() {
+    Shutdown();
+}
+
+bool AssetManager::Initialize(const std::string& baseDirectory, int workerCount) {
+    Shutdown();
+
+    mBaseDirectory = baseDirectory;
+    mStopping = false;
+    mReleaseQueue = std::make_shared<ReleaseQueue>();
+
+    if (workerCount <= 0) {
+        // Leave a core for the main thread
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        workerCount = std::max(1, std::min(cores - 1, kMaxDefaultWorkers));
+    }
+    for (int i = 0; i < workerCount; i++) {
+        mWorkers.emplace_back(&AssetManager::WorkerLoop, this);
+    }
+    return true;
+}
+
+void AssetManager::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        mStopping = true;
+    }
+    mQueueSignal.notify_all();
+    for (std::thread& worker : mWorkers) {
+        worker.join();
+    }
+    mWorkers.clear();
+
+    mLoadQueue.clear();
+    mUploadQueue.clear();
+    mPendingCount.store(0, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(mCacheMutex);
+        mCache.clear();
+    }
+
+    // Release what is already unloaded while the GPU context still exists.
+    // Handles dropped after this free their assets without the callback.
+    ReleaseAssets();
+    std::lock_guard<std::mutex> lock(mReleaseQueue->mutex);
+    mReleaseQueue->open = false;
+}
+
+void AssetManager::SetUploader(AssetType type, UploadFunction upload, ReleaseFunction release) {
+    Uploader& uploader = mUploaders[static_cast<int>(type)];
+    uploader.upload = upload;
+    uploader.release = release;
+}
+
+AssetHandle AssetManager::Load(AssetType type, const std::string& path) {
+    std::string key = std::to_string(static_cast<int>(type)) + ":" + path;
+
+    std::lock_guard<std::mutex> cacheLock(mCacheMutex);
+    std::shared_ptr<Asset> asset = mCache[key].lock();
+    if (asset) {
+        return AssetHandle(asset);
+    }
+
+    // Deleted by the last handle; GPU objects go through the release queue
+    std::shared_ptr<ReleaseQueue> releaseQueue = mReleaseQueue;
+    asset.reset(new Asset(type, path), [releaseQueue](Asset* unloaded) {
+        if (unloaded->HasGpuObjects()) {
+            std::lock_guard<std::mutex> lock(releaseQueue->mutex);
+            if (releaseQueue->open) {
+                releaseQueue->assets.push_back(unloaded);
+                return;
+            }
+        }
+        delete unloaded;
+    });
+    mCache[key] = asset;
+
+    mPendingCount.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        mLoadQueue.push_back(asset);
+    }
+    mQueueSignal.notify_one();
+
+    return AssetHandle(asset);
+}
+
+void AssetManager::WorkerLoop() {
+    for (;;) {
+        std::shared_ptr<Asset> asset;
+        {
+            std::unique_lock<std::mutex> lock(mQueueMutex);
+            mQueueSignal.wait(lock, [this]() { return mStopping || !mLoadQueue.empty(); });
+            if (mStopping) {
+                return;
+            }
+            asset = mLoadQueue.front().lock();
+            mLoadQueue.pop_front();
+        }
+
+        // Every handle was dropped before the load started
+        if (!asset) {
+            mPendingCount.fetch_sub(1, std::memory_order_acq_rel);
+            continue;
+        }
+
+        LoadAsset(*asset);
+        if (asset->GetState() == AssetState::Failed) {
+            mPendingCount.fetch_sub(1, std::memory_order_acq_rel);
+        } else {
+            std::lock_guard<std::mutex> lock(mUploadMutex);
+            mUploadQueue.push_back(asset);
+        }
+    }
+}
+
+void AssetManager::LoadAsset(Asset& asset) {
+    asset.mState.store(AssetState::Loading, std::memory_order_release);
+
+    const std::string& path = asset.mPath;
+    bool absolute = !path.empty() && (path[0] == '/' || path.find(':') != std::string::npos);
+    std::string fullPath = absolute ? path : mBaseDirectory + path;
+
+    std::vector<char> contents;
+    bool success = ReadFile(fullPath, contents);
+    if (success) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(contents.data());
+        switch (asset.mType) {
+            case AssetType::Model:
+                success = asset.mData.mesh.LoadObjData(contents.data(), contents.size(), path);
+                break;
+            case AssetType::Texture:
+                success = DecodeTga(bytes, contents.size(), path, asset.mData);
+                break;
+            case AssetType::Heightmap:
+                success = DecodePgm(bytes, contents.size(), path, asset.mData);
+                break;
+            case AssetType::Font:
+                success = DecodeTga(bytes, contents.size(), path, asset.mData) &&
+                          MeasureGlyphs(path, asset.mData);
+                break;
+        }
+    }
+
+    asset.mState.store(success ? AssetState::Uploading : AssetState::Failed, std::memory_order_release);
+}
+
+bool AssetManager::ReadFile(const std::string& path, std::vector<char>& contents) const {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open asset: " << path << std::endl;
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < 0) {
+        std::cerr << "Failed to read asset size: " << path << std::endl;
+        close(fd);
+        return false;
+    }
+
+    // Positional reads: no shared file offset, so workers never contend on it
+    contents.resize(static_cast<size_t>(fileStat.st_size));
+    size_t offset = 0;
+    while (offset < contents.size()) {
+        size_t chunk = std::min(contents.size() - offset, kReadChunkSize);
+        ssize_t bytesRead = pread(fd, &contents[offset], chunk, static_cast<off_t>(offset));
+        if (bytesRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytesRead <= 0) {
+            std::cerr << "Failed to read asset: " << path << std::endl;
+            close(fd);
+            return false;
+        }
+        offset += static_cast<size_t>(bytesRead);
+    }
+
+    close(fd);
+    return true;
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open asset: " << path << std::endl;
+        return false;
+    }
+
+    contents.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(contents.data(), contents.size());
+    if (!file) {
+        std::cerr << "Failed to read asset: " << path << std::endl;
+        return false;
+    }
+    return true;
+#endif
+}
+
+void AssetManager::ProcessUploads(float budgetSeconds) {
+    ReleaseAssets();
+
+    auto start = std::chrono::steady_clock::now();
+    bool first = true;
+    for (;;) {
+        // Always make progress, then stay inside the budget
+        if (!first) {
+            std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= budgetSeconds) {
+                break;
+            }
+        }
+
+        std::shared_ptr<Asset> asset;
+        {
+            std::lock_guard<std::mutex> lock(mUploadMutex);
+            if (mUploadQueue.empty()) {
+                break;
+            }
+            asset = mUploadQueue.front().lock();
+            mUploadQueue.pop_front();
+        }
+        mPendingCount.fetch_sub(1, std::memory_order_acq_rel);
+
+        // Dropped while loading
+        if (!asset) {
+            continue;
+        }
+
+        const Uploader& uploader = mUploaders[static_cast<int>(asset->mType)];
+        bool success = !uploader.upload || uploader.upload(*asset);
+        if (!success) {
+            std::cerr << "Failed to upload asset: " << asset->mPath << std::endl;
+        }
+        asset->mState.store(success ? AssetState::Ready : AssetState::Failed, std::memory_order_release);
+        first = false;
+    }
+}
+
+void AssetManager::ReleaseAssets() {
+    std::vector<Asset*> assets;
+    {
+        std::lock_guard<std::mutex> lock(mReleaseQueue->mutex);
+        assets.swap(mReleaseQueue->assets);
+    }
+
+    for (Asset* asset : assets) {
+        const Uploader& uploader = mUploaders[static_cast<int>(asset->mType)];
+        if (uploader.release) {
+            uploader.release(*asset);
+        }
+        delete asset;
+    }
+}
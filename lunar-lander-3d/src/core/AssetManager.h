@@ -0,0 +1,167 @@
+// AssetManager.h
+// Asynchronous loading of models, textures, heightmaps and fonts
+
+#pragma once
+
+#include "../rendering/Mesh.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum class AssetType {
+    Model,      // Wavefront OBJ
+    Texture,    // TGA (true color or grayscale, optionally RLE)
+    Heightmap,  // Binary PGM, 8 or 16 bits per sample
+    Font        // TGA atlas of 16 x 16 ASCII glyph cells
+};
+
+enum class AssetState {
+    Queued,     // Waiting for a worker
+    Loading,    // Being read and decoded
+    Uploading,  // Decoded, waiting for ProcessUploads()
+    Ready,
+    Failed
+};
+
+// Decoded contents; which members are filled depends on the type
+struct AssetData {
+    Mesh mesh;                    // Model
+    std::vector<uint8_t> pixels;  // Texture, Font: RGBA rows from the top
+    std::vector<float> heights;   // Heightmap: 0..1 rows from the top
+    int width = 0;
+    int height = 0;
+    uint8_t glyphAdvance[256] = {};  // Font: pen advance per character (pixels)
+};
+
+class Asset {
+public:
+    // GPU objects one asset may own (e.g. vertex and index buffer)
+    static const int kMaxGpuObjects = 2;
+
+    Asset(AssetType type, const std::string& path);
+
+    AssetType GetType() const { return mType; }
+    const std::string& GetPath() const { return mPath; }
+    AssetState GetState() const { return mState.load(std::memory_order_acquire); }
+    bool IsReady() const { return GetState() == AssetState::Ready; }
+
+    // Only valid once the asset is ready
+    const AssetData& GetData() const { return mData; }
+
+    // Set by the upload function, read back by the renderer and its release function
+    uint32_t GetGpuObject(int index) const { return mGpuObjects[index]; }
+    void SetGpuObject(int index, uint32_t object) { mGpuObjects[index] = object; }
+    bool HasGpuObjects() const;
+
+private:
+    friend class AssetManager;
+
+    AssetType mType;
+    std::string mPath;
+    std::atomic<AssetState> mState;
+    AssetData mData;
+    uint32_t mGpuObjects[kMaxGpuObjects];
+};
+
+// Reference-counted handle to an asset. The asset is unloaded when its last
+// handle goes away; GPU objects are released on the render thread by the next
+// ProcessUploads().
+class AssetHandle {
+public:
+    AssetHandle() {}
+
+    bool IsValid() const { return mAsset != nullptr; }
+    bool IsReady() const { return mAsset && mAsset->IsReady(); }
+    bool IsFailed() const { return mAsset && mAsset->GetState() == AssetState::Failed; }
+    void Reset() { mAsset.reset(); }
+
+    const Asset* Get() const { return mAsset.get(); }
+    const Asset* operator->() const { return mAsset.get(); }
+
+private:
+    friend class AssetManager;
+    explicit AssetHandle(const std::shared_ptr<Asset>& asset) : mAsset(asset) {}
+
+    std::shared_ptr<Asset> mAsset;
+};
+
+// Loads assets on a pool of worker threads: files are read with pread (plain
+// stream reads on Windows) and decoded there, including the model processing
+// in Mesh. Decoded assets wait in a queue until the render thread calls
+// ProcessUploads(), which creates their GPU objects through the upload
+// function registered for the type and stops once the frame's time budget is
+// spent, so a burst of finished loads spreads over several frames. Requests
+// for a path that is still loaded share the existing asset.
+class AssetManager {
+public:
+    // Create the asset's GPU objects from its data; false marks it failed.
+    // Types without an upload function become ready straight after decoding.
+    typedef std::function<bool(Asset& asset)> UploadFunction;
+    typedef std::function<void(Asset& asset)> ReleaseFunction;
+
+    AssetManager();
+    ~AssetManager();
+
+    // Relative paths are resolved against baseDirectory
+    bool Initialize(const std::string& baseDirectory, int workerCount = 0);
+    void Shutdown();
+
+    void SetUploader(AssetType type, UploadFunction upload, ReleaseFunction release);
+
+    // Queue a load (or share the asset already loaded from that path)
+    AssetHandle Load(AssetType type, const std::string& path);
+
+    // Render thread, once per frame: finish uploads within budgetSeconds
+    // (at least one per call) and release GPU objects of unloaded assets
+    void ProcessUploads(float budgetSeconds);
+
+    // Assets queued, loading or waiting for upload
+    int GetPendingCount() const { return mPendingCount.load(std::memory_order_acquire); }
+
+private:
+    // Assets whose last handle was dropped while they still own GPU objects.
+    // Shared with the handles' deleters, which may outlive the manager.
+    struct ReleaseQueue {
+        std::mutex mutex;
+        std::vector<Asset*> assets;
+        bool open = true;
+    };
+
+    struct Uploader {
+        UploadFunction upload;
+        ReleaseFunction release;
+    };
+    static const int kTypeCount = 4;
+
+    void WorkerLoop();
+    void LoadAsset(Asset& asset);
+    bool ReadFile(const std::string& path, std::vector<char>& contents) const;
+    void ReleaseAssets();
+
+    std::string mBaseDirectory;
+    Uploader mUploaders[kTypeCount];
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mQueueMutex;
+    std::condition_variable mQueueSignal;
+    std::deque<std::weak_ptr<Asset>> mLoadQueue;
+    bool mStopping;
+
+    std::mutex mUploadMutex;
+    std::deque<std::weak_ptr<Asset>> mUploadQueue;
+    std::atomic<int> mPendingCount;
+
+    // Loaded assets by type and path
+    std::mutex mCacheMutex;
+    std::unordered_map<std::string, std::weak_ptr<Asset>> mCache;
+
+    std::shared_ptr<ReleaseQueue> mReleaseQueue;
+};
@@ -0,0 +1,656 @@
+// BatchRunner.cpp
+// Implementation of the headless batch runner
+
+#include "BatchRunner.h"
+#include "ControlAllocator.h"
+#include "Entity.h"
+#include "Metrics.h"
+#include "ObservationRenderer.h"
+#include "Physics.h"
+#include "Replay.h"
+#include "Terrain.h"
+#include "TerrainNavigator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+// Where the lander starts in the game's 2D world
+static const float kStartHeight = 100.0f;
+
+// Start conditions drawn per episode: horizontal offset from the center pad
+// (either way), tilt in degrees (either way) and initial sink rate
+static const float kStartOffsetRange = 50.0f;
+static const float kStartTiltRange = 15.0f;
+static const float kStartSinkRateMax = 60.0f;
+
+// Each episode starts at a random time of the wind field, up to this
+static const float kWindPhaseRange = 3600.0f;
+
+// Autopilot: thrust while sinking faster than kMinSinkRate plus
+// kSinkRateGain per unit of altitude, and keep the tilt inside kTiltDeadband
+static const float kMinSinkRate = 5.0f;
+static const float kSinkRateGain = 0.2f;
+static const float kTiltDeadband = 3.0f;
+
+// One physics step in this many is timed for the latency histogram, which
+// keeps the clock reads off most steps
+static const uint64_t kLatencySampleInterval = 64;
+
+// Thruster allocation: force of each RCS thruster (newtons), and the torque
+// a rotate input asks for, in RCS couples across the lander's width. A
+// delivered couple turns the lander by the pilot's rotation step.
+static const float kRcsThrusterForce = 445.0f;
+static const float kRotationCouples = 1.0f;
+
+// Vision check: lander cameras at random spots over a 3D terrain, between
+// the two heights above its ground (high enough to see several craters),
+// each rendering a square depth image.
+// Packet and scalar tracing step through the same arithmetic, so their
+// depths agree to rounding (world units). Each lander also takes a
+// navigation fix, starting from an estimate up to kVisionEstimateError off
+// its true position along either horizontal axis.
+static const int kVisionTerrainSize = 800;
+static const int kVisionTerrainHeight = 600;
+static const int kVisionCameraCount = 64;
+static const int kVisionImageSize = 64;
+static const float kVisionFieldOfView = 60.0f;
+static const float kVisionAltitudeMin = 150.0f;
+static const float kVisionAltitudeMax = 350.0f;
+static const float kVisionTolerance = 1e-2f;
+static const float kVisionEstimateError = 20.0f;
+static const float kVisionSearchRadius = 40.0f;
+
+// Salts separating the random streams drawn from one seed
+static const uint32_t kTerrainSeedSalt = 0x7E44A1Bu;
+static const uint32_t kStartSeedSalt = 0x51A27u;
+static const uint32_t kVisionSeedSalt = 0xC4E7A5u;
+
+static uint32_t MixSeed(uint32_t seed, uint32_t index) {
+    uint32_t x = seed * 0x9E3779B9u + index * 0x85EBCA6Bu + 1;
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+static uint8_t Autopilot(const LanderObservation& observation) {
+    uint8_t inputs = 0;
+    float sinkRate = observation.velocity[1];
+    if (sinkRate > kMinSinkRate + observation.altitude * kSinkRateGain) {
+        inputs |= INPUT_THRUST;
+    }
+
+    // Rotating right lowers the angle
+    if (observation.tilt > kTiltDeadband) {
+        inputs |= INPUT_ROTATE_RIGHT;
+    } else if (observation.tilt < -kTiltDeadband) {
+        inputs |= INPUT_ROTATE_LEFT;
+    }
+    return inputs;
+}
+
+// Engine and RCS thrusters flown through the control allocator. The desired
+// wrench only changes with the inputs, so an allocation is kept and flown
+// again until they change.
+struct ThrusterActuator {
+    ControlAllocator allocator;
+    float rotationTorque;  // Asked for by one rotate input
+    int inputs;            // Inputs the current allocation is for; -1 for none
+    float throttle;        // Engine throttle the thrusters deliver for them
+    float turn;            // Degrees per tick, positive to the left
+};
+
+static void ActuateThrusters(ThrusterActuator& actuator, Lander& lander, uint8_t inputs, BatchReport& report) {
+    if (inputs != actuator.inputs) {
+        const ThrusterLayout& layout = actuator.allocator.GetLayout();
+        const float engineForce = layout.GetThruster(ThrusterLayout::kMainEngine).maxForce;
+
+        // Body-frame wrench: thrust is the engine's full force upwards (-y),
+        // and a positive torque about z turns the lander the way RotateLeft() does
+        float desired[ThrusterLayout::kWrenchSize] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        if (inputs & INPUT_THRUST) {
+            desired[1] = -engineForce;
+        }
+        if (inputs & INPUT_ROTATE_LEFT) {
+            desired[5] += actuator.rotationTorque;
+        }
+        if (inputs & INPUT_ROTATE_RIGHT) {
+            desired[5] -= actuator.rotationTorque;
+        }
+
+        float forces[ThrusterLayout::kMaxThrusters];
+        AllocationResult result;
+        auto allocationStart = std::chrono::steady_clock::now();
+        actuator.allocator.Allocate(desired, forces, &result);
+        report.allocationSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - allocationStart).count();
+        report.allocations++;
+        report.allocationIterations += result.iterations;
+        if (!result.converged) {
+            report.allocationsUnconverged++;
+        }
+
+        // Fly what the thrusters deliver: the upward force as the engine's
+        // throttle and the torque as a rotation
+        float achieved[ThrusterLayout::kWrenchSize];
+        layout.ComputeWrench(forces, achieved);
+        actuator.inputs = inputs;
+        actuator.throttle = -achieved[1] / engineForce;
+        actuator.turn = achieved[5] / actuator.rotationTorque * GetPilotRotationStep();
+    }
+
+    lander.ApplyThrust(actuator.throttle);
+    if (actuator.turn > 0.0f) {
+        lander.RotateLeft(actuator.turn);
+    } else if (actuator.turn < 0.0f) {
+        lander.RotateRight(-actuator.turn);
+    }
+    report.thrusterTicks++;
+}
+
+static void AddOutcome(FaultOutcomeStats& stats, EpisodeOutcome outcome) {
+    stats.episodes++;
+    stats.outcomes[static_cast<int>(outcome)]++;
+}
+
+static void AddStats(FaultOutcomeStats& total, const FaultOutcomeStats& part) {
+    total.episodes += part.episodes;
+    for (int i = 0; i < static_cast<int>(EpisodeOutcome::Count); i++) {
+        total.outcomes[i] += part.outcomes[i];
+    }
+}
+
+static void PrintRow(std::ostream& out, const char* name, const FaultOutcomeStats& stats) {
+    out << std::left << std::setw(16) << name << std::right << std::setw(10) << stats.episodes;
+    for (int i = 0; i < static_cast<int>(EpisodeOutcome::Count); i++) {
+        double share = stats.episodes > 0 ? 100.0 * stats.outcomes[i] / stats.episodes : 0.0;
+        out << std::setw(i == static_cast<int>(EpisodeOutcome::TimedOut) ? 11 : 10) << share << "%";
+    }
+    out << "\n";
+}
+
+// One episode being flown by a worker
+struct BatchRunner::EpisodeLane {
+    Lander* lander;
+    Terrain* terrain;
+    Physics physics;
+    FaultInjector faults;
+    int index;                      // Within the worker's lanes
+    int episode;                    // -1 once the batch has run out
+    float time;                     // Simulated seconds
+    float touchdownSpeed;
+    uint64_t ticks;
+    LanderObservation observation;  // Latest sensor reading
+    ThrusterActuator thrusters;     // With BatchConfig::allocateThrusters
+};
+
+BatchRunner::BatchRunner()
+    : mLaneCount(1)
+    , mNextEpisode(0)
+    , mEpisodeCount(0)
+    , mStepCounter(nullptr)
+    , mStepLatency(nullptr)
+    , mWorkerCount(nullptr)
+{
+    std::fill(mEpisodeCounters, mEpisodeCounters + static_cast<int>(EpisodeOutcome::Count), nullptr);
+}
+
+BatchRunner::~BatchRunner() = default;
+
+void BatchRunner::SetMetrics(MetricsRegistry* registry) {
+    static const char* const kOutcomeLabels[] = {
+        "outcome=\"landed\"",
+        "outcome=\"crashed\"",
+        "outcome=\"timed_out\""
+    };
+
+    for (int i = 0; i < static_cast<int>(EpisodeOutcome::Count); i++) {
+        mEpisodeCounters[i] = registry->AddCounter("lander_batch_episodes_total",
+                                                   "Episodes flown, by outcome.", kOutcomeLabels[i]);
+    }
+    mStepCounter = registry->AddCounter("lander_physics_steps_total", "Physics steps simulated.");
+    mStepLatency = registry->AddHistogram("lander_physics_step_seconds",
+                                          "Wall time of one physics step (sampled).",
+                                          MetricHistogram::DecadeBounds(2e-8, 1e-2));
+    // Read from the episode counter when scraped, so it never runs backwards
+    registry->AddGauge("lander_batch_queue_depth", "Episodes waiting for a worker.", "", [this]() {
+        return static_cast<double>(std::max(0, mEpisodeCount.load() - mNextEpisode.load()));
+    });
+    mWorkerCount = registry->AddGauge("lander_batch_workers", "Worker threads flying episodes.");
+}
+
+bool BatchRunner::Run(const BatchConfig& config, BatchReport& report) {
+    report = BatchReport();
+    if (config.episodeCount <= 0 || config.tickLength <= 0.0f) {
+        std::cerr << "Batch needs at least one episode and a positive tick length" << std::endl;
+        return false;
+    }
+
+    mConfig = config;
+    if (config.windEnabled && !mWindField.Initialize(config.wind)) {
+        return false;
+    }
+
+    int threadCount = config.threadCount;
+    if (threadCount <= 0) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    threadCount = std::min(threadCount, config.episodeCount);
+
+    // Lanes exist to batch a plugin's step_n and the wind lookups; the
+    // built-in autopilot in still air flies one episode at a time
+    mLaneCount = 1;
+    if (!config.controllerPath.empty() || (config.windEnabled && config.airDensity > 0.0f)) {
+        mLaneCount = std::max(1, std::min(config.lanesPerWorker, (config.episodeCount + threadCount - 1) / threadCount));
+    }
+
+    // One plugin context per worker, created up front so that a failing
+    // init stops the batch before it starts
+    std::vector<void*> contexts(threadCount, nullptr);
+    mController.Unload();
+    if (!config.controllerPath.empty()) {
+        if (!mController.Load(config.controllerPath)) {
+            return false;
+        }
+
+        Physics physics;
+        physics.SetGravity(config.gravity);
+        LanderControllerInfo info;
+        info.abiVersion = LANDER_CONTROLLER_ABI_VERSION;
+        info.laneCount = static_cast<uint32_t>(mLaneCount);
+        info.gravityAcceleration = physics.GetGravityAcceleration();
+        info.thrustAcceleration = physics.GetThrustAcceleration(1.0f);
+        info.rotationStep = GetPilotRotationStep();
+        info.config = config.controllerConfig.c_str();
+        for (int i = 0; i < threadCount; i++) {
+            if (!mController.CreateContext(info, contexts[i])) {
+                for (int j = 0; j < i; j++) {
+                    mController.DestroyContext(contexts[j]);
+                }
+                mController.Unload();
+                return false;
+            }
+        }
+    }
+    if (config.checkVision && !CheckVision(threadCount, report)) {
+        return false;
+    }
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Terrain generation uses the global rand(), so the pool is built here.
+    // Its logging (pads, landing checks) would drown the report and
+    // serialize the workers.
+    int terrainCount = std::max(1, std::min(config.terrainCount, config.episodeCount));
+    mTerrains.clear();
+    for (int i = 0; i < terrainCount; i++) {
+        srand(MixSeed(config.seed ^ kTerrainSeedSalt, static_cast<uint32_t>(i)));
+        mTerrains.push_back(std::make_unique<Terrain>());
+        mTerrains.back()->SetVerbose(false);
+        mTerrains.back()->Generate2D(Terrain::kWorldWidth2D, Terrain::kWorldHeight2D);
+    }
+
+    // Each worker flies its own landers and fills its own report; the
+    // calling thread is one of them. Entity IDs come from an unsynchronized
+    // counter, so the landers are all constructed here.
+    std::vector<Lander> landers(threadCount * mLaneCount);
+    std::vector<BatchReport> partial(threadCount);
+    mNextEpisode.store(0);
+    mEpisodeCount.store(config.episodeCount);
+    if (mWorkerCount) {
+        mWorkerCount->Set(threadCount);
+    }
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threadCount; i++) {
+        workers.emplace_back(&BatchRunner::WorkerLoop, this, &landers[i * mLaneCount], contexts[i], std::ref(partial[i]));
+    }
+    WorkerLoop(&landers[0], contexts[0], partial[0]);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    if (mController.IsLoaded()) {
+        for (void* context : contexts) {
+            mController.DestroyContext(context);
+        }
+        mController.Unload();
+    }
+
+    for (const BatchReport& part : partial) {
+        AddStats(report.all, part.all);
+        AddStats(report.noFault, part.noFault);
+        for (int i = 0; i < static_cast<int>(FaultType::Count); i++) {
+            AddStats(report.byFault[i], part.byFault[i]);
+        }
+        report.touchdownSpeedSum += part.touchdownSpeedSum;
+        report.fuelUsedSum += part.fuelUsedSum;
+        report.flightTimeSum += part.flightTimeSum;
+        report.ticks += part.ticks;
+        report.thrusterTicks += part.thrusterTicks;
+        report.allocations += part.allocations;
+        report.allocationIterations += part.allocationIterations;
+        report.allocationsUnconverged += part.allocationsUnconverged;
+        report.allocationSeconds += part.allocationSeconds;
+    }
+
+    if (mWorkerCount) {
+        mWorkerCount->Set(0);
+    }
+
+    mTerrains.clear();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return true;
+}
+
+void BatchRunner::WorkerLoop(Lander* landers, void* controllerContext, BatchReport& report) {
+    std::unique_ptr<EpisodeLane[]> lanes(new EpisodeLane[mLaneCount]);
+    for (int i = 0; i < mLaneCount; i++) {
+        EpisodeLane& lane = lanes[i];
+        lane.lander = &landers[i];
+        lane.index = i;
+        lane.faults.SetScenario(mConfig.faults);
+        lane.physics.RegisterLander(lane.lander);
+        lane.physics.SetVerbose(false);
+        lane.physics.SetGravity(mConfig.gravity);
+        lane.physics.SetFaultState(&lane.faults.GetState());
+        lane.physics.SetAirDensity(mConfig.airDensity);
+        if (mConfig.allocateThrusters) {
+            lane.thrusters.allocator.SetLayout(ThrusterLayout::CreateDefault(*lane.lander, kRcsThrusterForce));
+            lane.thrusters.rotationTorque = kRotationCouples * kRcsThrusterForce * lane.lander->GetWidth();
+        }
+        StartEpisode(lane);
+    }
+
+    // Observations of the lanes still flying, and their actions
+    std::vector<LanderObservation> observations(mLaneCount);
+    std::vector<LanderAction> actions(mLaneCount);
+    std::vector<EpisodeLane*> flying(mLaneCount);
+
+    // Where and when the flying lanes are, and the wind there (structure of
+    // arrays for SampleBatch); the lanes' physics gets it with SetWind()
+    const bool sampleWind = mConfig.windEnabled && mConfig.airDensity > 0.0f;
+    std::vector<float> windInputs[4];
+    std::vector<float> windOutputs[3];
+    for (std::vector<float>& values : windInputs) {
+        values.resize(mLaneCount);
+    }
+    for (std::vector<float>& values : windOutputs) {
+        values.resize(mLaneCount);
+    }
+
+    for (;;) {
+        int count = 0;
+        for (int i = 0; i < mLaneCount; i++) {
+            EpisodeLane& lane = lanes[i];
+            if (lane.episode < 0) {
+                continue;
+            }
+            lane.faults.Update(lane.time);
+
+            // During a dropout the controller flies on the last reading
+            LanderObservation& observation = lane.observation;
+            if (lane.faults.GetState().sensorsValid) {
+                ControllerPlugin::ObserveLander(*lane.lander, *lane.terrain, false, observation);
+                observation.flags |= LANDER_OBS_SENSORS_VALID;
+            } else {
+                observation.flags &= ~LANDER_OBS_SENSORS_VALID;
+            }
+            observation.time = lane.time;
+            observations[count] = observation;
+            observation.flags &= ~LANDER_OBS_NEW_EPISODE;
+            flying[count++] = &lane;
+        }
+        if (count == 0) {
+            return;
+        }
+
+        if (sampleWind) {
+            for (int i = 0; i < count; i++) {
+                const float* position = flying[i]->lander->GetPosition();
+                windInputs[0][i] = position[0];
+                windInputs[1][i] = position[1];
+                windInputs[2][i] = position[2];
+                windInputs[3][i] = flying[i]->physics.GetSimulationTime();
+            }
+            mWindField.SampleBatch(count, windInputs[0].data(), windInputs[1].data(), windInputs[2].data(),
+                                   windInputs[3].data(), windOutputs[0].data(), windOutputs[1].data(),
+                                   windOutputs[2].data());
+        }
+
+        if (mController.IsLoaded()) {
+            mController.StepBatch(controllerContext, static_cast<uint32_t>(count), observations.data(), actions.data());
+        } else {
+            for (int i = 0; i < count; i++) {
+                actions[i].inputs = Autopilot(observations[i]);
+            }
+        }
+
+        for (int i = 0; i < count; i++) {
+            EpisodeLane& lane = *flying[i];
+            Lander& lander = *lane.lander;
+            if (mConfig.allocateThrusters) {
+                ActuateThrusters(lane.thrusters, lander, lane.faults.FilterInputs(static_cast<uint8_t>(actions[i].inputs)), report);
+                lane.faults.ApplyThrottleFaults(&lander);
+            } else {
+                lane.faults.ApplyInputs(&lander, static_cast<uint8_t>(actions[i].inputs));
+            }
+            if (sampleWind) {
+                const float wind[3] = { windOutputs[0][i], windOutputs[1][i], windOutputs[2][i] };
+                lane.physics.SetWind(wind);
+            }
+
+            // Physics stops the lander on contact, so keep the speed it hit with
+            lane.touchdownSpeed = lander.GetVelocity()[1];
+            if (mStepLatency && report.ticks % kLatencySampleInterval == 0) {
+                auto stepStart = std::chrono::steady_clock::now();
+                lane.physics.Update(mConfig.tickLength);
+                mStepLatency->Observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count());
+            } else {
+                lane.physics.Update(mConfig.tickLength);
+            }
+            lane.time += mConfig.tickLength;
+            lane.ticks++;
+            report.ticks++;
+
+            if (lane.time >= mConfig.maxEpisodeTime || lander.IsLanded() || lander.IsCrashed()) {
+                FinishEpisode(lane, report);
+                StartEpisode(lane);
+            }
+        }
+    }
+}
+
+bool BatchRunner::StartEpisode(EpisodeLane& lane) {
+    int episode = mNextEpisode.fetch_add(1, std::memory_order_relaxed);
+    if (episode >= mConfig.episodeCount) {
+        lane.episode = -1;
+        return false;
+    }
+
+    uint32_t seed = MixSeed(mConfig.seed, static_cast<uint32_t>(episode));
+    lane.episode = episode;
+    lane.terrain = mTerrains[seed % mTerrains.size()].get();
+    lane.physics.RegisterTerrain(lane.terrain);
+
+    // Start conditions
+    Lander& lander = *lane.lander;
+    std::mt19937 random(seed ^ kStartSeedSalt);
+    std::uniform_real_distribution<float> spread(-1.0f, 1.0f);
+    lander.Reset();
+    lander.SetActive(true);
+    lander.SetPosition(Terrain::kWorldWidth2D / 2 + spread(random) * kStartOffsetRange, kStartHeight);
+    float tilt = spread(random) * kStartTiltRange;
+    lander.SetRotation(0.0f, 0.0f, tilt < 0.0f ? tilt + 360.0f : tilt);
+    lander.GetVelocity()[1] = (spread(random) + 1.0f) * 0.5f * kStartSinkRateMax;
+    lane.physics.SetSimulationTime((spread(random) + 1.0f) * 0.5f * kWindPhaseRange);
+    lane.faults.BeginEpisode(seed, mConfig.tickLength);
+    lane.thrusters.allocator.ResetWarmStart();
+    lane.thrusters.inputs = -1;
+
+    // The first reading is always good
+    lane.time = 0.0f;
+    lane.touchdownSpeed = 0.0f;
+    lane.ticks = 0;
+    ControllerPlugin::ObserveLander(lander, *lane.terrain, false, lane.observation);
+    lane.observation.deltaTime = mConfig.tickLength;
+    lane.observation.lane = static_cast<uint32_t>(lane.index);
+    lane.observation.flags = LANDER_OBS_SENSORS_VALID | LANDER_OBS_NEW_EPISODE;
+    return true;
+}
+
+bool BatchRunner::CheckVision(int threadCount, BatchReport& report) {
+    srand(MixSeed(mConfig.seed ^ kVisionSeedSalt, 0));
+    Terrain terrain;
+    terrain.SetVerbose(false);
+    terrain.Generate3D(kVisionTerrainSize, kVisionTerrainSize, kVisionTerrainHeight);
+
+    ObservationRenderer renderer;
+    if (!renderer.Initialize(kVisionImageSize, kVisionImageSize, kVisionFieldOfView, threadCount)) {
+        std::cerr << "Failed to initialize the observation renderer" << std::endl;
+        return false;
+    }
+    renderer.SetTerrain(&terrain);
+
+    TerrainNavigator navigator;
+    if (!navigator.Initialize()) {
+        std::cerr << "Failed to initialize the terrain navigator" << std::endl;
+        return false;
+    }
+    navigator.SetTerrain(&terrain);
+
+    // Tilted landers over random ground (Y grows downwards)
+    std::mt19937 random(mConfig.seed ^ kVisionSeedSalt);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    Lander lander;
+    std::vector<ObservationCamera> cameras(kVisionCameraCount);
+    for (ObservationCamera& camera : cameras) {
+        float x = unit(random) * kVisionTerrainSize;
+        float z = unit(random) * kVisionTerrainSize;
+        float ground = static_cast<float>(kVisionTerrainHeight);
+        terrain.GetSurfaceHeight3D(x, z, ground);
+        float altitude = kVisionAltitudeMin + unit(random) * (kVisionAltitudeMax - kVisionAltitudeMin);
+        float tilt = (unit(random) * 2.0f - 1.0f) * kStartTiltRange;
+        lander.SetPosition(x, ground - altitude, z);
+        lander.SetRotation(0.0f, 0.0f, tilt < 0.0f ? tilt + 360.0f : tilt);
+        camera = ObservationRenderer::GetLanderCamera(&lander);
+
+        const float* position = lander.GetPosition();
+        const float estimate[3] = {
+            position[0] + (unit(random) * 2.0f - 1.0f) * kVisionEstimateError,
+            position[1],
+            position[2] + (unit(random) * 2.0f - 1.0f) * kVisionEstimateError
+        };
+        NavigationFix fix;
+        if (navigator.ComputeFix(&lander, estimate, kVisionSearchRadius, fix)) {
+            float errorX = fix.position[0] - position[0];
+            float errorZ = fix.position[2] - position[2];
+            report.navigationFixes++;
+            report.navigationErrorSum += std::sqrt(errorX * errorX + errorZ * errorZ);
+        }
+    }
+
+    // Every image into one [camera][row][column] batch, traced in packets,
+    // then each pixel again on its own
+    const size_t imageSize = renderer.GetImageSize();
+    std::vector<float> depths(cameras.size() * imageSize);
+    auto renderStart = std::chrono::steady_clock::now();
+    renderer.Render(cameras.data(), kVisionCameraCount, ObservationRenderer::Channel::Depth, depths.data());
+    report.visionSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+    report.visionImages = kVisionCameraCount;
+
+    for (int i = 0; i < kVisionCameraCount; i++) {
+        const float* image = &depths[i * imageSize];
+        for (int y = 0; y < renderer.GetHeight(); y++) {
+            for (int x = 0; x < renderer.GetWidth(); x++) {
+                float direction[3];
+                renderer.GetPixelDirection(cameras[i], x + 0.5f, y + 0.5f, direction);
+                float depth = renderer.TraceDepth(cameras[i].position, direction);
+                float error = std::fabs(depth - image[y * renderer.GetWidth() + x]);
+                report.visionMaxError = std::max(report.visionMaxError, static_cast<double>(error));
+                if (error > kVisionTolerance) {
+                    report.visionMismatches++;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void BatchRunner::FinishEpisode(EpisodeLane& lane, BatchReport& report) {
+    const Lander& lander = *lane.lander;
+    EpisodeOutcome outcome = lander.IsLanded() ? EpisodeOutcome::Landed
+                           : lander.IsCrashed() ? EpisodeOutcome::Crashed
+                           : EpisodeOutcome::TimedOut;
+    AddOutcome(report.all, outcome);
+    if (mStepCounter) {
+        mEpisodeCounters[static_cast<int>(outcome)]->Add();
+        mStepCounter->Add(lane.ticks);
+    }
+    uint32_t occurred = lane.faults.GetOccurredFaults();
+    if (occurred == 0) {
+        AddOutcome(report.noFault, outcome);
+    }
+    for (int i = 0; i < static_cast<int>(FaultType::Count); i++) {
+        if (occurred & (1u << i)) {
+            AddOutcome(report.byFault[i], outcome);
+        }
+    }
+    if (outcome != EpisodeOutcome::TimedOut) {
+        report.touchdownSpeedSum += lane.touchdownSpeed;
+    }
+    report.fuelUsedSum += lander.GetMaxFuel() - lander.GetFuel();
+    report.flightTimeSum += lane.time;
+}
+
+void BatchRunner::PrintReport(const BatchReport& report, std::ostream& out) {
+    const int episodes = report.all.episodes;
+    const int grounded = episodes - report.all.outcomes[static_cast<int>(EpisodeOutcome::TimedOut)];
+    const double seconds = std::max(report.seconds, 1e-9);
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+
+    out << "Batch: " << episodes << " episodes in " << report.seconds << " s ("
+        << episodes / seconds << " episodes/s, " << report.ticks / seconds / 1e6 << "M ticks/s)\n";
+    out << std::left << std::setw(16) << "Faults" << std::right << std::setw(10) << "Episodes"
+        << std::setw(11) << "Landed" << std::setw(11) << "Crashed" << std::setw(12) << "Timed out" << "\n";
+    PrintRow(out, "any", report.all);
+    PrintRow(out, "none", report.noFault);
+    for (int i = 0; i < static_cast<int>(FaultType::Count); i++) {
+        if (report.byFault[i].episodes > 0) {
+            PrintRow(out, GetFaultName(static_cast<FaultType>(i)), report.byFault[i]);
+        }
+    }
+
+    if (episodes > 0) {
+        out << "Mean touchdown speed " << (grounded > 0 ? report.touchdownSpeedSum / grounded : 0.0)
+            << ", fuel used " << report.fuelUsedSum / episodes
+            << ", flight time " << report.flightTimeSum / episodes << " s\n";
+    }
+    if (report.allocations > 0) {
+        out << "Thruster allocation: one solve per "
+            << static_cast<double>(report.thrusterTicks) / report.allocations << " ticks, "
+            << std::setprecision(2) << 1e6 * report.allocationSeconds / report.allocations << " us and "
+            << static_cast<double>(report.allocationIterations) / report.allocations << " iterations per solve, "
+            << report.allocationsUnconverged << " unconverged\n";
+    }
+    if (report.visionImages > 0) {
+        out << "Vision check: " << report.visionImages << " depth images in "
+            << 1e3 * report.visionSeconds << " ms, " << report.visionMismatches
+            << " pixels where packet and scalar tracing disagree (largest difference "
+            << std::setprecision(4) << report.visionMaxError << ")\n";
+        out << std::setprecision(2) << "Navigation: " << report.navigationFixes << " of "
+            << report.visionImages << " cameras gave a fix, on average "
+            << (report.navigationFixes > 0 ? report.navigationErrorSum / report.navigationFixes : 0.0)
+            << " from the true position (estimates up to " << kVisionEstimateError << " off)\n";
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,130 @@
+// BatchRunner.h
+// Headless batches of autopilot flights for fault robustness sweeps
+
+#pragma once
+
+#include "ControllerPlugin.h"
+#include "FaultInjector.h"
+#include "WindField.h"
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Lander;
+class MetricCounter;
+class MetricGauge;
+class MetricHistogram;
+class MetricsRegistry;
+class Terrain;
+
+enum class EpisodeOutcome {
+    Landed,
+    Crashed,
+    TimedOut,
+    Count
+};
+
+struct BatchConfig {
+    int episodeCount = 1000;
+    uint32_t seed = 1;              // Every episode's seed derives from this
+    int threadCount = 0;            // Zero: one per core
+    int terrainCount = 16;          // Distinct terrains shared by the episodes
+    int lanesPerWorker = 8;         // Episodes each worker flies in lockstep (plugin or wind)
+    float tickLength = 1.0f / 60.0f;
+    float maxEpisodeTime = 300.0f;  // Simulated seconds before an episode times out
+    float gravity = 1.62f;
+    float airDensity = 0.0f;        // kg/m³; zero is vacuum
+    bool windEnabled = false;       // Felt only with an atmosphere
+    WindParameters wind;
+    FaultScenario faults;
+    bool allocateThrusters = false; // Actuate through the engine and RCS layout (ControlAllocator)
+    bool checkVision = false;       // Check the lander cameras and navigation over a 3D terrain first
+    std::string controllerPath;     // Controller plugin; empty for the built-in autopilot
+    std::string controllerConfig;   // Passed to the plugin's init
+};
+
+// Outcomes of the episodes in which one fault type occurred
+struct FaultOutcomeStats {
+    int episodes;
+    int outcomes[static_cast<int>(EpisodeOutcome::Count)];
+};
+
+struct BatchReport {
+    FaultOutcomeStats all;
+    FaultOutcomeStats noFault;
+    FaultOutcomeStats byFault[static_cast<int>(FaultType::Count)];
+    double touchdownSpeedSum;  // Vertical speed when the episode ended on the ground
+    double fuelUsedSum;
+    double flightTimeSum;      // Simulated seconds
+    uint64_t ticks;
+    double seconds;            // Wall-clock time of the batch
+
+    // Thruster allocation, with BatchConfig::allocateThrusters
+    uint64_t thrusterTicks;        // Ticks flown through the thrusters
+    uint64_t allocations;          // Solves; only a change of inputs needs one
+    uint64_t allocationIterations;
+    uint64_t allocationsUnconverged;
+    double allocationSeconds;      // Wall time of the solves
+
+    // Vision check, with BatchConfig::checkVision
+    int visionImages;              // Lander depth images rendered in one batch
+    uint64_t visionMismatches;     // Pixels where packet and scalar tracing disagree
+    double visionMaxError;         // Largest depth difference of any pixel
+    double visionSeconds;          // Wall time of rendering the images
+    int navigationFixes;           // Valid TerrainNavigator fixes from the same cameras
+    double navigationErrorSum;     // Horizontal distance of the fixes from the true positions
+};
+
+// Flies episodes without a window: each one picks a terrain from a shared
+// pool, draws its start conditions and faults from its own seed, and is
+// flown by a simple descent autopilot (or a controller plugin) whose inputs
+// and sensor readings pass through the FaultInjector. Optionally the inputs
+// are flown as a desired force and torque that a ControlAllocator spreads
+// over the descent engine and RCS thrusters. Episodes are spread over
+// worker threads; each worker flies several at once in lanes that keep
+// their own lander, physics and injector and step in lockstep, so a plugin
+// gets every lane's observation in one step_n call and the wind at every
+// lane is looked up in one WindField::SampleBatch call. The terrains and
+// the wind field are only read, so they are generated once up front.
+// The episodes fly in 2D, so the vision check renders landers' cameras
+// over a 3D terrain of its own before they start, and navigates by what
+// they see.
+class BatchRunner {
+public:
+    BatchRunner();
+    ~BatchRunner();
+
+    // Export episode outcomes, physics steps and their latency, the queue
+    // of episodes and the number of workers; call before Run()
+    void SetMetrics(MetricsRegistry* registry);
+
+    // Run every episode of the batch; blocks until done
+    bool Run(const BatchConfig& config, BatchReport& report);
+
+    static void PrintReport(const BatchReport& report, std::ostream& out);
+
+private:
+    struct EpisodeLane;
+
+    void WorkerLoop(Lander* landers, void* controllerContext, BatchReport& report);
+    bool StartEpisode(EpisodeLane& lane);
+    bool CheckVision(int threadCount, BatchReport& report);
+    void FinishEpisode(EpisodeLane& lane, BatchReport& report);
+
+    BatchConfig mConfig;
+    std::vector<std::unique_ptr<Terrain>> mTerrains;
+    WindField mWindField;
+    ControllerPlugin mController;
+    int mLaneCount;
+    std::atomic<int> mNextEpisode;
+    std::atomic<int> mEpisodeCount;  // Of the running batch, for the queue depth gauge
+
+    // Metrics, all null unless SetMetrics() was called
+    MetricCounter* mEpisodeCounters[static_cast<int>(EpisodeOutcome::Count)];
+    MetricCounter* mStepCounter;
+    MetricHistogram* mStepLatency;
+    MetricGauge* mWorkerCount;
+};
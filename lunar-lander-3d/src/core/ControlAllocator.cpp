@@ -0,0 +1,365 @@
+// ControlAllocator.cpp
+// Implementation of thruster layouts and the active-set control allocator
+
+#include "ControlAllocator.h"
+#include "Entity.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Ridge on the Hessian: keeps the free block positive definite when
+// thrusters are redundant (opposed pairs, coupled quads) and otherwise
+// picks the smallest commands among equally good allocations
+static const double kRidge = 1e-6;
+
+// Default price of fuel, relative to full authority on an axis
+static const float kDefaultFuelWeight = 1e-4f;
+
+// Bound multipliers closer to zero than this count as optimal
+static const double kMultiplierTolerance = 1e-9;
+
+// Each iteration adds or removes one bound, so this only trips on cycling
+static const int kMaxIterations = 64;
+
+static void Cross(const float* a, const float* b, float* result) {
+    result[0] = a[1] * b[2] - a[2] * b[1];
+    result[1] = a[2] * b[0] - a[0] * b[2];
+    result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+ThrusterLayout::ThrusterLayout()
+    : mCount(0)
+{
+}
+
+int ThrusterLayout::AddThruster(const Thruster& thruster) {
+    if (mCount >= kMaxThrusters) {
+        std::cerr << "Thruster layout is full (" << kMaxThrusters << " thrusters)" << std::endl;
+        return -1;
+    }
+
+    const float* direction = thruster.direction;
+    float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    if (length <= 0.0f || thruster.maxForce <= 0.0f) {
+        std::cerr << "Thruster needs a direction and a positive maximum force" << std::endl;
+        return -1;
+    }
+
+    Thruster& added = mThrusters[mCount];
+    added = thruster;
+    for (int i = 0; i < 3; i++) {
+        added.direction[i] /= length;
+    }
+    return mCount++;
+}
+
+void ThrusterLayout::ComputeWrench(const float* forces, float* wrench) const {
+    std::fill(wrench, wrench + kWrenchSize, 0.0f);
+    for (int i = 0; i < mCount; i++) {
+        const Thruster& thruster = mThrusters[i];
+        float torque[3];
+        Cross(thruster.position, thruster.direction, torque);
+        for (int axis = 0; axis < 3; axis++) {
+            wrench[axis] += thruster.direction[axis] * forces[i];
+            wrench[3 + axis] += torque[axis] * forces[i];
+        }
+    }
+}
+
+ThrusterLayout ThrusterLayout::CreateDefault(const Lander& lander, float rcsForce) {
+    ThrusterLayout layout;
+
+    // Descent engine at the base, pushing up (world Y grows downwards)
+    Thruster engine = { { 0.0f, lander.GetHeight() / 2.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, lander.GetMaxThrustForce() };
+    layout.AddThruster(engine);
+
+    // A quad on each diagonal, a quarter of the height above the center;
+    // the sideways pair pushes inwards along x and z
+    const float x = lander.GetWidth() / 2.0f;
+    const float y = -lander.GetHeight() / 4.0f;
+    const float z = lander.GetDepth() / 2.0f;
+    for (int quad = 0; quad < 4; quad++) {
+        float sx = (quad & 1) ? -1.0f : 1.0f;
+        float sz = (quad & 2) ? -1.0f : 1.0f;
+        Thruster up = { { sx * x, y, sz * z }, { 0.0f, -1.0f, 0.0f }, rcsForce };
+        Thruster down = { { sx * x, y, sz * z }, { 0.0f, 1.0f, 0.0f }, rcsForce };
+        Thruster sideX = { { sx * x, y, sz * z }, { -sx, 0.0f, 0.0f }, rcsForce };
+        Thruster sideZ = { { sx * x, y, sz * z }, { 0.0f, 0.0f, -sz }, rcsForce };
+        layout.AddThruster(up);
+        layout.AddThruster(down);
+        layout.AddThruster(sideX);
+        layout.AddThruster(sideZ);
+    }
+    return layout;
+}
+
+ControlAllocator::ControlAllocator()
+    : mCount(0)
+    , mFuelWeight(kDefaultFuelWeight)
+{
+    std::fill(mAxisWeights, mAxisWeights + kWrenchSize, 1.0f);
+    std::fill(mRowScale, mRowScale + kWrenchSize, 0.0);
+    std::fill(mEnabled, mEnabled + kMaxThrusters, true);
+    ResetWarmStart();
+}
+
+bool ControlAllocator::SetLayout(const ThrusterLayout& layout) {
+    if (layout.GetThrusterCount() == 0) {
+        std::cerr << "Control allocator needs at least one thruster" << std::endl;
+        return false;
+    }
+
+    mLayout = layout;
+    mCount = layout.GetThrusterCount();
+    std::fill(mEnabled, mEnabled + kMaxThrusters, true);
+    ResetWarmStart();
+    BuildNormalEquations();
+    return true;
+}
+
+void ControlAllocator::SetAxisWeights(const float* weights) {
+    for (int k = 0; k < kWrenchSize; k++) {
+        mAxisWeights[k] = std::max(0.0f, weights[k]);
+    }
+    BuildNormalEquations();
+}
+
+void ControlAllocator::SetFuelWeight(float weight) {
+    mFuelWeight = std::max(0.0f, weight);
+    BuildNormalEquations();
+}
+
+void ControlAllocator::SetThrusterEnabled(int index, bool enabled) {
+    if (index >= 0 && index < mCount) {
+        mEnabled[index] = enabled;
+    }
+}
+
+void ControlAllocator::ResetWarmStart() {
+    std::fill(mCommand, mCommand + kMaxThrusters, 0.0);
+    std::fill(mBound, mBound + kMaxThrusters, static_cast<signed char>(-1));
+}
+
+void ControlAllocator::BuildNormalEquations() {
+    if (mCount == 0) {
+        return;
+    }
+
+    // Wrench of each thruster at full force
+    float largestForce = 0.0f;
+    for (int i = 0; i < mCount; i++) {
+        const Thruster& thruster = mLayout.GetThruster(i);
+        float torque[3];
+        Cross(thruster.position, thruster.direction, torque);
+        for (int axis = 0; axis < 3; axis++) {
+            mMatrix[axis][i] = thruster.direction[axis] * thruster.maxForce;
+            mMatrix[3 + axis][i] = torque[axis] * thruster.maxForce;
+        }
+        largestForce = std::max(largestForce, thruster.maxForce);
+    }
+
+    // Scale each axis by its authority (the most all thrusters together can
+    // produce either way), so force and torque errors are comparable
+    for (int k = 0; k < kWrenchSize; k++) {
+        double positive = 0.0;
+        double negative = 0.0;
+        for (int i = 0; i < mCount; i++) {
+            positive += std::max(0.0, mMatrix[k][i]);
+            negative += std::max(0.0, -mMatrix[k][i]);
+        }
+        double authority = std::max(positive, negative);
+        mRowScale[k] = authority > 0.0 ? std::sqrt(static_cast<double>(mAxisWeights[k])) / authority : 0.0;
+        for (int i = 0; i < mCount; i++) {
+            mMatrix[k][i] *= mRowScale[k];
+        }
+    }
+
+    for (int i = 0; i < mCount; i++) {
+        for (int j = 0; j <= i; j++) {
+            double sum = 0.0;
+            for (int k = 0; k < kWrenchSize; k++) {
+                sum += mMatrix[k][i] * mMatrix[k][j];
+            }
+            mHessian[i][j] = mHessian[j][i] = sum;
+        }
+        mHessian[i][i] += kRidge;
+        mFuelCost[i] = mFuelWeight * mLayout.GetThruster(i).maxForce / largestForce;
+    }
+}
+
+bool ControlAllocator::SolveFreeSet(int freeCount, double* values) {
+    // Cholesky factor of the free block, lower triangle, row-major
+    const int n = freeCount;
+    for (int j = 0; j < n; j++) {
+        double* rowJ = mFactor + j * kMaxThrusters;
+        double diagonal = mHessian[mFree[j]][mFree[j]];
+        for (int k = 0; k < j; k++) {
+            diagonal -= rowJ[k] * rowJ[k];
+        }
+        if (diagonal <= 0.0) {
+            return false;
+        }
+        rowJ[j] = std::sqrt(diagonal);
+
+        for (int i = j + 1; i < n; i++) {
+            double* rowI = mFactor + i * kMaxThrusters;
+            double sum = mHessian[mFree[i]][mFree[j]];
+            for (int k = 0; k < j; k++) {
+                sum -= rowI[k] * rowJ[k];
+            }
+            rowI[j] = sum / rowJ[j];
+        }
+    }
+
+    // Forward then back substitution, in place
+    for (int i = 0; i < n; i++) {
+        const double* row = mFactor + i * kMaxThrusters;
+        double sum = values[i];
+        for (int k = 0; k < i; k++) {
+            sum -= row[k] * values[k];
+        }
+        values[i] = sum / row[i];
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        double sum = values[i];
+        for (int k = i + 1; k < n; k++) {
+            sum -= mFactor[k * kMaxThrusters + i] * values[k];
+        }
+        values[i] = sum / mFactor[i * kMaxThrusters + i];
+    }
+    return true;
+}
+
+bool ControlAllocator::Allocate(const float* desiredWrench, float* forces, AllocationResult* result) {
+    // Objective 1/2 |M u - d|^2 + c.u + ridge, i.e. 1/2 u.H u - target.u
+    double desired[kWrenchSize];
+    for (int k = 0; k < kWrenchSize; k++) {
+        desired[k] = mRowScale[k] * desiredWrench[k];
+    }
+    double target[kMaxThrusters];
+    for (int i = 0; i < mCount; i++) {
+        double sum = -mFuelCost[i];
+        for (int k = 0; k < kWrenchSize; k++) {
+            sum += mMatrix[k][i] * desired[k];
+        }
+        target[i] = sum;
+    }
+
+    // Warm start from the previous active set; bound thrusters sit exactly
+    // on their bound and failed ones are pinned at zero
+    for (int i = 0; i < mCount; i++) {
+        if (!mEnabled[i]) {
+            mBound[i] = -1;
+        }
+        if (mBound[i] < 0) {
+            mCommand[i] = 0.0;
+        } else if (mBound[i] > 0) {
+            mCommand[i] = 1.0;
+        } else {
+            mCommand[i] = std::max(0.0, std::min(1.0, mCommand[i]));
+        }
+    }
+
+    int iterations = 0;
+    bool converged = false;
+    double candidate[kMaxThrusters];
+    while (iterations < kMaxIterations) {
+        iterations++;
+
+        // Minimize over the free thrusters with the others held at their bounds
+        int freeCount = 0;
+        for (int i = 0; i < mCount; i++) {
+            if (mBound[i] == 0) {
+                mFree[freeCount++] = i;
+            }
+        }
+        for (int f = 0; f < freeCount; f++) {
+            const double* row = mHessian[mFree[f]];
+            double sum = target[mFree[f]];
+            for (int j = 0; j < mCount; j++) {
+                if (mBound[j] != 0) {
+                    sum -= row[j] * mCommand[j];
+                }
+            }
+            candidate[f] = sum;
+        }
+        if (freeCount > 0 && !SolveFreeSet(freeCount, candidate)) {
+            break;
+        }
+
+        // Step towards that minimum until a thruster hits a bound
+        double step = 1.0;
+        int blocking = -1;
+        for (int f = 0; f < freeCount; f++) {
+            double current = mCommand[mFree[f]];
+            double next = candidate[f];
+            if (next < 0.0 && current / (current - next) < step) {
+                step = current / (current - next);
+                blocking = f;
+            } else if (next > 1.0 && (1.0 - current) / (next - current) < step) {
+                step = (1.0 - current) / (next - current);
+                blocking = f;
+            }
+        }
+        for (int f = 0; f < freeCount; f++) {
+            double& command = mCommand[mFree[f]];
+            command += step * (candidate[f] - command);
+        }
+        if (blocking >= 0) {
+            int index = mFree[blocking];
+            bool upper = candidate[blocking] > 1.0;
+            mCommand[index] = upper ? 1.0 : 0.0;
+            mBound[index] = upper ? 1 : -1;
+            continue;
+        }
+
+        // Optimal for this active set; release the bound thruster whose
+        // multiplier most says the objective improves off its bound
+        int release = -1;
+        double worst = kMultiplierTolerance;
+        for (int i = 0; i < mCount; i++) {
+            if (mBound[i] == 0 || !mEnabled[i]) {
+                continue;
+            }
+            const double* row = mHessian[i];
+            double gradient = -target[i];
+            for (int j = 0; j < mCount; j++) {
+                gradient += row[j] * mCommand[j];
+            }
+            double violation = mBound[i] < 0 ? -gradient : gradient;
+            if (violation > worst) {
+                worst = violation;
+                release = i;
+            }
+        }
+        if (release < 0) {
+            converged = true;
+            break;
+        }
+        mBound[release] = 0;
+    }
+
+    for (int i = 0; i < mCount; i++) {
+        forces[i] = static_cast<float>(mCommand[i] * mLayout.GetThruster(i).maxForce);
+    }
+
+    if (result) {
+        double errorSum = 0.0;
+        int weightedAxes = 0;
+        for (int k = 0; k < kWrenchSize; k++) {
+            if (mRowScale[k] == 0.0) {
+                continue;
+            }
+            double achieved = 0.0;
+            for (int i = 0; i < mCount; i++) {
+                achieved += mMatrix[k][i] * mCommand[i];
+            }
+            errorSum += (achieved - desired[k]) * (achieved - desired[k]);
+            weightedAxes++;
+        }
+        result->iterations = iterations;
+        result->converged = converged;
+        result->residual = weightedAxes > 0 ? static_cast<float>(std::sqrt(errorSum / weightedAxes)) : 0.0f;
+    }
+    return converged;
+}
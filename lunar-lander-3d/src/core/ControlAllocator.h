@@ -0,0 +1,127 @@
+// ControlAllocator.h
+// Thruster layouts and the per-tick allocation of force and torque to thrusters
+
+#pragma once
+
+class Lander;
+
+// One thruster in the lander's body frame: x right, y down, z depth, with
+// the origin at the center of mass
+struct Thruster {
+    float position[3];
+    float direction[3];  // Unit vector along which it pushes the lander
+    float maxForce;      // Newtons; commands range from zero to this
+};
+
+// A fixed set of thrusters, typically a main engine and RCS quads
+class ThrusterLayout {
+public:
+    static const int kMaxThrusters = 32;
+
+    // Wrenches are force x, y, z then torque about x, y, z
+    static const int kWrenchSize = 6;
+
+    // Index of the descent engine in CreateDefault() layouts
+    static const int kMainEngine = 0;
+
+    ThrusterLayout();
+
+    // Returns the new thruster's index, or -1 when the layout is full
+    int AddThruster(const Thruster& thruster);
+    void Clear() { mCount = 0; }
+
+    int GetThrusterCount() const { return mCount; }
+    const Thruster& GetThruster(int index) const { return mThrusters[index]; }
+
+    // Total force and torque of the given per-thruster forces
+    void ComputeWrench(const float* forces, float* wrench) const;
+
+    // Descent engine under the lander plus four RCS quads on the diagonals
+    // of its upper body, each with an up, a down and two sideways thrusters
+    // (the Apollo LM arrangement), sized to the lander
+    static ThrusterLayout CreateDefault(const Lander& lander, float rcsForce = 445.0f);
+
+private:
+    Thruster mThrusters[kMaxThrusters];
+    int mCount;
+};
+
+// Result of ControlAllocator::Allocate()
+struct AllocationResult {
+    int iterations;  // Active-set iterations (one linear solve each)
+    bool converged;
+    float residual;  // Weighted RMS of the wrench error, relative to each axis' authority
+};
+
+// Maps a desired force and torque to thruster forces by bounded least
+// squares: minimize the weighted wrench error plus a small fuel cost, with
+// every thruster between zero and its maximum. Solved with a primal
+// active-set method on the normal equations, which are built once per
+// layout; each iteration factors the free thrusters' block (Cholesky) and
+// either lands on an optimum, moves a thruster onto a bound or frees one.
+// The active set carries over between calls, so a slowly changing command
+// usually settles in one or two iterations. All storage is fixed-size
+// members: Allocate() never allocates, and one allocator per thread is
+// enough for batched rollouts.
+class ControlAllocator {
+public:
+    ControlAllocator();
+
+    // Precompute the normal equations of a layout; resets enabled flags and
+    // the warm start
+    bool SetLayout(const ThrusterLayout& layout);
+    const ThrusterLayout& GetLayout() const { return mLayout; }
+
+    // Relative importance of each wrench axis; zero leaves an axis free.
+    // Errors are measured relative to the layout's authority on each axis.
+    void SetAxisWeights(const float* weights);
+
+    // Cost of running the largest thruster at full force, against a wrench
+    // error of that axis' full authority; smaller thrusters cost pro rata
+    void SetFuelWeight(float weight);
+
+    // A failed thruster stays in the layout but gets no share of the command
+    void SetThrusterEnabled(int index, bool enabled);
+    bool IsThrusterEnabled(int index) const { return mEnabled[index]; }
+
+    // Forces (newtons, one per thruster) best producing the desired wrench.
+    // Returns whether the solve converged; the forces are within bounds
+    // either way.
+    bool Allocate(const float* desiredWrench, float* forces, AllocationResult* result = nullptr);
+
+    // Forget the previous solution (e.g. after a discontinuous command)
+    void ResetWarmStart();
+
+private:
+    static const int kMaxThrusters = ThrusterLayout::kMaxThrusters;
+    static const int kWrenchSize = ThrusterLayout::kWrenchSize;
+
+    void BuildNormalEquations();
+    // Solve H_FF x = values in place for the first freeCount entries of mFree
+    bool SolveFreeSet(int freeCount, double* values);
+
+    ThrusterLayout mLayout;
+    int mCount;
+
+    // Wrench per unit command (commands are fractions of each maxForce),
+    // each row scaled by its weight over the axis' authority
+    double mMatrix[kWrenchSize][kMaxThrusters];
+    double mRowScale[kWrenchSize];
+    float mAxisWeights[kWrenchSize];
+    float mFuelWeight;
+    double mFuelCost[kMaxThrusters];
+
+    // Hessian of the objective: M^T M plus a small ridge
+    double mHessian[kMaxThrusters][kMaxThrusters];
+
+    bool mEnabled[kMaxThrusters];
+
+    // Solution and active set of the previous call: -1 at zero, 1 at full
+    // force, 0 free
+    double mCommand[kMaxThrusters];
+    signed char mBound[kMaxThrusters];
+
+    // Scratch for the free-set solve
+    int mFree[kMaxThrusters];
+    double mFactor[kMaxThrusters * kMaxThrusters];
+};
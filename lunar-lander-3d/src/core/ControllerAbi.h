@@ -0,0 +1,80 @@
+// ControllerAbi.h
+// C interface between the simulator and dynamically loaded controller plugins
+//
+// A plugin is a shared library exporting the functions below with C linkage.
+// Everything passed across is plain data, so plugins may be written in C,
+// C++ or anything else that can export C functions, and built with any
+// compiler. Bump LANDER_CONTROLLER_ABI_VERSION on any layout change.
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LANDER_CONTROLLER_ABI_VERSION 1
+
+#if defined(_WIN32)
+    #define LANDER_CONTROLLER_EXPORT __declspec(dllexport)
+#else
+    #define LANDER_CONTROLLER_EXPORT __attribute__((visibility("default")))
+#endif
+
+// LanderObservation::flags
+#define LANDER_OBS_SENSORS_VALID (1u << 0)  // Cleared during a sensor dropout; readings are the last good ones
+#define LANDER_OBS_NEW_EPISODE   (1u << 1)  // First step of a new flight in this lane
+
+// LanderAction::inputs, the same bits the pilot's keys produce
+#define LANDER_ACTION_THRUST       (1u << 0)
+#define LANDER_ACTION_ROTATE_LEFT  (1u << 1)
+#define LANDER_ACTION_ROTATE_RIGHT (1u << 2)
+
+// Passed to init; constant for the life of a context
+typedef struct LanderControllerInfo {
+    uint32_t abiVersion;
+    uint32_t laneCount;          // Most observations in one step_n call; lanes are 0..laneCount-1
+    float gravityAcceleration;   // World units/s², along +y (down)
+    float thrustAcceleration;    // At full thrust, along the lander's up axis
+    float rotationStep;          // Degrees turned per step with a rotate input
+    const char* config;          // Free-form settings from the command line; never null
+} LanderControllerInfo;
+
+// What the lander's sensors report at the start of a step
+typedef struct LanderObservation {
+    float time;         // Simulated seconds since the flight started
+    float deltaTime;    // Simulated seconds this step will advance
+    float position[3];  // World units; y points down
+    float velocity[3];
+    float tilt;         // Degrees, -180..180; rotating right lowers it
+    float altitude;     // Of the lander's base above the ground
+    float fuel;
+    float maxFuel;
+    uint32_t lane;      // Flights in different lanes are independent
+    uint32_t flags;     // LANDER_OBS_* bits
+} LanderObservation;
+
+typedef struct LanderAction {
+    uint32_t inputs;    // LANDER_ACTION_* bits
+} LanderAction;
+
+// Exported entry points. step_n is optional: without it the host calls step
+// once per observation. Calls on one context come from one thread at a
+// time; separate contexts may be stepped from different threads.
+typedef uint32_t (*LanderControllerAbiVersionFn)(void);
+typedef int (*LanderControllerInitFn)(const LanderControllerInfo* info, void** context);  // 0 on success
+typedef void (*LanderControllerStepFn)(void* context, const LanderObservation* observation, LanderAction* action);
+typedef void (*LanderControllerStepNFn)(void* context, uint32_t count, const LanderObservation* observations,
+                                        LanderAction* actions);
+typedef void (*LanderControllerShutdownFn)(void* context);
+
+#define LANDER_CONTROLLER_ABI_VERSION_SYMBOL "lander_controller_abi_version"
+#define LANDER_CONTROLLER_INIT_SYMBOL        "lander_controller_init"
+#define LANDER_CONTROLLER_STEP_SYMBOL        "lander_controller_step"
+#define LANDER_CONTROLLER_STEP_N_SYMBOL      "lander_controller_step_n"
+#define LANDER_CONTROLLER_SHUTDOWN_SYMBOL    "lander_controller_shutdown"
+
+#ifdef __cplusplus
+}
+#endif
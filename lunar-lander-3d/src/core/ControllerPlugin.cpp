@@ -0,0 +1,187 @@
+// ControllerPlugin.cpp
+// Implementation of the controller plugin loader
+
+#include "ControllerPlugin.h"
+#include "Entity.h"
+#include "Replay.h"
+#include "Terrain.h"
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+    #include <dlfcn.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+static_assert(LANDER_ACTION_THRUST == INPUT_THRUST && LANDER_ACTION_ROTATE_LEFT == INPUT_ROTATE_LEFT &&
+              LANDER_ACTION_ROTATE_RIGHT == INPUT_ROTATE_RIGHT, "Actions are applied as pilot inputs");
+
+// Numbers the private copies of loaded libraries
+static std::atomic<int> sNextCopy(0);
+
+ControllerPlugin::ControllerPlugin()
+    : mHandle(nullptr)
+    , mLoadedStamp()
+    , mSeenStamp()
+    , mInit(nullptr)
+    , mStep(nullptr)
+    , mStepN(nullptr)
+    , mShutdown(nullptr)
+{
+}
+
+ControllerPlugin::~ControllerPlugin() {
+    Unload();
+}
+
+bool ControllerPlugin::Load(const std::string& path) {
+    Unload();
+
+#ifndef _WIN32
+    FileStamp stamp;
+    if (!GetFileStamp(path, stamp)) {
+        std::cerr << "Controller plugin not found: " << path << std::endl;
+        return false;
+    }
+
+    // Private copy, removed again once mapped
+    const char* tempDir = std::getenv("TMPDIR");
+    std::string copyPath = std::string(tempDir && *tempDir ? tempDir : "/tmp") + "/lander-controller-" +
+                           std::to_string(getpid()) + "-" + std::to_string(sNextCopy.fetch_add(1)) + ".so";
+    {
+        std::ifstream source(path, std::ios::binary);
+        std::ofstream copy(copyPath, std::ios::binary | std::ios::trunc);
+        copy << source.rdbuf();
+        if (!source || !copy) {
+            std::cerr << "Failed to copy controller plugin " << path << " to " << copyPath << std::endl;
+            unlink(copyPath.c_str());
+            return false;
+        }
+    }
+
+    void* handle = dlopen(copyPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+    unlink(copyPath.c_str());
+    if (!handle) {
+        std::cerr << "Failed to load controller plugin " << path << ": " << dlerror() << std::endl;
+        return false;
+    }
+
+    LanderControllerAbiVersionFn abiVersion =
+        reinterpret_cast<LanderControllerAbiVersionFn>(dlsym(handle, LANDER_CONTROLLER_ABI_VERSION_SYMBOL));
+    mInit = reinterpret_cast<LanderControllerInitFn>(dlsym(handle, LANDER_CONTROLLER_INIT_SYMBOL));
+    mStep = reinterpret_cast<LanderControllerStepFn>(dlsym(handle, LANDER_CONTROLLER_STEP_SYMBOL));
+    mStepN = reinterpret_cast<LanderControllerStepNFn>(dlsym(handle, LANDER_CONTROLLER_STEP_N_SYMBOL));
+    mShutdown = reinterpret_cast<LanderControllerShutdownFn>(dlsym(handle, LANDER_CONTROLLER_SHUTDOWN_SYMBOL));
+
+    if (!abiVersion || !mInit || !mStep || !mShutdown) {
+        std::cerr << "Controller plugin " << path << " does not export the controller interface" << std::endl;
+        dlclose(handle);
+        return false;
+    }
+    if (abiVersion() != LANDER_CONTROLLER_ABI_VERSION) {
+        std::cerr << "Controller plugin " << path << " was built for interface version " << abiVersion()
+                  << ", not " << LANDER_CONTROLLER_ABI_VERSION << std::endl;
+        dlclose(handle);
+        return false;
+    }
+
+    mHandle = handle;
+    mPath = path;
+    mLoadedStamp = stamp;
+    mSeenStamp = stamp;
+    return true;
+#else
+    (void)path;
+    std::cerr << "Controller plugins need dlopen" << std::endl;
+    return false;
+#endif
+}
+
+void ControllerPlugin::Unload() {
+#ifndef _WIN32
+    if (mHandle) {
+        dlclose(mHandle);
+    }
+#endif
+    mHandle = nullptr;
+    mInit = nullptr;
+    mStep = nullptr;
+    mStepN = nullptr;
+    mShutdown = nullptr;
+}
+
+bool ControllerPlugin::CreateContext(const LanderControllerInfo& info, void*& context) const {
+    context = nullptr;
+    if (!mHandle) {
+        return false;
+    }
+
+    if (mInit(&info, &context) != 0) {
+        std::cerr << "Controller plugin " << mPath << " failed to initialize" << std::endl;
+        context = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void ControllerPlugin::DestroyContext(void* context) const {
+    if (mHandle) {
+        mShutdown(context);
+    }
+}
+
+bool ControllerPlugin::CheckForUpdate() {
+    FileStamp stamp;
+    if (!mHandle || !GetFileStamp(mPath, stamp)) {
+        return false;
+    }
+
+    bool stable = stamp == mSeenStamp;
+    mSeenStamp = stamp;
+    return stable && !(stamp == mLoadedStamp);
+}
+
+bool ControllerPlugin::GetFileStamp(const std::string& path, FileStamp& stamp) {
+#ifndef _WIN32
+    struct stat fileStat;
+    if (stat(path.c_str(), &fileStat) != 0) {
+        return false;
+    }
+    stamp.inode = static_cast<uint64_t>(fileStat.st_ino);
+    stamp.size = static_cast<uint64_t>(fileStat.st_size);
+    stamp.modified = static_cast<int64_t>(fileStat.st_mtime);
+    return true;
+#else
+    (void)path;
+    (void)stamp;
+    return false;
+#endif
+}
+
+void ControllerPlugin::ObserveLander(const Lander& lander, const Terrain& terrain, bool is3D,
+                                     LanderObservation& observation) {
+    const float* position = lander.GetPosition();
+    const float* velocity = lander.GetVelocity();
+    for (int i = 0; i < 3; i++) {
+        observation.position[i] = position[i];
+        observation.velocity[i] = velocity[i];
+    }
+
+    // Same base as Terrain::CheckCollision2D / CheckCollision3D
+    float ground = position[1];
+    if (is3D) {
+        terrain.GetSurfaceHeight3D(position[0], position[2], ground);
+        observation.altitude = ground - (position[1] + lander.GetHeight() / 2.0f);
+    } else {
+        terrain.GetSurfaceHeight2D(position[0], ground);
+        observation.altitude = ground - (position[1] - lander.GetHeight() / 2.0f);
+    }
+
+    float tilt = lander.GetRotation()[2];
+    observation.tilt = tilt > 180.0f ? tilt - 360.0f : tilt;
+    observation.fuel = lander.GetFuel();
+    observation.maxFuel = lander.GetMaxFuel();
+}
@@ -0,0 +1,81 @@
+// ControllerPlugin.h
+// Loads controller plugins (see ControllerAbi.h) and steps them
+
+#pragma once
+
+#include "ControllerAbi.h"
+#include <cstdint>
+#include <string>
+
+class Lander;
+class Terrain;
+
+// One loaded plugin library. The entry points are plain function pointers,
+// so a step is a direct call with the observations passed in place.
+//
+// Load() maps a private copy of the file rather than the file itself: a
+// rebuild can overwrite the library while it is in use, and a newer build
+// can be loaded next to the old one. Hot reload is done by loading the
+// changed file into a second ControllerPlugin, moving to contexts created
+// from it, and then destroying the first.
+class ControllerPlugin {
+public:
+    ControllerPlugin();
+    ~ControllerPlugin();
+
+    bool Load(const std::string& path);
+    void Unload();
+    bool IsLoaded() const { return mHandle != nullptr; }
+    const std::string& GetPath() const { return mPath; }
+    bool HasBatchStep() const { return mStepN != nullptr; }
+
+    // A context holds the controller's state for one thread (plugins
+    // without state may leave it null); false when the plugin's init fails
+    bool CreateContext(const LanderControllerInfo& info, void*& context) const;
+    void DestroyContext(void* context) const;
+
+    void Step(void* context, const LanderObservation& observation, LanderAction& action) const {
+        mStep(context, &observation, &action);
+    }
+
+    void StepBatch(void* context, uint32_t count, const LanderObservation* observations, LanderAction* actions) const {
+        if (mStepN) {
+            mStepN(context, count, observations, actions);
+            return;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            mStep(context, &observations[i], &actions[i]);
+        }
+    }
+
+    // True once the file on disk differs from the loaded one and has not
+    // changed since the previous call (so a half-written build is skipped)
+    bool CheckForUpdate();
+
+    // Sensor part of an observation (position, velocity, tilt, altitude, fuel)
+    static void ObserveLander(const Lander& lander, const Terrain& terrain, bool is3D, LanderObservation& observation);
+
+private:
+    // Identity of a version of the file
+    struct FileStamp {
+        uint64_t inode;
+        uint64_t size;
+        int64_t modified;
+
+        bool operator==(const FileStamp& other) const {
+            return inode == other.inode && size == other.size && modified == other.modified;
+        }
+    };
+
+    static bool GetFileStamp(const std::string& path, FileStamp& stamp);
+
+    void* mHandle;
+    std::string mPath;
+    FileStamp mLoadedStamp;
+    FileStamp mSeenStamp;  // From the last CheckForUpdate()
+
+    LanderControllerInitFn mInit;
+    LanderControllerStepFn mStep;
+    LanderControllerStepNFn mStepN;
+    LanderControllerShutdownFn mShutdown;
+};
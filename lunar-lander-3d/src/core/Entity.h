@@ -75,7 +75,9 @@ public:
     // Getters
     float GetFuel() const { return mFuel; }
     float GetMaxFuel() const { return mMaxFuel; }
+    float GetFuelConsumptionRate() const { return mFuelConsumptionRate; }
     float GetThrustLevel() const { return mThrustLevel; }
+    float GetMaxThrustForce() const { return mMaxThrustForce; }
     bool IsThrustActive() const { return mThrustActive; }
     bool IsLanded() const { return mLanded; }
     bool IsCrashed() const { return mCrashed; }
@@ -89,6 +91,7 @@ public:
     float GetDepth() const { return mDepth; } // For 3D
     
     // Status settings
+    void SetFuel(float fuel) { mFuel = fuel; }
     void SetLanded(bool landed) { mLanded = landed; }
     void SetCrashed(bool crashed) { mCrashed = crashed; }
 
@@ -0,0 +1,193 @@
+// FaultInjector.cpp
+// Implementation of the fault scenarios
+
+#include "FaultInjector.h"
+#include "Entity.h"
+#include "Replay.h"
+#include <algorithm>
+#include <limits>
+
+static const char* const kFaultNames[] = {
+    "thrust-loss",
+    "stuck-throttle",
+    "sensor-dropout",
+    "input-delay",
+    "rcs-failure"
+};
+
+// Magnitude ranges of random faults
+static const float kRandomThrustLossMin = 0.3f;
+static const float kRandomInputDelayMin = 0.1f;  // Seconds
+static const float kRandomInputDelayMax = 0.5f;
+
+const char* GetFaultName(FaultType type) {
+    int index = static_cast<int>(type);
+    return index >= 0 && index < static_cast<int>(FaultType::Count) ? kFaultNames[index] : "unknown";
+}
+
+bool ParseFaultType(const std::string& name, FaultType& type) {
+    for (int i = 0; i < static_cast<int>(FaultType::Count); i++) {
+        if (name == kFaultNames[i]) {
+            type = static_cast<FaultType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const FaultState& FaultState::Nominal() {
+    static const FaultState nominal = { 1.0f, -1.0f, 0xFF, 0, true };
+    return nominal;
+}
+
+FaultInjector::FaultInjector()
+    : mTickLength(1.0f / 60.0f)
+    , mNextChange(0)
+    , mNextChangeTime(std::numeric_limits<float>::infinity())
+    , mState(FaultState::Nominal())
+    , mOccurred(0)
+    , mInputHead(0)
+{
+    std::fill(mInputHistory, mInputHistory + kMaxInputDelayTicks, 0);
+}
+
+void FaultInjector::BeginEpisode(uint32_t seed, float tickLength) {
+    mRandom.seed(seed);
+    mTickLength = tickLength > 0.0f ? tickLength : 1.0f / 60.0f;
+    mEvents = mScenario.scripted;
+
+    // Random faults: exponential gaps between starts, uniform type, duration
+    // and magnitude
+    std::vector<FaultType> randomTypes;
+    for (int i = 0; i < static_cast<int>(FaultType::Count); i++) {
+        if (mScenario.randomTypes & (1u << i)) {
+            randomTypes.push_back(static_cast<FaultType>(i));
+        }
+    }
+    if (!randomTypes.empty() && mScenario.randomRate > 0.0f) {
+        std::exponential_distribution<float> gap(mScenario.randomRate);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::uniform_int_distribution<size_t> pickType(0, randomTypes.size() - 1);
+
+        for (float time = gap(mRandom); time < mScenario.horizon; time += gap(mRandom)) {
+            FaultEvent event;
+            event.type = randomTypes[pickType(mRandom)];
+            event.startTime = time;
+            event.duration = mScenario.randomMinDuration +
+                             (mScenario.randomMaxDuration - mScenario.randomMinDuration) * unit(mRandom);
+            switch (event.type) {
+                case FaultType::ThrustLoss:
+                    event.magnitude = kRandomThrustLossMin + (1.0f - kRandomThrustLossMin) * unit(mRandom);
+                    break;
+                case FaultType::StuckThrottle:
+                    event.magnitude = unit(mRandom);
+                    break;
+                case FaultType::InputDelay:
+                    event.magnitude = kRandomInputDelayMin + (kRandomInputDelayMax - kRandomInputDelayMin) * unit(mRandom);
+                    break;
+                case FaultType::RcsFailure:
+                    event.magnitude = static_cast<float>(static_cast<int>(unit(mRandom) * 3.0f) - 1);
+                    break;
+                default:
+                    event.magnitude = 0.0f;
+                    break;
+            }
+            mEvents.push_back(event);
+        }
+    }
+
+    std::stable_sort(mEvents.begin(), mEvents.end(), [](const FaultEvent& a, const FaultEvent& b) {
+        return a.startTime < b.startTime;
+    });
+
+    // Every start and end, in time order
+    mChanges.clear();
+    for (size_t i = 0; i < mEvents.size(); i++) {
+        Change start = { mEvents[i].startTime, static_cast<int>(i), true };
+        mChanges.push_back(start);
+        if (mEvents[i].duration > 0.0f) {
+            Change end = { mEvents[i].startTime + mEvents[i].duration, static_cast<int>(i), false };
+            mChanges.push_back(end);
+        }
+    }
+    std::stable_sort(mChanges.begin(), mChanges.end(), [](const Change& a, const Change& b) {
+        return a.time < b.time;
+    });
+
+    mActive.assign(mEvents.size(), false);
+    mNextChange = 0;
+    mNextChangeTime = mChanges.empty() ? std::numeric_limits<float>::infinity() : mChanges[0].time;
+    mState = FaultState::Nominal();
+    mOccurred = 0;
+    std::fill(mInputHistory, mInputHistory + kMaxInputDelayTicks, 0);
+    mInputHead = 0;
+}
+
+void FaultInjector::ApplyNextChange() {
+    const Change& change = mChanges[mNextChange++];
+    mActive[change.event] = change.starts;
+    if (change.starts) {
+        mOccurred |= 1u << static_cast<int>(mEvents[change.event].type);
+    }
+    UpdateState();
+
+    mNextChangeTime = mNextChange < mChanges.size() ? mChanges[mNextChange].time
+                                                    : std::numeric_limits<float>::infinity();
+}
+
+void FaultInjector::UpdateState() {
+    mState = FaultState::Nominal();
+    for (size_t i = 0; i < mEvents.size(); i++) {
+        if (!mActive[i]) {
+            continue;
+        }
+
+        const FaultEvent& event = mEvents[i];
+        switch (event.type) {
+            case FaultType::ThrustLoss:
+                mState.thrustScale *= 1.0f - std::max(0.0f, std::min(1.0f, event.magnitude));
+                break;
+            case FaultType::StuckThrottle:
+                mState.stuckThrottle = std::max(0.0f, std::min(1.0f, event.magnitude));
+                break;
+            case FaultType::SensorDropout:
+                mState.sensorsValid = false;
+                break;
+            case FaultType::InputDelay: {
+                int ticks = static_cast<int>(event.magnitude / mTickLength + 0.5f);
+                ticks = std::max(0, std::min(kMaxInputDelayTicks - 1, ticks));
+                mState.inputDelayTicks = std::max(mState.inputDelayTicks, ticks);
+                break;
+            }
+            case FaultType::RcsFailure:
+                if (event.magnitude <= 0.0f) {
+                    mState.inputMask &= ~INPUT_ROTATE_LEFT;
+                }
+                if (event.magnitude >= 0.0f) {
+                    mState.inputMask &= ~INPUT_ROTATE_RIGHT;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void FaultInjector::ApplyInputs(Lander* lander, uint8_t inputs) {
+    ApplyPilotInputs(lander, FilterInputs(inputs));
+    ApplyThrottleFaults(lander);
+}
+
+uint8_t FaultInjector::FilterInputs(uint8_t inputs) {
+    // The delay line always runs; with no delay it hands back this tick's input
+    mInputHead = (mInputHead + 1) & (kMaxInputDelayTicks - 1);
+    mInputHistory[mInputHead] = inputs;
+    uint8_t delayed = mInputHistory[(mInputHead - mState.inputDelayTicks) & (kMaxInputDelayTicks - 1)];
+    return delayed & mState.inputMask;
+}
+
+void FaultInjector::ApplyThrottleFaults(Lander* lander) const {
+    if (mState.stuckThrottle >= 0.0f && lander) {
+        lander->ApplyThrust(mState.stuckThrottle);
+    }
+}
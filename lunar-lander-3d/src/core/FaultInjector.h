@@ -0,0 +1,127 @@
+// FaultInjector.h
+// Scripted and random failures of the engine, RCS, sensors and inputs
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+class Lander;
+
+enum class FaultType {
+    ThrustLoss,     // Engine delivers only part of the commanded thrust
+    StuckThrottle,  // Throttle stays at one level whatever the input
+    SensorDropout,  // Sensors stop updating; readers keep the last value
+    InputDelay,     // Pilot inputs arrive late
+    RcsFailure,     // Rotation thrusters stop working
+    Count
+};
+
+// Names as used on the command line ("thrust-loss", ...)
+const char* GetFaultName(FaultType type);
+bool ParseFaultType(const std::string& name, FaultType& type);
+
+// One fault over a span of simulated time
+struct FaultEvent {
+    FaultType type;
+    float startTime;  // Seconds into the episode
+    float duration;   // Seconds; zero or less lasts to the end
+    float magnitude;  // ThrustLoss: fraction lost (0..1)
+                      // StuckThrottle: throttle level (0..1)
+                      // InputDelay: seconds
+                      // RcsFailure: negative left only, positive right only, zero both
+};
+
+// Faults of one episode: a fixed script plus random ones drawn from the
+// episode seed (a Poisson process over the enabled types)
+struct FaultScenario {
+    std::vector<FaultEvent> scripted;
+    uint32_t randomTypes = 0;        // Bit (1 << FaultType) per type drawn at random
+    float randomRate = 0.0f;         // Random faults per simulated second
+    float randomMinDuration = 1.0f;  // Seconds
+    float randomMaxDuration = 10.0f;
+    float horizon = 60.0f;           // Random faults start before this time
+};
+
+// What the active faults do, read every tick. Nominal() is the state with
+// no faults, so consumers never need to check whether faults are enabled.
+struct FaultState {
+    float thrustScale;    // Fraction of the commanded thrust delivered
+    float stuckThrottle;  // Level the throttle is stuck at; negative when it responds
+    uint8_t inputMask;    // PilotInput bits that still have an effect
+    int inputDelayTicks;
+    bool sensorsValid;
+
+    static const FaultState& Nominal();
+};
+
+// Turns a scenario into the per-tick FaultState. Events are sorted into a
+// list of state changes up front, so a tick without one costs one compare.
+class FaultInjector {
+public:
+    // Longest input delay (ticks); a power of two
+    static const int kMaxInputDelayTicks = 64;
+
+    FaultInjector();
+
+    void SetScenario(const FaultScenario& scenario) { mScenario = scenario; }
+    const FaultScenario& GetScenario() const { return mScenario; }
+
+    // Start an episode: draw its random faults and clear all state
+    void BeginEpisode(uint32_t seed, float tickLength);
+
+    // Advance to the given episode time (seconds)
+    void Update(float time) {
+        while (time >= mNextChangeTime) {
+            ApplyNextChange();
+        }
+    }
+
+    const FaultState& GetState() const { return mState; }
+
+    // Input path: apply this tick's pilot inputs to the lander through the
+    // delay line, the RCS mask and any stuck throttle
+    void ApplyInputs(Lander* lander, uint8_t inputs);
+
+    // The same in two parts, for callers that actuate the inputs themselves:
+    // the inputs that get through the delay line and the RCS mask (call
+    // once per tick), then the throttle override applied on top
+    uint8_t FilterInputs(uint8_t inputs);
+    void ApplyThrottleFaults(Lander* lander) const;
+
+    // Fault types that have been active this episode, one bit per type
+    uint32_t GetOccurredFaults() const { return mOccurred; }
+
+    // The episode's events, scripted and random, sorted by start time
+    const std::vector<FaultEvent>& GetEvents() const { return mEvents; }
+
+private:
+    // A fault starting or ending
+    struct Change {
+        float time;
+        int event;
+        bool starts;
+    };
+
+    void ApplyNextChange();
+    void UpdateState();
+
+    FaultScenario mScenario;
+    std::mt19937 mRandom;  // Separate from rand(), which generates terrain
+    float mTickLength;
+
+    std::vector<FaultEvent> mEvents;
+    std::vector<bool> mActive;
+    std::vector<Change> mChanges;
+    size_t mNextChange;
+    float mNextChangeTime;
+
+    FaultState mState;
+    uint32_t mOccurred;
+
+    // Recent inputs, newest at mInputHead
+    uint8_t mInputHistory[kMaxInputDelayTicks];
+    unsigned int mInputHead;
+};
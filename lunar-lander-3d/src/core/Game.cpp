@@ -2,27 +2,112 @@
 // Main game implementation for the lunar lander simulation
 
 #include "Game.h"
+#include "ControllerPlugin.h"
 #include "Entity.h"
+#include "PerfCounters.h"
 #include "Physics.h"
 #include "Terrain.h"
+#include "RewindBuffer.h"
+#include "Replay.h"
+#include "SharedState.h"
+#include "TrajectoryPredictor.h"
+#include "TerrainOverview.h"
 #include "../rendering/Renderer.h"
 #include "../rendering/Renderer2D.h"
 #include "../rendering/Renderer3D.h"
+#ifdef USE_VULKAN
+#include "../rendering/RendererVulkan.h"
+#endif
 #include "../input/InputHandler.h"
 #include <iostream>
 #include <SDL2/SDL.h>
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+
+// Time warp levels: simulation speed and how often a frame is rendered.
+// At high warp most frames are skipped, leaving the time for physics sub-steps.
+struct TimeWarpLevel {
+    float scale;
+    int renderInterval;
+};
+
+static const TimeWarpLevel kTimeWarpLevels[] = {
+    { 1.0f,   1 },
+    { 2.0f,   1 },
+    { 10.0f,  2 },
+    { 100.0f, 4 }
+};
+static const int kTimeWarpLevelCount = sizeof(kTimeWarpLevels) / sizeof(kTimeWarpLevels[0]);
+
+// Time warp drops back to 1x when the lander is closer to the terrain than
+// this, plus the distance it would fall in kTimeWarpLookahead real seconds
+static const float kTimeWarpMinClearance = 100.0f;
+static const float kTimeWarpLookahead = 0.5f;
+
+// Idle and background pacing (milliseconds)
+static const int kIdleWaitTimeout = 500;        // Longest block on events when idle
+static const int kIdleMinimizedTimeout = 2000;  // ... and when minimized
+static const int kForegroundFrameDelay = 1;
+static const int kBackgroundFrameDelay = 30;    // Unfocused: ~30 frames per second
+static const int kMinimizedFrameDelay = 100;    // Minimized: physics only, ~10 Hz
+static const unsigned int kPerfReportInterval = 5000;  // Between profile reports
+static const unsigned int kControllerCheckInterval = 500;  // Between checks for a rebuilt plugin
+
+// 2D camera limits
+static const float kMinCameraZoom = 0.125f;     // Whole world fits on screen
+static const float kMaxCameraZoom = 4.0f;
+static const float kCameraZoomStep = 1.25f;
+static const float kCameraPanStep = 100.0f;     // Screen pixels per key press
+static const float kCameraTopMargin = 100.0f;   // Screen pixels kept above the lander
+
+// 3D scene lights
+static const float kBeaconLift = 3.0f;            // Beacons sit this far above the pad
+static const float kBeaconRadius = 40.0f;
+static const float kBeaconBlinkRate = 4.0f;       // Radians per second
+static const float kBeaconBlinkPhase = 0.6f;      // Phase step between beacons (chase pattern)
+static const float kLandingLightRadius = 400.0f;
+static const float kLandingLightCosine = 0.9f;    // About 25 degree half angle
+static const float kEngineGlowRadius = 150.0f;
 
 Game::Game()
     : mGameState(GameState::READY)
     , mDifficulty(Difficulty::NORMAL)
     , m3DMode(false)
+    , mUseVulkan(false)
+    , mShowTrajectory(true)
+    , mShowMinimap(true)
+    , mShowLandingCamera(false)
+    , mBeaconGeneration(0)
     , mScore(0.0f)
     , mElapsedTime(0.0f)
     , mFuelUsed(0.0f)
     , mLastFrameTime(0)
+    , mTimeWarpLevel(0)
+    , mFramesSinceRender(0)
+    , mRewinding(false)
+    , mRewindTick(0)
+    , mRewindAccumulator(0.0f)
+    , mReplayFlight(0)
+    , mTerrainSeed(0)
+    , mPilotInputs(0)
+    , mUsePerfCounters(false)
+    , mLastPerfReport(0)
+    , mSharedTerrainGeneration(0)
+    , mControllerContext(nullptr)
+    , mControllerNewFlight(true)
+    , mLastControllerCheck(0)
+    , mAirDensity(0.0f)
     , mWindowWidth(800)
     , mWindowHeight(600)
+    , mWorldWidth(Terrain::kWorldWidth2D)
+    , mCameraX(0.0f)
+    , mCameraY(0.0f)
+    , mCameraZoom(1.0f)
+    , mCameraFollow(true)
+    , mWindowMinimized(false)
+    , mWindowFocused(true)
+    , mNeedsRedraw(true)
     , mIsRunning(false)
 {
 }
@@ -35,15 +120,34 @@ bool Game::Initialize() {
     // Create core game components
     mWindowWidth = 800;
     mWindowHeight = 600;
+    mWorldWidth = Terrain::kWorldWidth2D;
     mLander = std::make_unique<Lander>();
     mTerrain = std::make_unique<Terrain>();
     mPhysics = std::make_unique<Physics>();
     mInputHandler = std::make_unique<InputHandler>(this);
+    mRewindBuffer = std::make_unique<RewindBuffer>();
+    mTrajectory = std::make_unique<TrajectoryPredictor>();
+    mOverview = std::make_unique<TerrainOverview>();
 
     std::cout << "Creating renderer - 3D mode: " << (m3DMode ? "true" : "false") << std::endl; // Debug output
 
-    // Create renderer (2D or 3D based on setting)
-    if (m3DMode) {
+    // Create renderer (2D or 3D based on setting). The Vulkan backend is
+    // tried first when requested and falls back to OpenGL if it cannot start.
+    #ifdef USE_VULKAN
+        if (m3DMode && mUseVulkan) {
+            std::unique_ptr<Renderer> vulkan = std::make_unique<RendererVulkan>();
+            if (vulkan->Initialize(mWindowWidth, mWindowHeight, "Lunar Lander Simulator")) {
+                mRenderer = std::move(vulkan);
+                std::cout << "Created Vulkan renderer" << std::endl; // Debug output
+            } else {
+                std::cerr << "Vulkan renderer unavailable. Falling back to OpenGL." << std::endl;
+            }
+        }
+    #endif
+
+    if (mRenderer) {
+        // Vulkan renderer is already running
+    } else if (m3DMode) {
         #ifdef USE_OPENGL
             mRenderer = std::make_unique<Renderer3D>();
             std::cout << "Created 3D renderer" << std::endl; // Debug output
@@ -59,7 +163,7 @@ bool Game::Initialize() {
     }
     
     // Initialize renderer
-    if (!mRenderer->Initialize(mWindowWidth, mWindowHeight, "Lunar Lander Simulator")) {
+    if (!mRenderer->IsInitialized() && !mRenderer->Initialize(mWindowWidth, mWindowHeight, "Lunar Lander Simulator")) {
         std::cerr << "Failed to initialize renderer!" << std::endl;
         return false; 
     } else { 
@@ -70,11 +174,44 @@ bool Game::Initialize() {
     mPhysics->RegisterLander(mLander.get());
     mPhysics->RegisterTerrain(mTerrain.get());
     
+    // Atmosphere and wind if requested
+    if (mAirDensity > 0.0f) {
+        mWindField = std::make_unique<WindField>();
+        if (!mWindField->Initialize(mWindParameters)) {
+            std::cerr << "Failed to initialize wind field!" << std::endl;
+            return false;
+        }
+        mPhysics->SetAirDensity(mAirDensity);
+        mPhysics->SetWindField(mWindField.get());
+    }
+    
+    // Profile frame phases if requested (timing still works without counters)
+    if (mUsePerfCounters) {
+        mProfiler = std::make_unique<FrameProfiler>();
+        mProfiler->Initialize();
+        mPhysics->SetProfiler(mProfiler.get());
+    }
+    
+    // Load the controller plugin if requested; without it the pilot flies
+    if (!mControllerPath.empty() && LoadController(mController, mControllerContext)) {
+        std::cout << "Controller plugin " << mControllerPath << " flies when no key is held" << std::endl;
+    }
+    
+    // Export live state if requested; the game runs on without it
+    if (!mSharedStateName.empty()) {
+        mSharedState = std::make_unique<SharedStateWriter>();
+        if (mSharedState->Open(mSharedStateName)) {
+            std::cout << "Publishing state to shared memory " << mSharedStateName << std::endl;
+        } else {
+            mSharedState.reset();
+        }
+    }
+    
     // Initialize terrain
     if (m3DMode) {
         mTerrain->Generate3D(mWindowWidth, mWindowWidth, mWindowHeight);
     } else {
-        mTerrain->Generate2D(mWindowWidth, mWindowHeight);
+        mTerrain->Generate2D(mWorldWidth, Terrain::kWorldHeight2D);
     }
     
     // Reset game state
@@ -82,6 +219,7 @@ bool Game::Initialize() {
     
     mIsRunning = true;
     mLastFrameTime = SDL_GetTicks();
+    mLastPerfReport = mLastFrameTime;
     
     return true;
 }
@@ -97,6 +235,11 @@ void Game::Run() {
     
     // Main game loop
     while (mIsRunning) {
+        // When nothing moves, sleep until there is input or a window event
+        if (IsIdle()) {
+            WaitWhileIdle();
+        }
+        
         // Calculate delta time
         unsigned int currentTime = SDL_GetTicks();
         float deltaTime = (currentTime - mLastFrameTime) / 1000.0f;
@@ -107,13 +250,42 @@ void Game::Run() {
             deltaTime = 0.1f;
         }
         
-        // Process input, update game state, and render
+        // Process input and update game state
         ProcessInput();
         Update(deltaTime);
-        Render();
+        PublishSharedState();
+        
+        // Render only when something changed, skipping frames when time
+        // warp is high and everything while the window is minimized
+        bool warpFrame = ++mFramesSinceRender >= kTimeWarpLevels[mTimeWarpLevel].renderInterval;
+        if (mNeedsRedraw && warpFrame && !mWindowMinimized) {
+            FrameProfiler::Scope renderScope(mProfiler.get(), FramePhase::Render);
+            Render();
+            mFramesSinceRender = 0;
+            mNeedsRedraw = false;
+        }
         
-        // Small delay to prevent 100% CPU usage
-        SDL_Delay(1);
+        // Small delay to prevent 100% CPU usage, longer in the background
+        if (mWindowMinimized) {
+            SDL_Delay(kMinimizedFrameDelay);
+        } else if (!mWindowFocused) {
+            SDL_Delay(kBackgroundFrameDelay);
+        } else {
+            SDL_Delay(kForegroundFrameDelay);
+        }
+        
+        // Pick up a rebuilt controller plugin
+        if (mController && currentTime - mLastControllerCheck >= kControllerCheckInterval) {
+            ReloadControllerIfChanged();
+            mLastControllerCheck = currentTime;
+        }
+        
+        // Periodic profile of the frame phases
+        if (mProfiler && currentTime - mLastPerfReport >= kPerfReportInterval) {
+            mProfiler->Report(std::cout);
+            mProfiler->Reset();
+            mLastPerfReport = currentTime;
+        }
     }
 }
 
@@ -122,8 +294,20 @@ void Game::Shutdown() {
     
     // Clean up components in reverse order of creation
     mInputHandler.reset();
+    if (mController) {
+        mController->DestroyContext(mControllerContext);
+        mController.reset();
+        mControllerContext = nullptr;
+    }
+    mSharedState.reset();
+    mReplayWriter.reset();
+    mTrajectory.reset();
+    mOverview.reset();
+    mRewindBuffer.reset();
     mRenderer.reset();
     mPhysics.reset();
+    mWindField.reset();
+    mProfiler.reset();
     mTerrain.reset();
     mLander.reset();
     
@@ -169,6 +353,11 @@ void Game::SetRenderingMode(bool use3D) {
     }
 }
 
+void Game::SetVulkanBackend(bool useVulkan) {
+    // Takes effect the next time the 3D renderer is created
+    mUseVulkan = useVulkan;
+}
+
 void Game::Reset() {
     // Reset game state
     mGameState = GameState::FLYING;
@@ -176,6 +365,20 @@ void Game::Reset() {
     mElapsedTime = 0.0f;
     mFuelUsed = 0.0f;
     
+    // Always restart in real time
+    SetTimeWarpLevel(0);
+    
+    // Forget the previous flight
+    mRewinding = false;
+    mRewindTick = 0;
+    mRewindAccumulator = 0.0f;
+    if (mRewindBuffer) {
+        mRewindBuffer->Clear();
+    }
+    if (mTrajectory) {
+        mTrajectory->Invalidate();
+    }
+    
     // Reset lander
     if (mLander) {
         mLander->Reset();
@@ -185,7 +388,7 @@ void Game::Reset() {
         if (m3DMode) {
             mLander->SetPosition(mWindowWidth / 2,mWindowHeight / 3, mWindowWidth / 2);
         } else {
-            mLander->SetPosition(mWindowWidth / 2, 100);
+            mLander->SetPosition(mWorldWidth / 2, 100);
         }
 
         std::cout << "Lander reset: Active=" << (mLander->IsActive() ? "true" : "false") 
@@ -193,14 +396,35 @@ void Game::Reset() {
               << mLander->GetPosition()[1] << ")" << std::endl;
     }
     
-    // Reset terrain (regenerate)
+    // Reset terrain (regenerate from a fresh seed so replays can rebuild it)
+    mTerrainSeed = static_cast<unsigned int>(rand());
+    srand(mTerrainSeed);
     if (mTerrain) {
         if (m3DMode) {
             mTerrain->Generate3D(mWindowWidth, mWindowWidth, mWindowHeight);
         } else {
-            mTerrain->Generate2D(mWindowWidth, mWindowHeight);
+            mTerrain->Generate2D(mWorldWidth, Terrain::kWorldHeight2D);
+        }
+        
+        // Rasterize the minimap overview in the background
+        if (mOverview) {
+            mOverview->Rebuild(mTerrain.get(), m3DMode);
         }
     }
+    
+    // Start the camera on the lander
+    mCameraFollow = true;
+    UpdateCamera2D();
+    
+    // Record the starting state so a rewind can go all the way back
+    RecordRewindTick(0.0f);
+    
+    // Each flight gets a fresh replay recording
+    StartReplayRecording();
+    
+    // ... and a fresh start for the controller
+    mControllerNewFlight = true;
+    
     // Add debugging output
     std::cout << "Game reset. Lander position: " << mLander->GetPosition()[0] 
               << ", " << mLander->GetPosition()[1] << std::endl;
@@ -217,28 +441,19 @@ void Game::ProcessInput() {
             if (mInputHandler->IsStartActive()) {
                 mGameState = GameState::FLYING;
             }
-        } else if (mGameState == GameState::FLYING) {
-            // Apply thrust if active
+        } else if (mGameState == GameState::FLYING && !mRewinding) {
+            // Gather thrust and rotation input for this tick
+            mPilotInputs = 0;
             if (mInputHandler->IsThrustActive()) {
-                mLander->ApplyThrust(1.0f);
-                
-                // Track fuel usage
-                float originalFuel = mLander->GetFuel();
-                float newFuel = originalFuel;
-                if (originalFuel > newFuel) {
-                    mFuelUsed += originalFuel - newFuel;
-                }
-            } else {
-                mLander->ApplyThrust(0.0f);
+                mPilotInputs |= INPUT_THRUST;
             }
             
-            // Handle rotation
             if (mInputHandler->IsRotateLeftActive()) {
-                mLander->RotateLeft(2.0f);
+                mPilotInputs |= INPUT_ROTATE_LEFT;
             }
             
             if (mInputHandler->IsRotateRightActive()) {
-                mLander->RotateRight(2.0f);
+                mPilotInputs |= INPUT_ROTATE_RIGHT;
             }
         } else if (mGameState == GameState::LANDED || mGameState == GameState::CRASHED) {
             // Check for game reset
@@ -255,17 +470,38 @@ void Game::ProcessInput() {
 }
 
 void Game::Update(float deltaTime) {
-    // Only update physics when flying
-    if (mGameState == GameState::FLYING) {
-        // Update physics
+    // Only update physics when flying (the simulation is paused while scrubbing)
+    if (mGameState == GameState::FLYING && !mRewinding) {
+        // Drop out of time warp when approaching the terrain
+        UpdateTimeWarp();
+        
+        // A loaded controller flies whenever the pilot keeps off the keys
+        if (mController && mPilotInputs == 0 && mPhysics) {
+            mPilotInputs = StepController(deltaTime * mPhysics->GetTimeScale());
+        }
+        
+        // Record the tick before it is simulated
+        if (mReplayWriter && mReplayWriter->IsOpen() && mPhysics && mLander) {
+            LanderSnapshot snapshot;
+            CaptureSnapshot(snapshot);
+            
+            ReplayTick tick;
+            tick.deltaTime = deltaTime * mPhysics->GetTimeScale();
+            tick.inputs = mPilotInputs;
+            mReplayWriter->RecordTick(snapshot, mPhysics->GetSimulationTime(), tick);
+        }
+        
+        // Apply the inputs the same way replays do
+        ApplyPilotInputs(mLander.get(), mPilotInputs);
+        
+        // Update physics (also steps the lander through any time warp)
         if (mPhysics) {
+            FrameProfiler::Scope physicsScope(mProfiler.get(), FramePhase::Physics);
             mPhysics->Update(deltaTime);
         }
         
-        // Update lander
+        // Check lander status
         if (mLander) {
-            mLander->Update(deltaTime);
-            
             // Check if landed or crashed
             if (mLander->IsLanded()) {
                 mGameState = GameState::LANDED;
@@ -283,8 +519,15 @@ void Game::Update(float deltaTime) {
             }
         }
         
-        // Update elapsed time
-        mElapsedTime += deltaTime;
+        // Update elapsed time (in simulated seconds)
+        float simulatedTime = deltaTime * kTimeWarpLevels[mTimeWarpLevel].scale;
+        mElapsedTime += simulatedTime;
+        
+        // Remember this state for rewinding
+        RecordRewindTick(simulatedTime);
+        
+        // Things moved
+        mNeedsRedraw = true;
     }
 
    // Add fall time debugging code - declare static variables once outside the conditionals
@@ -315,11 +558,25 @@ void Game::Update(float deltaTime) {
        fallTimerStarted = false;
    }  
 
+    // Keep the predicted path in step with the lander
+    if (mTrajectory) {
+        if (mShowTrajectory && mGameState == GameState::FLYING) {
+            mTrajectory->Update(mLander.get(), mPhysics.get(), mTerrain.get(), m3DMode, mElapsedTime);
+        } else {
+            mTrajectory->Invalidate();
+        }
+    }
+    
     // Update terrain (generally static, but may have animations)
     if (mTerrain) {
         mTerrain->Update(deltaTime);
     }
     
+    // In 2D, scroll the camera with the lander
+    if (!m3DMode) {
+        UpdateCamera2D();
+    }
+    
     // If 3D mode, update camera to follow lander
     if (m3DMode && mRenderer && mLander) {
         const float* landerPos = mLander->GetPosition();
@@ -337,6 +594,14 @@ void Game::Update(float deltaTime) {
         // Set camera up vector
         mRenderer->SetCameraUp(0.0f, 1.0f, 0.0f);
         
+        // Landing camera just under the lander, looking at the ground
+        mRenderer->SetLandingCamera(
+            mShowLandingCamera,
+            landerPos[0],
+            landerPos[1] + mLander->GetHeight() / 2 + 1.0f,
+            landerPos[2]
+        );
+        
         // Set light position above terrain
         mRenderer->SetLightPosition(
             mWindowWidth / 2, 
@@ -346,6 +611,85 @@ void Game::Update(float deltaTime) {
         
         // Set ambient light
         mRenderer->SetAmbientLight(0.3f, 0.3f, 0.3f);
+        
+        // Beacons, landing lights and engine glow
+        UpdateSceneLights();
+        mRenderer->SetLights(mSceneLights);
+    }
+}
+
+void Game::UpdateSceneLights() {
+    // One beacon over every landing pad triangle, placed again for new terrain
+    if (mTerrain && mTerrain->GetGeneration() != mBeaconGeneration) {
+        mBeaconLights.clear();
+        for (const TerrainTriangle& triangle : mTerrain->GetTriangles3D()) {
+            if (!triangle.isLandingPad) {
+                continue;
+            }
+            
+            const float* v = triangle.vertices;
+            Light beacon = {};
+            beacon.position[0] = (v[0] + v[3] + v[6]) / 3.0f;
+            beacon.position[1] = (v[1] + v[4] + v[7]) / 3.0f - kBeaconLift;  // Y grows downward
+            beacon.position[2] = (v[2] + v[5] + v[8]) / 3.0f;
+            beacon.color[0] = 0.2f;
+            beacon.color[1] = 1.0f;
+            beacon.color[2] = 0.3f;
+            beacon.radius = kBeaconRadius;
+            beacon.spotCosine = -1.0f;
+            mBeaconLights.push_back(beacon);
+        }
+        mBeaconGeneration = mTerrain->GetGeneration();
+    }
+    
+    // Beacons blink in a chase pattern
+    mSceneLights = mBeaconLights;
+    for (size_t i = 0; i < mSceneLights.size(); i++) {
+        float wave = std::sin(mElapsedTime * kBeaconBlinkRate - i * kBeaconBlinkPhase);
+        mSceneLights[i].intensity = std::max(0.0f, wave) * 1.5f;
+    }
+    
+    if (!mLander) {
+        return;
+    }
+    
+    // The lander's down axis (towards the ground, +Y) and its side axis
+    const float* position = mLander->GetPosition();
+    float roll = mLander->GetRotation()[2] * static_cast<float>(M_PI) / 180.0f;
+    const float down[3] = { -std::sin(roll), std::cos(roll), 0.0f };
+    const float side[3] = { std::cos(roll), std::sin(roll), 0.0f };
+    float halfHeight = mLander->GetHeight() / 2.0f;
+    float halfWidth = mLander->GetWidth() / 2.0f;
+    
+    // Two landing lights under the body, pointing along the down axis
+    for (float offset : { -halfWidth * 0.6f, halfWidth * 0.6f }) {
+        Light landingLight = {};
+        for (int axis = 0; axis < 3; axis++) {
+            landingLight.position[axis] = position[axis] + down[axis] * halfHeight + side[axis] * offset;
+            landingLight.direction[axis] = down[axis];
+        }
+        landingLight.color[0] = 1.0f;
+        landingLight.color[1] = 0.95f;
+        landingLight.color[2] = 0.8f;
+        landingLight.intensity = 1.2f;
+        landingLight.radius = kLandingLightRadius;
+        landingLight.spotCosine = kLandingLightCosine;
+        mSceneLights.push_back(landingLight);
+    }
+    
+    // Engine glow just below the nozzle, following the throttle
+    if (mLander->IsThrustActive()) {
+        Light glow = {};
+        for (int axis = 0; axis < 3; axis++) {
+            glow.position[axis] = position[axis] + down[axis] * (halfHeight + 5.0f);
+        }
+        glow.color[0] = 1.0f;
+        glow.color[1] = 0.5f;
+        glow.color[2] = 0.1f;
+        glow.intensity = 2.0f * mLander->GetThrustLevel();
+        glow.radius = kEngineGlowRadius;
+        glow.spotCosine = -1.0f;
+        mSceneLights.push_back(glow);
     }
 }
 
@@ -355,27 +699,50 @@ void Game::Render() {
         std::cout << "Rendering frame..." << std::endl; // Debug output
         mRenderer->Clear();
         
-        // Render terrain
-        if (mTerrain) {
-            std::cout << "Rendering terrain" << std::endl; // Debug output
-            mTerrain->Render(mRenderer.get());
+        // Point the 2D view at the part of the world being shown
+        if (!m3DMode) {
+            mRenderer->SetCamera2D(mCameraX, mCameraY, mCameraZoom);
         }
         
-        // Render lander
-        if (mLander) {
-            std::cout << "About to render lander at position: " << mLander->GetPosition()[0] 
-                      << ", " << mLander->GetPosition()[1] << std::endl;
+        // Draw the scene once per view (main view plus any insets)
+        int viewCount = mRenderer->GetViewCount();
+        for (int view = 0; view < viewCount; view++) {
+            mRenderer->BeginView(view);
+            
+            // Render terrain
+            if (mTerrain) {
+                std::cout << "Rendering terrain" << std::endl; // Debug output
+                mTerrain->Render(mRenderer.get());
+            }
             
-            // Call RenderLander directly instead of through Lander::Render
-            mRenderer->RenderLander(mLander.get());
+            // Render predicted path under the lander
+            if (mTrajectory && mShowTrajectory && mGameState == GameState::FLYING) {
+                mRenderer->RenderTrajectory(mTrajectory.get());
+            }
+            
+            // Render lander
+            if (mLander) {
+                std::cout << "About to render lander at position: " << mLander->GetPosition()[0] 
+                          << ", " << mLander->GetPosition()[1] << std::endl;
+                
+                // Call RenderLander directly instead of through Lander::Render
+                mRenderer->RenderLander(mLander.get());
+                
+                std::cout << "Lander render complete" << std::endl;
+            }
             
-            std::cout << "Lander render complete" << std::endl;
+            mRenderer->EndView(view);
         }
         
         // Render UI elements
         mRenderer->RenderTelemetry(this);
         mRenderer->RenderGameState(this);
         
+        // Render the minimap over the corner of the view
+        if (mShowMinimap && mOverview) {
+            mRenderer->RenderMinimap(mOverview.get(), mLander.get());
+        }
+        
         // Present rendered frame
         mRenderer->Present();
     } else { 
@@ -384,6 +751,9 @@ void Game::Render() {
 }
 
 void Game::OnKeyDown(int keyCode) {
+    // Any key may change what is shown
+    mNeedsRedraw = true;
+    
     // Handle key press events
     switch (keyCode) {
         case SDLK_r:
@@ -415,10 +785,484 @@ void Game::OnKeyDown(int keyCode) {
             // Toggle between 2D and 3D mode
             SetRenderingMode(!m3DMode);
             break;
+            
+        case SDLK_PERIOD:
+            // Speed up time warp
+            IncreaseTimeWarp();
+            break;
+            
+        case SDLK_COMMA:
+            // Slow down time warp
+            DecreaseTimeWarp();
+            break;
+            
+        case SDLK_LEFTBRACKET:
+            // Rewind one second
+            ScrubRewind(-static_cast<int>(1.0f / RewindBuffer::kTickInterval));
+            break;
+            
+        case SDLK_RIGHTBRACKET:
+            // Scrub forward one second
+            ScrubRewind(static_cast<int>(1.0f / RewindBuffer::kTickInterval));
+            break;
+            
+        case SDLK_RETURN:
+            // Resume flying from the rewound tick
+            ResumeFromRewind();
+            break;
+            
+        case SDLK_t:
+            // Toggle the predicted path overlay
+            mShowTrajectory = !mShowTrajectory;
+            break;
+            
+        case SDLK_v:
+            // Toggle the landing camera inset (3D)
+            mShowLandingCamera = !mShowLandingCamera;
+            break;
+            
+        case SDLK_m:
+            // Toggle the minimap
+            mShowMinimap = !mShowMinimap;
+            break;
+            
+        case SDLK_EQUALS:
+            // Zoom the 2D camera in
+            ZoomCamera2D(kCameraZoomStep);
+            break;
+            
+        case SDLK_MINUS:
+            // Zoom the 2D camera out
+            ZoomCamera2D(1.0f / kCameraZoomStep);
+            break;
+            
+        case SDLK_f:
+            // Toggle following the lander
+            ToggleCameraFollow();
+            break;
+            
+        case SDLK_a:
+            PanCamera2D(-kCameraPanStep, 0.0f);
+            break;
+            
+        case SDLK_d:
+            PanCamera2D(kCameraPanStep, 0.0f);
+            break;
+            
+        case SDLK_w:
+            PanCamera2D(0.0f, -kCameraPanStep);
+            break;
+            
+        case SDLK_s:
+            PanCamera2D(0.0f, kCameraPanStep);
+            break;
     }
 }
 
 void Game::OnKeyUp(int keyCode) {
     // Handle key release events
-    // Currently no additional functionality needed here
-}
\ No newline at end of file
+    mNeedsRedraw = true;
+}
+
+void Game::OnWindowEvent(int windowEvent) {
+    switch (windowEvent) {
+        case SDL_WINDOWEVENT_MINIMIZED:
+        case SDL_WINDOWEVENT_HIDDEN:
+            mWindowMinimized = true;
+            break;
+            
+        case SDL_WINDOWEVENT_RESTORED:
+        case SDL_WINDOWEVENT_MAXIMIZED:
+        case SDL_WINDOWEVENT_SHOWN:
+            mWindowMinimized = false;
+            mNeedsRedraw = true;
+            break;
+            
+        case SDL_WINDOWEVENT_FOCUS_GAINED:
+            mWindowFocused = true;
+            mNeedsRedraw = true;
+            break;
+            
+        case SDL_WINDOWEVENT_FOCUS_LOST:
+            mWindowFocused = false;
+            break;
+            
+        case SDL_WINDOWEVENT_EXPOSED:
+        case SDL_WINDOWEVENT_RESIZED:
+        case SDL_WINDOWEVENT_SIZE_CHANGED:
+            // Window contents need repainting
+            mNeedsRedraw = true;
+            break;
+    }
+}
+
+bool Game::IsIdle() const {
+    // Only a flight in progress changes the picture by itself
+    return mGameState != GameState::FLYING || mRewinding;
+}
+
+void Game::WaitWhileIdle() {
+    // A pending redraw (e.g. the frame that just landed) goes out first
+    if (mNeedsRedraw && !mWindowMinimized) {
+        return;
+    }
+    
+    if (mInputHandler) {
+        int timeout = mWindowMinimized ? kIdleMinimizedTimeout : kIdleWaitTimeout;
+        mInputHandler->WaitForInput(timeout);
+    }
+    
+    // Time spent blocked is not simulation time
+    mLastFrameTime = SDL_GetTicks();
+}
+
+void Game::IncreaseTimeWarp() {
+    if (mGameState != GameState::FLYING || mRewinding ||
+        mTimeWarpLevel + 1 >= kTimeWarpLevelCount) {
+        return;
+    }
+    
+    SetTimeWarpLevel(mTimeWarpLevel + 1);
+}
+
+void Game::DecreaseTimeWarp() {
+    if (mTimeWarpLevel > 0) {
+        SetTimeWarpLevel(mTimeWarpLevel - 1);
+    }
+}
+
+float Game::GetTimeWarp() const {
+    return kTimeWarpLevels[mTimeWarpLevel].scale;
+}
+
+void Game::SetTimeWarpLevel(int level) {
+    if (level < 0 || level >= kTimeWarpLevelCount) {
+        return;
+    }
+    
+    bool changed = level != mTimeWarpLevel;
+    mTimeWarpLevel = level;
+    mFramesSinceRender = 0;
+    
+    if (mPhysics) {
+        mPhysics->SetTimeScale(kTimeWarpLevels[level].scale);
+    }
+    
+    if (changed) {
+        std::cout << "Time warp: " << kTimeWarpLevels[level].scale << "x" << std::endl;
+    }
+}
+
+void Game::UpdateTimeWarp() {
+    if (mTimeWarpLevel == 0 || !mLander) {
+        return;
+    }
+    
+    // Keep a margin that grows with the distance covered at the current warp
+    float scale = kTimeWarpLevels[mTimeWarpLevel].scale;
+    float verticalSpeed = std::abs(mLander->GetVelocity()[1]);
+    float safeClearance = kTimeWarpMinClearance + verticalSpeed * scale * kTimeWarpLookahead;
+    
+    if (GetTerrainClearance() < safeClearance) {
+        std::cout << "Approaching terrain, leaving time warp" << std::endl;
+        SetTimeWarpLevel(0);
+    }
+}
+
+float Game::GetTerrainClearance() const {
+    if (!mLander || !mTerrain) {
+        return 0.0f;
+    }
+    
+    const float* position = mLander->GetPosition();
+    float halfHeight = mLander->GetHeight() / 2;
+    float surfaceHeight = 0.0f;
+    
+    // Measured the same way the collision checks do (Y grows towards the ground)
+    if (m3DMode) {
+        if (mTerrain->GetSurfaceHeight3D(position[0], position[2], surfaceHeight)) {
+            return surfaceHeight - (position[1] + halfHeight);
+        }
+    } else {
+        if (mTerrain->GetSurfaceHeight2D(position[0], surfaceHeight)) {
+            return surfaceHeight - (position[1] - halfHeight);
+        }
+    }
+    
+    // Not above any terrain
+    return 1.0e9f;
+}
+
+void Game::ScrubRewind(int ticks) {
+    if (!mRewindBuffer || mRewindBuffer->GetTickCount() == 0) {
+        return;
+    }
+    
+    size_t newestTick = mRewindBuffer->GetTickCount() - 1;
+    
+    // Pause on the newest tick when scrubbing starts
+    if (!mRewinding) {
+        mRewinding = true;
+        mRewindTick = newestTick;
+        SetTimeWarpLevel(0);
+    }
+    
+    // Move and clamp to the recorded range
+    long target = static_cast<long>(mRewindTick) + ticks;
+    target = std::max(0L, std::min(target, static_cast<long>(newestTick)));
+    mRewindTick = static_cast<size_t>(target);
+    
+    LanderSnapshot snapshot;
+    if (mRewindBuffer->GetTick(mRewindTick, snapshot)) {
+        RestoreSnapshot(snapshot);
+        std::cout << "Rewind: t=" << snapshot.elapsedTime << "s (tick " << mRewindTick
+                  << " of " << newestTick << ")" << std::endl;
+    }
+}
+
+void Game::ResumeFromRewind() {
+    if (!mRewinding) {
+        return;
+    }
+    
+    // The rewound tick becomes the newest one; later history is discarded
+    mRewindBuffer->Truncate(mRewindTick + 1);
+    mRewinding = false;
+    mRewindAccumulator = 0.0f;
+    
+    // The recorded state jumps, so the replay needs a keyframe here
+    if (mReplayWriter) {
+        mReplayWriter->ForceKeyframe();
+    }
+    
+    if (mLander) {
+        mLander->ApplyThrust(0.0f);
+    }
+    
+    // A controller's history no longer matches the flight
+    mControllerNewFlight = true;
+    
+    std::cout << "Resuming from t=" << mElapsedTime << "s" << std::endl;
+}
+
+void Game::RecordRewindTick(float simulatedTime) {
+    if (!mRewindBuffer || !mLander) {
+        return;
+    }
+    
+    // Record at the tick rate, but always keep the first and final states
+    mRewindAccumulator += simulatedTime;
+    bool firstTick = mRewindBuffer->GetTickCount() == 0;
+    bool finalTick = mGameState != GameState::FLYING;
+    if (mRewindAccumulator < RewindBuffer::kTickInterval && !firstTick && !finalTick) {
+        return;
+    }
+    mRewindAccumulator = 0.0f;
+    
+    LanderSnapshot snapshot;
+    CaptureSnapshot(snapshot);
+    mRewindBuffer->Record(snapshot);
+}
+
+void Game::CaptureSnapshot(LanderSnapshot& snapshot) const {
+    CaptureLanderSnapshot(mLander.get(), mElapsedTime, snapshot);
+}
+
+void Game::RestoreSnapshot(const LanderSnapshot& snapshot) {
+    RestoreLanderSnapshot(mLander.get(), snapshot);
+    mElapsedTime = snapshot.elapsedTime;
+    
+    // Game state follows the restored lander
+    if (snapshot.landed) {
+        mGameState = GameState::LANDED;
+    } else if (snapshot.crashed) {
+        mGameState = GameState::CRASHED;
+    } else {
+        mGameState = GameState::FLYING;
+    }
+}
+
+void Game::SetReplayPath(const std::string& path) {
+    mReplayPath = path;
+}
+
+void Game::StartReplayRecording() {
+    if (mReplayPath.empty() || !mPhysics) {
+        return;
+    }
+    
+    if (!mReplayWriter) {
+        mReplayWriter = std::make_unique<ReplayWriter>();
+    }
+    
+    // Enough to rebuild this flight's world
+    ReplayHeader header = {};
+    header.terrainSeed = mTerrainSeed;
+    header.keyframeInterval = ReplayWriter::kDefaultKeyframeInterval;
+    header.worldWidth = m3DMode ? mWindowWidth : mWorldWidth;
+    header.worldHeight = m3DMode ? mWindowHeight : Terrain::kWorldHeight2D;
+    header.gravity = mPhysics->GetGravity();
+    header.use3D = m3DMode ? 1 : 0;
+    header.airDensity = mWindField ? mAirDensity : 0.0f;
+    header.wind = mWindParameters;
+    
+    // One file per flight: flight.rpl is recorded as flight-0001.rpl, ...
+    std::string path = mReplayPath;
+    size_t extension = path.find_last_of('.');
+    if (extension == std::string::npos || path.find_first_of("/\\", extension) != std::string::npos) {
+        extension = path.size();
+    }
+    char flightNumber[16];
+    snprintf(flightNumber, sizeof(flightNumber), "-%04u", ++mReplayFlight);
+    path.insert(extension, flightNumber);
+    
+    mReplayWriter->Open(path, header);
+}
+
+void Game::PublishSharedState() {
+    if (!mSharedState || !mLander || !mTerrain) {
+        return;
+    }
+    
+    // Terrain metadata only changes with a new terrain
+    if (mTerrain->GetGeneration() != mSharedTerrainGeneration) {
+        SharedTerrainInfo info;
+        SharedStateWriter::DescribeTerrain(*mTerrain, mTerrainSeed, m3DMode, info);
+        mSharedState->PublishTerrain(info);
+        mSharedTerrainGeneration = mTerrain->GetGeneration();
+    }
+    
+    SharedLanderState state;
+    std::copy(mLander->GetPosition(), mLander->GetPosition() + 3, state.position);
+    std::copy(mLander->GetVelocity(), mLander->GetVelocity() + 3, state.velocity);
+    std::copy(mLander->GetRotation(), mLander->GetRotation() + 3, state.rotation);
+    state.fuel = mLander->GetFuel();
+    state.maxFuel = mLander->GetMaxFuel();
+    state.thrustLevel = mLander->GetThrustLevel();
+    state.score = mScore;
+    state.elapsedTime = mElapsedTime;
+    state.fuelUsed = mFuelUsed;
+    state.timeWarp = GetTimeWarp();
+    state.gameState = static_cast<uint32_t>(mGameState);
+    state.flags = (mLander->IsLanded() ? SHARED_LANDED : 0)
+                | (mLander->IsCrashed() ? SHARED_CRASHED : 0)
+                | (mLander->IsThrustActive() ? SHARED_THRUSTING : 0)
+                | (mRewinding ? SHARED_REWINDING : 0)
+                | (m3DMode ? SHARED_3D : 0);
+    state.terrainGeneration = mTerrain->GetGeneration();
+    mSharedState->PublishLander(state);
+}
+
+void Game::SetWind(const WindParameters& parameters, float airDensity) {
+    mWindParameters = parameters;
+    mAirDensity = airDensity;
+}
+
+void Game::SetController(const std::string& path, const std::string& config) {
+    mControllerPath = path;
+    mControllerConfig = config;
+}
+
+bool Game::LoadController(std::unique_ptr<ControllerPlugin>& plugin, void*& context) {
+    std::unique_ptr<ControllerPlugin> loaded = std::make_unique<ControllerPlugin>();
+    if (!loaded->Load(mControllerPath)) {
+        return false;
+    }
+    
+    LanderControllerInfo info;
+    info.abiVersion = LANDER_CONTROLLER_ABI_VERSION;
+    info.laneCount = 1;
+    info.gravityAcceleration = mPhysics->GetGravityAcceleration();
+    info.thrustAcceleration = mPhysics->GetThrustAcceleration(1.0f);
+    info.rotationStep = GetPilotRotationStep();
+    info.config = mControllerConfig.c_str();
+    if (!loaded->CreateContext(info, context)) {
+        return false;
+    }
+    
+    plugin = std::move(loaded);
+    return true;
+}
+
+void Game::ReloadControllerIfChanged() {
+    if (!mController->CheckForUpdate()) {
+        return;
+    }
+    
+    // The old build keeps flying if the new one fails to load
+    std::unique_ptr<ControllerPlugin> plugin;
+    void* context = nullptr;
+    if (!LoadController(plugin, context)) {
+        std::cerr << "Keeping the previous controller" << std::endl;
+        return;
+    }
+    
+    mController->DestroyContext(mControllerContext);
+    mController = std::move(plugin);
+    mControllerContext = context;
+    mControllerNewFlight = true;
+    std::cout << "Reloaded controller plugin " << mControllerPath << std::endl;
+}
+
+unsigned char Game::StepController(float deltaTime) {
+    LanderObservation observation;
+    ControllerPlugin::ObserveLander(*mLander, *mTerrain, m3DMode, observation);
+    observation.time = mElapsedTime;
+    observation.deltaTime = deltaTime;
+    observation.lane = 0;
+    observation.flags = LANDER_OBS_SENSORS_VALID | (mControllerNewFlight ? LANDER_OBS_NEW_EPISODE : 0);
+    mControllerNewFlight = false;
+    
+    LanderAction action;
+    action.inputs = 0;
+    mController->Step(mControllerContext, observation, action);
+    return static_cast<unsigned char>(action.inputs & (INPUT_THRUST | INPUT_ROTATE_LEFT | INPUT_ROTATE_RIGHT));
+}
+
+void Game::ZoomCamera2D(float factor) {
+    mCameraZoom = std::max(kMinCameraZoom, std::min(kMaxCameraZoom, mCameraZoom * factor));
+    UpdateCamera2D();
+}
+
+void Game::PanCamera2D(float dx, float dy) {
+    // Panning by hand stops following the lander until F is pressed
+    mCameraFollow = false;
+    mCameraX += dx / mCameraZoom;
+    mCameraY += dy / mCameraZoom;
+    ClampCamera2D();
+}
+
+void Game::ToggleCameraFollow() {
+    mCameraFollow = !mCameraFollow;
+    UpdateCamera2D();
+}
+
+void Game::UpdateCamera2D() {
+    if (mCameraFollow && mLander) {
+        const float* landerPos = mLander->GetPosition();
+        float halfViewHeight = mWindowHeight / 2 / mCameraZoom;
+        float topMargin = kCameraTopMargin / mCameraZoom;
+        
+        // Track the lander horizontally; keep the ground at the bottom of
+        // the screen unless the lander climbs too close to the top edge
+        mCameraX = landerPos[0];
+        mCameraY = std::min(Terrain::kWorldHeight2D - halfViewHeight,
+                            landerPos[1] - topMargin + halfViewHeight);
+    }
+    
+    ClampCamera2D();
+}
+
+void Game::ClampCamera2D() {
+    // Keep the view inside the world horizontally (centered if it is wider)
+    float halfViewWidth = mWindowWidth / 2 / mCameraZoom;
+    if (halfViewWidth * 2 >= mWorldWidth) {
+        mCameraX = mWorldWidth / 2.0f;
+    } else {
+        mCameraX = std::max(halfViewWidth, std::min(mWorldWidth - halfViewWidth, mCameraX));
+    }
+    
+    // Never scroll below the bottom of the world
+    float halfViewHeight = mWindowHeight / 2 / mCameraZoom;
+    mCameraY = std::min(mCameraY, Terrain::kWorldHeight2D - halfViewHeight);
+}
@@ -7,12 +7,22 @@
 #include <vector>
 #include <memory>
 #include "Entity.h"
+#include "WindField.h"
+#include "../rendering/Light.h"
 
 // Forward declarations
 class Renderer;
 class Physics;
 class Terrain;
 class InputHandler;
+class RewindBuffer;
+class ReplayWriter;
+class TrajectoryPredictor;
+class TerrainOverview;
+class FrameProfiler;
+class SharedStateWriter;
+class ControllerPlugin;
+struct LanderSnapshot;
 
 // Game states
 enum class GameState {
@@ -50,8 +60,41 @@ public:
     // Game config settings
     void SetDifficulty(Difficulty difficulty);
     void SetRenderingMode(bool use3D);
+    void SetVulkanBackend(bool useVulkan);
     void Reset();
     
+    // Time warp (1x, 2x, 10x, 100x)
+    void IncreaseTimeWarp();
+    void DecreaseTimeWarp();
+    float GetTimeWarp() const;
+    
+    // Rewind (scrub back through the flight and resume from any tick)
+    void ScrubRewind(int ticks);
+    void ResumeFromRewind();
+    bool IsRewinding() const { return mRewinding; }
+    
+    // Record each flight to its own numbered replay file (path-0001.ext, ...)
+    void SetReplayPath(const std::string& path);
+    
+    // Measure physics, collision and rendering with hardware counters and
+    // print a report every few seconds
+    void SetPerfCounters(bool enabled) { mUsePerfCounters = enabled; }
+    
+    // Publish live state to a shared-memory segment for external tools
+    void SetSharedStateName(const std::string& name) { mSharedStateName = name; }
+    
+    // Fly with a controller plugin whenever no key is held; the library is
+    // reloaded when it is rebuilt
+    void SetController(const std::string& path, const std::string& config);
+    
+    // Fly through an atmosphere of the given density (kg/m³) and its wind
+    void SetWind(const WindParameters& parameters, float airDensity);
+    
+    // 2D camera (follows the lander across the world, or pans freely)
+    void ZoomCamera2D(float factor);
+    void PanCamera2D(float dx, float dy);
+    void ToggleCameraFollow();
+    
     // Game statistics
     float GetScore() const { return mScore; }
     float GetElapsedTime() const { return mElapsedTime; }
@@ -60,6 +103,7 @@ public:
     // Input callbacks
     void OnKeyDown(int keyCode);
     void OnKeyUp(int keyCode);
+    void OnWindowEvent(int windowEvent);
     
 private:
     // Game loop functions
@@ -67,10 +111,46 @@ private:
     void Update(float deltaTime);
     void Render();
     
+    // Idle handling (nothing moves, so wait for events instead of rendering)
+    bool IsIdle() const;
+    void WaitWhileIdle();
+    
+    // Time warp helpers
+    void SetTimeWarpLevel(int level);
+    void UpdateTimeWarp();
+    float GetTerrainClearance() const;
+    
+    // Rewind helpers
+    void RecordRewindTick(float simulatedTime);
+    void CaptureSnapshot(LanderSnapshot& snapshot) const;
+    void RestoreSnapshot(const LanderSnapshot& snapshot);
+    
+    // Replay recording
+    void StartReplayRecording();
+    
+    // Shared-memory export of this tick's state
+    void PublishSharedState();
+    
+    // Controller plugin
+    bool LoadController(std::unique_ptr<ControllerPlugin>& plugin, void*& context);
+    void ReloadControllerIfChanged();
+    unsigned char StepController(float deltaTime);
+    
+    // 2D camera helpers
+    void UpdateCamera2D();
+    void ClampCamera2D();
+    
+    // 3D lighting: pad beacons plus the lander's landing lights and engine glow
+    void UpdateSceneLights();
+    
     // Game state
     GameState mGameState;
     Difficulty mDifficulty;
     bool m3DMode;
+    bool mUseVulkan;   // Use the Vulkan backend for 3D (when built with it)
+    bool mShowTrajectory;
+    bool mShowMinimap;
+    bool mShowLandingCamera;
     
     // Game entities
     std::unique_ptr<Lander> mLander;
@@ -80,6 +160,18 @@ private:
     std::unique_ptr<Renderer> mRenderer;
     std::unique_ptr<Physics> mPhysics;
     std::unique_ptr<InputHandler> mInputHandler;
+    std::unique_ptr<RewindBuffer> mRewindBuffer;
+    std::unique_ptr<ReplayWriter> mReplayWriter;
+    std::unique_ptr<TrajectoryPredictor> mTrajectory;
+    std::unique_ptr<TerrainOverview> mOverview;
+    std::unique_ptr<FrameProfiler> mProfiler;
+    std::unique_ptr<SharedStateWriter> mSharedState;
+    std::unique_ptr<ControllerPlugin> mController;
+    
+    // Dynamic 3D lights; beacons are placed once per terrain generation
+    std::vector<Light> mBeaconLights;
+    unsigned int mBeaconGeneration;
+    std::vector<Light> mSceneLights;
     
     // Game statistics
     float mScore;
@@ -89,10 +181,57 @@ private:
     // Timing
     unsigned int mLastFrameTime;
     
+    // Time warp state
+    int mTimeWarpLevel;      // Index into the time warp table
+    int mFramesSinceRender;  // Frames skipped since the last render
+    
+    // Rewind state
+    bool mRewinding;           // Paused and scrubbing through the rewind buffer
+    size_t mRewindTick;        // Tick currently shown while scrubbing
+    float mRewindAccumulator;  // Simulated time since the last recorded tick
+    
+    // Replay state
+    std::string mReplayPath;
+    unsigned int mReplayFlight;    // Flights recorded so far, numbers the files
+    unsigned int mTerrainSeed;     // Seed the current terrain was generated from
+    unsigned char mPilotInputs;    // PilotInput bits applied this tick
+    
+    // Profiling state
+    bool mUsePerfCounters;
+    unsigned int mLastPerfReport;  // SDL ticks of the last profile report
+    
+    // Shared-memory export state
+    std::string mSharedStateName;
+    unsigned int mSharedTerrainGeneration;  // Terrain generation last published
+    
+    // Controller plugin state
+    std::string mControllerPath;
+    std::string mControllerConfig;
+    void* mControllerContext;
+    bool mControllerNewFlight;         // Next step starts a flight
+    unsigned int mLastControllerCheck; // SDL ticks of the last reload check
+    
+    // Atmosphere; zero density is vacuum and leaves the wind off
+    float mAirDensity;
+    WindParameters mWindParameters;
+    std::unique_ptr<WindField> mWindField;
+    
     // Window dimensions
     int mWindowWidth;
     int mWindowHeight;
     
+    // 2D world and camera (world units; the world is several screens wide)
+    int mWorldWidth;
+    float mCameraX;
+    float mCameraY;
+    float mCameraZoom;
+    bool mCameraFollow;
+    
+    // Window and redraw state
+    bool mWindowMinimized;
+    bool mWindowFocused;
+    bool mNeedsRedraw;
+    
     // Game is running flag
     bool mIsRunning;
 };
@@ -0,0 +1,274 @@
+// Metrics.cpp
+// Implementation of the metrics and their Prometheus text rendering
+
+#include "Metrics.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#ifdef __linux__
+    #include <unistd.h>
+#endif
+
+static uint64_t DoubleToBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double BitsToDouble(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Prometheus spells the special values its own way
+static void WriteValue(std::ostream& out, double value) {
+    if (std::isnan(value)) {
+        out << "NaN";
+    } else if (std::isinf(value)) {
+        out << (value > 0.0 ? "+Inf" : "-Inf");
+    } else {
+        out << value;
+    }
+}
+
+static const char* GetTypeName(MetricType type) {
+    switch (type) {
+        case MetricType::Counter:   return "counter";
+        case MetricType::Gauge:     return "gauge";
+        case MetricType::Histogram: return "histogram";
+    }
+    return "untyped";
+}
+
+Metric::Metric(MetricType type, const std::string& name, const std::string& help, const std::string& labels)
+    : mType(type)
+    , mName(name)
+    , mHelp(help)
+    , mLabels(labels)
+{
+}
+
+void Metric::WriteSeries(std::ostream& out, const char* suffix, const char* extraLabel) const {
+    out << mName << suffix;
+    if (!mLabels.empty() || extraLabel) {
+        out << "{" << mLabels;
+        if (!mLabels.empty() && extraLabel) {
+            out << ",";
+        }
+        if (extraLabel) {
+            out << extraLabel;
+        }
+        out << "}";
+    }
+    out << " ";
+}
+
+int Metric::GetThreadShard() {
+    // Threads take shards in turn; sharing one past kShardCount threads
+    // only costs some contention
+    static std::atomic<int> sNextShard(0);
+    static thread_local int sShard = sNextShard.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+    return sShard;
+}
+
+MetricCounter::MetricCounter(const std::string& name, const std::string& help, const std::string& labels)
+    : Metric(MetricType::Counter, name, help, labels)
+{
+    for (std::atomic<uint64_t>& shard : mShards) {
+        shard.store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricCounter::Add(uint64_t count) {
+    mShards[GetThreadShard() * kShardStride].fetch_add(count, std::memory_order_relaxed);
+}
+
+uint64_t MetricCounter::GetValue() const {
+    uint64_t total = 0;
+    for (int i = 0; i < kShardCount; i++) {
+        total += mShards[i * kShardStride].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void MetricCounter::Render(std::ostream& out) const {
+    WriteSeries(out, "");
+    out << GetValue() << "\n";
+}
+
+MetricGauge::MetricGauge(const std::string& name, const std::string& help, const std::string& labels,
+                         std::function<double()> callback)
+    : Metric(MetricType::Gauge, name, help, labels)
+    , mBits(DoubleToBits(0.0))
+    , mCallback(std::move(callback))
+{
+}
+
+void MetricGauge::Set(double value) {
+    mBits.store(DoubleToBits(value), std::memory_order_relaxed);
+}
+
+double MetricGauge::GetValue() const {
+    if (mCallback) {
+        return mCallback();
+    }
+    return BitsToDouble(mBits.load(std::memory_order_relaxed));
+}
+
+void MetricGauge::Render(std::ostream& out) const {
+    WriteSeries(out, "");
+    WriteValue(out, GetValue());
+    out << "\n";
+}
+
+MetricHistogram::MetricHistogram(const std::string& name, const std::string& help, const std::string& labels,
+                                 const std::vector<double>& bounds)
+    : Metric(MetricType::Histogram, name, help, labels)
+    , mBounds(bounds)
+{
+    // Buckets including +Inf, then the sum
+    int values = static_cast<int>(mBounds.size()) + 2;
+    mStride = (values + kShardStride - 1) / kShardStride * kShardStride;
+    mShards.reset(new std::atomic<uint64_t>[kShardCount * mStride]);
+    for (int i = 0; i < kShardCount * mStride; i++) {
+        mShards[i].store(0, std::memory_order_relaxed);
+    }
+    for (int shard = 0; shard < kShardCount; shard++) {
+        mShards[shard * mStride + mBounds.size() + 1].store(DoubleToBits(0.0), std::memory_order_relaxed);
+    }
+}
+
+void MetricHistogram::Observe(double value) {
+    // First bucket whose bound holds the value (counts are made cumulative
+    // when rendering)
+    size_t bucket = 0;
+    while (bucket < mBounds.size() && value > mBounds[bucket]) {
+        bucket++;
+    }
+
+    std::atomic<uint64_t>* shard = &mShards[GetThreadShard() * mStride];
+    shard[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    // Another thread only shares this shard past kShardCount threads
+    std::atomic<uint64_t>& sum = shard[mBounds.size() + 1];
+    uint64_t expected = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(expected, DoubleToBits(BitsToDouble(expected) + value),
+                                      std::memory_order_relaxed)) {
+    }
+}
+
+void MetricHistogram::Render(std::ostream& out) const {
+    const size_t bucketCount = mBounds.size() + 1;
+    std::vector<uint64_t> counts(bucketCount, 0);
+    double sum = 0.0;
+    for (int shard = 0; shard < kShardCount; shard++) {
+        const std::atomic<uint64_t>* values = &mShards[shard * mStride];
+        for (size_t i = 0; i < bucketCount; i++) {
+            counts[i] += values[i].load(std::memory_order_relaxed);
+        }
+        sum += BitsToDouble(values[bucketCount].load(std::memory_order_relaxed));
+    }
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < bucketCount; i++) {
+        cumulative += counts[i];
+        std::ostringstream label;
+        label << std::setprecision(out.precision()) << "le=\"";
+        WriteValue(label, i < mBounds.size() ? mBounds[i] : std::numeric_limits<double>::infinity());
+        label << "\"";
+        WriteSeries(out, "_bucket", label.str().c_str());
+        out << cumulative << "\n";
+    }
+    WriteSeries(out, "_sum");
+    WriteValue(out, sum);
+    out << "\n";
+    WriteSeries(out, "_count");
+    out << cumulative << "\n";
+}
+
+std::vector<double> MetricHistogram::DecadeBounds(double first, double last) {
+    static const double kSteps[] = { 1.0, 2.0, 5.0 };
+
+    std::vector<double> bounds;
+    double decade = std::pow(10.0, std::floor(std::log10(first)));
+    while (bounds.empty() || bounds.back() < last) {
+        for (double step : kSteps) {
+            double bound = decade * step;
+            if (bound >= first * 0.999 && (bounds.empty() || bounds.back() < last)) {
+                bounds.push_back(bound);
+            }
+        }
+        decade *= 10.0;
+    }
+    return bounds;
+}
+
+MetricCounter* MetricsRegistry::AddCounter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMetrics.push_back(std::make_unique<MetricCounter>(name, help, labels));
+    return static_cast<MetricCounter*>(mMetrics.back().get());
+}
+
+MetricGauge* MetricsRegistry::AddGauge(const std::string& name, const std::string& help, const std::string& labels,
+                                       std::function<double()> callback) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMetrics.push_back(std::make_unique<MetricGauge>(name, help, labels, std::move(callback)));
+    return static_cast<MetricGauge*>(mMetrics.back().get());
+}
+
+MetricHistogram* MetricsRegistry::AddHistogram(const std::string& name, const std::string& help,
+                                               const std::vector<double>& bounds, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMetrics.push_back(std::make_unique<MetricHistogram>(name, help, labels, bounds));
+    return static_cast<MetricHistogram*>(mMetrics.back().get());
+}
+
+void MetricsRegistry::AddProcessMetrics() {
+    AddGauge("process_resident_memory_bytes", "Resident memory size in bytes.", "",
+             [] { return static_cast<double>(GetResidentMemory()); });
+}
+
+void MetricsRegistry::Render(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::defaultfloat << std::setprecision(std::numeric_limits<double>::digits10);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    const std::string* family = nullptr;
+    for (const std::unique_ptr<Metric>& metric : mMetrics) {
+        // HELP and TYPE once per metric family
+        if (!family || *family != metric->GetName()) {
+            family = &metric->GetName();
+            out << "# HELP " << metric->GetName() << " " << metric->GetHelp() << "\n";
+            out << "# TYPE " << metric->GetName() << " " << GetTypeName(metric->GetType()) << "\n";
+        }
+        metric->Render(out);
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+std::string MetricsRegistry::Render() const {
+    std::ostringstream out;
+    Render(out);
+    return out.str();
+}
+
+uint64_t MetricsRegistry::GetResidentMemory() {
+#ifdef __linux__
+    // Second field of statm: resident pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if (statm >> size >> resident) {
+        return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Metrics.h
+// Counters, gauges and histograms exported in the Prometheus text format
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class MetricType {
+    Counter,
+    Gauge,
+    Histogram
+};
+
+// One exported series. Updates from the simulation threads are relaxed
+// atomic operations on per-thread shards, so they never wait on each other
+// or on a scrape; a scrape sums the shards.
+class Metric {
+public:
+    Metric(MetricType type, const std::string& name, const std::string& help, const std::string& labels);
+    virtual ~Metric() = default;
+
+    MetricType GetType() const { return mType; }
+    const std::string& GetName() const { return mName; }
+    const std::string& GetHelp() const { return mHelp; }
+
+    // Sample lines of this series (the HELP and TYPE lines are the registry's)
+    virtual void Render(std::ostream& out) const = 0;
+
+protected:
+    // Writes name{labels} with an optional extra label
+    void WriteSeries(std::ostream& out, const char* suffix, const char* extraLabel = nullptr) const;
+
+    // Shards one per cache line, picked by the calling thread
+    static const int kShardCount = 16;
+    static const int kShardStride = 8;  // uint64_t values per cache line
+    static int GetThreadShard();
+
+private:
+    MetricType mType;
+    std::string mName;
+    std::string mHelp;
+    std::string mLabels;  // e.g. outcome="landed", or empty
+};
+
+// Monotonic count of events
+class MetricCounter : public Metric {
+public:
+    MetricCounter(const std::string& name, const std::string& help, const std::string& labels);
+
+    void Add(uint64_t count = 1);
+    uint64_t GetValue() const;
+    void Render(std::ostream& out) const override;
+
+private:
+    std::atomic<uint64_t> mShards[kShardCount * kShardStride];
+};
+
+// Current value of something; either set by its owner or read on demand
+// from a callback at scrape time (which runs on the scraping thread)
+class MetricGauge : public Metric {
+public:
+    MetricGauge(const std::string& name, const std::string& help, const std::string& labels,
+                std::function<double()> callback = nullptr);
+
+    void Set(double value);
+    double GetValue() const;
+    void Render(std::ostream& out) const override;
+
+private:
+    std::atomic<uint64_t> mBits;  // The double's bit pattern
+    std::function<double()> mCallback;
+};
+
+// Distribution of observations over fixed buckets; quantiles such as the
+// p99 come from histogram_quantile() on the scraped buckets
+class MetricHistogram : public Metric {
+public:
+    // Upper bounds in increasing order; a +Inf bucket is added
+    MetricHistogram(const std::string& name, const std::string& help, const std::string& labels,
+                    const std::vector<double>& bounds);
+
+    void Observe(double value);
+    void Render(std::ostream& out) const override;
+
+    // Bounds growing by 1, 2, 5 per decade from first up to last
+    static std::vector<double> DecadeBounds(double first, double last);
+
+private:
+    std::vector<double> mBounds;
+    int mStride;  // Values per shard: buckets, then the sum's bits, rounded to a cache line
+    std::unique_ptr<std::atomic<uint64_t>[]> mShards;
+};
+
+// Owns the metrics of a process and renders them for a scrape. Metrics are
+// usually added before the threads that update them start; adding later is
+// safe but takes a lock that scrapes also take. Series sharing a name (with
+// different labels) should be added one after another.
+class MetricsRegistry {
+public:
+    MetricCounter* AddCounter(const std::string& name, const std::string& help, const std::string& labels = "");
+    MetricGauge* AddGauge(const std::string& name, const std::string& help, const std::string& labels = "",
+                          std::function<double()> callback = nullptr);
+    MetricHistogram* AddHistogram(const std::string& name, const std::string& help,
+                                  const std::vector<double>& bounds, const std::string& labels = "");
+
+    // process_resident_memory_bytes, read from the OS at each scrape
+    void AddProcessMetrics();
+
+    // Text exposition format 0.0.4
+    void Render(std::ostream& out) const;
+    std::string Render() const;
+
+    // Resident set size in bytes, or 0 where unknown
+    static uint64_t GetResidentMemory();
+
+private:
+    mutable std::mutex mMutex;
+    std::vector<std::unique_ptr<Metric>> mMetrics;
+};
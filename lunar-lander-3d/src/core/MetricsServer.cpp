@@ -0,0 +1,185 @@
+// MetricsServer.cpp
+// Implementation of the /metrics HTTP server
+
+#include "MetricsServer.h"
+#include "Metrics.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+    #define METRICS_SOCKETS 1
+#endif
+
+// How often the serving thread checks for Stop(), and how long a client
+// may take to send its request (milliseconds)
+static const int kPollInterval = 200;
+static const int kRequestTimeout = 1000;
+
+// Longest request read; the headers beyond the request line are ignored
+static const size_t kMaxRequestSize = 4096;
+
+MetricsServer::MetricsServer()
+    : mRegistry(nullptr)
+    , mListener(-1)
+    , mPort(0)
+    , mStopping(false)
+{
+}
+
+MetricsServer::~MetricsServer() {
+    Stop();
+}
+
+bool MetricsServer::Start(const MetricsRegistry& registry, int port) {
+    Stop();
+
+#ifdef METRICS_SOCKETS
+    mListener = socket(AF_INET, SOCK_STREAM, 0);
+    if (mListener < 0) {
+        std::cerr << "Metrics server: cannot create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(mListener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Local scrapers only
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(mListener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(mListener, 8) < 0) {
+        std::cerr << "Metrics server: cannot listen on port " << port << ": " << std::strerror(errno) << std::endl;
+        close(mListener);
+        mListener = -1;
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    getsockname(mListener, reinterpret_cast<sockaddr*>(&address), &length);
+    mPort = ntohs(address.sin_port);
+
+    mRegistry = &registry;
+    mStopping.store(false);
+    mThread = std::thread(&MetricsServer::ServeLoop, this);
+    return true;
+#else
+    (void)registry;
+    (void)port;
+    std::cerr << "Metrics server needs POSIX sockets" << std::endl;
+    return false;
+#endif
+}
+
+void MetricsServer::Stop() {
+    if (mThread.joinable()) {
+        mStopping.store(true);
+        mThread.join();
+    }
+#ifdef METRICS_SOCKETS
+    if (mListener >= 0) {
+        close(mListener);
+    }
+#endif
+    mListener = -1;
+    mRegistry = nullptr;
+}
+
+void MetricsServer::ServeLoop() {
+#ifdef METRICS_SOCKETS
+    while (!mStopping.load()) {
+        pollfd listener = { mListener, POLLIN, 0 };
+        if (poll(&listener, 1, kPollInterval) <= 0) {
+            continue;
+        }
+
+        int connection = accept(mListener, nullptr, nullptr);
+        if (connection < 0) {
+            continue;
+        }
+        HandleConnection(connection);
+        close(connection);
+    }
+#endif
+}
+
+void MetricsServer::HandleConnection(int connection) {
+#ifdef METRICS_SOCKETS
+    // A client that stops sending must not hold up the next scrape
+    timeval timeout;
+    timeout.tv_sec = kRequestTimeout / 1000;
+    timeout.tv_usec = (kRequestTimeout % 1000) * 1000;
+    setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    int sendFlags = 0;
+    #ifdef MSG_NOSIGNAL
+        sendFlags = MSG_NOSIGNAL;
+    #elif defined(SO_NOSIGPIPE)
+        int noSignal = 1;
+        setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &noSignal, sizeof(noSignal));
+    #endif
+
+    // Read up to the end of the headers
+    std::string request;
+    char buffer[1024];
+    while (request.size() < kMaxRequestSize && request.find("\r\n\r\n") == std::string::npos) {
+        ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    // Request line: method, target (a query string is allowed), version
+    std::string line = request.substr(0, request.find("\r\n"));
+    std::string target = line.substr(0, line.rfind(' '));
+    bool isGet = target.compare(0, 4, "GET ") == 0;
+    bool isHead = target.compare(0, 5, "HEAD ") == 0;
+    target = target.substr(target.find(' ') + 1);
+    target = target.substr(0, target.find('?'));
+
+    std::string status;
+    std::string contentType = "text/plain; charset=utf-8";
+    std::string body;
+    if (!isGet && !isHead) {
+        status = "405 Method Not Allowed";
+        body = "Only GET is supported\n";
+    } else if (target != "/metrics") {
+        status = "404 Not Found";
+        body = "Metrics are at /metrics\n";
+    } else {
+        status = "200 OK";
+        contentType = "text/plain; version=0.0.4; charset=utf-8";
+        body = mRegistry->Render();
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\n"
+        "Content-Type: " + contentType + "\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n\r\n";
+    if (!isHead) {
+        response += body;
+    }
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t count = send(connection, response.data() + sent, response.size() - sent, sendFlags);
+        if (count <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(count);
+    }
+#else
+    (void)connection;
+#endif
+}
@@ -0,0 +1,35 @@
+// MetricsServer.h
+// Minimal HTTP server for a metrics registry's /metrics page
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+class MetricsRegistry;
+
+// Serves GET /metrics on 127.0.0.1 from its own thread, one connection at a
+// time. A scrape only reads the metrics' atomics, so the simulation threads
+// never wait for it. POSIX sockets only.
+class MetricsServer {
+public:
+    MetricsServer();
+    ~MetricsServer();
+
+    // The registry must outlive the server; port 0 picks a free one
+    bool Start(const MetricsRegistry& registry, int port);
+    void Stop();
+
+    bool IsRunning() const { return mThread.joinable(); }
+    int GetPort() const { return mPort; }
+
+private:
+    void ServeLoop();
+    void HandleConnection(int connection);
+
+    const MetricsRegistry* mRegistry;
+    int mListener;  // Listening socket, or -1
+    int mPort;
+    std::atomic<bool> mStopping;
+    std::thread mThread;
+};
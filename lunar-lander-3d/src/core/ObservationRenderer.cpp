@@ -0,0 +1,478 @@
+// ObservationRenderer.cpp
+// Implementation of the batched terrain ray-caster
+
+#include "ObservationRenderer.h"
+#include "Entity.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define OBSERVATION_SSE 1
+#endif
+
+// Rays stop here (world units along the view direction)
+static const float kMaxDepth = 2000.0f;
+
+// Marching: a ray has landed once it is this close above the surface, and
+// never advances less than kMinStep per iteration
+static const float kHitEpsilon = 0.02f;
+static const float kMinStep = 0.05f;
+static const int kMaxSteps = 512;
+
+// Direction towards the sun for intensity images (Y grows downwards)
+static const float kSunDirection[3] = { 0.36f, -0.86f, 0.36f };
+
+ObservationRenderer::ObservationRenderer()
+    : mWidth(0)
+    , mHeight(0)
+    , mTanHalfFov(0.0f)
+    , mTerrain(nullptr)
+    , mTerrainGeneration(0)
+    , mHeights(nullptr)
+    , mResolution(0)
+    , mCellWidth(0.0f)
+    , mCellLength(0.0f)
+    , mTerrainWidth(0.0f)
+    , mTerrainLength(0.0f)
+    , mHighest(0.0f)
+    , mSlopeBound(0.0f)
+    , mCameras(nullptr)
+    , mCameraCount(0)
+    , mChannel(Channel::Depth)
+    , mOutput(nullptr)
+    , mNextCamera(0)
+    , mWorkGeneration(0)
+    , mWorkPending(0)
+    , mWorkStop(false)
+{
+}
+
+ObservationRenderer::~ObservationRenderer() {
+    Shutdown();
+}
+
+bool ObservationRenderer::Initialize(int width, int height, float fieldOfView, int workerCount) {
+    Shutdown();
+
+    if (width <= 0 || height <= 0 || fieldOfView <= 0.0f || fieldOfView >= 180.0f) {
+        return false;
+    }
+
+    mWidth = width;
+    mHeight = height;
+    mTanHalfFov = std::tan(fieldOfView * 0.5f * static_cast<float>(M_PI) / 180.0f);
+
+    if (workerCount <= 0) {
+        workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    // The thread calling Render() is one of the workers
+    mWorkStop = false;
+    for (int i = 1; i < workerCount; i++) {
+        mWorkers.emplace_back(&ObservationRenderer::WorkerLoop, this);
+    }
+    return true;
+}
+
+void ObservationRenderer::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mWorkMutex);
+        mWorkStop = true;
+    }
+    mWorkStart.notify_all();
+    for (std::thread& worker : mWorkers) {
+        worker.join();
+    }
+    mWorkers.clear();
+}
+
+void ObservationRenderer::SetTerrain(const Terrain* terrain) {
+    if (terrain == mTerrain && (!terrain || terrain->GetGeneration() == mTerrainGeneration)) {
+        return;
+    }
+
+    mTerrain = terrain;
+    mHeights = nullptr;
+    mResolution = 0;
+    if (!terrain || terrain->GetDetailResolution3D() <= 0) {
+        return;
+    }
+
+    mTerrainGeneration = terrain->GetGeneration();
+    mHeights = terrain->GetDetailHeights3D().data();
+    mResolution = terrain->GetDetailResolution3D();
+    mTerrainWidth = static_cast<float>(terrain->GetWidth());
+    mTerrainLength = static_cast<float>(terrain->GetLength());
+    mCellWidth = mTerrainWidth / mResolution;
+    mCellLength = mTerrainLength / mResolution;
+
+    // Highest ground, and the steepest edge of any cell: bilinear patches are
+    // never steeper than their edges, so this bounds the whole surface
+    const int stride = mResolution + 1;
+    float slopeX = 0.0f;
+    float slopeZ = 0.0f;
+    mHighest = mHeights[0];
+    for (int z = 0; z <= mResolution; z++) {
+        for (int x = 0; x <= mResolution; x++) {
+            float height = mHeights[z * stride + x];
+            mHighest = std::min(mHighest, height);
+            if (x < mResolution) {
+                slopeX = std::max(slopeX, std::fabs(mHeights[z * stride + x + 1] - height));
+            }
+            if (z < mResolution) {
+                slopeZ = std::max(slopeZ, std::fabs(mHeights[(z + 1) * stride + x] - height));
+            }
+        }
+    }
+    slopeX /= mCellWidth;
+    slopeZ /= mCellLength;
+    mSlopeBound = std::sqrt(slopeX * slopeX + slopeZ * slopeZ);
+}
+
+ObservationCamera ObservationRenderer::GetLanderCamera(const Lander* lander) {
+    ObservationCamera camera = {};
+    if (!lander) {
+        return camera;
+    }
+
+    // The lander's down axis (towards the ground, +Y), as for its landing lights
+    const float* position = lander->GetPosition();
+    float roll = lander->GetRotation()[2] * static_cast<float>(M_PI) / 180.0f;
+    const float down[3] = { -std::sin(roll), std::cos(roll), 0.0f };
+    float halfHeight = lander->GetHeight() / 2.0f;
+
+    for (int axis = 0; axis < 3; axis++) {
+        camera.position[axis] = position[axis] + down[axis] * halfHeight;
+        camera.forward[axis] = down[axis];
+    }
+    camera.up[0] = 0.0f;
+    camera.up[1] = 0.0f;
+    camera.up[2] = -1.0f;
+    return camera;
+}
+
+void ObservationRenderer::GetPixelDirection(const ObservationCamera& camera, float x, float y,
+                                            float* direction) const {
+    const float* forward = camera.forward;
+    const float* up = camera.up;
+    const float right[3] = {
+        forward[1] * up[2] - forward[2] * up[1],
+        forward[2] * up[0] - forward[0] * up[2],
+        forward[0] * up[1] - forward[1] * up[0]
+    };
+    float u = (x * 2.0f / mWidth - 1.0f) * mTanHalfFov;
+    float v = (1.0f - y * 2.0f / mHeight) * mTanHalfFov * static_cast<float>(mHeight) / mWidth;
+    for (int axis = 0; axis < 3; axis++) {
+        direction[axis] = forward[axis] + right[axis] * u + up[axis] * v;
+    }
+}
+
+float ObservationRenderer::TraceDepth(const float* origin, const float* direction) const {
+    float start, end, inverseRate;
+    if (!mHeights || !SetupRay(origin, direction, start, end, inverseRate)) {
+        return kMaxDepth;
+    }
+    float t = TraceRay(origin, direction, start, end, inverseRate);
+    return t >= 0.0f ? t : kMaxDepth;
+}
+
+float ObservationRenderer::GetMaxDepth() const {
+    return kMaxDepth;
+}
+
+void ObservationRenderer::Render(const ObservationCamera* cameras, int count, Channel channel, float* output) {
+    if (!cameras || !output || count <= 0 || mWidth <= 0) {
+        return;
+    }
+
+    mCameras = cameras;
+    mCameraCount = count;
+    mChannel = channel;
+    mOutput = output;
+    mNextCamera.store(0, std::memory_order_relaxed);
+
+    // Wake the workers, help out, then wait for the rest
+    std::unique_lock<std::mutex> lock(mWorkMutex);
+    mWorkPending = static_cast<int>(mWorkers.size());
+    mWorkGeneration++;
+    mWorkStart.notify_all();
+    lock.unlock();
+
+    RenderCameras();
+
+    lock.lock();
+    mWorkDone.wait(lock, [this]() { return mWorkPending == 0; });
+}
+
+void ObservationRenderer::WorkerLoop() {
+    uint64_t seenGeneration = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mWorkMutex);
+            mWorkStart.wait(lock, [&]() { return mWorkStop || mWorkGeneration != seenGeneration; });
+            if (mWorkStop) {
+                return;
+            }
+            seenGeneration = mWorkGeneration;
+        }
+
+        RenderCameras();
+
+        {
+            std::lock_guard<std::mutex> lock(mWorkMutex);
+            if (--mWorkPending == 0) {
+                mWorkDone.notify_one();
+            }
+        }
+    }
+}
+
+void ObservationRenderer::RenderCameras() {
+    // Cameras are taken one at a time, so long traces do not hold up a thread
+    for (;;) {
+        int index = mNextCamera.fetch_add(1, std::memory_order_relaxed);
+        if (index >= mCameraCount) {
+            return;
+        }
+        RenderImage(mCameras[index], mOutput + index * GetImageSize());
+    }
+}
+
+void ObservationRenderer::RenderImage(const ObservationCamera& camera, float* image) const {
+    const float* forward = camera.forward;
+    const float* up = camera.up;
+    const float right[3] = {
+        forward[1] * up[2] - forward[2] * up[1],
+        forward[2] * up[0] - forward[0] * up[2],
+        forward[0] * up[1] - forward[1] * up[0]
+    };
+    float aspect = static_cast<float>(mHeight) / mWidth;
+
+    for (int y = 0; y < mHeight; y++) {
+        float v = (1.0f - (y + 0.5f) * 2.0f / mHeight) * mTanHalfFov * aspect;
+        float* row = image + static_cast<size_t>(y) * mWidth;
+
+        for (int x = 0; x < mWidth; x += 4) {
+            // Directions have a unit forward component, so the ray parameter
+            // is the depth along the view direction
+            RayPacket packet;
+            for (int lane = 0; lane < 4; lane++) {
+                float u = ((x + lane + 0.5f) * 2.0f / mWidth - 1.0f) * mTanHalfFov;
+                float direction[3];
+                for (int axis = 0; axis < 3; axis++) {
+                    direction[axis] = forward[axis] + right[axis] * u + up[axis] * v;
+                    packet.direction[axis][lane] = direction[axis];
+                }
+                packet.start[lane] = packet.end[lane] = packet.inverseRate[lane] = 0.0f;
+                packet.valid[lane] = x + lane < mWidth && mHeights &&
+                                     SetupRay(camera.position, direction, packet.start[lane],
+                                              packet.end[lane], packet.inverseRate[lane]);
+            }
+
+            float hits[4];
+            TracePacket(camera.position, packet, hits);
+
+            for (int lane = 0; lane < 4 && x + lane < mWidth; lane++) {
+                if (mChannel == Channel::Depth) {
+                    row[x + lane] = hits[lane] >= 0.0f ? hits[lane] : kMaxDepth;
+                } else if (hits[lane] >= 0.0f) {
+                    const float direction[3] = { packet.direction[0][lane], packet.direction[1][lane],
+                                                 packet.direction[2][lane] };
+                    row[x + lane] = Shade(camera.position, direction, hits[lane]);
+                } else {
+                    row[x + lane] = 0.0f;
+                }
+            }
+        }
+    }
+}
+
+bool ObservationRenderer::SetupRay(const float* origin, const float* direction, float& start, float& end,
+                                   float& inverseRate) const {
+    start = 0.0f;
+    end = kMaxDepth;
+
+    // Clip to the grid's x and z extent
+    const float limits[2] = { mTerrainWidth, mTerrainLength };
+    for (int i = 0; i < 2; i++) {
+        int axis = i * 2;
+        if (std::fabs(direction[axis]) < 1e-8f) {
+            if (origin[axis] < 0.0f || origin[axis] > limits[i]) {
+                return false;
+            }
+            continue;
+        }
+        float t0 = -origin[axis] / direction[axis];
+        float t1 = (limits[i] - origin[axis]) / direction[axis];
+        start = std::max(start, std::min(t0, t1));
+        end = std::min(end, std::max(t0, t1));
+    }
+
+    // Nothing to hit above the highest ground
+    if (origin[1] < mHighest) {
+        if (direction[1] <= 0.0f) {
+            return false;
+        }
+        start = std::max(start, (mHighest - origin[1]) / direction[1]);
+    } else if (direction[1] < 0.0f) {
+        end = std::min(end, (mHighest - origin[1]) / direction[1]);
+    }
+    if (start > end) {
+        return false;
+    }
+
+    // How fast the gap to the ground can close per unit of ray parameter:
+    // the ray's descent plus the steepest climb the ground can make under it
+    float horizontal = std::sqrt(direction[0] * direction[0] + direction[2] * direction[2]);
+    float rate = direction[1] + mSlopeBound * horizontal;
+    if (rate <= 1e-6f) {
+        // Pulling away at least as fast as the ground rises: only a ray that
+        // starts underground hits
+        float x = origin[0] + direction[0] * start;
+        float z = origin[2] + direction[2] * start;
+        if (SampleHeight(x, z) - (origin[1] + direction[1] * start) > kHitEpsilon) {
+            return false;
+        }
+        inverseRate = 0.0f;
+    } else {
+        inverseRate = 1.0f / rate;
+    }
+    return true;
+}
+
+#ifdef OBSERVATION_SSE
+void ObservationRenderer::TracePacket(const float* origin, RayPacket& packet, float* hits) const {
+    const __m128 originX = _mm_set1_ps(origin[0]);
+    const __m128 originY = _mm_set1_ps(origin[1]);
+    const __m128 originZ = _mm_set1_ps(origin[2]);
+    const __m128 directionX = _mm_loadu_ps(packet.direction[0]);
+    const __m128 directionY = _mm_loadu_ps(packet.direction[1]);
+    const __m128 directionZ = _mm_loadu_ps(packet.direction[2]);
+    const __m128 end = _mm_loadu_ps(packet.end);
+    const __m128 inverseRate = _mm_loadu_ps(packet.inverseRate);
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 epsilon = _mm_set1_ps(kHitEpsilon);
+    const __m128 minStep = _mm_set1_ps(kMinStep);
+    const __m128 inverseCellWidth = _mm_set1_ps(1.0f / mCellWidth);
+    const __m128 inverseCellLength = _mm_set1_ps(1.0f / mCellLength);
+    const __m128 gridMax = _mm_set1_ps(static_cast<float>(mResolution));
+    const __m128 lastCell = _mm_set1_ps(static_cast<float>(mResolution - 1));
+    const __m128 stride = _mm_set1_ps(static_cast<float>(mResolution + 1));
+    const int rowStride = mResolution + 1;
+
+    // Invalid lanes start inactive; every lane reports -1 unless it lands
+    __m128 active = _mm_castsi128_ps(_mm_setr_epi32(packet.valid[0] ? -1 : 0, packet.valid[1] ? -1 : 0,
+                                                    packet.valid[2] ? -1 : 0, packet.valid[3] ? -1 : 0));
+    __m128 t = _mm_and_ps(active, _mm_loadu_ps(packet.start));
+    __m128 hit = _mm_set1_ps(-1.0f);
+
+    for (int step = 0; step < kMaxSteps; step++) {
+        active = _mm_and_ps(active, _mm_cmple_ps(t, end));
+        if (_mm_movemask_ps(active) == 0) {
+            break;
+        }
+
+        __m128 x = _mm_add_ps(originX, _mm_mul_ps(t, directionX));
+        __m128 y = _mm_add_ps(originY, _mm_mul_ps(t, directionY));
+        __m128 z = _mm_add_ps(originZ, _mm_mul_ps(t, directionZ));
+
+        // Bilinear height under each lane: cells in SIMD, corners gathered
+        __m128 gridX = _mm_min_ps(_mm_max_ps(_mm_mul_ps(x, inverseCellWidth), zero), gridMax);
+        __m128 gridZ = _mm_min_ps(_mm_max_ps(_mm_mul_ps(z, inverseCellLength), zero), gridMax);
+        __m128 cellX = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(gridX)), lastCell);
+        __m128 cellZ = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(gridZ)), lastCell);
+        __m128 fractionX = _mm_sub_ps(gridX, cellX);
+        __m128 fractionZ = _mm_sub_ps(gridZ, cellZ);
+
+        alignas(16) int32_t index[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(index),
+                        _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(cellZ, stride), cellX)));
+        const float* h = mHeights;
+        __m128 h00 = _mm_setr_ps(h[index[0]], h[index[1]], h[index[2]], h[index[3]]);
+        __m128 h10 = _mm_setr_ps(h[index[0] + 1], h[index[1] + 1], h[index[2] + 1], h[index[3] + 1]);
+        __m128 h01 = _mm_setr_ps(h[index[0] + rowStride], h[index[1] + rowStride],
+                                 h[index[2] + rowStride], h[index[3] + rowStride]);
+        __m128 h11 = _mm_setr_ps(h[index[0] + rowStride + 1], h[index[1] + rowStride + 1],
+                                 h[index[2] + rowStride + 1], h[index[3] + rowStride + 1]);
+        __m128 top = _mm_add_ps(h00, _mm_mul_ps(_mm_sub_ps(h10, h00), fractionX));
+        __m128 bottom = _mm_add_ps(h01, _mm_mul_ps(_mm_sub_ps(h11, h01), fractionX));
+        __m128 height = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fractionZ));
+
+        // Land lanes that reached the surface, step the others as far as is safe
+        __m128 gap = _mm_sub_ps(height, y);
+        __m128 landed = _mm_and_ps(active, _mm_cmple_ps(gap, epsilon));
+        hit = _mm_or_ps(_mm_and_ps(landed, t), _mm_andnot_ps(landed, hit));
+        active = _mm_andnot_ps(landed, active);
+        t = _mm_add_ps(t, _mm_max_ps(_mm_mul_ps(gap, inverseRate), minStep));
+    }
+
+    _mm_storeu_ps(hits, hit);
+}
+#else
+void ObservationRenderer::TracePacket(const float* origin, RayPacket& packet, float* hits) const {
+    for (int lane = 0; lane < 4; lane++) {
+        hits[lane] = -1.0f;
+        if (packet.valid[lane]) {
+            const float direction[3] = { packet.direction[0][lane], packet.direction[1][lane],
+                                         packet.direction[2][lane] };
+            hits[lane] = TraceRay(origin, direction, packet.start[lane], packet.end[lane],
+                                  packet.inverseRate[lane]);
+        }
+    }
+}
+#endif
+
+float ObservationRenderer::TraceRay(const float* origin, const float* direction, float start, float end,
+                                    float inverseRate) const {
+    float t = start;
+    for (int step = 0; step < kMaxSteps && t <= end; step++) {
+        float x = origin[0] + direction[0] * t;
+        float y = origin[1] + direction[1] * t;
+        float z = origin[2] + direction[2] * t;
+        float gap = SampleHeight(x, z) - y;
+        if (gap <= kHitEpsilon) {
+            return t;
+        }
+        t += std::max(gap * inverseRate, kMinStep);
+    }
+    return -1.0f;
+}
+
+float ObservationRenderer::SampleHeight(float x, float z) const {
+    // Scaled by the inverse cell size, as the SSE path does, so that both
+    // paths pick the same cells and fractions
+    float gridX = std::min(std::max(x * (1.0f / mCellWidth), 0.0f), static_cast<float>(mResolution));
+    float gridZ = std::min(std::max(z * (1.0f / mCellLength), 0.0f), static_cast<float>(mResolution));
+    int cellX = std::min(static_cast<int>(gridX), mResolution - 1);
+    int cellZ = std::min(static_cast<int>(gridZ), mResolution - 1);
+    float fractionX = gridX - cellX;
+    float fractionZ = gridZ - cellZ;
+
+    const int stride = mResolution + 1;
+    const float* corner = mHeights + cellZ * stride + cellX;
+    float top = corner[0] + (corner[1] - corner[0]) * fractionX;
+    float bottom = corner[stride] + (corner[stride + 1] - corner[stride]) * fractionX;
+    return top + (bottom - top) * fractionZ;
+}
+
+float ObservationRenderer::Shade(const float* origin, const float* direction, float t) const {
+    // Normal of the cell that was hit, from its average slopes (as in
+    // TerrainNormalMap), lit by the sun
+    float x = origin[0] + direction[0] * t;
+    float z = origin[2] + direction[2] * t;
+    int cellX = std::min(std::max(static_cast<int>(x / mCellWidth), 0), mResolution - 1);
+    int cellZ = std::min(std::max(static_cast<int>(z / mCellLength), 0), mResolution - 1);
+
+    const int stride = mResolution + 1;
+    const float* corner = mHeights + cellZ * stride + cellX;
+    float slopeX = ((corner[1] - corner[0]) + (corner[stride + 1] - corner[stride])) / (2.0f * mCellWidth);
+    float slopeZ = ((corner[stride] - corner[0]) + (corner[stride + 1] - corner[1])) / (2.0f * mCellLength);
+
+    float lightDot = slopeX * kSunDirection[0] - kSunDirection[1] + slopeZ * kSunDirection[2];
+    float length = std::sqrt(slopeX * slopeX + 1.0f + slopeZ * slopeZ);
+    return std::max(0.0f, std::min(1.0f, lightDot / length));
+}
@@ -0,0 +1,126 @@
+// ObservationRenderer.h
+// Small depth or intensity images of the terrain for vision-based controllers
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Lander;
+class Terrain;
+
+// Pinhole camera in world space (Y grows towards the ground)
+struct ObservationCamera {
+    float position[3];
+    float forward[3];  // View direction, unit length
+    float up[3];       // Image up, unit length and perpendicular to forward
+};
+
+// Ray-casts the terrain's full-resolution height grid for many cameras at
+// once, for agents that learn from pixels rather than state. Rays are traced
+// four at a time with SSE (scalar on other targets) by stepping along each
+// ray as far as the grid's steepest slope allows without passing through
+// the surface. Cameras are spread over a pool of worker threads, and every
+// image is written straight into the caller's batch tensor.
+class ObservationRenderer {
+public:
+    enum class Channel {
+        Depth,     // Distance along the view direction; GetMaxDepth() for no hit
+        Intensity  // Sunlit surface brightness 0..1; 0 for no hit
+    };
+
+    ObservationRenderer();
+    ~ObservationRenderer();
+
+    // Image size and horizontal field of view (degrees). With no worker
+    // count, one thread per core (the caller's thread included).
+    bool Initialize(int width, int height, float fieldOfView, int workerCount = 0);
+    void Shutdown();
+
+    // Terrain to trace (its 3D detail grid). Nothing is copied: the terrain
+    // must not change while Render() runs. Cheap when it has not changed.
+    void SetTerrain(const Terrain* terrain);
+
+    // Camera below the lander, looking along its down axis
+    static ObservationCamera GetLanderCamera(const Lander* lander);
+
+    // Render one image per camera into output, which must hold
+    // count * GetImageSize() floats: image after image, rows from the top.
+    // Blocks until every image is written.
+    void Render(const ObservationCamera* cameras, int count, Channel channel, float* output);
+
+    // View ray through image point (x, y) in pixels, pixel centers at +0.5.
+    // Its forward component is 1, so position + direction * depth is the
+    // surface point seen at that depth.
+    void GetPixelDirection(const ObservationCamera& camera, float x, float y, float* direction) const;
+
+    // Depth seen along one such ray, traced on its own by the scalar path
+    // whatever the target; GetMaxDepth() for no hit. For checking Render(),
+    // which traces four rays at a time.
+    float TraceDepth(const float* origin, const float* direction) const;
+
+    int GetWidth() const { return mWidth; }
+    int GetHeight() const { return mHeight; }
+    size_t GetImageSize() const { return static_cast<size_t>(mWidth) * mHeight; }
+    float GetMaxDepth() const;
+
+private:
+    // Rays of one image row segment: up to four, side by side
+    struct RayPacket {
+        float direction[3][4];
+        float start[4];  // Ray parameter range inside the terrain's bounds
+        float end[4];
+        float inverseRate[4];  // Step per unit of height above the ground
+        bool valid[4];         // False when the ray cannot hit
+    };
+
+    void WorkerLoop();
+    void RenderCameras();
+    void RenderImage(const ObservationCamera& camera, float* image) const;
+
+    // Ray setup shared by both paths; returns false when it misses the terrain
+    bool SetupRay(const float* origin, const float* direction, float& start, float& end,
+                  float& inverseRate) const;
+    void TracePacket(const float* origin, RayPacket& packet, float* hits) const;
+    float TraceRay(const float* origin, const float* direction, float start, float end,
+                   float inverseRate) const;
+    float SampleHeight(float x, float z) const;
+    float Shade(const float* origin, const float* direction, float t) const;
+
+    int mWidth;
+    int mHeight;
+    float mTanHalfFov;
+
+    // Height grid of the current terrain
+    const Terrain* mTerrain;
+    unsigned int mTerrainGeneration;
+    const float* mHeights;
+    int mResolution;
+    float mCellWidth;
+    float mCellLength;
+    float mTerrainWidth;
+    float mTerrainLength;
+    float mHighest;     // Smallest Y of the grid
+    float mSlopeBound;  // Largest height change per unit of horizontal distance
+
+    // Current batch, shared with the workers
+    const ObservationCamera* mCameras;
+    int mCameraCount;
+    Channel mChannel;
+    float* mOutput;
+    std::atomic<int> mNextCamera;
+
+    // Worker pool
+    std::vector<std::thread> mWorkers;
+    std::mutex mWorkMutex;
+    std::condition_variable mWorkStart;
+    std::condition_variable mWorkDone;
+    uint64_t mWorkGeneration;
+    int mWorkPending;
+    bool mWorkStop;
+};
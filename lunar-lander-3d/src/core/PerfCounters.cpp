@@ -0,0 +1,243 @@
+// PerfCounters.cpp
+// Implementation of the perf_event_open counter group and frame profiler
+
+#include "PerfCounters.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+static const int kEventCount = static_cast<int>(PerfEvent::Count);
+static const int kPhaseCount = static_cast<int>(FramePhase::Count);
+
+static const char* const kPhaseNames[] = {
+    "physics",
+    "collision",
+    "render"
+};
+
+static uint64_t GetWallTime() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#ifdef __linux__
+// Type and config of each PerfEvent
+struct PerfEventConfig {
+    uint32_t type;
+    uint64_t config;
+};
+
+static uint64_t CacheMissConfig(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+static const PerfEventConfig kEventConfigs[] = {
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, CacheMissConfig(PERF_COUNT_HW_CACHE_L1D) },
+    { PERF_TYPE_HW_CACHE, CacheMissConfig(PERF_COUNT_HW_CACHE_LL) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+};
+
+// Layout of a PERF_FORMAT_GROUP read with both times
+struct GroupReadFormat {
+    uint64_t count;
+    uint64_t timeEnabled;
+    uint64_t timeRunning;
+    uint64_t values[kEventCount];
+};
+#endif
+
+PerfCounterGroup::PerfCounterGroup()
+    : mLeader(-1)
+    , mOpenCount(0)
+{
+    std::fill(mFds, mFds + kEventCount, -1);
+    std::fill(mSlots, mSlots + kEventCount, -1);
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+    Close();
+}
+
+bool PerfCounterGroup::Open() {
+    Close();
+
+#ifdef __linux__
+    for (int i = 0; i < kEventCount; i++) {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = kEventConfigs[i].type;
+        attributes.config = kEventConfigs[i].config;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attributes.disabled = mLeader < 0 ? 1 : 0;  // The leader starts the group
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        // This thread, on any CPU
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, mLeader, 0));
+        if (fd < 0) {
+            continue;
+        }
+        if (mLeader < 0) {
+            mLeader = fd;
+        }
+        mFds[i] = fd;
+        mSlots[i] = mOpenCount++;
+    }
+
+    if (mLeader < 0) {
+        std::cerr << "Performance counters unavailable: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    ioctl(mLeader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(mLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+#else
+    std::cerr << "Performance counters need Linux perf_event_open" << std::endl;
+    return false;
+#endif
+}
+
+void PerfCounterGroup::Close() {
+#ifdef __linux__
+    // Members before the leader
+    for (int i = kEventCount - 1; i >= 0; i--) {
+        if (mFds[i] >= 0) {
+            close(mFds[i]);
+        }
+    }
+#endif
+    mLeader = -1;
+    mOpenCount = 0;
+    std::fill(mFds, mFds + kEventCount, -1);
+    std::fill(mSlots, mSlots + kEventCount, -1);
+}
+
+void PerfCounterGroup::Read(PerfReading& reading) const {
+    std::fill(reading.values, reading.values + kEventCount, 0);
+    reading.wallTime = GetWallTime();
+
+#ifdef __linux__
+    GroupReadFormat data;
+    if (mLeader < 0 || read(mLeader, &data, sizeof(data)) <= 0 || data.timeRunning == 0) {
+        return;
+    }
+
+    // Estimate the full counts when the PMU was shared
+    double scale = static_cast<double>(data.timeEnabled) / data.timeRunning;
+    for (int i = 0; i < kEventCount; i++) {
+        if (mSlots[i] >= 0 && static_cast<uint64_t>(mSlots[i]) < data.count) {
+            reading.values[i] = static_cast<uint64_t>(data.values[mSlots[i]] * scale);
+        }
+    }
+#endif
+}
+
+FrameProfiler::FrameProfiler() {
+    Reset();
+    for (PerfReading& start : mStart) {
+        std::fill(start.values, start.values + kEventCount, 0);
+        start.wallTime = 0;
+    }
+}
+
+bool FrameProfiler::Initialize() {
+    if (!mCounters.Open()) {
+        return false;
+    }
+    if (!HasCounters()) {
+        std::cerr << "Hardware counters unavailable; profiling CPU and wall time only" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void FrameProfiler::Begin(FramePhase phase) {
+    mCounters.Read(mStart[static_cast<int>(phase)]);
+}
+
+void FrameProfiler::End(FramePhase phase) {
+    PerfReading end;
+    mCounters.Read(end);
+
+    const PerfReading& start = mStart[static_cast<int>(phase)];
+    PhaseStats& stats = mStats[static_cast<int>(phase)];
+    stats.calls++;
+    stats.wallTime += end.wallTime - start.wallTime;
+    for (int i = 0; i < kEventCount; i++) {
+        // Scaled counts can step back slightly between reads
+        stats.values[i] += end.values[i] > start.values[i] ? end.values[i] - start.values[i] : 0;
+    }
+}
+
+void FrameProfiler::Reset() {
+    for (PhaseStats& stats : mStats) {
+        stats.calls = 0;
+        stats.wallTime = 0;
+        std::fill(stats.values, stats.values + kEventCount, 0);
+    }
+}
+
+void FrameProfiler::Report(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed;
+
+    out << std::left << std::setw(11) << "Phase" << std::right << std::setw(8) << "Calls"
+        << std::setw(10) << "ms/call" << std::setw(8) << "CPU%" << std::setw(7) << "IPC"
+        << std::setw(10) << "L1D MPKI" << std::setw(10) << "LLC MPKI" << std::setw(10) << "Br MPKI" << "\n";
+
+    for (int phase = 0; phase < kPhaseCount; phase++) {
+        const PhaseStats& stats = mStats[phase];
+        if (stats.calls == 0) {
+            continue;
+        }
+
+        out << std::left << std::setw(11) << kPhaseNames[phase] << std::right << std::setw(8) << stats.calls
+            << std::setw(10) << std::setprecision(3) << stats.wallTime / 1e6 / stats.calls;
+
+        // Share of the wall time actually spent on the CPU
+        if (mCounters.HasEvent(PerfEvent::TaskClock) && stats.wallTime > 0) {
+            out << std::setw(8) << std::setprecision(1)
+                << 100.0 * stats.values[static_cast<int>(PerfEvent::TaskClock)] / stats.wallTime;
+        } else {
+            out << std::setw(8) << "n/a";
+        }
+
+        const double instructions = static_cast<double>(stats.values[static_cast<int>(PerfEvent::Instructions)]);
+        const double cycles = static_cast<double>(stats.values[static_cast<int>(PerfEvent::Cycles)]);
+        if (mCounters.HasEvent(PerfEvent::Cycles) && mCounters.HasEvent(PerfEvent::Instructions) && cycles > 0.0) {
+            out << std::setw(7) << std::setprecision(2) << instructions / cycles;
+        } else {
+            out << std::setw(7) << "n/a";
+        }
+
+        const PerfEvent misses[] = { PerfEvent::L1DMisses, PerfEvent::LLCMisses, PerfEvent::BranchMisses };
+        for (PerfEvent event : misses) {
+            if (mCounters.HasEvent(event) && instructions > 0.0) {
+                out << std::setw(10) << std::setprecision(2)
+                    << 1000.0 * stats.values[static_cast<int>(event)] / instructions;
+            } else {
+                out << std::setw(10) << "n/a";
+            }
+        }
+        out << "\n";
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
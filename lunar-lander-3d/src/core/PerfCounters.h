@@ -0,0 +1,114 @@
+// PerfCounters.h
+// Hardware performance counters per frame phase (Linux perf_event_open)
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+
+// Counted events; CPU time is a software event that anchors the group
+enum class PerfEvent {
+    TaskClock,     // Nanoseconds on the CPU
+    Cycles,
+    Instructions,
+    L1DMisses,     // L1 data cache read misses
+    LLCMisses,     // Last-level cache read misses
+    BranchMisses,
+    Count
+};
+
+// Parts of a frame that are measured; collision runs inside physics, so
+// the physics figures include it
+enum class FramePhase {
+    Physics,
+    Collision,
+    Render,
+    Count
+};
+
+// Cumulative counts at one instant, scaled up for any time the group was
+// multiplexed off the PMU; unavailable events stay zero
+struct PerfReading {
+    uint64_t values[static_cast<int>(PerfEvent::Count)];
+    uint64_t wallTime;  // Nanoseconds
+};
+
+// The calling thread's counters, opened as one perf_event group so they
+// are scheduled together and read with a single system call. Events the
+// machine or its permissions don't allow (e.g. no PMU in a VM, or
+// perf_event_paranoid above 2) are left out; with none at all only wall
+// time is measured. Not available outside Linux.
+class PerfCounterGroup {
+public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    // Returns false when no event could be opened
+    bool Open();
+    void Close();
+
+    bool HasEvent(PerfEvent event) const { return mSlots[static_cast<int>(event)] >= 0; }
+    void Read(PerfReading& reading) const;
+
+private:
+    int mLeader;  // Group leader's file descriptor, or -1
+    int mFds[static_cast<int>(PerfEvent::Count)];  // -1 for events not counted
+    int mSlots[static_cast<int>(PerfEvent::Count)];  // Position in a group read, or -1
+    int mOpenCount;
+};
+
+// Totals of one phase
+struct PhaseStats {
+    uint64_t calls;
+    uint64_t wallTime;  // Nanoseconds
+    uint64_t values[static_cast<int>(PerfEvent::Count)];
+};
+
+// Accumulates counters per frame phase and reports them as time, IPC and
+// misses per thousand instructions (MPKI). Phases may nest.
+class FrameProfiler {
+public:
+    FrameProfiler();
+
+    // Opens the counters; false when only wall time can be measured, in
+    // which case the profiler still works
+    bool Initialize();
+
+    void Begin(FramePhase phase);
+    void End(FramePhase phase);
+
+    // Measures the enclosing block; does nothing without a profiler
+    class Scope {
+    public:
+        Scope(FrameProfiler* profiler, FramePhase phase)
+            : mProfiler(profiler)
+            , mPhase(phase)
+        {
+            if (mProfiler) {
+                mProfiler->Begin(mPhase);
+            }
+        }
+
+        ~Scope() {
+            if (mProfiler) {
+                mProfiler->End(mPhase);
+            }
+        }
+
+    private:
+        FrameProfiler* mProfiler;
+        FramePhase mPhase;
+    };
+
+    const PhaseStats& GetStats(FramePhase phase) const { return mStats[static_cast<int>(phase)]; }
+    bool HasCounters() const { return mCounters.HasEvent(PerfEvent::Instructions); }
+
+    // Table of every phase measured since the last Reset()
+    void Report(std::ostream& out) const;
+    void Reset();
+
+private:
+    PerfCounterGroup mCounters;
+    PerfReading mStart[static_cast<int>(FramePhase::Count)];
+    PhaseStats mStats[static_cast<int>(FramePhase::Count)];
+};
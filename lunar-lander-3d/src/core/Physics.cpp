@@ -2,9 +2,14 @@
 // Implementation of the physics system
 
 #include "Physics.h"
+#include "FaultInjector.h"
+#include "WindField.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
+constexpr float Physics::kMaxSubStep;
+
 Physics::Physics()
     : mGravity(1.62f)      // Lunar gravity (m/s²)
     , mAirDensity(0.0f)    // No atmosphere on the moon
@@ -13,6 +18,13 @@ Physics::Physics()
     , mTerrain(nullptr)
     , mIntegrationMethod(EULER)
     , mTimeScale(1.0f) // Normal simulation speed (1:1)
+    , mFaultState(&FaultState::Nominal())
+    , mWindField(nullptr)
+    , mWind{ 0.0f, 0.0f, 0.0f }
+    , mHasWind(false)
+    , mSimulationTime(0.0f)
+    , mProfiler(nullptr)
+    , mVerbose(true)
 {
 }
 
@@ -20,6 +32,15 @@ void Physics::Initialize() {
     // Initialize physics system
 }
 
+void Physics::SetWind(const float* wind) {
+    std::copy(wind, wind + 3, mWind);
+    mHasWind = true;
+}
+
+void Physics::SetFaultState(const FaultState* state) {
+    mFaultState = state ? state : &FaultState::Nominal();
+}
+
 void Physics::RegisterLander(Lander* lander) {
     mLander = lander;
 }
@@ -29,12 +50,32 @@ void Physics::RegisterTerrain(Terrain* terrain) {
 }
 
 void Physics::Update(float deltaTime) {
-    // Choose the appropriate update method based on mode
-    if (m3DMode) {
-        Update3D(deltaTime);
-    } else {
-        Update2D(deltaTime);
+    if (!mLander || !mTerrain) {
+        return;
     }
+    
+    // Scale the frame time by the time warp factor and split it into
+    // sub-steps, so high warp doesn't tunnel the lander through the terrain
+    float remaining = deltaTime * mTimeScale;
+    
+    while (remaining > 0.0f && !mLander->IsLanded() && !mLander->IsCrashed()) {
+        float step = std::min(remaining, kMaxSubStep);
+        remaining -= step;
+        
+        // Choose the appropriate update method based on mode
+        if (m3DMode) {
+            Update3D(step);
+        } else {
+            Update2D(step);
+        }
+        
+        // Entity-specific update (fuel consumption) runs at the same rate
+        mLander->Update(step);
+        mSimulationTime += step;
+    }
+    
+    // A wind given with SetWind() holds for this update only
+    mHasWind = false;
 }
 
 bool Physics::CheckCollisions() {
@@ -56,7 +97,7 @@ void Physics::ApplyGravity(Lander* lander, float deltaTime) {
     float* velocity = lander->GetVelocity();
     
     // Apply gravity (only in Y direction for 2D mode)
-    velocity[1] += mGravity * deltaTime * 10.31f;
+    velocity[1] += GetGravityAcceleration() * deltaTime;
     
     // In 3D mode, gravity would be applied based on coordinate system
     if (m3DMode) {
@@ -70,8 +111,9 @@ void Physics::ApplyThrust(Lander* lander, float deltaTime) {
         return;
     }
     
-    // Calculate thrust force based on lander properties
-    float thrustForce = 2.5f * mGravity * lander->GetThrustLevel();
+    // Calculate thrust force based on lander properties, less any lost to
+    // an engine fault
+    float thrustForce = GetThrustAcceleration(lander->GetThrustLevel()) * mFaultState->thrustScale;
     
     // Get lander velocity and rotation
     float* velocity = lander->GetVelocity();
@@ -106,20 +148,26 @@ void Physics::ApplyDrag(Lander* lander, float deltaTime) {
         return; // No drag in vacuum or when landed
     }
     
-    // Get lander velocity
+    // Get lander velocity, and the wind it is moving through
     float* velocity = lander->GetVelocity();
+    float wind[3] = { 0.0f, 0.0f, 0.0f };
+    if (mHasWind) {
+        std::copy(mWind, mWind + 3, wind);
+    } else if (mWindField) {
+        mWindField->Sample(lander->GetPosition(), mSimulationTime, wind);
+    }
     
     // Calculate drag force
     // Drag = 0.5 * density * velocity^2 * drag_coefficient * area
     float dragCoefficient = 0.5f;
     float area = lander->GetWidth() * lander->GetHeight(); // Simplified
     
-    // Apply drag in each direction
+    // Apply drag in each direction, from the velocity relative to the air
     for (int i = 0; i < (m3DMode ? 3 : 2); i++) {
-        float speed = velocity[i];
+        float speed = velocity[i] - wind[i];
         float dragForce = 0.5f * mAirDensity * speed * std::abs(speed) * dragCoefficient * area;
         
-        // Drag always opposes motion
+        // Drag always opposes motion through the air
         if (speed != 0) {
             velocity[i] -= dragForce * deltaTime / lander->GetMass();
         }
@@ -132,13 +180,10 @@ void Physics::Update2D(float deltaTime) {
         return;
     }
     
-    // Scale deltaTime to make simulation faster
-    float scaledDeltaTime = deltaTime * mTimeScale;
-
     // Apply forces
-    ApplyGravity(mLander, scaledDeltaTime);
-    ApplyThrust(mLander, scaledDeltaTime);
-    ApplyDrag(mLander, scaledDeltaTime);
+    ApplyGravity(mLander, deltaTime);
+    ApplyThrust(mLander, deltaTime);
+    ApplyDrag(mLander, deltaTime);
     
     // Update position based on velocity (simple Euler integration)
     if (!mLander->IsLanded() && !mLander->IsCrashed()) {
@@ -153,6 +198,7 @@ void Physics::Update2D(float deltaTime) {
     }
     
     // Check for collisions
+    FrameProfiler::Scope collisionScope(mProfiler, FramePhase::Collision);
     CheckCollisions2D();
 }
 
@@ -184,7 +230,9 @@ bool Physics::CheckCollisions2D() {
             float* velocity = mLander->GetVelocity();
             velocity[0] = velocity[1] = 0.0f;
             
-            std::cout << "Successful landing!" << std::endl;
+            if (mVerbose) {
+                std::cout << "Successful landing!" << std::endl;
+            }
         } else {
             // Crash landing
             mLander->SetCrashed(true);
@@ -193,7 +241,9 @@ bool Physics::CheckCollisions2D() {
             float* velocity = mLander->GetVelocity();
             velocity[0] = velocity[1] = 0.0f;
             
-            std::cout << "Crash landing!" << std::endl;
+            if (mVerbose) {
+                std::cout << "Crash landing!" << std::endl;
+            }
         }
         
         return true;
@@ -227,6 +277,7 @@ void Physics::Update3D(float deltaTime) {
     }
     
     // Check for collisions
+    FrameProfiler::Scope collisionScope(mProfiler, FramePhase::Collision);
     CheckCollisions3D();
 }
 
@@ -258,7 +309,9 @@ bool Physics::CheckCollisions3D() {
             float* velocity = mLander->GetVelocity();
             velocity[0] = velocity[1] = velocity[2] = 0.0f;
             
-            std::cout << "Successful 3D landing!" << std::endl;
+            if (mVerbose) {
+                std::cout << "Successful 3D landing!" << std::endl;
+            }
         } else {
             // Crash landing
             mLander->SetCrashed(true);
@@ -267,7 +320,9 @@ bool Physics::CheckCollisions3D() {
             float* velocity = mLander->GetVelocity();
             velocity[0] = velocity[1] = velocity[2] = 0.0f;
             
-            std::cout << "Crash landing in 3D!" << std::endl;
+            if (mVerbose) {
+                std::cout << "Crash landing in 3D!" << std::endl;
+            }
         }
         
         return true;
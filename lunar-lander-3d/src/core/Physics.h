@@ -4,9 +4,13 @@
 #pragma once
 
 #include "Entity.h"
+#include "PerfCounters.h"
 #include "Terrain.h"
 #include <vector>
 
+struct FaultState;
+class WindField;
+
 class Physics {
 public:
     Physics();
@@ -27,6 +31,40 @@ public:
     float GetAirDensity() const { return mAirDensity; }
     void SetAirDensity(float density) { mAirDensity = density; }
     
+    // Wind the lander's drag is computed against; nullptr for still air.
+    // Only felt with an atmosphere (SetAirDensity()).
+    void SetWindField(const WindField* wind) { mWindField = wind; }
+    
+    // Wind for the next Update() only, used instead of a lookup in the wind
+    // field; lets a caller sample many landers at once (WindField::SampleBatch)
+    void SetWind(const float* wind);
+    
+    // Simulated seconds flown, the time the wind field is sampled at
+    float GetSimulationTime() const { return mSimulationTime; }
+    void SetSimulationTime(float time) { mSimulationTime = time; }
+    
+    // Accelerations applied by the integrator (world units per second squared)
+    float GetGravityAcceleration() const { return mGravity * 10.31f; }
+    float GetThrustAcceleration(float thrustLevel) const { return 2.5f * mGravity * thrustLevel; }
+    
+    // Time warp: simulated seconds per real second
+    float GetTimeScale() const { return mTimeScale; }
+    void SetTimeScale(float timeScale) { mTimeScale = timeScale > 0.0f ? timeScale : 1.0f; }
+    
+    // Active faults (engine thrust loss); nullptr restores nominal behavior.
+    // The state is read every tick, so it must outlive its use here.
+    void SetFaultState(const FaultState* state);
+    
+    // Profiler that times terrain collision checks; nullptr to not measure
+    void SetProfiler(FrameProfiler* profiler) { mProfiler = profiler; }
+    
+    // Touchdowns are logged to std::cout unless turned off (headless runs)
+    void SetVerbose(bool verbose) { mVerbose = verbose; }
+    
+    // Largest step a single physics tick may integrate; warped frames are
+    // split into sub-steps no longer than this
+    static constexpr float kMaxSubStep = 1.0f / 60.0f;
+    
     // Collision detection
     bool CheckCollisions();
     
@@ -48,6 +86,13 @@ private:
     float mGravity;         // Lunar gravity (m/s²)
     float mAirDensity;      // Atmospheric density (kg/m³)
     float mTimeScale;       // Time scaling factor for simulation speed
+    const FaultState* mFaultState;  // Never null (FaultState::Nominal() when unset)
+    const WindField* mWindField;
+    float mWind[3];         // From SetWind()
+    bool mHasWind;
+    float mSimulationTime;
+    FrameProfiler* mProfiler;
+    bool mVerbose;
     
     // Simulation mode
     bool m3DMode;           // Whether to use 3D physics
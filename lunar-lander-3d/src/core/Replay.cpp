@@ -0,0 +1,451 @@
+// Replay.cpp
+// Implementation of the replay writer and memory-mapped reader
+
+#include "Replay.h"
+#include "Entity.h"
+#include "Physics.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+static const uint32_t kReplayMagic = 0x50524C4C; // "LLRP"
+static const uint32_t kReplayVersion = 2;
+
+// Record tags and sizes
+static const uint8_t kKeyframeTag = 'K';
+static const uint8_t kTickTag = 'T';
+static const size_t kKeyframeRecordSize = 1 + sizeof(uint64_t) + sizeof(float) + 1 + sizeof(LanderSnapshot);
+static const uint8_t kKeyframeAfterJump = 1 << 0;
+static const size_t kTickRecordSize = 1 + sizeof(float) + sizeof(uint8_t);
+static const size_t kIndexEntrySize = 2 * sizeof(uint64_t);
+static const size_t kFooterSize = 3 * sizeof(uint64_t) + sizeof(uint32_t);
+
+// Rotation applied per tick while a rotate key is held (degrees)
+static const float kRotationStep = 2.0f;
+
+void ApplyPilotInputs(Lander* lander, uint8_t inputs) {
+    if (!lander) {
+        return;
+    }
+
+    lander->ApplyThrust((inputs & INPUT_THRUST) ? 1.0f : 0.0f);
+
+    if (inputs & INPUT_ROTATE_LEFT) {
+        lander->RotateLeft(kRotationStep);
+    }
+
+    if (inputs & INPUT_ROTATE_RIGHT) {
+        lander->RotateRight(kRotationStep);
+    }
+}
+
+float GetPilotRotationStep() {
+    return kRotationStep;
+}
+
+// Unaligned reads from the mapped file
+template <typename T>
+static T ReadValue(const uint8_t* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+// ReplayWriter implementation
+ReplayWriter::ReplayWriter()
+    : mKeyframeInterval(kDefaultKeyframeInterval)
+    , mTickCount(0)
+    , mTicksSinceKeyframe(0)
+    , mForceKeyframe(false)
+    , mJumped(false)
+{
+}
+
+ReplayWriter::~ReplayWriter() {
+    Close();
+}
+
+bool ReplayWriter::Open(const std::string& path, const ReplayHeader& header) {
+    Close();
+
+    mFile.open(path, std::ios::binary | std::ios::trunc);
+    if (!mFile.is_open()) {
+        std::cerr << "Failed to open replay file: " << path << std::endl;
+        return false;
+    }
+
+    ReplayHeader fileHeader = header;
+    fileHeader.magic = kReplayMagic;
+    fileHeader.version = kReplayVersion;
+    if (fileHeader.keyframeInterval == 0) {
+        fileHeader.keyframeInterval = kDefaultKeyframeInterval;
+    }
+    mFile.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+
+    mPath = path;
+    mKeyframeInterval = fileHeader.keyframeInterval;
+    mTickCount = 0;
+    mTicksSinceKeyframe = 0;
+    mForceKeyframe = true;  // The first tick always starts with a keyframe
+    mJumped = false;
+    mIndex.clear();
+
+    std::cout << "Recording replay to " << path << std::endl;
+    return true;
+}
+
+void ReplayWriter::Close() {
+    if (!mFile.is_open()) {
+        return;
+    }
+
+    // Trailing index table
+    uint64_t indexOffset = static_cast<uint64_t>(mFile.tellp());
+    for (const auto& entry : mIndex) {
+        mFile.write(reinterpret_cast<const char*>(&entry.tick), sizeof(entry.tick));
+        mFile.write(reinterpret_cast<const char*>(&entry.offset), sizeof(entry.offset));
+    }
+
+    // Footer
+    uint64_t keyframeCount = mIndex.size();
+    mFile.write(reinterpret_cast<const char*>(&indexOffset), sizeof(indexOffset));
+    mFile.write(reinterpret_cast<const char*>(&keyframeCount), sizeof(keyframeCount));
+    mFile.write(reinterpret_cast<const char*>(&mTickCount), sizeof(mTickCount));
+    mFile.write(reinterpret_cast<const char*>(&kReplayMagic), sizeof(kReplayMagic));
+    mFile.close();
+
+    std::cout << "Replay saved: " << mPath << " (" << mTickCount << " ticks, "
+              << keyframeCount << " keyframes)" << std::endl;
+}
+
+void ReplayWriter::RecordTick(const LanderSnapshot& snapshot, float simulationTime, const ReplayTick& tick) {
+    if (!mFile.is_open()) {
+        return;
+    }
+
+    // Keyframe at fixed intervals, or when requested
+    if (mForceKeyframe || mTicksSinceKeyframe >= mKeyframeInterval) {
+        IndexEntry entry;
+        entry.tick = mTickCount;
+        entry.offset = static_cast<uint64_t>(mFile.tellp());
+        mIndex.push_back(entry);
+
+        mFile.put(static_cast<char>(kKeyframeTag));
+        mFile.write(reinterpret_cast<const char*>(&mTickCount), sizeof(mTickCount));
+        mFile.write(reinterpret_cast<const char*>(&simulationTime), sizeof(simulationTime));
+        mFile.put(static_cast<char>(mJumped ? kKeyframeAfterJump : 0));
+        mFile.write(reinterpret_cast<const char*>(&snapshot), sizeof(snapshot));
+
+        mTicksSinceKeyframe = 0;
+        mForceKeyframe = false;
+        mJumped = false;
+    }
+
+    mFile.put(static_cast<char>(kTickTag));
+    mFile.write(reinterpret_cast<const char*>(&tick.deltaTime), sizeof(tick.deltaTime));
+    mFile.put(static_cast<char>(tick.inputs));
+
+    mTickCount++;
+    mTicksSinceKeyframe++;
+}
+
+// ReplayReader implementation
+ReplayReader::ReplayReader()
+    : mData(nullptr)
+    , mSize(0)
+    , mHeader()
+    , mIndex(nullptr)
+    , mKeyframeCount(0)
+    , mTickCount(0)
+{
+}
+
+ReplayReader::~ReplayReader() {
+    Close();
+}
+
+bool ReplayReader::Open(const std::string& path) {
+    Close();
+
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open replay file: " << path << std::endl;
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        std::cerr << "Failed to read replay file size: " << path << std::endl;
+        close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map replay file: " << path << std::endl;
+        return false;
+    }
+
+    mData = static_cast<const uint8_t*>(mapping);
+    mSize = static_cast<size_t>(fileStat.st_size);
+#else
+    // No mmap: read the whole file instead
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open replay file: " << path << std::endl;
+        return false;
+    }
+
+    mFallbackData.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(mFallbackData.data()), mFallbackData.size());
+    mData = mFallbackData.data();
+    mSize = mFallbackData.size();
+#endif
+
+    // Validate header and footer
+    if (mSize < sizeof(ReplayHeader) + kFooterSize) {
+        std::cerr << "Replay file is truncated: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    std::memcpy(&mHeader, mData, sizeof(mHeader));
+    const uint8_t* footer = mData + mSize - kFooterSize;
+    uint64_t indexOffset = ReadValue<uint64_t>(footer);
+    uint64_t keyframeCount = ReadValue<uint64_t>(footer + sizeof(uint64_t));
+    uint64_t tickCount = ReadValue<uint64_t>(footer + 2 * sizeof(uint64_t));
+    uint32_t footerMagic = ReadValue<uint32_t>(footer + 3 * sizeof(uint64_t));
+
+    if (mHeader.magic != kReplayMagic || footerMagic != kReplayMagic ||
+        mHeader.version != kReplayVersion) {
+        std::cerr << "Not a replay file (or unfinished recording): " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    if (indexOffset + keyframeCount * kIndexEntrySize != mSize - kFooterSize ||
+        (keyframeCount == 0 && tickCount != 0)) {
+        std::cerr << "Replay index is corrupt: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    mIndex = mData + indexOffset;
+    mKeyframeCount = static_cast<size_t>(keyframeCount);
+    mTickCount = tickCount;
+    return true;
+}
+
+void ReplayReader::Close() {
+#ifndef _WIN32
+    if (mData && mFallbackData.empty()) {
+        munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+#endif
+
+    mFallbackData.clear();
+    mData = nullptr;
+    mSize = 0;
+    mIndex = nullptr;
+    mKeyframeCount = 0;
+    mTickCount = 0;
+}
+
+uint64_t ReplayReader::GetKeyframeTick(size_t index) const {
+    return ReadValue<uint64_t>(mIndex + index * kIndexEntrySize);
+}
+
+size_t ReplayReader::FindKeyframe(uint64_t tick) const {
+    // Last keyframe at or before the tick
+    size_t low = 0;
+    size_t high = mKeyframeCount;
+    while (high - low > 1) {
+        size_t mid = (low + high) / 2;
+        if (GetKeyframeTick(mid) <= tick) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+const uint8_t* ReplayReader::FindTickRecord(uint64_t tick) const {
+    if (!mData || tick >= mTickCount) {
+        return nullptr;
+    }
+
+    // Only tick records follow a keyframe until the next one, so the
+    // record sits at a fixed stride from its keyframe
+    size_t keyframe = FindKeyframe(tick);
+    uint64_t keyframeTick = GetKeyframeTick(keyframe);
+    uint64_t keyframeOffset = ReadValue<uint64_t>(mIndex + keyframe * kIndexEntrySize + sizeof(uint64_t));
+    uint64_t offset = keyframeOffset + kKeyframeRecordSize + (tick - keyframeTick) * kTickRecordSize;
+
+    if (offset + kTickRecordSize > mSize || mData[offset] != kTickTag) {
+        return nullptr;
+    }
+
+    return mData + offset;
+}
+
+bool ReplayReader::GetTick(uint64_t tick, ReplayTick& replayTick) const {
+    const uint8_t* record = FindTickRecord(tick);
+    if (!record) {
+        return false;
+    }
+
+    replayTick.deltaTime = ReadValue<float>(record + 1);
+    replayTick.inputs = record[1 + sizeof(float)];
+    return true;
+}
+
+bool ReplayReader::GetKeyframe(size_t index, ReplayKeyframe& keyframe) const {
+    if (index >= mKeyframeCount) {
+        return false;
+    }
+
+    uint64_t offset = ReadValue<uint64_t>(mIndex + index * kIndexEntrySize + sizeof(uint64_t));
+    if (offset + kKeyframeRecordSize > mSize || mData[offset] != kKeyframeTag) {
+        return false;
+    }
+
+    const uint8_t* record = mData + offset + 1 + sizeof(uint64_t);
+    keyframe.simulationTime = ReadValue<float>(record);
+    keyframe.afterJump = (record[sizeof(float)] & kKeyframeAfterJump) != 0;
+    std::memcpy(&keyframe.lander, record + sizeof(float) + 1, sizeof(keyframe.lander));
+    return true;
+}
+
+void ReplayReader::GenerateTerrain(Terrain* terrain) const {
+    if (!terrain) {
+        return;
+    }
+
+    srand(mHeader.terrainSeed);
+    if (mHeader.use3D) {
+        terrain->Generate3D(mHeader.worldWidth, mHeader.worldWidth, mHeader.worldHeight);
+    } else {
+        terrain->Generate2D(mHeader.worldWidth, mHeader.worldHeight);
+    }
+}
+
+bool ReplayReader::AttachWind(Physics* physics, WindField* field) const {
+    if (!physics || !field) {
+        return false;
+    }
+
+    physics->SetAirDensity(mHeader.airDensity);
+    physics->SetWindField(nullptr);
+    if (mHeader.airDensity > 0.0f) {
+        if (!field->Initialize(mHeader.wind)) {
+            return false;
+        }
+        physics->SetWindField(field);
+    }
+    return true;
+}
+
+bool ReplayReader::Seek(uint64_t tick, Lander* lander, Physics* physics, float* elapsedTime) const {
+    if (!mData || !lander || !physics || mKeyframeCount == 0 || tick > mTickCount) {
+        return false;
+    }
+
+    return Resimulate(FindKeyframe(tick), tick, lander, physics, elapsedTime);
+}
+
+size_t ReplayReader::VerifyKeyframes(Lander* lander, Physics* physics, float tolerance, float* maxError) const {
+    size_t mismatches = 0;
+    float largestError = 0.0f;
+
+    for (size_t index = 1; index < mKeyframeCount; index++) {
+        ReplayKeyframe expected;
+        if (!GetKeyframe(index, expected) || expected.afterJump) {
+            continue;
+        }
+
+        if (!Resimulate(index - 1, GetKeyframeTick(index), lander, physics, nullptr)) {
+            mismatches++;
+            continue;
+        }
+
+        // Largest difference of any state component
+        LanderSnapshot actual;
+        CaptureLanderSnapshot(lander, 0.0f, actual);
+        float error = std::abs(actual.rotation - expected.lander.rotation);
+        error = std::max(error, std::abs(actual.fuel - expected.lander.fuel));
+        for (int i = 0; i < 3; i++) {
+            error = std::max(error, std::abs(actual.position[i] - expected.lander.position[i]));
+            error = std::max(error, std::abs(actual.velocity[i] - expected.lander.velocity[i]));
+        }
+        largestError = std::max(largestError, error);
+
+        if (error > tolerance || actual.landed != expected.lander.landed ||
+            actual.crashed != expected.lander.crashed) {
+            mismatches++;
+        }
+    }
+
+    if (maxError) {
+        *maxError = largestError;
+    }
+    return mismatches;
+}
+
+bool ReplayReader::Resimulate(size_t keyframe, uint64_t tick, Lander* lander, Physics* physics,
+                              float* elapsedTime) const {
+    if (!mData || !lander || !physics) {
+        return false;
+    }
+
+    // Load the keyframe, including the time the wind is sampled at
+    ReplayKeyframe state;
+    if (!GetKeyframe(keyframe, state)) {
+        return false;
+    }
+    RestoreLanderSnapshot(lander, state.lander);
+    physics->SetSimulationTime(state.simulationTime);
+    float elapsed = state.lander.elapsedTime;
+
+    // Resimulate the ticks in between (recorded step lengths include any time warp)
+    float savedTimeScale = physics->GetTimeScale();
+    float savedGravity = physics->GetGravity();
+    physics->SetGravity(mHeader.gravity);
+    physics->SetTimeScale(1.0f);
+
+    for (uint64_t t = GetKeyframeTick(keyframe); t < tick; t++) {
+        ReplayTick replayTick;
+        if (!GetTick(t, replayTick)) {
+            physics->SetTimeScale(savedTimeScale);
+            physics->SetGravity(savedGravity);
+            return false;
+        }
+
+        ApplyPilotInputs(lander, replayTick.inputs);
+        physics->Update(replayTick.deltaTime);
+        elapsed += replayTick.deltaTime;
+    }
+
+    physics->SetTimeScale(savedTimeScale);
+    physics->SetGravity(savedGravity);
+
+    if (elapsedTime) {
+        *elapsedTime = elapsed;
+    }
+    return true;
+}
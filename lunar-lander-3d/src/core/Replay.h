@@ -0,0 +1,162 @@
+// Replay.h
+// Recorded flight container with a keyframe index for random access
+
+#pragma once
+
+#include "RewindBuffer.h"
+#include "WindField.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class Lander;
+class Physics;
+class Terrain;
+
+// Pilot input bits stored with every tick
+enum PilotInput : uint8_t {
+    INPUT_THRUST = 1 << 0,
+    INPUT_ROTATE_LEFT = 1 << 1,
+    INPUT_ROTATE_RIGHT = 1 << 2
+};
+
+// Apply one tick of pilot input to the lander (shared by the game and replays
+// so that resimulated ticks match the recorded flight)
+void ApplyPilotInputs(Lander* lander, uint8_t inputs);
+
+// Degrees a rotate input turns the lander per tick
+float GetPilotRotationStep();
+
+// Everything needed to rebuild the world a replay was recorded in
+struct ReplayHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t terrainSeed;   // srand() seed used for terrain generation
+    uint32_t keyframeInterval;
+    int32_t worldWidth;
+    int32_t worldHeight;
+    float gravity;
+    uint8_t use3D;
+    float airDensity;       // Zero is vacuum, where the wind is not felt
+    WindParameters wind;    // Including the seed of its noise volume
+};
+
+// Input and simulated step length of one recorded tick
+struct ReplayTick {
+    float deltaTime;  // Simulated seconds (time warp already applied)
+    uint8_t inputs;   // PilotInput bits
+};
+
+// State stored at a keyframe
+struct ReplayKeyframe {
+    LanderSnapshot lander;
+    float simulationTime;  // Physics time, which the wind field is sampled at
+    bool afterJump;        // Set rather than simulated (e.g. resuming from a rewind)
+};
+
+// File layout:
+//   ReplayHeader
+//   records: 'K' tick simulationTime flags snapshot (keyframe) or
+//            'T' deltaTime inputs (tick)
+//   index:   (tick, file offset) for every keyframe
+//   footer:  index offset, keyframe count, tick count, magic
+// A keyframe holds the state at the start of its tick and is followed only
+// by tick records until the next keyframe.
+class ReplayWriter {
+public:
+    static const uint32_t kDefaultKeyframeInterval = 256;
+
+    ReplayWriter();
+    ~ReplayWriter();
+
+    bool Open(const std::string& path, const ReplayHeader& header);
+    void Close();
+    bool IsOpen() const { return mFile.is_open(); }
+
+    // Record one tick; snapshot is the state before the tick's inputs are
+    // applied and simulationTime the physics time at that point
+    void RecordTick(const LanderSnapshot& snapshot, float simulationTime, const ReplayTick& tick);
+
+    // Write a keyframe on the next tick because the state jumped
+    void ForceKeyframe() { mForceKeyframe = true; mJumped = true; }
+
+    uint64_t GetTickCount() const { return mTickCount; }
+
+private:
+    struct IndexEntry {
+        uint64_t tick;
+        uint64_t offset;
+    };
+
+    std::ofstream mFile;
+    std::string mPath;
+    uint32_t mKeyframeInterval;
+    uint64_t mTickCount;
+    uint64_t mTicksSinceKeyframe;
+    bool mForceKeyframe;
+    bool mJumped;
+    std::vector<IndexEntry> mIndex;
+};
+
+// Memory-maps a replay and seeks by loading the nearest keyframe and
+// resimulating at most one keyframe interval of ticks. Readers are
+// read-only, so several threads can share one and split it by keyframe.
+class ReplayReader {
+public:
+    ReplayReader();
+    ~ReplayReader();
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return mData != nullptr; }
+
+    const ReplayHeader& GetHeader() const { return mHeader; }
+    uint64_t GetTickCount() const { return mTickCount; }
+
+    // Keyframe index access
+    size_t GetKeyframeCount() const { return mKeyframeCount; }
+    uint64_t GetKeyframeTick(size_t index) const;
+    size_t FindKeyframe(uint64_t tick) const;
+
+    // Raw record access
+    bool GetTick(uint64_t tick, ReplayTick& replayTick) const;
+    bool GetKeyframe(size_t index, ReplayKeyframe& keyframe) const;
+
+    // Rebuild the recorded terrain. Uses the global rand() state, so
+    // parallel jobs should generate once and copy the Terrain.
+    void GenerateTerrain(Terrain* terrain) const;
+
+    // Give the physics system the recorded atmosphere, building the recorded
+    // wind into field (which must outlive its use by physics)
+    bool AttachWind(Physics* physics, WindField* field) const;
+
+    // Put the lander in its state at the start of the given tick. The
+    // physics system must already have the lander and terrain registered,
+    // and the wind attached.
+    bool Seek(uint64_t tick, Lander* lander, Physics* physics, float* elapsedTime = nullptr) const;
+
+    // Resimulate from every keyframe to the next one and compare with the
+    // recorded state. Returns the number of keyframes that differ by more
+    // than tolerance; keyframes written after a jump are not checked.
+    size_t VerifyKeyframes(Lander* lander, Physics* physics, float tolerance, float* maxError = nullptr) const;
+
+private:
+    const uint8_t* FindTickRecord(uint64_t tick) const;
+
+    // Load a keyframe and simulate the recorded ticks up to the given one
+    // with the recorded gravity; the physics settings are restored after
+    bool Resimulate(size_t keyframe, uint64_t tick, Lander* lander, Physics* physics, float* elapsedTime) const;
+
+    // Mapped file
+    const uint8_t* mData;
+    size_t mSize;
+    std::vector<uint8_t> mFallbackData;  // Used where mmap isn't available
+
+    // Parsed header, index and footer
+    ReplayHeader mHeader;
+    const uint8_t* mIndex;
+    size_t mKeyframeCount;
+    uint64_t mTickCount;
+};
@@ -0,0 +1,258 @@
+// RewindBuffer.cpp
+// Implementation of the rewind ring buffer
+
+#include "RewindBuffer.h"
+#include "Entity.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+constexpr size_t RewindBuffer::kDefaultMemoryBudget;
+constexpr float RewindBuffer::kDefaultDuration;
+constexpr float RewindBuffer::kTickInterval;
+
+// Quantization steps (values are stored as multiples of 1/scale)
+static const float kPositionScale = 64.0f;
+static const float kVelocityScale = 256.0f;
+static const float kFuelScale = 16.0f;
+static const float kTimeScale = 1000.0f;
+static const float kRotationScale = 65536.0f / 360.0f;
+
+// Snapshot flag bits
+static const uint8_t kFlagLanded = 1 << 0;
+static const uint8_t kFlagCrashed = 1 << 1;
+
+void CaptureLanderSnapshot(const Lander* lander, float elapsedTime, LanderSnapshot& snapshot) {
+    const float* position = lander->GetPosition();
+    const float* velocity = lander->GetVelocity();
+
+    for (int i = 0; i < 3; i++) {
+        snapshot.position[i] = position[i];
+        snapshot.velocity[i] = velocity[i];
+    }
+
+    snapshot.rotation = lander->GetRotation()[2];
+    snapshot.fuel = lander->GetFuel();
+    snapshot.elapsedTime = elapsedTime;
+    snapshot.landed = lander->IsLanded();
+    snapshot.crashed = lander->IsCrashed();
+}
+
+void RestoreLanderSnapshot(Lander* lander, const LanderSnapshot& snapshot) {
+    lander->SetPosition(snapshot.position[0], snapshot.position[1], snapshot.position[2]);
+    lander->SetRotation(0.0f, 0.0f, snapshot.rotation);
+
+    float* velocity = lander->GetVelocity();
+    for (int i = 0; i < 3; i++) {
+        velocity[i] = snapshot.velocity[i];
+    }
+
+    lander->SetFuel(snapshot.fuel);
+    lander->SetLanded(snapshot.landed);
+    lander->SetCrashed(snapshot.crashed);
+    lander->ApplyThrust(0.0f);
+}
+
+RewindBuffer::RewindBuffer(size_t memoryBudget, float duration)
+    : mFirstBlock(0)
+    , mBlockCount(0)
+    , mOldestTick(0)
+    , mNextTick(0)
+    , mLastState()
+{
+    // Enough blocks to cover the requested duration, capped by the budget
+    size_t budgetBlocks = memoryBudget / sizeof(Block);
+    size_t durationBlocks = static_cast<size_t>(
+        std::ceil(duration / kTickInterval / kBlockTicks)) + 1;
+
+    mBlocks.resize(std::max<size_t>(1, std::min(budgetBlocks, durationBlocks)));
+}
+
+void RewindBuffer::Clear() {
+    mFirstBlock = 0;
+    mBlockCount = 0;
+    mOldestTick = 0;
+    mNextTick = 0;
+}
+
+void RewindBuffer::Record(const LanderSnapshot& snapshot) {
+    KeyState state;
+    Quantize(snapshot, state);
+
+    // Append to the current block while the delta fits
+    if (mBlockCount > 0) {
+        Block& block = BlockAt(mBlockCount - 1);
+        DeltaState delta;
+
+        if (block.count < kBlockTicks && MakeDelta(mLastState, state, delta)) {
+            block.deltas[block.count - 1] = delta;
+            block.count++;
+
+            mLastState = state;
+            mNextTick++;
+            return;
+        }
+    }
+
+    // Block is full or the change is too large for a delta: new keyframe
+    StartBlock(state);
+}
+
+bool RewindBuffer::GetTick(size_t index, LanderSnapshot& snapshot) const {
+    if (index >= GetTickCount()) {
+        return false;
+    }
+
+    uint64_t tick = mOldestTick + index;
+
+    // Find the last block starting at or before the tick (blocks are in tick order)
+    size_t low = 0;
+    size_t high = mBlockCount;
+    while (high - low > 1) {
+        size_t mid = (low + high) / 2;
+        if (BlockAt(mid).firstTick <= tick) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    // Decode from the keyframe forward
+    const Block& block = BlockAt(low);
+    KeyState state = block.key;
+    int deltaCount = static_cast<int>(tick - block.firstTick);
+    for (int i = 0; i < deltaCount; i++) {
+        ApplyDelta(state, block.deltas[i]);
+    }
+
+    Dequantize(state, snapshot);
+    return true;
+}
+
+void RewindBuffer::Truncate(size_t tickCount) {
+    if (tickCount >= GetTickCount()) {
+        return;
+    }
+
+    if (tickCount == 0) {
+        Clear();
+        return;
+    }
+
+    uint64_t endTick = mOldestTick + tickCount;
+
+    // Drop whole blocks past the new end
+    while (mBlockCount > 1 && BlockAt(mBlockCount - 1).firstTick >= endTick) {
+        mBlockCount--;
+    }
+
+    // Shorten the block that now holds the newest tick
+    Block& block = BlockAt(mBlockCount - 1);
+    block.count = static_cast<int>(endTick - block.firstTick);
+    mNextTick = endTick;
+
+    // Rebuild the delta base from the new newest tick
+    mLastState = block.key;
+    for (int i = 0; i < block.count - 1; i++) {
+        ApplyDelta(mLastState, block.deltas[i]);
+    }
+}
+
+void RewindBuffer::StartBlock(const KeyState& key) {
+    // Evict the oldest block when the ring is full
+    if (mBlockCount == mBlocks.size()) {
+        mOldestTick += BlockAt(0).count;
+        mFirstBlock = (mFirstBlock + 1) % mBlocks.size();
+        mBlockCount--;
+    }
+
+    if (mBlockCount == 0) {
+        mOldestTick = mNextTick;
+    }
+
+    Block& block = BlockAt(mBlockCount);
+    block.firstTick = mNextTick;
+    block.count = 1;
+    block.key = key;
+    mBlockCount++;
+
+    mLastState = key;
+    mNextTick++;
+}
+
+void RewindBuffer::Quantize(const LanderSnapshot& snapshot, KeyState& state) {
+    for (int i = 0; i < 3; i++) {
+        state.position[i] = static_cast<int32_t>(std::lround(snapshot.position[i] * kPositionScale));
+        state.velocity[i] = static_cast<int32_t>(std::lround(snapshot.velocity[i] * kVelocityScale));
+    }
+
+    state.fuel = static_cast<int32_t>(std::lround(snapshot.fuel * kFuelScale));
+    state.timeMs = static_cast<int32_t>(std::lround(snapshot.elapsedTime * kTimeScale));
+
+    // Angles wrap, so keep only the low 16 bits of the quantized value
+    long rotation = std::lround(snapshot.rotation * kRotationScale);
+    state.rotation = static_cast<uint16_t>(rotation & 0xFFFF);
+
+    state.flags = (snapshot.landed ? kFlagLanded : 0) | (snapshot.crashed ? kFlagCrashed : 0);
+}
+
+void RewindBuffer::Dequantize(const KeyState& state, LanderSnapshot& snapshot) {
+    for (int i = 0; i < 3; i++) {
+        snapshot.position[i] = state.position[i] / kPositionScale;
+        snapshot.velocity[i] = state.velocity[i] / kVelocityScale;
+    }
+
+    snapshot.fuel = state.fuel / kFuelScale;
+    snapshot.elapsedTime = state.timeMs / kTimeScale;
+    snapshot.rotation = state.rotation / kRotationScale;
+    snapshot.landed = (state.flags & kFlagLanded) != 0;
+    snapshot.crashed = (state.flags & kFlagCrashed) != 0;
+}
+
+// Store a signed difference in 16 bits, failing if it doesn't fit
+static bool FitDelta(int32_t from, int32_t to, int16_t& delta) {
+    int64_t difference = static_cast<int64_t>(to) - from;
+    if (difference < std::numeric_limits<int16_t>::min() ||
+        difference > std::numeric_limits<int16_t>::max()) {
+        return false;
+    }
+
+    delta = static_cast<int16_t>(difference);
+    return true;
+}
+
+bool RewindBuffer::MakeDelta(const KeyState& from, const KeyState& to, DeltaState& delta) {
+    for (int i = 0; i < 3; i++) {
+        if (!FitDelta(from.position[i], to.position[i], delta.position[i]) ||
+            !FitDelta(from.velocity[i], to.velocity[i], delta.velocity[i])) {
+            return false;
+        }
+    }
+
+    if (!FitDelta(from.fuel, to.fuel, delta.fuel)) {
+        return false;
+    }
+
+    // Time only moves forward
+    int32_t timeDelta = to.timeMs - from.timeMs;
+    if (timeDelta < 0 || timeDelta > std::numeric_limits<uint16_t>::max()) {
+        return false;
+    }
+    delta.timeMs = static_cast<uint16_t>(timeDelta);
+
+    delta.rotation = static_cast<uint16_t>(to.rotation - from.rotation);
+    delta.flags = to.flags;
+    return true;
+}
+
+void RewindBuffer::ApplyDelta(KeyState& state, const DeltaState& delta) {
+    for (int i = 0; i < 3; i++) {
+        state.position[i] += delta.position[i];
+        state.velocity[i] += delta.velocity[i];
+    }
+
+    state.fuel += delta.fuel;
+    state.timeMs += delta.timeMs;
+    state.rotation = static_cast<uint16_t>(state.rotation + delta.rotation);
+    state.flags = delta.flags;
+}
@@ -0,0 +1,107 @@
+// RewindBuffer.h
+// Fixed-budget ring of compact lander states for rewinding a flight
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Lander;
+
+// Full-precision lander state, as captured from and restored to the game
+struct LanderSnapshot {
+    float position[3];
+    float velocity[3];
+    float rotation;     // Z rotation in degrees
+    float fuel;
+    float elapsedTime;  // Simulated seconds since the flight started
+    bool landed;
+    bool crashed;
+};
+
+// Copy lander state into a snapshot and back
+void CaptureLanderSnapshot(const Lander* lander, float elapsedTime, LanderSnapshot& snapshot);
+void RestoreLanderSnapshot(Lander* lander, const LanderSnapshot& snapshot);
+
+// Stores the last few minutes of flight as quantized, delta-encoded ticks.
+// Ticks are grouped into blocks that start with a keyframe, and the blocks
+// live in a ring that is allocated once, so memory use never grows.
+class RewindBuffer {
+public:
+    static constexpr size_t kDefaultMemoryBudget = 4 * 1024 * 1024; // bytes
+    static constexpr float kDefaultDuration = 10.0f * 60.0f;        // seconds
+    static constexpr float kTickInterval = 1.0f / 60.0f;            // seconds
+
+    RewindBuffer(size_t memoryBudget = kDefaultMemoryBudget, float duration = kDefaultDuration);
+    ~RewindBuffer() = default;
+
+    // Drop all recorded ticks
+    void Clear();
+
+    // Append a tick, evicting the oldest block when the ring is full
+    void Record(const LanderSnapshot& snapshot);
+
+    // Decode a tick; 0 is the oldest tick still in the buffer
+    bool GetTick(size_t index, LanderSnapshot& snapshot) const;
+
+    // Discard every tick after the first tickCount ticks
+    void Truncate(size_t tickCount);
+
+    // Buffer statistics
+    size_t GetTickCount() const { return static_cast<size_t>(mNextTick - mOldestTick); }
+    size_t GetMemoryUsage() const { return mBlocks.size() * sizeof(Block); }
+
+private:
+    static const int kBlockTicks = 64;
+
+    // Quantized full state stored at the start of each block
+    struct KeyState {
+        int32_t position[3];  // 1/64 unit
+        int32_t velocity[3];  // 1/256 unit per second
+        int32_t fuel;         // 1/16 unit
+        int32_t timeMs;       // Elapsed simulated milliseconds
+        uint16_t rotation;    // 1/65536 of a turn
+        uint8_t flags;
+    };
+
+    // Difference from the previous tick in the same quantized units
+    struct DeltaState {
+        int16_t position[3];
+        int16_t velocity[3];
+        int16_t fuel;
+        uint16_t timeMs;
+        uint16_t rotation;    // Wraps around together with the angle
+        uint8_t flags;
+    };
+
+    struct Block {
+        uint64_t firstTick;   // Absolute tick number of the keyframe
+        int count;            // Ticks stored in this block, keyframe included
+        KeyState key;
+        DeltaState deltas[kBlockTicks - 1];
+    };
+
+    // Quantization helpers
+    static void Quantize(const LanderSnapshot& snapshot, KeyState& state);
+    static void Dequantize(const KeyState& state, LanderSnapshot& snapshot);
+    static bool MakeDelta(const KeyState& from, const KeyState& to, DeltaState& delta);
+    static void ApplyDelta(KeyState& state, const DeltaState& delta);
+
+    // Ring access
+    Block& BlockAt(size_t ringIndex) { return mBlocks[(mFirstBlock + ringIndex) % mBlocks.size()]; }
+    const Block& BlockAt(size_t ringIndex) const { return mBlocks[(mFirstBlock + ringIndex) % mBlocks.size()]; }
+    void StartBlock(const KeyState& key);
+
+    // Block storage, allocated once from the memory budget
+    std::vector<Block> mBlocks;
+    size_t mFirstBlock;
+    size_t mBlockCount;
+
+    // Absolute tick numbers of the oldest stored and the next recorded tick
+    uint64_t mOldestTick;
+    uint64_t mNextTick;
+
+    // Quantized state of the newest tick, used to encode the next delta
+    KeyState mLastState;
+};
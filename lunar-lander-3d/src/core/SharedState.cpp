@@ -0,0 +1,279 @@
+// SharedState.cpp
+// Implementation of the shared-memory state segment and its seqlocks
+
+#include "SharedState.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+static const uint32_t kSharedStateMagic = 0x53534C4C; // "LLSS"
+static const uint32_t kSharedStateVersion = 1;
+
+// Reads retried while the writer is mid-publication; a write takes tens of
+// nanoseconds, so running out means the writer is stuck or gone
+static const int kMaxReadAttempts = 1000;
+static const int kReadSpinsBeforeYield = 64;
+
+static std::string GetSegmentName(const std::string& name) {
+    return name.empty() || name[0] == '/' ? name : "/" + name;
+}
+
+static void WriteSeqlocked(std::atomic<uint32_t>& sequence, std::atomic<uint64_t>* words,
+                           const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const size_t wordCount = (size + 7) / 8;
+
+    // Odd while writing. The fence keeps the word stores after it.
+    uint32_t start = sequence.load(std::memory_order_relaxed) + 1;
+    sequence.store(start, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < wordCount; i++) {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + i * 8, std::min<size_t>(8, size - i * 8));
+        words[i].store(word, std::memory_order_relaxed);
+    }
+
+    sequence.store(start + 1, std::memory_order_release);
+}
+
+static bool ReadSeqlocked(const std::atomic<uint32_t>& sequence, const std::atomic<uint64_t>* words,
+                          void* data, size_t size) {
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    const size_t wordCount = (size + 7) / 8;
+
+    for (int attempt = 0; attempt < kMaxReadAttempts; attempt++) {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            for (size_t i = 0; i < wordCount; i++) {
+                uint64_t word = words[i].load(std::memory_order_relaxed);
+                std::memcpy(bytes + i * 8, &word, std::min<size_t>(8, size - i * 8));
+            }
+
+            // The fence keeps the word loads before the second sequence load
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+
+        // The writer may have been descheduled mid-write
+        if (attempt >= kReadSpinsBeforeYield) {
+            std::this_thread::yield();
+        }
+    }
+    return false;
+}
+
+SharedStateWriter::SharedStateWriter()
+    : mSegment(nullptr)
+    , mTick(0)
+{
+}
+
+SharedStateWriter::~SharedStateWriter() {
+    Close();
+}
+
+bool SharedStateWriter::Open(const std::string& name) {
+    Close();
+
+#ifndef _WIN32
+    // Atomics that fall back to a lock would not work across processes
+    std::atomic<uint64_t> probe(0);
+    if (!probe.is_lock_free()) {
+        std::cerr << "Shared state export needs lock-free 64-bit atomics" << std::endl;
+        return false;
+    }
+
+    mName = GetSegmentName(name);
+    int fd = shm_open(mName.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to create shared memory " << mName << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // A segment left behind by an earlier run is reused
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, sizeof(SharedStateSegment)) == 0) {
+        mapping = mmap(nullptr, sizeof(SharedStateSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << mName << ": " << std::strerror(errno) << std::endl;
+        shm_unlink(mName.c_str());
+        return false;
+    }
+
+    // Zeroed blocks at sequence 0 read as "nothing published yet"
+    mSegment = new (mapping) SharedStateSegment();
+    mSegment->magic = kSharedStateMagic;
+    mSegment->version = kSharedStateVersion;
+    mSegment->size = sizeof(SharedStateSegment);
+    mTick = 0;
+    return true;
+#else
+    std::cerr << "Shared state export needs POSIX shared memory" << std::endl;
+    return false;
+#endif
+}
+
+void SharedStateWriter::Close() {
+#ifndef _WIN32
+    if (mSegment) {
+        munmap(mSegment, sizeof(SharedStateSegment));
+        shm_unlink(mName.c_str());
+    }
+#endif
+    mSegment = nullptr;
+}
+
+void SharedStateWriter::PublishLander(SharedLanderState& state) {
+    if (!mSegment) {
+        return;
+    }
+    state.tick = ++mTick;
+    WriteSeqlocked(mSegment->landerSequence, mSegment->landerWords, &state, sizeof(state));
+}
+
+void SharedStateWriter::PublishTerrain(const SharedTerrainInfo& info) {
+    if (!mSegment) {
+        return;
+    }
+    WriteSeqlocked(mSegment->terrainSequence, mSegment->terrainWords, &info, sizeof(info));
+}
+
+void SharedStateWriter::DescribeTerrain(const Terrain& terrain, uint32_t seed, bool is3D, SharedTerrainInfo& info) {
+    std::memset(&info, 0, sizeof(info));
+    info.generation = terrain.GetGeneration();
+    info.seed = seed;
+    info.is3D = is3D ? 1 : 0;
+    info.width = static_cast<float>(terrain.GetWidth());
+    info.height = static_cast<float>(terrain.GetHeight());
+    info.length = static_cast<float>(terrain.GetLength());
+
+    if (!is3D) {
+        // Runs of consecutive pad segments
+        bool inPad = false;
+        for (const TerrainSegment& segment : terrain.GetSegments2D()) {
+            if (!segment.isLandingPad) {
+                inPad = false;
+                continue;
+            }
+            if (inPad) {
+                info.pads[info.padCount - 1].maxX = segment.x2;
+                continue;
+            }
+            if (info.padCount == SharedTerrainInfo::kMaxPads) {
+                break;
+            }
+            SharedLandingPad& pad = info.pads[info.padCount++];
+            pad.minX = segment.x1;
+            pad.maxX = segment.x2;
+            pad.height = segment.y1;
+            inPad = true;
+        }
+        return;
+    }
+
+    // The 3D terrain has a single pad area; report its bounds
+    SharedLandingPad pad = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    bool found = false;
+    for (const TerrainTriangle& triangle : terrain.GetTriangles3D()) {
+        if (!triangle.isLandingPad) {
+            continue;
+        }
+        for (int v = 0; v < 3; v++) {
+            const float* vertex = &triangle.vertices[v * 3];
+            if (!found) {
+                pad.minX = pad.maxX = vertex[0];
+                pad.minZ = pad.maxZ = vertex[2];
+                pad.height = vertex[1];
+                found = true;
+            }
+            pad.minX = std::min(pad.minX, vertex[0]);
+            pad.maxX = std::max(pad.maxX, vertex[0]);
+            pad.minZ = std::min(pad.minZ, vertex[2]);
+            pad.maxZ = std::max(pad.maxZ, vertex[2]);
+        }
+    }
+    if (found) {
+        info.pads[0] = pad;
+        info.padCount = 1;
+    }
+}
+
+SharedStateReader::SharedStateReader()
+    : mSegment(nullptr)
+{
+}
+
+SharedStateReader::~SharedStateReader() {
+    Close();
+}
+
+bool SharedStateReader::Open(const std::string& name) {
+    Close();
+
+#ifndef _WIN32
+    std::string segmentName = GetSegmentName(name);
+    int fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to open shared memory " << segmentName << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat segmentStat;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &segmentStat) == 0 && segmentStat.st_size >= static_cast<off_t>(sizeof(SharedStateSegment))) {
+        mapping = mmap(nullptr, sizeof(SharedStateSegment), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Shared memory " << segmentName << " is not a state segment" << std::endl;
+        return false;
+    }
+
+    const SharedStateSegment* segment = static_cast<const SharedStateSegment*>(mapping);
+    if (segment->magic != kSharedStateMagic || segment->version != kSharedStateVersion ||
+        segment->size != sizeof(SharedStateSegment)) {
+        std::cerr << "Shared memory " << segmentName << " has an unknown layout" << std::endl;
+        munmap(mapping, sizeof(SharedStateSegment));
+        return false;
+    }
+    mSegment = segment;
+    return true;
+#else
+    (void)name;
+    std::cerr << "Shared state export needs POSIX shared memory" << std::endl;
+    return false;
+#endif
+}
+
+void SharedStateReader::Close() {
+#ifndef _WIN32
+    if (mSegment) {
+        munmap(const_cast<SharedStateSegment*>(mSegment), sizeof(SharedStateSegment));
+    }
+#endif
+    mSegment = nullptr;
+}
+
+bool SharedStateReader::ReadLander(SharedLanderState& state) const {
+    return mSegment && ReadSeqlocked(mSegment->landerSequence, mSegment->landerWords, &state, sizeof(state));
+}
+
+bool SharedStateReader::ReadTerrain(SharedTerrainInfo& info) const {
+    return mSegment && ReadSeqlocked(mSegment->terrainSequence, mSegment->terrainWords, &info, sizeof(info));
+}
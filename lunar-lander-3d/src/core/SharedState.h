@@ -0,0 +1,126 @@
+// SharedState.h
+// Live lander, game and terrain state in POSIX shared memory for external tools
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Terrain;
+
+// Status bits of SharedLanderState::flags
+enum SharedStateFlag : uint32_t {
+    SHARED_LANDED = 1 << 0,
+    SHARED_CRASHED = 1 << 1,
+    SHARED_THRUSTING = 1 << 2,
+    SHARED_REWINDING = 1 << 3,
+    SHARED_3D = 1 << 4
+};
+
+// Published every game tick
+struct SharedLanderState {
+    uint64_t tick;               // Publications so far; 0 before the first
+    float position[3];
+    float velocity[3];
+    float rotation[3];           // Degrees
+    float fuel;
+    float maxFuel;
+    float thrustLevel;           // 0..1
+    float score;
+    float elapsedTime;           // Seconds of flight
+    float fuelUsed;
+    float timeWarp;
+    uint32_t gameState;          // GameState
+    uint32_t flags;              // SharedStateFlag bits
+    uint32_t terrainGeneration;  // Matches SharedTerrainInfo::generation
+};
+
+// A flat landing zone; minZ and maxZ are 0 in 2D
+struct SharedLandingPad {
+    float minX;
+    float maxX;
+    float minZ;
+    float maxZ;
+    float height;
+};
+
+// Published whenever the terrain is regenerated
+struct SharedTerrainInfo {
+    static const int kMaxPads = 8;
+
+    uint32_t generation;
+    uint32_t seed;               // srand() seed the terrain was generated from
+    uint32_t is3D;
+    uint32_t padCount;
+    float width;
+    float height;
+    float length;                // 3D only
+    SharedLandingPad pads[kMaxPads];
+};
+
+// The segment. Each block is guarded by its own seqlock: the writer makes
+// the sequence odd, writes the words, then makes it even again. A reader
+// (in any language) reads the sequence, skips if it is odd, copies the
+// words, and keeps the copy only if the sequence is still the same.
+// Readers never block the writer and may poll at any rate.
+struct SharedStateSegment {
+    static const int kLanderWords = (sizeof(SharedLanderState) + 7) / 8;
+    static const int kTerrainWords = (sizeof(SharedTerrainInfo) + 7) / 8;
+
+    uint32_t magic;    // "LLSS"
+    uint32_t version;
+    uint32_t size;     // sizeof(SharedStateSegment)
+    uint32_t reserved;
+
+    // On their own cache lines, away from each other's writes
+    alignas(64) std::atomic<uint32_t> landerSequence;
+    std::atomic<uint64_t> landerWords[kLanderWords];
+
+    alignas(64) std::atomic<uint32_t> terrainSequence;
+    std::atomic<uint64_t> terrainWords[kTerrainWords];
+};
+
+// Creates the segment (e.g. /dev/shm/lunar-lander) and publishes into it.
+// There should be one writer per segment; it is removed on Close().
+class SharedStateWriter {
+public:
+    SharedStateWriter();
+    ~SharedStateWriter();
+
+    // A leading '/' is added to the name if missing
+    bool Open(const std::string& name);
+    void Close();
+    bool IsOpen() const { return mSegment != nullptr; }
+
+    // Fills in state.tick
+    void PublishLander(SharedLanderState& state);
+    void PublishTerrain(const SharedTerrainInfo& info);
+
+    // Terrain metadata, with the landing pads merged into zones
+    static void DescribeTerrain(const Terrain& terrain, uint32_t seed, bool is3D, SharedTerrainInfo& info);
+
+private:
+    SharedStateSegment* mSegment;
+    std::string mName;
+    uint64_t mTick;
+};
+
+// Maps a segment read-only and takes consistent snapshots of it
+class SharedStateReader {
+public:
+    SharedStateReader();
+    ~SharedStateReader();
+
+    bool Open(const std::string& name);
+    void Close();
+    bool IsOpen() const { return mSegment != nullptr; }
+
+    // False only when every attempt overlapped a write
+    bool ReadLander(SharedLanderState& state) const;
+    bool ReadTerrain(SharedTerrainInfo& info) const;
+
+private:
+    const SharedStateSegment* mSegment;
+};
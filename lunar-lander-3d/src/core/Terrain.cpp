@@ -8,11 +8,39 @@
 #include <iostream>
 #include <algorithm>
 
+// 2D level of detail: tolerance of the first simplified level, and the
+// limits on how many levels are built
+static const float kLodBaseTolerance2D = 0.5f;
+static const int kLodMaxLevels2D = 12;
+static const size_t kLodMinSegments2D = 32;
+
+// 3D detail: crater radii as fractions of the terrain width, crater shape as
+// fractions of the radius, and surface roughness (world units, detail cells)
+static const float kCraterMinRadius3D = 0.006f;
+static const float kCraterMaxRadius3D = 0.05f;
+static const float kCraterDepth3D = 0.25f;
+static const float kCraterRimHeight3D = 0.06f;
+static const float kCraterRimWidth3D = 0.6f;
+static const float kRoughness3D = 0.4f;
+static const int kRoughnessPeriod3D = 4;
+
+// Value noise lattice point in -1..1
+static float LatticeNoise(int x, int z, unsigned int seed) {
+    unsigned int hash = static_cast<unsigned int>(x) * 73856093u ^ static_cast<unsigned int>(z) * 19349663u ^ seed;
+    hash ^= hash >> 13;
+    hash *= 0x5bd1e995u;
+    hash ^= hash >> 15;
+    return (hash & 0xFFFF) / 32767.5f - 1.0f;
+}
+
 Terrain::Terrain()
     : Entity()
+    , mGridSize(0)
     , mWidth(800)
     , mHeight(600)
     , mLength(800) // For 3D
+    , mGeneration(0)
+    , mVerbose(true)
 {
     mName = "Terrain";
 }
@@ -29,84 +57,246 @@ void Terrain::Render(Renderer* renderer) {
 void Terrain::Generate2D(int width, int height) {
     mWidth = width;
     mHeight = height;
+    mGeneration++;
     
     // Clear any existing terrain
     mSegments2D.clear();
+    mDetailHeights.clear();
+    mCraters3D.clear();
     
     // Create a baseline terrain height
-    int baseHeight = height - 50;
+    const float baseHeight = height - 50.0f;
     
-    // Create segments for the terrain with some randomness
-    const int segmentCount = 10;
-    const int segmentWidth = width / segmentCount;
+    // Dense, continuous polyline: one point every few world units
+    const int segmentCount = std::max(10, width / kSegmentWidth2D);
+    const float segmentWidth = (float)width / segmentCount;
+    
+    // Random walk for the point heights, kept inside the lower part of the world
+    std::vector<float> heights(segmentCount + 1);
+    float terrainHeight = baseHeight;
+    for (int i = 0; i <= segmentCount; i++) {
+        terrainHeight += (rand() % 17) - 8;
+        terrainHeight = std::max(height - 250.0f, std::min(height - 20.0f, terrainHeight));
+        heights[i] = terrainHeight;
+    }
+    
+    // Landing pads: one centered under the lander's start, plus a few spread
+    // over the rest of the world
+    std::vector<bool> padPoints(segmentCount + 1, false);
+    auto flattenPad = [&](float startX, float padWidth, float padHeight) {
+        int first = std::max(0, (int)std::lround(startX / segmentWidth));
+        int last = std::min(segmentCount, (int)std::lround((startX + padWidth) / segmentWidth));
+        for (int i = first; i <= last; i++) {
+            heights[i] = padHeight;
+            padPoints[i] = true;
+        }
+        
+        if (mVerbose) {
+            std::cout << "LANDING PAD created at x=" << first * segmentWidth
+                      << " to " << last * segmentWidth << std::endl;
+        }
+    };
+    
+    const float centerPadWidth = 160.0f;
+    flattenPad(width / 2 - centerPadWidth / 2, centerPadWidth, baseHeight);
+    
+    const float extraPadWidth = 120.0f;
+    const int regionCount = kExtraLandingPads2D + 1;
+    for (int pad = 0; pad < kExtraLandingPads2D; pad++) {
+        // Pick a spot in this pad's share of the world, skipping the center
+        int region = pad < regionCount / 2 ? pad : pad + 1;
+        float regionStart = (float)width * region / regionCount;
+        float regionWidth = (float)width / regionCount - extraPadWidth;
+        if (regionWidth <= 0.0f) {
+            break;
+        }
+        
+        float startX = regionStart + (rand() % std::max(1, (int)regionWidth));
+        int startPoint = std::min(segmentCount, (int)(startX / segmentWidth));
+        flattenPad(startX, extraPadWidth, heights[startPoint]);
+    }
     
+    // Build the segments (sorted by x, each starting where the previous ends)
+    mSegments2D.reserve(segmentCount);
     for (int i = 0; i < segmentCount; i++) {
         TerrainSegment segment;
         segment.x1 = i * segmentWidth;
-        segment.y1 = baseHeight - (rand() % 20);
+        segment.y1 = heights[i];
         segment.x2 = (i + 1) * segmentWidth;
-        segment.y2 = baseHeight - (rand() % 20);
-        segment.isLandingPad = false;
+        segment.y2 = heights[i + 1];
+        segment.isLandingPad = padPoints[i] && padPoints[i + 1];
         mSegments2D.push_back(segment);
     }
     
-    // Create a landing pad
-    // IMPORTANT FIX: Create landing pad at the center of the screen
-    // This ensures it's directly beneath the lander's starting position
-    int centerX = width / 2;
-    int landingPadWidth = segmentWidth * 2;  // Make landing pad 2 segments wide
-
-    // Calculate landing pad start position to be perfectly centered
-    int landingPadStart = centerX - (landingPadWidth / 2);
-
-     // Find which segments the landing pad overlaps with
-     int startSegment = landingPadStart / segmentWidth;
-     int endSegment = (landingPadStart + landingPadWidth) / segmentWidth;
+    BuildLod2D();
+}
 
-    // Mark all segments in range as landing pad
-    for (int i = startSegment; i <= endSegment && i < segmentCount; i++) {
-    if (i >= 0 && i < mSegments2D.size()) {
-        mSegments2D[i].isLandingPad = true;
-        // Make landing pad perfectly flat
-        mSegments2D[i].y1 = mSegments2D[i].y2 = baseHeight;
-          }
-        }   
-    // Make first and last segment of landing pad have exact boundaries
-    if (startSegment >= 0 && startSegment < mSegments2D.size()) {
-    mSegments2D[startSegment].x1 = landingPadStart;
+// Douglas-Peucker simplification of points [first, last]: marks the points
+// that must stay so that no dropped point is further than tolerance from
+// the simplified line
+static void SimplifyPolyline(const std::vector<float>& xs, const std::vector<float>& ys,
+                             size_t first, size_t last, float tolerance,
+                             std::vector<bool>& keep) {
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.push_back(std::make_pair(first, last));
+    
+    while (!stack.empty()) {
+        size_t a = stack.back().first;
+        size_t b = stack.back().second;
+        stack.pop_back();
+        
+        // Find the point furthest from the chord a-b
+        float dx = xs[b] - xs[a];
+        float dy = ys[b] - ys[a];
+        float length = std::sqrt(dx * dx + dy * dy);
+        float maxDistance = 0.0f;
+        size_t furthest = a;
+        
+        for (size_t i = a + 1; i < b; i++) {
+            float distance = std::fabs(dy * (xs[i] - xs[a]) - dx * (ys[i] - ys[a]));
+            if (length > 0.0f) {
+                distance /= length;
+            }
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                furthest = i;
+            }
+        }
+        
+        // Too far off the chord: keep that point and split there
+        if (maxDistance > tolerance) {
+            keep[furthest] = true;
+            stack.push_back(std::make_pair(a, furthest));
+            stack.push_back(std::make_pair(furthest, b));
+        }
+    }
 }
 
-if (endSegment >= 0 && endSegment < mSegments2D.size()) {
-    mSegments2D[endSegment].x2 = landingPadStart + landingPadWidth;
+void Terrain::BuildLod2D() {
+    mLodSegments2D.clear();
+    mLodTolerances2D.clear();
+    
+    if (mSegments2D.size() < 2) {
+        return;
+    }
+    
+    // Polyline points (the segments are joined end to start)
+    const size_t pointCount = mSegments2D.size() + 1;
+    std::vector<float> xs(pointCount);
+    std::vector<float> ys(pointCount);
+    for (size_t i = 0; i < mSegments2D.size(); i++) {
+        xs[i] = mSegments2D[i].x1;
+        ys[i] = mSegments2D[i].y1;
+    }
+    xs.back() = mSegments2D.back().x2;
+    ys.back() = mSegments2D.back().y2;
+    
+    float tolerance = kLodBaseTolerance2D;
+    size_t previousCount = mSegments2D.size();
+    
+    for (int level = 1; level <= kLodMaxLevels2D; level++, tolerance *= 2.0f) {
+        // Simplify each run of pad / non-pad segments on its own so the
+        // landing pads keep their exact extent at every level
+        std::vector<bool> keep(pointCount, false);
+        size_t runStart = 0;
+        for (size_t i = 1; i <= mSegments2D.size(); i++) {
+            if (i == mSegments2D.size() ||
+                mSegments2D[i].isLandingPad != mSegments2D[runStart].isLandingPad) {
+                keep[runStart] = true;
+                keep[i] = true;
+                SimplifyPolyline(xs, ys, runStart, i, tolerance, keep);
+                runStart = i;
+            }
+        }
+        
+        // Join the kept points back into segments
+        std::vector<TerrainSegment> segments;
+        size_t from = 0;
+        for (size_t i = 1; i < pointCount; i++) {
+            if (!keep[i]) {
+                continue;
+            }
+            
+            TerrainSegment segment;
+            segment.x1 = xs[from];
+            segment.y1 = ys[from];
+            segment.x2 = xs[i];
+            segment.y2 = ys[i];
+            segment.isLandingPad = mSegments2D[from].isLandingPad;
+            segments.push_back(segment);
+            from = i;
+        }
+        
+        // Stop once simplifying no longer helps
+        if (segments.size() >= previousCount) {
+            break;
+        }
+        
+        previousCount = segments.size();
+        mLodSegments2D.push_back(std::move(segments));
+        mLodTolerances2D.push_back(tolerance);
+        
+        if (previousCount <= kLodMinSegments2D) {
+            break;
+        }
+    }
 }
 
-std::cout << "LANDING PAD created at x=" << landingPadStart 
-          << " to " << (landingPadStart + landingPadWidth) 
-          << " (center: " << centerX << ")" << std::endl;
+const std::vector<TerrainSegment>& Terrain::GetSegments2D(int lodLevel) const {
+    if (lodLevel <= 0 || mLodSegments2D.empty()) {
+        return mSegments2D;
+    }
+    
+    return mLodSegments2D[std::min<size_t>(lodLevel, mLodSegments2D.size()) - 1];
+}
 
-      // Make sure landing pad is flat and visible
-    for (auto& segment : mSegments2D) {
-        if (segment.isLandingPad) {
-            // Make landing pad perfectly flat
-            segment.y1 = segment.y2 = baseHeight;
-            std::cout << "LANDING PAD created at x=" << segment.x1 << " to " << segment.x2 << std::endl;
-        }
+float Terrain::GetLodTolerance2D(int lodLevel) const {
+    if (lodLevel <= 0 || mLodTolerances2D.empty()) {
+        return 0.0f;
     }
+    
+    return mLodTolerances2D[std::min<size_t>(lodLevel, mLodTolerances2D.size()) - 1];
 }
 
 void Terrain::CreateLandingPad2D(int startX, int width) {
     // Find the segments that we need to modify
-    for (auto& segment : mSegments2D) {
+    float padHeight = 0.0f;
+    bool found = false;
+    
+    for (size_t i = 0; i < mSegments2D.size(); i++) {
+        TerrainSegment& segment = mSegments2D[i];
         if (segment.x1 >= startX && segment.x2 <= startX + width) {
             // This segment should be part of the landing pad
+            if (!found) {
+                padHeight = segment.y1;
+                found = true;
+            }
             segment.isLandingPad = true;
             
-            // Make it flat
-            segment.y1 = segment.y2 = mHeight - 50;
+            // Make it flat, keeping the neighbours joined to it
+            segment.y1 = segment.y2 = padHeight;
+            if (i > 0) {
+                mSegments2D[i - 1].y2 = padHeight;
+            }
+            if (i + 1 < mSegments2D.size()) {
+                mSegments2D[i + 1].y1 = padHeight;
+            }
         }
     }
 }
 
+int Terrain::FindSegment2D(float x) const {
+    // Segments are sorted by x: find the first one ending at or after x
+    auto it = std::lower_bound(mSegments2D.begin(), mSegments2D.end(), x,
+        [](const TerrainSegment& segment, float value) { return segment.x2 < value; });
+    
+    if (it == mSegments2D.end() || x < it->x1) {
+        return -1;
+    }
+    
+    return static_cast<int>(it - mSegments2D.begin());
+}
+
 bool Terrain::CheckCollision2D(Lander* lander, float& collisionHeight) {
     const float* landerPos = lander->GetPosition();
     float landerWidth = lander->GetWidth();
@@ -116,25 +306,42 @@ bool Terrain::CheckCollision2D(Lander* lander, float& collisionHeight) {
     float landerBottomX = landerPos[0];
     float landerBottomY = landerPos[1] - landerHeight / 2;
     
-    // Check collision with each terrain segment
-    for (const auto& segment : mSegments2D) {
-        // Simple line-point collision check
-        if (landerBottomX >= segment.x1 && landerBottomX <= segment.x2) {
-            // Interpolate Y position on segment
-            float segmentPct = (landerBottomX - segment.x1) / (segment.x2 - segment.x1);
-            float segmentY = segment.y1 + segmentPct * (segment.y2 - segment.y1);
-            
-            if (landerBottomY >= segmentY) {
-                // Collision detected
-                collisionHeight = segmentY;
-                return true;
-            }
+    // Check collision with the terrain segment under the lander
+    int index = FindSegment2D(landerBottomX);
+    if (index >= 0) {
+        const TerrainSegment& segment = mSegments2D[index];
+        
+        // Interpolate Y position on segment
+        float segmentPct = (landerBottomX - segment.x1) / (segment.x2 - segment.x1);
+        float segmentY = segment.y1 + segmentPct * (segment.y2 - segment.y1);
+        
+        if (landerBottomY >= segmentY) {
+            // Collision detected
+            collisionHeight = segmentY;
+            return true;
         }
     }
     
     return false;
 }
 
+bool Terrain::GetSurfaceHeight2D(float x, float& height) const {
+    int index = FindSegment2D(x);
+    if (index < 0) {
+        return false;
+    }
+    
+    const TerrainSegment& segment = mSegments2D[index];
+    float segmentPct = (x - segment.x1) / (segment.x2 - segment.x1);
+    height = segment.y1 + segmentPct * (segment.y2 - segment.y1);
+    return true;
+}
+
+bool Terrain::IsLandingPadAt2D(float x) const {
+    int index = FindSegment2D(x);
+    return index >= 0 && mSegments2D[index].isLandingPad;
+}
+
 bool Terrain::IsValidLanding2D(Lander* lander) {
     const float* landerPos = lander->GetPosition();
     const float* landerVel = lander->GetVelocity();
@@ -144,8 +351,10 @@ bool Terrain::IsValidLanding2D(Lander* lander) {
     float landerBottomX = landerPos[0];
     
       // Debug output to help diagnose landing issues
-      std::cout << "Landing check - Position: (" << landerPos[0] << "," << landerPos[1] 
-      << "), Velocity: (" << landerVel[0] << "," << landerVel[1] << ")" << std::endl;
+      if (mVerbose) {
+          std::cout << "Landing check - Position: (" << landerPos[0] << "," << landerPos[1] 
+          << "), Velocity: (" << landerVel[0] << "," << landerVel[1] << ")" << std::endl;
+      }
 
     // Check if lander is on a landing pad
     bool onLandingPad = false;
@@ -155,7 +364,9 @@ bool Terrain::IsValidLanding2D(Lander* lander) {
         landerBottomX <= segment.x2) {
     
         onLandingPad = true;
-        std::cout << "Lander is on landing pad!" << std::endl;
+        if (mVerbose) {
+            std::cout << "Lander is on landing pad!" << std::endl;
+        }
     
         // Check landing conditions:
         // 1. Vertical velocity must be low (regardless of direction)
@@ -166,8 +377,10 @@ bool Terrain::IsValidLanding2D(Lander* lander) {
         bool safeVertical = std::abs(landerVel[1]) <= safeVerticalVelocity;
         bool safeHorizontal = std::abs(landerVel[0]) <= safeHorizontalVelocity;
     
-        std::cout << "Safe vertical: " << (safeVertical ? "YES" : "NO") 
-              << ", Safe horizontal: " << (safeHorizontal ? "YES" : "NO") << std::endl;
+        if (mVerbose) {
+            std::cout << "Safe vertical: " << (safeVertical ? "YES" : "NO") 
+                  << ", Safe horizontal: " << (safeHorizontal ? "YES" : "NO") << std::endl;
+        }
     
         if (safeVertical && safeHorizontal) {
             return true;
@@ -175,7 +388,7 @@ bool Terrain::IsValidLanding2D(Lander* lander) {
     }
 }
 
-if (!onLandingPad) {
+if (!onLandingPad && mVerbose) {
     std::cout << "Lander is NOT on a landing pad!" << std::endl;
 }
 
@@ -188,6 +401,7 @@ void Terrain::Generate3D(int width, int length, int height) {
     mWidth = width;
     mLength = length;
     mHeight = height;
+    mGeneration++;
     
     // Clear any existing terrain
     mTriangles3D.clear();
@@ -197,6 +411,7 @@ void Terrain::Generate3D(int width, int length, int height) {
     
     // Generate a grid of vertices
     const int gridSize = 20;
+    mGridSize = gridSize;
     const float cellWidth = (float)width / gridSize;
     const float cellLength = (float)length / gridSize;
     
@@ -274,6 +489,156 @@ void Terrain::Generate3D(int width, int length, int height) {
             mTriangles3D.push_back(tri2);
         }
     }
+    
+    GenerateDetail3D();
+}
+
+void Terrain::GenerateDetail3D() {
+    const int resolution = kDetailResolution3D;
+    const int stride = resolution + 1;
+    const float cellWidth = (float)mWidth / resolution;
+    const float cellLength = (float)mLength / resolution;
+    
+    // Start from the coarse surface
+    mDetailHeights.resize(stride * stride);
+    for (int z = 0; z <= resolution; z++) {
+        for (int x = 0; x <= resolution; x++) {
+            float height = 0.0f;
+            GetSurfaceHeight3D(x * cellWidth, z * cellLength, height);
+            mDetailHeights[z * stride + x] = height;
+        }
+    }
+    
+    // Landing pad area, which is kept smooth
+    float padMin[2] = { (float)mWidth, (float)mLength };
+    float padMax[2] = { 0.0f, 0.0f };
+    const float coarseWidth = (float)mWidth / mGridSize;
+    const float coarseLength = (float)mLength / mGridSize;
+    for (int z = 0; z < mGridSize; z++) {
+        for (int x = 0; x < mGridSize; x++) {
+            if (mTriangles3D[(z * mGridSize + x) * 2].isLandingPad) {
+                padMin[0] = std::min(padMin[0], x * coarseWidth);
+                padMin[1] = std::min(padMin[1], z * coarseLength);
+                padMax[0] = std::max(padMax[0], (x + 1) * coarseWidth);
+                padMax[1] = std::max(padMax[1], (z + 1) * coarseLength);
+            }
+        }
+    }
+    
+    // Craters: bowls with a raised rim, many more small ones than large ones.
+    // Y grows downwards, so the bowl adds height and the rim subtracts it.
+    std::vector<float> detail(stride * stride, 0.0f);
+    mCraters3D.clear();
+    for (int i = 0; i < kCraterCount3D; i++) {
+        float centerX = (rand() % 1000) / 1000.0f * mWidth;
+        float centerZ = (rand() % 1000) / 1000.0f * mLength;
+        float size = (rand() % 1000) / 1000.0f;
+        float radius = mWidth * kCraterMinRadius3D *
+                       std::pow(kCraterMaxRadius3D / kCraterMinRadius3D, size * size);
+        float extent = radius * (1.0f + kCraterRimWidth3D);
+    
+        if (centerX + extent > padMin[0] && centerX - extent < padMax[0] &&
+            centerZ + extent > padMin[1] && centerZ - extent < padMax[1]) {
+            continue;
+        }
+    
+        TerrainCrater crater = { centerX, centerZ, radius };
+        mCraters3D.push_back(crater);
+        float depth = radius * kCraterDepth3D;
+        float rim = radius * kCraterRimHeight3D;
+        int minX = std::max(0, (int)((centerX - extent) / cellWidth));
+        int maxX = std::min(resolution, (int)((centerX + extent) / cellWidth) + 1);
+        int minZ = std::max(0, (int)((centerZ - extent) / cellLength));
+        int maxZ = std::min(resolution, (int)((centerZ + extent) / cellLength) + 1);
+        for (int z = minZ; z <= maxZ; z++) {
+            for (int x = minX; x <= maxX; x++) {
+                float dx = x * cellWidth - centerX;
+                float dz = z * cellLength - centerZ;
+                float t = std::sqrt(dx * dx + dz * dz) / radius;
+                if (t < 1.0f) {
+                    detail[z * stride + x] += (depth + rim) * (1.0f - t * t) - rim;
+                } else if (t < 1.0f + kCraterRimWidth3D) {
+                    float falloff = (1.0f + kCraterRimWidth3D - t) / kCraterRimWidth3D;
+                    detail[z * stride + x] -= rim * falloff * falloff;
+                }
+            }
+        }
+    }
+    
+    // Fine roughness (smoothed value noise) everywhere but on the pads
+    unsigned int seed = static_cast<unsigned int>(rand());
+    for (int z = 0; z <= resolution; z++) {
+        for (int x = 0; x <= resolution; x++) {
+            float worldX = x * cellWidth;
+            float worldZ = z * cellLength;
+            if (worldX >= padMin[0] && worldX <= padMax[0] && worldZ >= padMin[1] && worldZ <= padMax[1]) {
+                continue;
+            }
+    
+            int cellX = x / kRoughnessPeriod3D;
+            int cellZ = z / kRoughnessPeriod3D;
+            float fx = (float)(x % kRoughnessPeriod3D) / kRoughnessPeriod3D;
+            float fz = (float)(z % kRoughnessPeriod3D) / kRoughnessPeriod3D;
+            fx = fx * fx * (3.0f - 2.0f * fx);
+            fz = fz * fz * (3.0f - 2.0f * fz);
+            float n00 = LatticeNoise(cellX, cellZ, seed);
+            float n10 = LatticeNoise(cellX + 1, cellZ, seed);
+            float n01 = LatticeNoise(cellX, cellZ + 1, seed);
+            float n11 = LatticeNoise(cellX + 1, cellZ + 1, seed);
+            float top = n00 + (n10 - n00) * fx;
+            float bottom = n01 + (n11 - n01) * fx;
+            detail[z * stride + x] += (top + (bottom - top) * fz) * kRoughness3D;
+        }
+    }
+    
+    for (size_t i = 0; i < detail.size(); i++) {
+        mDetailHeights[i] += detail[i];
+    }
+}
+
+bool Terrain::GetSurfaceHeight3D(float x, float z, float& height) const {
+    if (mGridSize <= 0 || mHeightData.empty()) {
+        return false;
+    }
+    
+    // Convert to grid coordinates
+    float gx = x / ((float)mWidth / mGridSize);
+    float gz = z / ((float)mLength / mGridSize);
+    if (gx < 0.0f || gz < 0.0f || gx > mGridSize || gz > mGridSize) {
+        return false;
+    }
+    
+    int x0 = std::min((int)gx, mGridSize - 1);
+    int z0 = std::min((int)gz, mGridSize - 1);
+    float fx = gx - x0;
+    float fz = gz - z0;
+    
+    // Bilinear interpolation between the four surrounding samples
+    const int stride = mGridSize + 1;
+    float h00 = mHeightData[z0 * stride + x0];
+    float h10 = mHeightData[z0 * stride + x0 + 1];
+    float h01 = mHeightData[(z0 + 1) * stride + x0];
+    float h11 = mHeightData[(z0 + 1) * stride + x0 + 1];
+    
+    float top = h00 + (h10 - h00) * fx;
+    float bottom = h01 + (h11 - h01) * fx;
+    height = top + (bottom - top) * fz;
+    return true;
+}
+
+bool Terrain::IsLandingPadAt3D(float x, float z) const {
+    if (mGridSize <= 0 || mTriangles3D.empty()) {
+        return false;
+    }
+    
+    int cellX = (int)(x / ((float)mWidth / mGridSize));
+    int cellZ = (int)(z / ((float)mLength / mGridSize));
+    if (cellX < 0 || cellZ < 0 || cellX >= mGridSize || cellZ >= mGridSize) {
+        return false;
+    }
+    
+    // Two triangles per cell, generated row by row
+    return mTriangles3D[(cellZ * mGridSize + cellX) * 2].isLandingPad;
 }
 
 void Terrain::LoadHeightmap(const char* filename) {
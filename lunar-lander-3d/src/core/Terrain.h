@@ -20,12 +20,27 @@ struct TerrainTriangle {
     bool isLandingPad;  // Whether this triangle is a valid landing zone
 };
 
+// Crater stamped into the 3D detail grid (world units)
+struct TerrainCrater {
+    float x, z;    // Center
+    float radius;  // Radius of the bowl, inside the raised rim
+};
+
 // Terrain class - handles generation and collision detection
 class Terrain : public Entity {
 public:
     Terrain();
     virtual ~Terrain() = default;
     
+    // The 2D world the game and batch runs fly in: eight 800x600 screens
+    // side by side (world units)
+    static const int kWorldWidth2D = 800 * 8;
+    static const int kWorldHeight2D = 600;
+    
+    // Landing checks and generated pads are logged to std::cout unless
+    // turned off (headless runs)
+    void SetVerbose(bool verbose) { mVerbose = verbose; }
+    
     // Implement Entity methods
     void Update(float deltaTime) override;
     void Render(Renderer* renderer) override;
@@ -41,29 +56,81 @@ public:
     bool CheckCollision3D(Lander* lander, float& collisionHeight);
     bool IsValidLanding3D(Lander* lander);
     
+    // Surface height queries (return false when the point is off the terrain)
+    bool GetSurfaceHeight2D(float x, float& height) const;
+    bool GetSurfaceHeight3D(float x, float z, float& height) const;
+    bool IsLandingPadAt2D(float x) const;
+    bool IsLandingPadAt3D(float x, float z) const;
+    
     // Terrain accessors
     const std::vector<TerrainSegment>& GetSegments2D() const { return mSegments2D; }
+    
+    // 2D level of detail: level 0 is the full polyline and each further level
+    // is simplified with twice the error tolerance (world units) of the last
+    int GetLodLevelCount2D() const { return static_cast<int>(mLodSegments2D.size()) + 1; }
+    const std::vector<TerrainSegment>& GetSegments2D(int lodLevel) const;
+    float GetLodTolerance2D(int lodLevel) const;
     const std::vector<TerrainTriangle>& GetTriangles3D() const { return mTriangles3D; }
     
+    // Full-resolution 3D height grid: (resolution + 1)^2 samples spanning the
+    // terrain, row by row along z. The triangles are a coarse fit of the same
+    // surface; the detail (craters and roughness) is only drawn, via a normal
+    // map, and does not take part in collisions.
+    const std::vector<float>& GetDetailHeights3D() const { return mDetailHeights; }
+    int GetDetailResolution3D() const { return mDetailHeights.empty() ? 0 : kDetailResolution3D; }
+    
+    // Craters of the detail grid, for map-based navigation
+    const std::vector<TerrainCrater>& GetCraters3D() const { return mCraters3D; }
+    
     // Terrain dimensions
     int GetWidth() const { return mWidth; }
     int GetHeight() const { return mHeight; }
     int GetLength() const { return mLength; } // For 3D
+    
+    // Incremented by every Generate2D()/Generate3D(), so renderers that keep
+    // the terrain in GPU memory know when to upload it again
+    unsigned int GetGeneration() const { return mGeneration; }
 
 private:
     // 2D terrain representation (from Phase 2)
     std::vector<TerrainSegment> mSegments2D;
     
+    // Simplified copies of mSegments2D, coarsest last
+    std::vector<std::vector<TerrainSegment>> mLodSegments2D;
+    std::vector<float> mLodTolerances2D;
+    
     // 3D terrain representation (for Phase 3)
     std::vector<TerrainTriangle> mTriangles3D;
     
     // Heightmap data (for 3D)
     std::vector<float> mHeightData;
+    int mGridSize;  // Cells per side of the 3D heightmap grid
+    std::vector<float> mDetailHeights;
+    std::vector<TerrainCrater> mCraters3D;
     
     // Terrain dimensions
     int mWidth;
     int mHeight;
     int mLength; // For 3D
+    unsigned int mGeneration;
+    bool mVerbose;
+    
+    // 2D generation parameters
+    static const int kSegmentWidth2D = 10;     // World units per terrain segment
+    static const int kExtraLandingPads2D = 4;  // Pads besides the one at the center
+    
+    // 3D detail generation parameters
+    static const int kDetailResolution3D = 512;  // Cells per side of the detail grid
+    static const int kCraterCount3D = 80;
+    
+    // Index of the 2D segment spanning x, or -1 (binary search on x)
+    int FindSegment2D(float x) const;
+    
+    // Build the simplified 2D levels from mSegments2D
+    void BuildLod2D();
+    
+    // Build mDetailHeights and mCraters3D from the coarse grid (uses rand())
+    void GenerateDetail3D();
     
     // Create a valid landing pad in the terrain
     void CreateLandingPad2D(int startX, int width);
@@ -0,0 +1,618 @@
+// TerrainNavigator.cpp
+// Implementation of crater-based terrain-relative navigation
+
+#include "TerrainNavigator.h"
+#include "Entity.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define NAVIGATION_SSE 1
+#endif
+
+// Template crater profile in units of its radius: the bowl-and-rim shape of
+// small lunar craters, about a quarter as deep as they are wide
+static const float kTemplateDepth = 0.25f;
+static const float kTemplateRimHeight = 0.06f;
+static const float kTemplateRimWidth = 0.6f;
+
+// Template radii: two per octave of the pyramid, the smallest in pixels
+static const float kTemplateRadius = 2.0f;
+static const int kTemplatesPerOctave = 2;
+
+// Coarsest pyramid level (pixels per side)
+static const int kMinLevelSize = 16;
+
+// Detections: smallest correlation with the template, smallest fitted
+// depth relative to the template's, and how many are kept at most
+static const float kMinCorrelation = 0.6f;
+static const float kMinDepthRatio = 0.4f;
+static const int kMaxDetections = 48;
+
+// Height variance (world units squared per pixel) below which a window
+// counts as flat, so noise on smooth ground does not correlate
+static const float kMinVariance = 0.01f;
+
+// Matching: position tolerance (fraction of the radius, with a floor in
+// world units), radius mismatch allowed, and matches needed for a fix
+static const float kMatchTolerance = 0.3f;
+static const float kMinMatchTolerance = 2.0f;
+static const float kRadiusRatio = 1.6f;
+static const int kMinMatches = 3;
+
+// Crater candidate before suppression of overlapping detections
+struct CraterCandidate {
+    CraterDetection detection;
+    float pixelRadius;  // Full-resolution pixels
+};
+
+static bool RadiusMatches(float detected, float catalog) {
+    return detected < catalog * kRadiusRatio && detected * kRadiusRatio > catalog;
+}
+
+// Count in the integral image of the pixels [x0, x1) x [y0, y1)
+static int BoxSum(const std::vector<int>& sums, int size, int x0, int y0, int x1, int y1) {
+    const int stride = size + 1;
+    return sums[y1 * stride + x1] - sums[y0 * stride + x1] - sums[y1 * stride + x0] + sums[y0 * stride + x0];
+}
+
+static void BuildIntegral(const std::vector<unsigned char>& invalid, int size, std::vector<int>& sums) {
+    const int stride = size + 1;
+    sums.assign(static_cast<size_t>(stride) * stride, 0);
+    for (int y = 0; y < size; y++) {
+        int rowSum = 0;
+        for (int x = 0; x < size; x++) {
+            rowSum += invalid[y * size + x];
+            sums[(y + 1) * stride + x + 1] = sums[y * stride + x + 1] + rowSum;
+        }
+    }
+}
+
+// Normalized correlation of image with the template wherever it fits
+// entirely, and the template amplitude fitted there; 0 elsewhere. The
+// variance is taken about the best-fitting plane, as the zero-mean, symmetric
+// template ignores slopes too. Heights are taken relative to the output
+// pixel, which keeps the sums small.
+static void Correlate(const std::vector<float>& image, int size, const std::vector<int>& taps,
+                      const std::vector<float>& offsetX, const std::vector<float>& offsetY,
+                      const std::vector<float>& weights, float energy, float moment, int reach,
+                      std::vector<float>& correlations, std::vector<float>& amplitudes) {
+    correlations.assign(static_cast<size_t>(size) * size, 0.0f);
+    amplitudes.assign(correlations.size(), 0.0f);
+    const int tapCount = static_cast<int>(taps.size());
+    const float inverseCount = 1.0f / tapCount;
+    const float inverseMoment = 1.0f / moment;
+    const float minVariance = kMinVariance * tapCount;
+    const int first = reach;
+    const int last = size - reach;
+
+    for (int y = first; y < last; y++) {
+        const float* center = &image[static_cast<size_t>(y) * size];
+        float* correlationRow = &correlations[static_cast<size_t>(y) * size];
+        float* amplitudeRow = &amplitudes[static_cast<size_t>(y) * size];
+        int x = first;
+
+#ifdef NAVIGATION_SSE
+        // Four neighbouring outputs per pass, one template tap at a time
+        const __m128 inverseCount4 = _mm_set1_ps(inverseCount);
+        const __m128 inverseMoment4 = _mm_set1_ps(inverseMoment);
+        const __m128 minVariance4 = _mm_set1_ps(minVariance);
+        const __m128 energy4 = _mm_set1_ps(energy);
+        for (; x + 4 <= last; x += 4) {
+            const __m128 reference = _mm_loadu_ps(center + x);
+            __m128 dot = _mm_setzero_ps();
+            __m128 sum = _mm_setzero_ps();
+            __m128 squares = _mm_setzero_ps();
+            __m128 slopeX = _mm_setzero_ps();
+            __m128 slopeY = _mm_setzero_ps();
+            for (int tap = 0; tap < tapCount; tap++) {
+                __m128 height = _mm_sub_ps(_mm_loadu_ps(center + x + taps[tap]), reference);
+                dot = _mm_add_ps(dot, _mm_mul_ps(height, _mm_set1_ps(weights[tap])));
+                sum = _mm_add_ps(sum, height);
+                squares = _mm_add_ps(squares, _mm_mul_ps(height, height));
+                slopeX = _mm_add_ps(slopeX, _mm_mul_ps(height, _mm_set1_ps(offsetX[tap])));
+                slopeY = _mm_add_ps(slopeY, _mm_mul_ps(height, _mm_set1_ps(offsetY[tap])));
+            }
+            __m128 plane = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sum, sum), inverseCount4),
+                                      _mm_mul_ps(_mm_add_ps(_mm_mul_ps(slopeX, slopeX), _mm_mul_ps(slopeY, slopeY)),
+                                                 inverseMoment4));
+            __m128 variance = _mm_max_ps(_mm_sub_ps(squares, plane), minVariance4);
+            _mm_storeu_ps(correlationRow + x, _mm_div_ps(dot, _mm_sqrt_ps(_mm_mul_ps(variance, energy4))));
+            _mm_storeu_ps(amplitudeRow + x, _mm_div_ps(dot, energy4));
+        }
+#endif
+
+        for (; x < last; x++) {
+            const float reference = center[x];
+            float dot = 0.0f;
+            float sum = 0.0f;
+            float squares = 0.0f;
+            float slopeX = 0.0f;
+            float slopeY = 0.0f;
+            for (int tap = 0; tap < tapCount; tap++) {
+                float height = center[x + taps[tap]] - reference;
+                dot += height * weights[tap];
+                sum += height;
+                squares += height * height;
+                slopeX += height * offsetX[tap];
+                slopeY += height * offsetY[tap];
+            }
+            float plane = sum * sum * inverseCount + (slopeX * slopeX + slopeY * slopeY) * inverseMoment;
+            float variance = std::max(squares - plane, minVariance);
+            correlationRow[x] = dot / std::sqrt(variance * energy);
+            amplitudeRow[x] = dot / energy;
+        }
+    }
+}
+
+// Offset of a peak from its center sample, from a parabola through three
+static float RefinePeak(float before, float center, float after) {
+    float curvature = before - 2.0f * center + after;
+    if (curvature >= 0.0f) {
+        return 0.0f;
+    }
+    return std::max(-0.5f, std::min(0.5f, 0.5f * (before - after) / curvature));
+}
+
+TerrainNavigator::TerrainNavigator()
+    : mImageSize(0)
+    , mTanHalfFov(0.0f)
+    , mTerrain(nullptr)
+    , mTerrainGeneration(0)
+{
+}
+
+TerrainNavigator::~TerrainNavigator() {
+    Shutdown();
+}
+
+bool TerrainNavigator::Initialize(int imageSize, float fieldOfView) {
+    Shutdown();
+
+    // One image per fix, so the calling thread renders it alone
+    if (imageSize < kMinLevelSize || !mRenderer.Initialize(imageSize, imageSize, fieldOfView, 1)) {
+        return false;
+    }
+
+    mImageSize = imageSize;
+    mTanHalfFov = std::tan(fieldOfView * 0.5f * static_cast<float>(M_PI) / 180.0f);
+    mDepth.assign(static_cast<size_t>(imageSize) * imageSize, 0.0f);
+
+    int levelCount = 0;
+    while ((imageSize >> levelCount) >= kMinLevelSize) {
+        levelCount++;
+    }
+    mLevels.resize(levelCount);
+    for (int level = 0; level < levelCount; level++) {
+        mLevels[level].size = imageSize >> level;
+    }
+
+    BuildTemplates();
+    return true;
+}
+
+void TerrainNavigator::Shutdown() {
+    mRenderer.Shutdown();
+    mImageSize = 0;
+    mLevels.clear();
+    mTemplates.clear();
+    mDepth.clear();
+    mDetections.clear();
+}
+
+void TerrainNavigator::SetTerrain(const Terrain* terrain) {
+    mRenderer.SetTerrain(terrain);
+    if (terrain == mTerrain && (!terrain || terrain->GetGeneration() == mTerrainGeneration)) {
+        return;
+    }
+
+    mTerrain = terrain;
+    mCatalog.clear();
+    if (!terrain) {
+        return;
+    }
+
+    mTerrainGeneration = terrain->GetGeneration();
+    mCatalog = terrain->GetCraters3D();
+    BuildTree(0, static_cast<int>(mCatalog.size()), 0);
+}
+
+void TerrainNavigator::BuildTemplates() {
+    mTemplates.clear();
+    for (int i = 0; i < kTemplatesPerOctave; i++) {
+        Template crater;
+        crater.radius = kTemplateRadius * std::pow(2.0f, static_cast<float>(i) / kTemplatesPerOctave);
+        crater.reach = static_cast<int>(std::ceil(crater.radius * (1.0f + kTemplateRimWidth)));
+
+        // Profile over the disk reaching the outer edge of the rim
+        std::vector<float> profile;
+        for (int y = -crater.reach; y <= crater.reach; y++) {
+            for (int x = -crater.reach; x <= crater.reach; x++) {
+                float t = std::sqrt(static_cast<float>(x * x + y * y)) / crater.radius;
+                if (t > 1.0f + kTemplateRimWidth) {
+                    continue;
+                }
+
+                // Y grows downwards, so the bowl is positive and the rim negative
+                float height;
+                if (t < 1.0f) {
+                    height = (kTemplateDepth + kTemplateRimHeight) * (1.0f - t * t) - kTemplateRimHeight;
+                } else {
+                    float falloff = (1.0f + kTemplateRimWidth - t) / kTemplateRimWidth;
+                    height = -kTemplateRimHeight * falloff * falloff;
+                }
+                crater.offsetX.push_back(static_cast<float>(x));
+                crater.offsetY.push_back(static_cast<float>(y));
+                profile.push_back(height);
+            }
+        }
+
+        // Zero mean, so constant and (by symmetry) sloped ground cancel out.
+        // Correlating with a crater of radius r then gives r * energy.
+        float mean = 0.0f;
+        for (float height : profile) {
+            mean += height;
+        }
+        mean /= profile.size();
+        crater.energy = 0.0f;
+        for (float height : profile) {
+            crater.weights.push_back(height - mean);
+            crater.energy += (height - mean) * (height - mean);
+        }
+        crater.moment = 0.0f;
+        for (float x : crater.offsetX) {
+            crater.moment += x * x;
+        }
+        mTemplates.push_back(crater);
+    }
+}
+
+void TerrainNavigator::BuildPyramid(const ObservationCamera& camera) {
+    const float maxDepth = mRenderer.GetMaxDepth();
+    std::vector<unsigned char> invalid;
+
+    // Full resolution: surface height of every pixel that hit the terrain
+    Level& base = mLevels[0];
+    base.heights.assign(mDepth.size(), 0.0f);
+    invalid.assign(mDepth.size(), 0);
+    for (int y = 0; y < base.size; y++) {
+        for (int x = 0; x < base.size; x++) {
+            int index = y * base.size + x;
+            if (mDepth[index] >= maxDepth) {
+                invalid[index] = 1;
+                continue;
+            }
+            float direction[3];
+            mRenderer.GetPixelDirection(camera, x + 0.5f, y + 0.5f, direction);
+            base.heights[index] = camera.position[1] + direction[1] * mDepth[index];
+        }
+    }
+    BuildIntegral(invalid, base.size, base.invalidSums);
+
+    // Each coarser level averages 2x2 blocks, invalid if any pixel is
+    for (size_t level = 1; level < mLevels.size(); level++) {
+        const Level& source = mLevels[level - 1];
+        Level& target = mLevels[level];
+        target.heights.assign(static_cast<size_t>(target.size) * target.size, 0.0f);
+        invalid.assign(target.heights.size(), 0);
+        for (int y = 0; y < target.size; y++) {
+            const float* top = &source.heights[static_cast<size_t>(y * 2) * source.size];
+            const float* bottom = top + source.size;
+            for (int x = 0; x < target.size; x++) {
+                int index = y * target.size + x;
+                if (BoxSum(source.invalidSums, source.size, x * 2, y * 2, x * 2 + 2, y * 2 + 2) > 0) {
+                    invalid[index] = 1;
+                    continue;
+                }
+                target.heights[index] = (top[x * 2] + top[x * 2 + 1] + bottom[x * 2] + bottom[x * 2 + 1]) * 0.25f;
+            }
+        }
+        BuildIntegral(invalid, target.size, target.invalidSums);
+    }
+}
+
+void TerrainNavigator::DetectCraters(const ObservationCamera& camera) {
+    std::vector<CraterCandidate> candidates;
+    std::vector<int> taps;
+    const float pixelFootprint = 2.0f * mTanHalfFov / mImageSize;  // Per unit of depth
+
+    for (size_t level = 0; level < mLevels.size(); level++) {
+        Level& source = mLevels[level];
+        const int size = source.size;
+        const float scale = static_cast<float>(1 << level);
+
+        for (const Template& crater : mTemplates) {
+            if (crater.reach * 2 + 3 > size) {
+                continue;
+            }
+            taps.resize(crater.weights.size());
+            for (size_t tap = 0; tap < taps.size(); tap++) {
+                taps[tap] = static_cast<int>(crater.offsetY[tap]) * size + static_cast<int>(crater.offsetX[tap]);
+            }
+            Correlate(source.heights, size, taps, crater.offsetX, crater.offsetY, crater.weights, crater.energy,
+                      crater.moment, crater.reach, source.correlations, source.amplitudes);
+
+            // Local maxima whose template window saw only terrain
+            const float* correlations = source.correlations.data();
+            for (int y = crater.reach; y < size - crater.reach; y++) {
+                for (int x = crater.reach; x < size - crater.reach; x++) {
+                    float correlation = correlations[y * size + x];
+                    if (correlation < kMinCorrelation) {
+                        continue;
+                    }
+                    bool peak = true;
+                    for (int dy = -1; dy <= 1 && peak; dy++) {
+                        for (int dx = -1; dx <= 1; dx++) {
+                            if (correlations[(y + dy) * size + x + dx] > correlation) {
+                                peak = false;
+                                break;
+                            }
+                        }
+                    }
+                    if (!peak || BoxSum(source.invalidSums, size, x - crater.reach, y - crater.reach,
+                                        x + crater.reach + 1, y + crater.reach + 1) > 0) {
+                        continue;
+                    }
+
+                    float peakX = x + 0.5f + RefinePeak(correlations[y * size + x - 1], correlation,
+                                                        correlations[y * size + x + 1]);
+                    float peakY = y + 0.5f + RefinePeak(correlations[(y - 1) * size + x], correlation,
+                                                        correlations[(y + 1) * size + x]);
+                    CraterCandidate candidate;
+                    CraterDetection& detection = candidate.detection;
+                    detection.imageX = peakX * scale;
+                    detection.imageY = peakY * scale;
+                    detection.score = correlation;
+                    candidate.pixelRadius = crater.radius * scale;
+
+                    int pixelX = std::min(mImageSize - 1, static_cast<int>(detection.imageX));
+                    int pixelY = std::min(mImageSize - 1, static_cast<int>(detection.imageY));
+                    float depth = mDepth[pixelY * mImageSize + pixelX];
+                    if (depth >= mRenderer.GetMaxDepth()) {
+                        continue;
+                    }
+
+                    // Sizes from the depth at the center, as seen straight on.
+                    // Shallow matches are roughness rather than craters.
+                    float direction[3];
+                    mRenderer.GetPixelDirection(camera, detection.imageX, detection.imageY, direction);
+                    for (int axis = 0; axis < 3; axis++) {
+                        detection.offset[axis] = direction[axis] * depth;
+                    }
+                    detection.radius = candidate.pixelRadius * depth * pixelFootprint;
+                    if (source.amplitudes[y * size + x] >= detection.radius * kMinDepthRatio) {
+                        candidates.push_back(candidate);
+                    }
+                }
+            }
+        }
+    }
+
+    // Strongest first; drop candidates centered inside a stronger one
+    std::sort(candidates.begin(), candidates.end(), [](const CraterCandidate& a, const CraterCandidate& b) {
+        return a.detection.score > b.detection.score;
+    });
+    mDetections.clear();
+    std::vector<float> acceptedRadii;
+    for (const CraterCandidate& candidate : candidates) {
+        if (static_cast<int>(mDetections.size()) >= kMaxDetections) {
+            break;
+        }
+        bool overlaps = false;
+        for (size_t i = 0; i < mDetections.size() && !overlaps; i++) {
+            float dx = candidate.detection.imageX - mDetections[i].imageX;
+            float dy = candidate.detection.imageY - mDetections[i].imageY;
+            float reach = std::max(candidate.pixelRadius, acceptedRadii[i]);
+            overlaps = dx * dx + dy * dy < reach * reach;
+        }
+        if (!overlaps) {
+            mDetections.push_back(candidate.detection);
+            acceptedRadii.push_back(candidate.pixelRadius);
+        }
+    }
+}
+
+void TerrainNavigator::BuildTree(int begin, int end, int axis) {
+    if (end - begin <= 1) {
+        return;
+    }
+
+    int middle = (begin + end) / 2;
+    std::nth_element(mCatalog.begin() + begin, mCatalog.begin() + middle, mCatalog.begin() + end,
+                     [axis](const TerrainCrater& a, const TerrainCrater& b) {
+                         return axis == 0 ? a.x < b.x : a.z < b.z;
+                     });
+    BuildTree(begin, middle, 1 - axis);
+    BuildTree(middle + 1, end, 1 - axis);
+}
+
+void TerrainNavigator::FindInRadius(float x, float z, float radius, int begin, int end, int axis,
+                                    std::vector<int>& found) const {
+    if (begin >= end) {
+        return;
+    }
+
+    int middle = (begin + end) / 2;
+    const TerrainCrater& crater = mCatalog[middle];
+    float dx = x - crater.x;
+    float dz = z - crater.z;
+    if (dx * dx + dz * dz <= radius * radius) {
+        found.push_back(middle);
+    }
+
+    // Lower coordinates are in the first half, higher ones in the second
+    float split = axis == 0 ? dx : dz;
+    if (split <= radius) {
+        FindInRadius(x, z, radius, begin, middle, 1 - axis, found);
+    }
+    if (split >= -radius) {
+        FindInRadius(x, z, radius, middle + 1, end, 1 - axis, found);
+    }
+}
+
+int TerrainNavigator::MatchDetections(const std::vector<float>& predicted, const float* shift,
+                                      std::vector<int>& matches) const {
+    std::vector<int> found;
+    int matchCount = 0;
+    matches.assign(mDetections.size(), -1);
+
+    for (size_t i = 0; i < mDetections.size(); i++) {
+        float x = predicted[i * 2] + shift[0];
+        float z = predicted[i * 2 + 1] + shift[1];
+        float tolerance = std::max(kMinMatchTolerance, mDetections[i].radius * kMatchTolerance);
+        found.clear();
+        FindInRadius(x, z, tolerance, 0, static_cast<int>(mCatalog.size()), 0, found);
+
+        float closest = tolerance * tolerance;
+        for (int index : found) {
+            const TerrainCrater& crater = mCatalog[index];
+            float distance = (crater.x - x) * (crater.x - x) + (crater.z - z) * (crater.z - z);
+            if (distance <= closest && RadiusMatches(mDetections[i].radius, crater.radius)) {
+                closest = distance;
+                matches[i] = index;
+            }
+        }
+        if (matches[i] >= 0) {
+            matchCount++;
+        }
+    }
+    return matchCount;
+}
+
+bool TerrainNavigator::SampleMapHeight(float x, float z, float& height) const {
+    const int resolution = mTerrain ? mTerrain->GetDetailResolution3D() : 0;
+    if (resolution <= 0) {
+        return false;
+    }
+
+    float gridX = x / mTerrain->GetWidth() * resolution;
+    float gridZ = z / mTerrain->GetLength() * resolution;
+    if (gridX < 0.0f || gridZ < 0.0f || gridX > resolution || gridZ > resolution) {
+        return false;
+    }
+
+    const std::vector<float>& heights = mTerrain->GetDetailHeights3D();
+    const int stride = resolution + 1;
+    int x0 = std::min(static_cast<int>(gridX), resolution - 1);
+    int z0 = std::min(static_cast<int>(gridZ), resolution - 1);
+    float fx = gridX - x0;
+    float fz = gridZ - z0;
+    const float* row = &heights[static_cast<size_t>(z0) * stride + x0];
+    float top = row[0] + (row[1] - row[0]) * fx;
+    float bottom = row[stride] + (row[stride + 1] - row[stride]) * fx;
+    height = top + (bottom - top) * fz;
+    return true;
+}
+
+bool TerrainNavigator::ComputeFix(const Lander* lander, const float* estimatedPosition, float searchRadius,
+                                  NavigationFix& fix) {
+    fix.valid = false;
+    fix.detectedCount = 0;
+    fix.matchedCount = 0;
+    fix.residual = 0.0f;
+    mDetections.clear();
+    if (!estimatedPosition) {
+        return false;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        fix.position[axis] = estimatedPosition[axis];
+    }
+    if (!lander || !mTerrain || mImageSize <= 0 || mTerrain->GetDetailResolution3D() <= 0) {
+        return false;
+    }
+
+    ObservationCamera camera = ObservationRenderer::GetLanderCamera(lander);
+    mRenderer.Render(&camera, 1, ObservationRenderer::Channel::Depth, mDepth.data());
+    BuildPyramid(camera);
+    DetectCraters(camera);
+    fix.detectedCount = static_cast<int>(mDetections.size());
+    if (fix.detectedCount < kMinMatches) {
+        return false;
+    }
+
+    // Where the estimate puts each detection: the camera sits at the same
+    // offset from the lander whatever its position
+    float cameraOffset[3];
+    for (int axis = 0; axis < 3; axis++) {
+        cameraOffset[axis] = camera.position[axis] - lander->GetPosition()[axis];
+    }
+    std::vector<float> predicted(mDetections.size() * 2);
+    for (size_t i = 0; i < mDetections.size(); i++) {
+        predicted[i * 2] = estimatedPosition[0] + cameraOffset[0] + mDetections[i].offset[0];
+        predicted[i * 2 + 1] = estimatedPosition[2] + cameraOffset[2] + mDetections[i].offset[2];
+    }
+
+    // Every plausible catalog match of every detection proposes a shift of
+    // the estimate; keep the one most other detections agree with
+    std::vector<int> found;
+    std::vector<int> matches;
+    float bestShift[2] = { 0.0f, 0.0f };
+    int bestCount = 0;
+    for (size_t i = 0; i < mDetections.size(); i++) {
+        found.clear();
+        FindInRadius(predicted[i * 2], predicted[i * 2 + 1], searchRadius, 0, static_cast<int>(mCatalog.size()),
+                     0, found);
+        for (int index : found) {
+            if (!RadiusMatches(mDetections[i].radius, mCatalog[index].radius)) {
+                continue;
+            }
+            const float shift[2] = { mCatalog[index].x - predicted[i * 2], mCatalog[index].z - predicted[i * 2 + 1] };
+            int count = MatchDetections(predicted, shift, matches);
+            if (count > bestCount) {
+                bestCount = count;
+                bestShift[0] = shift[0];
+                bestShift[1] = shift[1];
+            }
+        }
+    }
+    if (bestCount < kMinMatches) {
+        return false;
+    }
+
+    // Refine the shift to the mean over all of its matches, then match again
+    int count = MatchDetections(predicted, bestShift, matches);
+    float refined[2] = { 0.0f, 0.0f };
+    for (size_t i = 0; i < mDetections.size(); i++) {
+        if (matches[i] >= 0) {
+            refined[0] += mCatalog[matches[i]].x - predicted[i * 2];
+            refined[1] += mCatalog[matches[i]].z - predicted[i * 2 + 1];
+        }
+    }
+    refined[0] /= count;
+    refined[1] /= count;
+    fix.matchedCount = MatchDetections(predicted, refined, matches);
+    if (fix.matchedCount < kMinMatches) {
+        return false;
+    }
+
+    // Height from the map under the matched craters, less their measured
+    // depth below the camera
+    float squaredError = 0.0f;
+    float heightSum = 0.0f;
+    int heightCount = 0;
+    for (size_t i = 0; i < mDetections.size(); i++) {
+        if (matches[i] < 0) {
+            continue;
+        }
+        float x = predicted[i * 2] + refined[0];
+        float z = predicted[i * 2 + 1] + refined[1];
+        squaredError += (mCatalog[matches[i]].x - x) * (mCatalog[matches[i]].x - x) +
+                        (mCatalog[matches[i]].z - z) * (mCatalog[matches[i]].z - z);
+
+        float height = 0.0f;
+        if (SampleMapHeight(x, z, height)) {
+            heightSum += height - mDetections[i].offset[1] - cameraOffset[1];
+            heightCount++;
+        }
+    }
+
+    fix.valid = true;
+    fix.position[0] = estimatedPosition[0] + refined[0];
+    fix.position[2] = estimatedPosition[2] + refined[1];
+    if (heightCount > 0) {
+        fix.position[1] = heightSum / heightCount;
+    }
+    fix.residual = std::sqrt(squaredError / fix.matchedCount);
+    return true;
+}
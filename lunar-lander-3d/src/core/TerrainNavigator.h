@@ -0,0 +1,106 @@
+// TerrainNavigator.h
+// Terrain-relative navigation: position fixes from craters seen below the lander
+
+#pragma once
+
+#include "ObservationRenderer.h"
+#include "Terrain.h"
+#include <vector>
+
+class Lander;
+
+// Crater found in a navigation image
+struct CraterDetection {
+    float imageX, imageY;  // Center in pixels of the full-resolution image
+    float offset[3];       // Center relative to the camera, world axes
+    float radius;          // World units
+    float score;           // Correlation with the crater template, up to 1
+};
+
+// Result of TerrainNavigator::ComputeFix()
+struct NavigationFix {
+    bool valid;
+    float position[3];  // Lander position implied by the matched craters
+    int detectedCount;  // Craters found in the image
+    int matchedCount;   // Detections that agree on one catalog match
+    float residual;     // RMS distance of the matches from the catalog (world units)
+};
+
+// Simulates a camera-based navigation sensor. The view below the lander is
+// ray-cast into a depth image, converted to surface heights, and correlated
+// (normalized, with SSE where available) against a bowl-and-rim crater
+// template at two radii per octave of an image pyramid. The craters found
+// are matched against the terrain's crater catalog, held in a k-d tree, by
+// voting for the position correction that lines up the most of them.
+class TerrainNavigator {
+public:
+    TerrainNavigator();
+    ~TerrainNavigator();
+
+    // Square depth image size (pixels) and field of view (degrees)
+    bool Initialize(int imageSize = 128, float fieldOfView = 60.0f);
+    void Shutdown();
+
+    // Terrain to navigate over; the catalog is rebuilt when it changes
+    void SetTerrain(const Terrain* terrain);
+
+    // Fix from what the lander's camera sees at its true pose. The attitude
+    // is taken as known; estimatedPosition is the navigation estimate being
+    // corrected, and catalog craters are searched for within searchRadius of
+    // where it places each detection. Returns fix.valid.
+    bool ComputeFix(const Lander* lander, const float* estimatedPosition, float searchRadius, NavigationFix& fix);
+
+    // Results of the last ComputeFix(), for display and debugging
+    const std::vector<CraterDetection>& GetDetections() const { return mDetections; }
+    const std::vector<float>& GetDepthImage() const { return mDepth; }
+    int GetImageSize() const { return mImageSize; }
+    int GetCatalogSize() const { return static_cast<int>(mCatalog.size()); }
+
+private:
+    // Pyramid level of the height image; level n is 2^n times coarser
+    struct Level {
+        int size;
+        std::vector<float> heights;       // World Y per pixel
+        std::vector<int> invalidSums;     // Integral image of pixels without a hit
+        std::vector<float> correlations;  // Current template, normalized
+        std::vector<float> amplitudes;    // Current template, fitted amplitude
+    };
+
+    // Zero-mean crater template of one radius, as a list of nonzero taps
+    struct Template {
+        float radius;  // Pixels
+        int reach;     // Largest tap offset
+        std::vector<float> offsetX;
+        std::vector<float> offsetY;
+        std::vector<float> weights;
+        float energy;  // Sum of squared weights
+        float moment;  // Sum of squared offsets along either axis
+    };
+
+    void BuildTemplates();
+    void BuildPyramid(const ObservationCamera& camera);
+    void DetectCraters(const ObservationCamera& camera);
+
+    // Catalog k-d tree, stored implicitly: the middle of every range splits it
+    void BuildTree(int begin, int end, int axis);
+    void FindInRadius(float x, float z, float radius, int begin, int end, int axis, std::vector<int>& found) const;
+
+    // Best catalog match of every detection after shifting the predicted
+    // positions by shift; returns the match count
+    int MatchDetections(const std::vector<float>& predicted, const float* shift, std::vector<int>& matches) const;
+
+    bool SampleMapHeight(float x, float z, float& height) const;
+
+    ObservationRenderer mRenderer;
+    int mImageSize;
+    float mTanHalfFov;
+
+    const Terrain* mTerrain;
+    unsigned int mTerrainGeneration;
+    std::vector<TerrainCrater> mCatalog;
+
+    std::vector<Template> mTemplates;
+    std::vector<Level> mLevels;
+    std::vector<float> mDepth;
+    std::vector<CraterDetection> mDetections;
+};
@@ -0,0 +1,140 @@
+// TerrainNormalMap.cpp
+// Implementation of the terrain normal map baker
+
+#include "TerrainNormalMap.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <cmath>
+
+// Upper bound on baking threads
+static const int kMaxBakeWorkers = 8;
+
+static uint8_t EncodeComponent(float value) {
+    return static_cast<uint8_t>(std::lround((std::max(-1.0f, std::min(1.0f, value)) * 0.5f + 0.5f) * 255.0f));
+}
+
+static float DecodeComponent(uint8_t value) {
+    return value / 255.0f * 2.0f - 1.0f;
+}
+
+static void StoreNormal(uint8_t* texel, float x, float y, float z) {
+    float length = std::sqrt(x * x + y * y + z * z);
+    if (length > 0.0f) {
+        x /= length;
+        y /= length;
+        z /= length;
+    }
+    texel[0] = EncodeComponent(x);
+    texel[1] = EncodeComponent(y);
+    texel[2] = EncodeComponent(z);
+    texel[3] = 255;
+}
+
+TerrainNormalMap::TerrainNormalMap()
+    : mCellWidth(0.0f)
+    , mCellLength(0.0f)
+    , mRunningWorkers(0)
+    , mReady(false)
+    , mGeneration(0)
+    , mSize(0)
+{
+}
+
+TerrainNormalMap::~TerrainNormalMap() {
+    Wait();
+}
+
+void TerrainNormalMap::Wait() {
+    for (std::thread& worker : mWorkers) {
+        worker.join();
+    }
+    mWorkers.clear();
+}
+
+void TerrainNormalMap::Rebuild(const Terrain* terrain) {
+    // The previous bake must finish before its buffers are reused
+    Wait();
+    mReady.store(false, std::memory_order_release);
+    mGeneration++;
+
+    if (!terrain || terrain->GetDetailResolution3D() <= 0) {
+        return;
+    }
+
+    // Private copy, so the terrain can be regenerated meanwhile
+    mHeights = terrain->GetDetailHeights3D();
+    mSize = terrain->GetDetailResolution3D();
+    mCellWidth = static_cast<float>(terrain->GetWidth()) / mSize;
+    mCellLength = static_cast<float>(terrain->GetLength()) / mSize;
+
+    int levelCount = 1;
+    while ((mSize >> levelCount) > 0) {
+        levelCount++;
+    }
+    mLevels.resize(levelCount);
+    for (int level = 0; level < levelCount; level++) {
+        int size = GetLevelSize(level);
+        mLevels[level].assign(static_cast<size_t>(size) * size * 4, 0);
+    }
+
+    // Bands of rows, one per worker; the last worker to finish builds the mips
+    int workerCount = static_cast<int>(std::thread::hardware_concurrency());
+    workerCount = std::max(1, std::min(std::min(workerCount, kMaxBakeWorkers), mSize));
+    mRunningWorkers.store(workerCount, std::memory_order_release);
+    for (int i = 0; i < workerCount; i++) {
+        int firstRow = mSize * i / workerCount;
+        int lastRow = mSize * (i + 1) / workerCount;
+        mWorkers.emplace_back([this, firstRow, lastRow]() {
+            BakeRows(firstRow, lastRow);
+
+            if (mRunningWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                BuildMipLevels();
+                mHeights.clear();
+                mReady.store(true, std::memory_order_release);
+            }
+        });
+    }
+}
+
+void TerrainNormalMap::BakeRows(int firstRow, int lastRow) {
+    const int stride = mSize + 1;
+    uint8_t* texels = mLevels[0].data();
+
+    for (int z = firstRow; z < lastRow; z++) {
+        const float* row = &mHeights[static_cast<size_t>(z) * stride];
+        const float* nextRow = row + stride;
+        for (int x = 0; x < mSize; x++) {
+            // Average slope over the cell from its four corner heights
+            float slopeX = ((row[x + 1] - row[x]) + (nextRow[x + 1] - nextRow[x])) / (2.0f * mCellWidth);
+            float slopeZ = ((nextRow[x] - row[x]) + (nextRow[x + 1] - row[x + 1])) / (2.0f * mCellLength);
+
+            // Surface y = h(x, z) with y growing towards the ground, so the
+            // normal pointing away from it is (dh/dx, -1, dh/dz)
+            StoreNormal(&texels[(static_cast<size_t>(z) * mSize + x) * 4], slopeX, -1.0f, slopeZ);
+        }
+    }
+}
+
+void TerrainNormalMap::BuildMipLevels() {
+    for (int level = 1; level < GetLevelCount(); level++) {
+        const std::vector<uint8_t>& source = mLevels[level - 1];
+        std::vector<uint8_t>& target = mLevels[level];
+        int sourceSize = GetLevelSize(level - 1);
+        int size = GetLevelSize(level);
+
+        for (int z = 0; z < size; z++) {
+            for (int x = 0; x < size; x++) {
+                float sum[3] = { 0.0f, 0.0f, 0.0f };
+                for (int corner = 0; corner < 4; corner++) {
+                    int sourceX = x * 2 + (corner & 1);
+                    int sourceZ = z * 2 + (corner >> 1);
+                    const uint8_t* texel = &source[(static_cast<size_t>(sourceZ) * sourceSize + sourceX) * 4];
+                    for (int axis = 0; axis < 3; axis++) {
+                        sum[axis] += DecodeComponent(texel[axis]);
+                    }
+                }
+                StoreNormal(&target[(static_cast<size_t>(z) * size + x) * 4], sum[0], sum[1], sum[2]);
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+// TerrainNormalMap.h
+// Normal map of the full-resolution 3D terrain, baked on worker threads
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class Terrain;
+
+// Bakes an object-space normal map from the terrain's detail height grid so
+// the coarse render mesh can be lit with the craters it does not model. One
+// texel per detail cell, with a mip chain built on the CPU (the normals are
+// renormalized per level, which hardware mipmapping would not do). Rows are
+// split between worker threads working on a private copy of the heights;
+// like TerrainOverview, Rebuild() and the accessors must be called from the
+// same thread.
+class TerrainNormalMap {
+public:
+    TerrainNormalMap();
+    ~TerrainNormalMap();
+
+    // Start baking the current terrain (waits for any previous bake)
+    void Rebuild(const Terrain* terrain);
+
+    // True once the levels of the latest Rebuild() are available
+    bool IsReady() const { return mReady.load(std::memory_order_acquire); }
+
+    // Incremented by every Rebuild(), so renderers know when to re-upload
+    unsigned int GetGeneration() const { return mGeneration; }
+
+    // RGBA texels, rows along z, x to the right. The normal n points away
+    // from the ground (world -Y) and is stored as (n * 0.5 + 0.5) * 255.
+    // Valid only when IsReady(); level 0 is the full resolution.
+    int GetLevelCount() const { return static_cast<int>(mLevels.size()); }
+    const std::vector<uint8_t>& GetLevel(int level) const { return mLevels[level]; }
+    int GetLevelSize(int level) const { return mSize >> level; }
+
+private:
+    void Wait();
+    void BakeRows(int firstRow, int lastRow);
+    void BuildMipLevels();
+
+    // Height copy owned by the workers while they run
+    std::vector<float> mHeights;
+    float mCellWidth;
+    float mCellLength;
+
+    std::vector<std::thread> mWorkers;
+    std::atomic<int> mRunningWorkers;
+    std::atomic<bool> mReady;
+    unsigned int mGeneration;
+
+    // Result
+    std::vector<std::vector<uint8_t>> mLevels;
+    int mSize;
+};
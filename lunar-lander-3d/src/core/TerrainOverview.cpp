@@ -0,0 +1,157 @@
+// TerrainOverview.cpp
+// Implementation of the minimap terrain raster
+
+#include "TerrainOverview.h"
+#include "Terrain.h"
+#include <algorithm>
+
+TerrainOverview::TerrainOverview()
+    : mReady(false)
+    , mGeneration(0)
+    , mWidth(0)
+    , mHeight(0)
+    , mUse3D(false)
+    , mWorldWidth(0.0f)
+    , mWorldHeight(0.0f)
+    , mWorldLength(0.0f)
+{
+}
+
+TerrainOverview::~TerrainOverview() {
+    Wait();
+}
+
+void TerrainOverview::Wait() {
+    if (mWorker.joinable()) {
+        mWorker.join();
+    }
+}
+
+void TerrainOverview::Rebuild(const Terrain* terrain, bool use3D) {
+    // The previous build must finish before its buffers are reused
+    Wait();
+    mReady.store(false, std::memory_order_release);
+    mGeneration++;
+
+    if (!terrain) {
+        return;
+    }
+
+    // Private copy, so the game can regenerate or query its own terrain meanwhile
+    mTerrain.reset(new Terrain(*terrain));
+    mUse3D = use3D;
+    mWorldWidth = static_cast<float>(terrain->GetWidth());
+    mWorldHeight = static_cast<float>(terrain->GetHeight());
+    mWorldLength = static_cast<float>(terrain->GetLength());
+    mWidth = use3D ? kSize3D : kWidth2D;
+    mHeight = use3D ? kSize3D : kHeight2D;
+    mPixels.assign(static_cast<size_t>(mWidth) * mHeight * 4, 0);
+
+    mWorker = std::thread([this]() {
+        if (mUse3D) {
+            Rasterize3D();
+        } else {
+            Rasterize2D();
+        }
+
+        mTerrain.reset();
+        mReady.store(true, std::memory_order_release);
+    });
+}
+
+bool TerrainOverview::WorldToMap(float x, float y, float z, float& u, float& v) const {
+    if (mWorldWidth <= 0.0f) {
+        return false;
+    }
+
+    u = x / mWorldWidth;
+    if (mUse3D) {
+        v = (mWorldLength > 0.0f) ? z / mWorldLength : 0.0f;
+    } else {
+        v = (mWorldHeight > 0.0f) ? y / mWorldHeight : 0.0f;
+    }
+
+    return u >= 0.0f && u <= 1.0f && v >= 0.0f && v <= 1.0f;
+}
+
+void TerrainOverview::SetPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    if (x < 0 || y < 0 || x >= mWidth || y >= mHeight) {
+        return;
+    }
+
+    uint8_t* pixel = &mPixels[(static_cast<size_t>(y) * mWidth + x) * 4];
+    pixel[0] = r;
+    pixel[1] = g;
+    pixel[2] = b;
+    pixel[3] = a;
+}
+
+void TerrainOverview::Rasterize2D() {
+    // Side view: one column per slice of the world, ground filled in below
+    // the surface line and the pads drawn thicker so they stand out
+    for (int x = 0; x < mWidth; x++) {
+        float worldX = (x + 0.5f) * mWorldWidth / mWidth;
+
+        float surfaceY = 0.0f;
+        int surfaceRow = mHeight;
+        if (mTerrain->GetSurfaceHeight2D(worldX, surfaceY)) {
+            surfaceRow = static_cast<int>(surfaceY / mWorldHeight * mHeight);
+        }
+        bool pad = mTerrain->IsLandingPadAt2D(worldX);
+
+        for (int y = 0; y < mHeight; y++) {
+            if (y < surfaceRow) {
+                SetPixel(x, y, 0, 0, 0, 160);
+            } else if (y == surfaceRow || (pad && y == surfaceRow + 1)) {
+                if (pad) {
+                    SetPixel(x, y, 0, 255, 0, 255);
+                } else {
+                    SetPixel(x, y, 200, 200, 200, 255);
+                }
+            } else {
+                SetPixel(x, y, 70, 70, 70, 220);
+            }
+        }
+    }
+}
+
+void TerrainOverview::Rasterize3D() {
+    // Top-down height map: sample every pixel, then shade by height
+    std::vector<float> heights(static_cast<size_t>(mWidth) * mHeight, 0.0f);
+    float lowest = 0.0f;
+    float highest = 0.0f;
+    bool first = true;
+
+    for (int y = 0; y < mHeight; y++) {
+        for (int x = 0; x < mWidth; x++) {
+            float worldX = (x + 0.5f) * mWorldWidth / mWidth;
+            float worldZ = (y + 0.5f) * mWorldLength / mHeight;
+
+            float height = 0.0f;
+            if (mTerrain->GetSurfaceHeight3D(worldX, worldZ, height)) {
+                // Y grows downwards, so larger values are lower ground
+                lowest = first ? height : std::max(lowest, height);
+                highest = first ? height : std::min(highest, height);
+                first = false;
+            }
+            heights[static_cast<size_t>(y) * mWidth + x] = height;
+        }
+    }
+
+    float range = std::max(1.0f, lowest - highest);
+    for (int y = 0; y < mHeight; y++) {
+        for (int x = 0; x < mWidth; x++) {
+            float worldX = (x + 0.5f) * mWorldWidth / mWidth;
+            float worldZ = (y + 0.5f) * mWorldLength / mHeight;
+
+            if (mTerrain->IsLandingPadAt3D(worldX, worldZ)) {
+                SetPixel(x, y, 0, 200, 0, 230);
+                continue;
+            }
+
+            float elevation = (lowest - heights[static_cast<size_t>(y) * mWidth + x]) / range;
+            uint8_t shade = static_cast<uint8_t>(60.0f + elevation * 160.0f);
+            SetPixel(x, y, shade, shade, shade, 220);
+        }
+    }
+}
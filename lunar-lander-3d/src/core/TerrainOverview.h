@@ -0,0 +1,70 @@
+// TerrainOverview.h
+// Small raster of the whole terrain for the minimap, built on a worker thread
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class Terrain;
+
+// Rasterizes the terrain once per generation: a side view of the 2D world or
+// a top-down height map of the 3D one, with the landing pads in green. The
+// work runs on a worker thread against a private copy of the terrain, so the
+// game keeps running while it is built and renderers only upload the finished
+// pixels. Rebuild() and the accessors must be called from the same thread.
+class TerrainOverview {
+public:
+    // Raster sizes (pixels)
+    static const int kWidth2D = 200;
+    static const int kHeight2D = 60;
+    static const int kSize3D = 128;
+
+    TerrainOverview();
+    ~TerrainOverview();
+
+    // Start rasterizing the current terrain (waits for any previous build)
+    void Rebuild(const Terrain* terrain, bool use3D);
+
+    // True once the pixels of the latest Rebuild() are available
+    bool IsReady() const { return mReady.load(std::memory_order_acquire); }
+
+    // Incremented by every Rebuild(), so renderers know when to re-upload
+    unsigned int GetGeneration() const { return mGeneration; }
+
+    // RGBA pixels, row by row from the top (valid only when IsReady())
+    const std::vector<uint8_t>& GetPixels() const { return mPixels; }
+    int GetWidth() const { return mWidth; }
+    int GetHeight() const { return mHeight; }
+    bool Is3D() const { return mUse3D; }
+
+    // Map a world position to 0..1 overview coordinates (x and y in 2D,
+    // x and z in 3D). Returns false when the position is off the map.
+    bool WorldToMap(float x, float y, float z, float& u, float& v) const;
+
+private:
+    void Wait();
+    void Rasterize2D();
+    void Rasterize3D();
+    void SetPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+
+    // Terrain copy owned by the worker while it runs
+    std::unique_ptr<Terrain> mTerrain;
+    std::thread mWorker;
+    std::atomic<bool> mReady;
+    unsigned int mGeneration;
+
+    // Result
+    std::vector<uint8_t> mPixels;
+    int mWidth;
+    int mHeight;
+    bool mUse3D;
+
+    // World extent covered by the raster
+    float mWorldWidth;
+    float mWorldHeight;
+    float mWorldLength;
+};
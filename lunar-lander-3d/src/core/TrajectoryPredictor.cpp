@@ -0,0 +1,175 @@
+// TrajectoryPredictor.cpp
+// Implementation of the incremental trajectory prediction
+
+#include "TrajectoryPredictor.h"
+#include "Entity.h"
+#include "Physics.h"
+#include "Terrain.h"
+#include <cmath>
+
+constexpr float TrajectoryPredictor::kHorizon;
+constexpr float TrajectoryPredictor::kStep;
+constexpr float TrajectoryPredictor::kDriftTolerance;
+
+TrajectoryPredictor::TrajectoryPredictor()
+    : mFirst(0)
+    , mTail()
+    , mValid(false)
+    , mThrustLevel(0.0f)
+    , mGravityAcceleration(0.0f)
+    , mThrustAcceleration(0.0f)
+    , mFuelRate(0.0f)
+    , mHalfHeight(0.0f)
+    , mHasImpact(false)
+    , mImpactOnLandingPad(false)
+{
+    mImpactPoint[0] = mImpactPoint[1] = mImpactPoint[2] = 0.0f;
+
+    // Room for the whole horizon so extending never reallocates
+    mPoints.reserve(static_cast<size_t>(2.0f * kHorizon / kStep) + 2);
+}
+
+void TrajectoryPredictor::Invalidate() {
+    mPoints.clear();
+    mFirst = 0;
+    mValid = false;
+    mHasImpact = false;
+}
+
+void TrajectoryPredictor::Update(const Lander* lander, const Physics* physics, const Terrain* terrain,
+                                 bool use3D, float elapsedTime) {
+    if (!lander || !physics || !terrain) {
+        Invalidate();
+        return;
+    }
+
+    // Inputs the prediction depends on
+    float thrustLevel = lander->IsThrustActive() ? lander->GetThrustLevel() : 0.0f;
+    float gravity = physics->GetGravityAcceleration();
+    bool inputsChanged = !mValid || thrustLevel != mThrustLevel || gravity != mGravityAcceleration;
+
+    if (inputsChanged || HasDrifted(lander, elapsedTime)) {
+        // Recompute everything ahead of the lander's current state
+        mThrustLevel = thrustLevel;
+        mGravityAcceleration = gravity;
+        mThrustAcceleration = physics->GetThrustAcceleration(1.0f);
+        mFuelRate = lander->GetFuelConsumptionRate();
+        mHalfHeight = lander->GetHeight() / 2;
+        Restart(lander, elapsedTime);
+    } else {
+        // Still on course: drop the points the lander has passed
+        while (mFirst + 1 < mPoints.size() && mPoints[mFirst + 1].time <= elapsedTime) {
+            mFirst++;
+        }
+
+        // Compact once most of the buffer has been passed
+        if (mFirst > mPoints.size() / 2) {
+            mPoints.erase(mPoints.begin(), mPoints.begin() + mFirst);
+            mFirst = 0;
+        }
+    }
+
+    // Only the end of the path is new work
+    Extend(terrain, use3D, elapsedTime + kHorizon);
+}
+
+void TrajectoryPredictor::Restart(const Lander* lander, float elapsedTime) {
+    mPoints.clear();
+    mFirst = 0;
+    mHasImpact = false;
+    mImpactOnLandingPad = false;
+
+    const float* position = lander->GetPosition();
+    const float* velocity = lander->GetVelocity();
+    for (int i = 0; i < 3; i++) {
+        mTail.position[i] = position[i];
+        mTail.velocity[i] = velocity[i];
+    }
+    mTail.fuel = lander->GetFuel();
+    mTail.time = elapsedTime;
+
+    AppendPoint(mTail);
+    mValid = true;
+}
+
+void TrajectoryPredictor::Extend(const Terrain* terrain, bool use3D, float endTime) {
+    while (!mHasImpact && mTail.time < endTime) {
+        // Ballistic step with the same forces as Physics::ApplyGravity/ApplyThrust
+        float thrust = (mTail.fuel > 0.0f) ? mThrustAcceleration * mThrustLevel : 0.0f;
+        mTail.velocity[1] += (mGravityAcceleration - thrust) * kStep;
+
+        // Physics::Update2D and Lander::Update both advance x and y each tick
+        mTail.position[0] += 2.0f * mTail.velocity[0] * kStep;
+        mTail.position[1] += 2.0f * mTail.velocity[1] * kStep;
+        mTail.position[2] += mTail.velocity[2] * kStep;
+
+        if (thrust > 0.0f) {
+            mTail.fuel -= mFuelRate * mThrustLevel * kStep;
+        }
+        mTail.time += kStep;
+
+        // Stop at the terrain, using the same contact rule as the collision checks
+        float surfaceHeight = 0.0f;
+        if (use3D) {
+            if (terrain->GetSurfaceHeight3D(mTail.position[0], mTail.position[2], surfaceHeight) &&
+                mTail.position[1] + mHalfHeight >= surfaceHeight) {
+                mHasImpact = true;
+                mImpactOnLandingPad = terrain->IsLandingPadAt3D(mTail.position[0], mTail.position[2]);
+            }
+        } else {
+            if (terrain->GetSurfaceHeight2D(mTail.position[0], surfaceHeight) &&
+                mTail.position[1] - mHalfHeight >= surfaceHeight) {
+                mHasImpact = true;
+                mImpactOnLandingPad = terrain->IsLandingPadAt2D(mTail.position[0]);
+            }
+        }
+
+        if (mHasImpact) {
+            mImpactPoint[0] = mTail.position[0];
+            mImpactPoint[1] = surfaceHeight;
+            mImpactPoint[2] = mTail.position[2];
+        }
+
+        AppendPoint(mTail);
+    }
+}
+
+bool TrajectoryPredictor::HasDrifted(const Lander* lander, float elapsedTime) const {
+    if (mFirst >= mPoints.size()) {
+        return true;
+    }
+
+    // Find the cached segment that covers the current time
+    size_t index = mFirst;
+    while (index + 1 < mPoints.size() && mPoints[index + 1].time <= elapsedTime) {
+        index++;
+    }
+
+    const TrajectoryPoint& from = mPoints[index];
+    if (elapsedTime < from.time || index + 1 >= mPoints.size()) {
+        return true;  // Time moved backwards or past the cached path
+    }
+
+    const TrajectoryPoint& to = mPoints[index + 1];
+    float t = (elapsedTime - from.time) / (to.time - from.time);
+
+    // Compare the predicted position with where the lander actually is
+    const float* position = lander->GetPosition();
+    float distanceSquared = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float predicted = from.position[i] + (to.position[i] - from.position[i]) * t;
+        float difference = position[i] - predicted;
+        distanceSquared += difference * difference;
+    }
+
+    return distanceSquared > kDriftTolerance * kDriftTolerance;
+}
+
+void TrajectoryPredictor::AppendPoint(const State& state) {
+    TrajectoryPoint point;
+    point.position[0] = state.position[0];
+    point.position[1] = state.position[1];
+    point.position[2] = state.position[2];
+    point.time = state.time;
+    mPoints.push_back(point);
+}
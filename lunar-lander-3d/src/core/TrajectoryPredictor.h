@@ -0,0 +1,79 @@
+// TrajectoryPredictor.h
+// Forward simulation of the lander's path for the predicted-path overlay
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+class Lander;
+class Physics;
+class Terrain;
+
+// One sample of the predicted path
+struct TrajectoryPoint {
+    float position[3];
+    float time;  // Simulated time the lander reaches this point
+};
+
+// Predicts where the lander will be over the next few seconds if the
+// current throttle is held. The path is cached between frames: while the
+// throttle stays the same and the lander follows the prediction, only the
+// points it has passed are dropped and the end of the path is extended.
+class TrajectoryPredictor {
+public:
+    static constexpr float kHorizon = 5.0f;         // Seconds to look ahead
+    static constexpr float kStep = 1.0f / 30.0f;    // Prediction time step
+    static constexpr float kDriftTolerance = 1.0f;  // Max deviation before recomputing
+
+    TrajectoryPredictor();
+    ~TrajectoryPredictor() = default;
+
+    // Bring the prediction up to date with the lander at the given time
+    void Update(const Lander* lander, const Physics* physics, const Terrain* terrain,
+                bool use3D, float elapsedTime);
+
+    // Drop the cached path (e.g. after a reset or rewind)
+    void Invalidate();
+
+    // Path access (points before GetFirstIndex() have already been passed)
+    const std::vector<TrajectoryPoint>& GetPoints() const { return mPoints; }
+    size_t GetFirstIndex() const { return mFirst; }
+
+    // Predicted touchdown, if it happens within the horizon
+    bool HasImpact() const { return mHasImpact; }
+    const float* GetImpactPoint() const { return mImpactPoint; }
+    bool IsImpactOnLandingPad() const { return mImpactOnLandingPad; }
+
+private:
+    // Full integration state at the end of the cached path
+    struct State {
+        float position[3];
+        float velocity[3];
+        float fuel;
+        float time;
+    };
+
+    void Restart(const Lander* lander, float elapsedTime);
+    void Extend(const Terrain* terrain, bool use3D, float endTime);
+    bool HasDrifted(const Lander* lander, float elapsedTime) const;
+    void AppendPoint(const State& state);
+
+    // Cached path
+    std::vector<TrajectoryPoint> mPoints;
+    size_t mFirst;
+    State mTail;
+    bool mValid;
+
+    // Inputs the path was computed for
+    float mThrustLevel;
+    float mGravityAcceleration;
+    float mThrustAcceleration;
+    float mFuelRate;
+    float mHalfHeight;
+
+    // Touchdown
+    bool mHasImpact;
+    bool mImpactOnLandingPad;
+    float mImpactPoint[3];
+};
@@ -0,0 +1,318 @@
+// WindField.cpp
+// Implementation of the noise-volume wind field
+
+#include "WindField.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define WIND_SSE 1
+#endif
+
+// Noise volume cells per axis (a power of two), and floats per cell
+static const int kVolumeSize = 16;
+static const int kCellFloats = 4;
+
+// Cells per correlation length (and per correlation time): the volume
+// tiles about every kVolumeSize / kCellsPerLength correlation lengths
+static const float kCellsPerLength = 2.0f;
+
+// Interpolating between cells stretches the correlation; sampling the
+// volume this much faster brings the integral scale back to the
+// requested length (and time)
+static const float kInterpolationStretch = 1.2f;
+
+// Where the gust octave reads the volume, away from the turbulence octave
+static const float kGustOffset[4] = { 5.5f, 9.25f, 2.75f, 11.5f };
+
+constexpr float WindParameters::kMarsAirDensity;
+
+WindParameters WindParameters::Mars() {
+    WindParameters parameters;
+    parameters.meanWind[0] = 8.0f;
+    parameters.turbulenceIntensity = 3.0f;
+    parameters.gustIntensity = 6.0f;
+    return parameters;
+}
+
+// Floats between neighbouring cells along x, y, z and time
+static const int kAxisStrides[4] = {
+    kCellFloats,
+    kCellFloats * kVolumeSize,
+    kCellFloats * kVolumeSize * kVolumeSize,
+    kCellFloats * kVolumeSize * kVolumeSize * kVolumeSize
+};
+
+// Corner offsets (in floats) along each axis, and interpolation weights,
+// of one lookup
+struct CellLookup {
+    int offsets[4][2];
+    float fraction[4];
+};
+
+// Cells of one axis, wrapped into the volume
+static inline void SetLookupAxis(int cell, int axis, CellLookup& lookup) {
+    lookup.offsets[axis][0] = (cell & (kVolumeSize - 1)) * kAxisStrides[axis];
+    lookup.offsets[axis][1] = ((cell + 1) & (kVolumeSize - 1)) * kAxisStrides[axis];
+}
+
+#ifdef WIND_SSE
+// Floor each volume coordinate: truncate, then step down where that rounded up
+static inline __m128 Floor(__m128 coordinates, __m128i& cells) {
+    cells = _mm_cvttps_epi32(coordinates);
+    __m128i roundedUp = _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(cells), coordinates));
+    cells = _mm_add_epi32(cells, roundedUp);
+    return _mm_cvtepi32_ps(cells);
+}
+
+// Lookup of the volume coordinates x, y, z, time in the four lanes
+static void Locate(__m128 coordinates, CellLookup& lookup) {
+    __m128i cells;
+    __m128 cell = Floor(coordinates, cells);
+    int cellArray[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(cellArray), cells);
+    _mm_storeu_ps(lookup.fraction, _mm_sub_ps(coordinates, cell));
+    for (int axis = 0; axis < 4; axis++) {
+        SetLookupAxis(cellArray[axis], axis, lookup);
+    }
+}
+#else
+static void Locate(const float* coordinates, CellLookup& lookup) {
+    for (int axis = 0; axis < 4; axis++) {
+        float cell = std::floor(coordinates[axis]);
+        lookup.fraction[axis] = coordinates[axis] - cell;
+        SetLookupAxis(static_cast<int>(cell), axis, lookup);
+    }
+}
+#endif
+
+// First-order filter around a periodic sequence; the gain keeps unit
+// variance. The first lap only settles the filter into its periodic state.
+static void FilterPeriodic(float* values, int count, int stride, float pole) {
+    const float gain = std::sqrt(1.0f - pole * pole);
+    float state = 0.0f;
+    for (int lap = 0; lap < 2; lap++) {
+        for (int i = 0; i < count; i++) {
+            state = pole * state + gain * values[i * stride];
+            if (lap == 1) {
+                values[i * stride] = state;
+            }
+        }
+    }
+}
+
+#ifdef WIND_SSE
+static inline __m128 Lerp(__m128 a, __m128 b, __m128 t) {
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+// The 16 corners around a lookup, interpolated along x, y, z then time
+static __m128 Interpolate(const float* cells, const CellLookup& lookup) {
+    const __m128 fx = _mm_set1_ps(lookup.fraction[0]);
+    const __m128 fy = _mm_set1_ps(lookup.fraction[1]);
+    const __m128 fz = _mm_set1_ps(lookup.fraction[2]);
+    __m128 slices[2];
+    for (int t = 0; t < 2; t++) {
+        __m128 planes[2];
+        for (int z = 0; z < 2; z++) {
+            const float* row0 = cells + lookup.offsets[3][t] + lookup.offsets[2][z] + lookup.offsets[1][0];
+            const float* row1 = cells + lookup.offsets[3][t] + lookup.offsets[2][z] + lookup.offsets[1][1];
+            __m128 near = Lerp(_mm_loadu_ps(row0 + lookup.offsets[0][0]), _mm_loadu_ps(row0 + lookup.offsets[0][1]), fx);
+            __m128 far = Lerp(_mm_loadu_ps(row1 + lookup.offsets[0][0]), _mm_loadu_ps(row1 + lookup.offsets[0][1]), fx);
+            planes[z] = Lerp(near, far, fy);
+        }
+        slices[t] = Lerp(planes[0], planes[1], fz);
+    }
+    return Lerp(slices[0], slices[1], _mm_set1_ps(lookup.fraction[3]));
+}
+#else
+static void Interpolate(const float* cells, const CellLookup& lookup, float* result) {
+    for (int c = 0; c < 3; c++) {
+        float slices[2];
+        for (int t = 0; t < 2; t++) {
+            float planes[2];
+            for (int z = 0; z < 2; z++) {
+                float rows[2];
+                for (int y = 0; y < 2; y++) {
+                    const float* row = cells + lookup.offsets[3][t] + lookup.offsets[2][z] + lookup.offsets[1][y] + c;
+                    float a = row[lookup.offsets[0][0]];
+                    rows[y] = a + (row[lookup.offsets[0][1]] - a) * lookup.fraction[0];
+                }
+                planes[z] = rows[0] + (rows[1] - rows[0]) * lookup.fraction[1];
+            }
+            slices[t] = planes[0] + (planes[1] - planes[0]) * lookup.fraction[2];
+        }
+        result[c] = slices[0] + (slices[1] - slices[0]) * lookup.fraction[3];
+    }
+}
+#endif
+
+WindField::WindField() {
+    for (Octave& octave : mOctaves) {
+        std::fill(octave.rate, octave.rate + 4, 0.0f);
+        std::fill(octave.offset, octave.offset + 4, 0.0f);
+        std::fill(octave.scale, octave.scale + 4, 0.0f);
+    }
+}
+
+bool WindField::Initialize(const WindParameters& parameters) {
+    if (parameters.turbulenceLength <= 0.0f || parameters.turbulenceTime <= 0.0f ||
+        parameters.gustLength <= 0.0f || parameters.gustTime <= 0.0f) {
+        std::cerr << "Wind length and time scales must be positive" << std::endl;
+        return false;
+    }
+    mParameters = parameters;
+
+    // White noise, then the Dryden shaping filter along x, y, z and time
+    const int cellCount = kVolumeSize * kVolumeSize * kVolumeSize * kVolumeSize;
+    mCells.assign(cellCount * kCellFloats, 0.0f);
+    std::mt19937 random(parameters.seed);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    for (int cell = 0; cell < cellCount; cell++) {
+        for (int c = 0; c < 3; c++) {
+            mCells[cell * kCellFloats + c] = noise(random);
+        }
+    }
+
+    const float pole = std::exp(-1.0f / kCellsPerLength);
+    for (int axis = 0, stride = 1; axis < 4; axis++, stride *= kVolumeSize) {
+        for (int cell = 0; cell < cellCount; cell++) {
+            if ((cell / stride) % kVolumeSize != 0) {
+                continue;
+            }
+            for (int c = 0; c < 3; c++) {
+                FilterPeriodic(&mCells[cell * kCellFloats + c], kVolumeSize, stride * kCellFloats, pole);
+            }
+        }
+    }
+
+    // Back to exactly unit variance per component, and make up for the
+    // variance linear interpolation loses between correlated cells
+    // (on average (2 + pole) / 3 per axis)
+    const float interpolationGain = 1.0f / std::pow((2.0f + pole) / 3.0f, 2.0f);
+    for (int c = 0; c < 3; c++) {
+        double sum = 0.0;
+        for (int cell = 0; cell < cellCount; cell++) {
+            sum += mCells[cell * kCellFloats + c] * mCells[cell * kCellFloats + c];
+        }
+        float normalize = interpolationGain / static_cast<float>(std::sqrt(sum / cellCount));
+        for (int cell = 0; cell < cellCount; cell++) {
+            mCells[cell * kCellFloats + c] *= normalize;
+        }
+    }
+
+    // Horizontal components get the full intensity; world Y is vertical
+    Octave& turbulence = mOctaves[0];
+    std::fill(turbulence.rate, turbulence.rate + 3, kCellsPerLength * kInterpolationStretch / parameters.turbulenceLength);
+    turbulence.rate[3] = kCellsPerLength * kInterpolationStretch / parameters.turbulenceTime;
+    std::fill(turbulence.offset, turbulence.offset + 4, 0.0f);
+    turbulence.scale[0] = turbulence.scale[2] = parameters.turbulenceIntensity;
+    turbulence.scale[1] = parameters.turbulenceIntensity * parameters.verticalRatio;
+    turbulence.scale[3] = 0.0f;
+
+    Octave& gust = mOctaves[1];
+    std::fill(gust.rate, gust.rate + 3, kCellsPerLength * kInterpolationStretch / parameters.gustLength);
+    gust.rate[3] = kCellsPerLength * kInterpolationStretch / parameters.gustTime;
+    std::copy(kGustOffset, kGustOffset + 4, gust.offset);
+    gust.scale[0] = gust.scale[2] = parameters.gustIntensity;
+    gust.scale[1] = parameters.gustIntensity * parameters.verticalRatio;
+    gust.scale[3] = 0.0f;
+    return true;
+}
+
+void WindField::Sample(const float* position, float time, float* wind) const {
+    if (mCells.empty()) {
+        std::copy(mParameters.meanWind, mParameters.meanWind + 3, wind);
+        return;
+    }
+
+#ifdef WIND_SSE
+    const __m128 point = _mm_setr_ps(position[0], position[1], position[2], time);
+    __m128 sum = _mm_setr_ps(mParameters.meanWind[0], mParameters.meanWind[1], mParameters.meanWind[2], 0.0f);
+    for (const Octave& octave : mOctaves) {
+        CellLookup lookup;
+        Locate(_mm_add_ps(_mm_mul_ps(point, _mm_loadu_ps(octave.rate)), _mm_loadu_ps(octave.offset)), lookup);
+        sum = _mm_add_ps(sum, _mm_mul_ps(Interpolate(mCells.data(), lookup), _mm_loadu_ps(octave.scale)));
+    }
+    float result[4];
+    _mm_storeu_ps(result, sum);
+    std::copy(result, result + 3, wind);
+#else
+    const float point[4] = { position[0], position[1], position[2], time };
+    std::copy(mParameters.meanWind, mParameters.meanWind + 3, wind);
+    for (const Octave& octave : mOctaves) {
+        float coordinates[4];
+        for (int axis = 0; axis < 4; axis++) {
+            coordinates[axis] = point[axis] * octave.rate[axis] + octave.offset[axis];
+        }
+        CellLookup lookup;
+        Locate(coordinates, lookup);
+        float noise[3];
+        Interpolate(mCells.data(), lookup, noise);
+        for (int c = 0; c < 3; c++) {
+            wind[c] += noise[c] * octave.scale[c];
+        }
+    }
+#endif
+}
+
+void WindField::SampleBatch(int count, const float* x, const float* y, const float* z, const float* time,
+                            float* windX, float* windY, float* windZ) const {
+    int first = 0;
+#ifdef WIND_SSE
+    if (!mCells.empty()) {
+        const __m128 mean = _mm_setr_ps(mParameters.meanWind[0], mParameters.meanWind[1], mParameters.meanWind[2], 0.0f);
+
+        // Four landers at a time: cell coordinates, floors and fractions
+        // with a lander per lane, then each lander's corners as one vector
+        // per cell
+        for (; first + 4 <= count; first += 4) {
+            const __m128 inputs[4] = {
+                _mm_loadu_ps(x + first), _mm_loadu_ps(y + first), _mm_loadu_ps(z + first), _mm_loadu_ps(time + first)
+            };
+            __m128 sums[4] = { mean, mean, mean, mean };
+
+            for (const Octave& octave : mOctaves) {
+                CellLookup lookups[4];
+                for (int axis = 0; axis < 4; axis++) {
+                    __m128 coordinate = _mm_add_ps(_mm_mul_ps(inputs[axis], _mm_set1_ps(octave.rate[axis])),
+                                                   _mm_set1_ps(octave.offset[axis]));
+                    __m128i cells;
+                    __m128 cell = Floor(coordinate, cells);
+                    int cellArray[4];
+                    float fractions[4];
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(cellArray), cells);
+                    _mm_storeu_ps(fractions, _mm_sub_ps(coordinate, cell));
+                    for (int lane = 0; lane < 4; lane++) {
+                        lookups[lane].fraction[axis] = fractions[lane];
+                        SetLookupAxis(cellArray[lane], axis, lookups[lane]);
+                    }
+                }
+
+                const __m128 scale = _mm_loadu_ps(octave.scale);
+                for (int lane = 0; lane < 4; lane++) {
+                    sums[lane] = _mm_add_ps(sums[lane], _mm_mul_ps(Interpolate(mCells.data(), lookups[lane]), scale));
+                }
+            }
+
+            // One vector per lander to one vector per component
+            _MM_TRANSPOSE4_PS(sums[0], sums[1], sums[2], sums[3]);
+            _mm_storeu_ps(windX + first, sums[0]);
+            _mm_storeu_ps(windY + first, sums[1]);
+            _mm_storeu_ps(windZ + first, sums[2]);
+        }
+    }
+#endif
+
+    for (int i = first; i < count; i++) {
+        const float position[3] = { x[i], y[i], z[i] };
+        float wind[3];
+        Sample(position, time[i], wind);
+        windX[i] = wind[0];
+        windY[i] = wind[1];
+        windZ[i] = wind[2];
+    }
+}
@@ -0,0 +1,69 @@
+// WindField.h
+// Spatio-temporal wind: steady wind, Dryden turbulence and large-scale gusts
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Wind statistics in world units and seconds
+struct WindParameters {
+    float meanWind[3] = { 0.0f, 0.0f, 0.0f };
+
+    // Dryden turbulence: RMS speed of the horizontal components (the
+    // vertical one is scaled by verticalRatio), correlation length and time
+    float turbulenceIntensity = 0.0f;
+    float turbulenceLength = 60.0f;
+    float turbulenceTime = 4.0f;
+
+    // Gusts: the same field sampled at a much larger, slower scale
+    float gustIntensity = 0.0f;
+    float gustLength = 800.0f;
+    float gustTime = 30.0f;
+
+    float verticalRatio = 0.5f;
+    uint32_t seed = 1;
+
+    // Near-surface conditions of a Martian afternoon
+    static WindParameters Mars();
+
+    // Mars surface air density (kg/m³), for Physics::SetAirDensity()
+    static constexpr float kMarsAirDensity = 0.020f;
+};
+
+// Samples the wind from one precomputed noise volume that tiles in x, y, z
+// and time. The volume holds unit-variance white noise passed through a
+// first-order (Dryden-form) filter along each axis, and stores each cell's
+// three components padded to four floats, so a lookup is 16 vector loads
+// interpolated trilinearly in space and linearly between time slices.
+// Turbulence and gusts are two lookups of the volume at different scales.
+// The field is read-only after Initialize() and can be shared by threads.
+class WindField {
+public:
+    WindField();
+
+    bool Initialize(const WindParameters& parameters);
+    bool IsInitialized() const { return !mCells.empty(); }
+    const WindParameters& GetParameters() const { return mParameters; }
+
+    // Wind at a world position and time
+    void Sample(const float* position, float time, float* wind) const;
+
+    // Wind for a batch of landers (structure of arrays), four at a time
+    void SampleBatch(int count, const float* x, const float* y, const float* z, const float* time,
+                     float* windX, float* windY, float* windZ) const;
+
+private:
+    // One scale at which the volume is sampled
+    struct Octave {
+        float rate[4];    // Volume cells per world unit (x, y, z) and per second
+        float offset[4];  // Volume coordinates added to x, y, z, time
+        float scale[4];   // Per-component RMS; the pad lane is zero
+    };
+
+    static const int kOctaveCount = 2;  // Turbulence, gusts
+
+    WindParameters mParameters;
+    std::vector<float> mCells;  // [t][z][y][x] cells of x, y, z, pad
+    Octave mOctaves[kOctaveCount];
+};
@@ -29,34 +29,59 @@ void InputHandler::ProcessInput() {
     // Process SDL events
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
-        switch (event.type) {
-            case SDL_QUIT:
-                // Handle window close
-                if (mGame) {
-                    mGame->OnKeyDown(SDLK_ESCAPE); // Simulate ESC key press
-                }
-                break;
-                
-            case SDL_KEYDOWN:
-                // Handle key down events
-                if (mGame) {
-                    mGame->OnKeyDown(event.key.keysym.sym);
-                }
-                break;
-                
-            case SDL_KEYUP:
-                // Handle key up events
-                if (mGame) {
-                    mGame->OnKeyUp(event.key.keysym.sym);
-                }
-                break;
-        }
+        HandleEvent(event);
     }
     
     // Game-specific input handling can be done here
     // For example, checking if thrust is active and notifying the game
 }
 
+bool InputHandler::WaitForInput(int timeoutMs) {
+    // Sleep in SDL until something happens
+    SDL_Event event;
+    if (!SDL_WaitEventTimeout(&event, timeoutMs)) {
+        return false;
+    }
+    
+    HandleEvent(event);
+    
+    // Drain anything that arrived with it
+    while (SDL_PollEvent(&event)) {
+        HandleEvent(event);
+    }
+    
+    mKeyboardState = SDL_GetKeyboardState(nullptr);
+    return true;
+}
+
+void InputHandler::HandleEvent(const SDL_Event& event) {
+    if (!mGame) {
+        return;
+    }
+    
+    switch (event.type) {
+        case SDL_QUIT:
+            // Handle window close
+            mGame->OnKeyDown(SDLK_ESCAPE); // Simulate ESC key press
+            break;
+            
+        case SDL_KEYDOWN:
+            // Handle key down events
+            mGame->OnKeyDown(event.key.keysym.sym);
+            break;
+            
+        case SDL_KEYUP:
+            // Handle key up events
+            mGame->OnKeyUp(event.key.keysym.sym);
+            break;
+            
+        case SDL_WINDOWEVENT:
+            // Handle minimize, focus and expose events
+            mGame->OnWindowEvent(event.window.event);
+            break;
+    }
+}
+
 bool InputHandler::IsKeyPressed(SDL_Scancode key) const {
     return mKeyboardState[key] != 0;
 }
@@ -17,6 +17,10 @@ public:
     // Process input events
     void ProcessInput();
     
+    // Block until an event arrives or the timeout (ms) expires, then process
+    // it and any queued events. Returns true if an event was handled.
+    bool WaitForInput(int timeoutMs);
+    
     // Check if a key is currently pressed
     bool IsKeyPressed(SDL_Scancode key) const;
     
@@ -43,4 +47,7 @@ private:
     
     // Initialize default key bindings
     void InitializeKeyBindings();
+    
+    // Forward one SDL event to the game
+    void HandleEvent(const SDL_Event& event);
 };
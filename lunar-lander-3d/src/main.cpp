@@ -2,24 +2,209 @@
 // Entry point for the lunar lander simulation
 
 #include "core/Game.h"
+#include "core/BatchRunner.h"
+#include "core/Metrics.h"
+#include "core/MetricsServer.h"
+#include "core/Physics.h"
+#include "core/Replay.h"
+#include <cstdlib>
 #include <iostream>
+#include <sstream>
+
+// Random faults per simulated minute when --faults is given without a rate
+static const float kDefaultFaultRate = 2.0f;
+
+// Largest difference a resimulated keyframe may have from the recorded one
+static const float kReplayVerifyTolerance = 1e-3f;
+
+// Comma-separated fault names, or "all", to a mask of FaultType bits
+static bool ParseFaultList(const std::string& list, uint32_t& mask) {
+    mask = 0;
+    std::stringstream stream(list);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        FaultType type;
+        if (name == "all") {
+            mask |= (1u << static_cast<int>(FaultType::Count)) - 1;
+        } else if (name == "none") {
+            // Explicitly no random faults
+        } else if (ParseFaultType(name, type)) {
+            mask |= 1u << static_cast<int>(type);
+        } else {
+            std::cerr << "Unknown fault: " << name << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check that a recorded flight resimulates to its own keyframes
+static bool VerifyReplay(const std::string& path) {
+    ReplayReader reader;
+    if (!reader.Open(path)) {
+        return false;
+    }
+    
+    Terrain terrain;
+    Lander lander;
+    Physics physics;
+    WindField wind;
+    terrain.SetVerbose(false);
+    physics.SetVerbose(false);
+    reader.GenerateTerrain(&terrain);
+    if (!reader.AttachWind(&physics, &wind)) {
+        return false;
+    }
+    physics.RegisterLander(&lander);
+    physics.RegisterTerrain(&terrain);
+    
+    float maxError = 0.0f;
+    size_t mismatches = reader.VerifyKeyframes(&lander, &physics, kReplayVerifyTolerance, &maxError);
+    std::cout << path << ": " << reader.GetTickCount() << " ticks, " << reader.GetKeyframeCount()
+              << " keyframes, " << mismatches << " mismatched (largest error " << maxError << ")" << std::endl;
+    return mismatches == 0;
+}
 
 int main(int argc, char* argv[]) {
-    // Check for 3D mode command line argument
+    // Parse command line arguments
     bool use3DMode = false;
+    bool useVulkan = false;
+    std::string replayPath;
+    std::string verifyPath;
+    bool usePerfCounters = false;
+    int metricsPort = -1;
+    std::string sharedStateName;
+    std::string controllerPath;
+    std::string controllerConfig;
+    int batchEpisodes = 0;
+    BatchConfig batch;
+    float faultRate = kDefaultFaultRate;
+    std::string batchOption;  // An option that only configures the batch
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--3d" || arg == "-3d") {
             use3DMode = true;
-            break;
+        } else if (arg == "--vulkan") {
+            // Vulkan backend for the 3D view
+            use3DMode = true;
+            useVulkan = true;
+        } else if (arg == "--record" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--replay-verify" && i + 1 < argc) {
+            verifyPath = argv[++i];
+        } else if (arg == "--controller" && i + 1 < argc) {
+            controllerPath = argv[++i];
+        } else if (arg == "--controller-config" && i + 1 < argc) {
+            controllerConfig = argv[++i];
+        } else if (arg == "--shm" && i + 1 < argc) {
+            sharedStateName = argv[++i];
+        } else if (arg == "--perf") {
+            usePerfCounters = true;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchEpisodes = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            batch.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            batchOption = arg;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            batch.threadCount = std::atoi(argv[++i]);
+            batchOption = arg;
+        } else if (arg == "--faults" && i + 1 < argc) {
+            if (!ParseFaultList(argv[++i], batch.faults.randomTypes)) {
+                return 1;
+            }
+            batchOption = arg;
+        } else if (arg == "--fault-rate" && i + 1 < argc) {
+            faultRate = static_cast<float>(std::atof(argv[++i]));
+            batchOption = arg;
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            metricsPort = std::atoi(argv[++i]);
+            batchOption = arg;
+        } else if (arg == "--thrusters") {
+            // Engine and RCS thrusters through the control allocator
+            batch.allocateThrusters = true;
+            batchOption = arg;
+        } else if (arg == "--check-vision") {
+            // Packet against scalar ray tracing of lander camera images
+            batch.checkVision = true;
+            batchOption = arg;
+        } else if (arg == "--wind") {
+            // Martian atmosphere and winds
+            batch.airDensity = WindParameters::kMarsAirDensity;
+            batch.windEnabled = true;
+            batch.wind = WindParameters::Mars();
         }
     }
     
+    // The game would silently ignore these
+    if (batchEpisodes <= 0 && !batchOption.empty()) {
+        std::cerr << batchOption << " only applies with --batch" << std::endl;
+        return 1;
+    }
+    
+    // Check a recording instead of playing
+    if (!verifyPath.empty()) {
+        return VerifyReplay(verifyPath) ? 0 : 1;
+    }
+    
+    // Headless robustness sweep instead of the game
+    if (batchEpisodes > 0) {
+        batch.episodeCount = batchEpisodes;
+        batch.faults.randomRate = faultRate / 60.0f;
+        batch.wind.seed = batch.seed;
+        batch.controllerPath = controllerPath;
+        batch.controllerConfig = controllerConfig;
+        
+        BatchRunner runner;
+        
+        // Prometheus metrics on localhost while the batch runs
+        MetricsRegistry metrics;
+        MetricsServer metricsServer;
+        if (metricsPort >= 0) {
+            metrics.AddProcessMetrics();
+            runner.SetMetrics(&metrics);
+            if (!metricsServer.Start(metrics, metricsPort)) {
+                return 1;
+            }
+            std::cout << "Metrics at http://127.0.0.1:" << metricsServer.GetPort() << "/metrics" << std::endl;
+        }
+        
+        BatchReport report;
+        if (!runner.Run(batch, report)) {
+            return 1;
+        }
+        BatchRunner::PrintReport(report, std::cout);
+        return report.visionMismatches > 0 ? 1 : 0;
+    }
+    
     // Create the game instance
     Game game;
     
     // Set rendering mode
     game.SetRenderingMode(use3DMode);
+    game.SetVulkanBackend(useVulkan);
+    
+    // Record flights to a replay file if requested
+    if (!replayPath.empty()) {
+        game.SetReplayPath(replayPath);
+    }
+    
+    // Profile frame phases if requested
+    game.SetPerfCounters(usePerfCounters);
+    
+    // Fly with a controller plugin if requested
+    if (!controllerPath.empty()) {
+        game.SetController(controllerPath, controllerConfig);
+    }
+    
+    // Publish live state for external tools if requested
+    if (!sharedStateName.empty()) {
+        game.SetSharedStateName(sharedStateName);
+    }
+    
+    // Fly through an atmosphere and its wind if requested
+    if (batch.windEnabled) {
+        game.SetWind(batch.wind, batch.airDensity);
+    }
     
     // Initialize the game
     bool success = game.Initialize();
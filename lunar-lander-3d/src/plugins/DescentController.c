@@ -0,0 +1,80 @@
+// DescentController.c
+// Example controller plugin: the batch runner's descent autopilot as a plugin
+//
+// Build as a shared library (the DescentController target) and fly with
+//   ./LunarLander --controller ./DescentController.so
+// Settings come from --controller-config, e.g. "gain=0.25 deadband=2".
+
+#include "../core/ControllerAbi.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Thrust while sinking faster than minSinkRate plus gain per unit of
+// altitude, and keep the tilt inside deadband degrees
+typedef struct DescentSettings {
+    float minSinkRate;
+    float gain;
+    float deadband;
+} DescentSettings;
+
+static void ParseSettings(const char* config, DescentSettings* settings) {
+    const char* keys[] = { "min-sink=", "gain=", "deadband=" };
+    float* values[] = { &settings->minSinkRate, &settings->gain, &settings->deadband };
+    for (int i = 0; i < 3; i++) {
+        const char* found = strstr(config, keys[i]);
+        if (found) {
+            *values[i] = strtof(found + strlen(keys[i]), NULL);
+        }
+    }
+}
+
+static uint32_t Decide(const DescentSettings* settings, const LanderObservation* observation) {
+    uint32_t inputs = 0;
+    float sinkRate = observation->velocity[1];
+    if (sinkRate > settings->minSinkRate + observation->altitude * settings->gain) {
+        inputs |= LANDER_ACTION_THRUST;
+    }
+
+    // Rotating right lowers the tilt
+    if (observation->tilt > settings->deadband) {
+        inputs |= LANDER_ACTION_ROTATE_RIGHT;
+    } else if (observation->tilt < -settings->deadband) {
+        inputs |= LANDER_ACTION_ROTATE_LEFT;
+    }
+    return inputs;
+}
+
+LANDER_CONTROLLER_EXPORT uint32_t lander_controller_abi_version(void) {
+    return LANDER_CONTROLLER_ABI_VERSION;
+}
+
+LANDER_CONTROLLER_EXPORT int lander_controller_init(const LanderControllerInfo* info, void** context) {
+    DescentSettings* settings = (DescentSettings*)malloc(sizeof(DescentSettings));
+    if (!settings) {
+        return -1;
+    }
+    settings->minSinkRate = 5.0f;
+    settings->gain = 0.2f;
+    settings->deadband = 3.0f;
+    ParseSettings(info->config, settings);
+
+    *context = settings;
+    return 0;
+}
+
+LANDER_CONTROLLER_EXPORT void lander_controller_step(void* context, const LanderObservation* observation,
+                                                     LanderAction* action) {
+    action->inputs = Decide((const DescentSettings*)context, observation);
+}
+
+LANDER_CONTROLLER_EXPORT void lander_controller_step_n(void* context, uint32_t count,
+                                                       const LanderObservation* observations, LanderAction* actions) {
+    const DescentSettings* settings = (const DescentSettings*)context;
+    for (uint32_t i = 0; i < count; i++) {
+        actions[i].inputs = Decide(settings, &observations[i]);
+    }
+}
+
+LANDER_CONTROLLER_EXPORT void lander_controller_shutdown(void* context) {
+    free(context);
+}
@@ -0,0 +1,93 @@
+// GLFunctions.cpp
+// Runtime loading of the OpenGL shader and program entry points
+
+#include "GLFunctions.h"
+#include <SDL2/SDL.h>
+
+// Look up one entry point, trying the ARB name for the program binary functions
+template <typename T>
+static bool LoadFunction(T& function, const char* name, const char* arbName = nullptr) {
+    function = reinterpret_cast<T>(SDL_GL_GetProcAddress(name));
+    if (!function && arbName) {
+        function = reinterpret_cast<T>(SDL_GL_GetProcAddress(arbName));
+    }
+    return function != nullptr;
+}
+
+GLFunctions::GLFunctions()
+    : CreateShader(nullptr)
+    , ShaderSource(nullptr)
+    , CompileShader(nullptr)
+    , GetShaderiv(nullptr)
+    , GetShaderInfoLog(nullptr)
+    , DeleteShader(nullptr)
+    , CreateProgram(nullptr)
+    , AttachShader(nullptr)
+    , DetachShader(nullptr)
+    , LinkProgram(nullptr)
+    , GetProgramiv(nullptr)
+    , GetProgramInfoLog(nullptr)
+    , DeleteProgram(nullptr)
+    , GetUniformLocation(nullptr)
+    , UseProgram(nullptr)
+    , Uniform1i(nullptr)
+    , Uniform3i(nullptr)
+    , Uniform2fv(nullptr)
+    , Uniform3fv(nullptr)
+    , Uniform4fv(nullptr)
+    , ActiveTexture(nullptr)
+    , GenBuffers(nullptr)
+    , DeleteBuffers(nullptr)
+    , BindBuffer(nullptr)
+    , BufferData(nullptr)
+    , ProgramParameteri(nullptr)
+    , GetProgramBinary(nullptr)
+    , ProgramBinary(nullptr)
+{
+}
+
+bool GLFunctions::Load() {
+    bool success = true;
+    success &= LoadFunction(CreateShader, "glCreateShader");
+    success &= LoadFunction(ShaderSource, "glShaderSource");
+    success &= LoadFunction(CompileShader, "glCompileShader");
+    success &= LoadFunction(GetShaderiv, "glGetShaderiv");
+    success &= LoadFunction(GetShaderInfoLog, "glGetShaderInfoLog");
+    success &= LoadFunction(DeleteShader, "glDeleteShader");
+    success &= LoadFunction(CreateProgram, "glCreateProgram");
+    success &= LoadFunction(AttachShader, "glAttachShader");
+    success &= LoadFunction(DetachShader, "glDetachShader");
+    success &= LoadFunction(LinkProgram, "glLinkProgram");
+    success &= LoadFunction(GetProgramiv, "glGetProgramiv");
+    success &= LoadFunction(GetProgramInfoLog, "glGetProgramInfoLog");
+    success &= LoadFunction(DeleteProgram, "glDeleteProgram");
+    success &= LoadFunction(GetUniformLocation, "glGetUniformLocation");
+    success &= LoadFunction(UseProgram, "glUseProgram");
+    success &= LoadFunction(Uniform1i, "glUniform1i");
+    success &= LoadFunction(Uniform3i, "glUniform3i");
+    success &= LoadFunction(Uniform2fv, "glUniform2fv");
+    success &= LoadFunction(Uniform3fv, "glUniform3fv");
+    success &= LoadFunction(Uniform4fv, "glUniform4fv");
+    success &= LoadFunction(ActiveTexture, "glActiveTexture");
+    success &= LoadFunction(GenBuffers, "glGenBuffers");
+    success &= LoadFunction(DeleteBuffers, "glDeleteBuffers");
+    success &= LoadFunction(BindBuffer, "glBindBuffer");
+    success &= LoadFunction(BufferData, "glBufferData");
+
+    LoadFunction(ProgramParameteri, "glProgramParameteri", "glProgramParameteriARB");
+    LoadFunction(GetProgramBinary, "glGetProgramBinary", "glGetProgramBinaryARB");
+    LoadFunction(ProgramBinary, "glProgramBinary", "glProgramBinaryARB");
+
+    return success;
+}
+
+bool GLFunctions::HasProgramBinary() const {
+    if (!ProgramParameteri || !GetProgramBinary || !ProgramBinary) {
+        return false;
+    }
+
+    // Drivers may expose the entry points but support no binary formats
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    return formatCount > 0;
+}
@@ -0,0 +1,95 @@
+// GLFunctions.h
+// OpenGL entry points beyond GL 1.1, loaded at runtime through SDL
+
+#pragma once
+
+#ifdef __APPLE__
+    #include <OpenGL/gl.h>
+#else
+    #include <GL/gl.h>
+#endif
+
+#include <cstddef>
+
+#ifndef APIENTRY
+    #define APIENTRY
+#endif
+
+// Enums from GL 1.2, 1.3, 1.5, 2.0, 3.0 and GL 4.1 / ARB_get_program_binary (gl.h only covers 1.1)
+#ifndef GL_FRAGMENT_SHADER
+    #define GL_FRAGMENT_SHADER 0x8B30
+    #define GL_VERTEX_SHADER 0x8B31
+    #define GL_COMPILE_STATUS 0x8B81
+    #define GL_LINK_STATUS 0x8B82
+    #define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+    #define GL_CLAMP_TO_EDGE 0x812F
+#endif
+#ifndef GL_TEXTURE0
+    #define GL_TEXTURE0 0x84C0
+#endif
+#ifndef GL_ARRAY_BUFFER
+    #define GL_ARRAY_BUFFER 0x8892
+    #define GL_ELEMENT_ARRAY_BUFFER 0x8893
+    #define GL_STATIC_DRAW 0x88E4
+#endif
+#ifndef GL_RGBA32F
+    #define GL_RGBA32F 0x8814
+    #define GL_RG_INTEGER 0x8228
+    #define GL_R32UI 0x8236
+    #define GL_RG32UI 0x823C
+    #define GL_RED_INTEGER 0x8D94
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+    #define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+    #define GL_PROGRAM_BINARY_LENGTH 0x8741
+    #define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// Function pointers for the shader and program API. Only valid while the
+// context they were loaded with (or one sharing with it) is current.
+struct GLFunctions {
+    GLuint (APIENTRY* CreateShader)(GLenum type);
+    void (APIENTRY* ShaderSource)(GLuint shader, GLsizei count, const char* const* strings, const GLint* lengths);
+    void (APIENTRY* CompileShader)(GLuint shader);
+    void (APIENTRY* GetShaderiv)(GLuint shader, GLenum name, GLint* value);
+    void (APIENTRY* GetShaderInfoLog)(GLuint shader, GLsizei size, GLsizei* length, char* log);
+    void (APIENTRY* DeleteShader)(GLuint shader);
+
+    GLuint (APIENTRY* CreateProgram)();
+    void (APIENTRY* AttachShader)(GLuint program, GLuint shader);
+    void (APIENTRY* DetachShader)(GLuint program, GLuint shader);
+    void (APIENTRY* LinkProgram)(GLuint program);
+    void (APIENTRY* GetProgramiv)(GLuint program, GLenum name, GLint* value);
+    void (APIENTRY* GetProgramInfoLog)(GLuint program, GLsizei size, GLsizei* length, char* log);
+    void (APIENTRY* DeleteProgram)(GLuint program);
+    GLint (APIENTRY* GetUniformLocation)(GLuint program, const char* name);
+    void (APIENTRY* UseProgram)(GLuint program);
+    void (APIENTRY* Uniform1i)(GLint location, GLint value);
+    void (APIENTRY* Uniform3i)(GLint location, GLint x, GLint y, GLint z);
+    void (APIENTRY* Uniform2fv)(GLint location, GLsizei count, const GLfloat* values);
+    void (APIENTRY* Uniform3fv)(GLint location, GLsizei count, const GLfloat* values);
+    void (APIENTRY* Uniform4fv)(GLint location, GLsizei count, const GLfloat* values);
+    void (APIENTRY* ActiveTexture)(GLenum texture);
+
+    // Buffer objects (GL 1.5)
+    void (APIENTRY* GenBuffers)(GLsizei count, GLuint* buffers);
+    void (APIENTRY* DeleteBuffers)(GLsizei count, const GLuint* buffers);
+    void (APIENTRY* BindBuffer)(GLenum target, GLuint buffer);
+    void (APIENTRY* BufferData)(GLenum target, std::ptrdiff_t size, const void* data, GLenum usage);
+
+    // GL 4.1 / ARB_get_program_binary (may be missing)
+    void (APIENTRY* ProgramParameteri)(GLuint program, GLenum name, GLint value);
+    void (APIENTRY* GetProgramBinary)(GLuint program, GLsizei size, GLsizei* length, GLenum* format, void* binary);
+    void (APIENTRY* ProgramBinary)(GLuint program, GLenum format, const void* binary, GLsizei length);
+
+    GLFunctions();
+
+    // Load everything for the current context. Returns false when the
+    // shader API itself is missing; program binaries are optional.
+    bool Load();
+
+    // True when the driver can save and restore linked programs
+    bool HasProgramBinary() const;
+};
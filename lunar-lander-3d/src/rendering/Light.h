@@ -0,0 +1,15 @@
+// Light.h
+// Dynamic point and spot lights passed to the renderers
+
+#pragma once
+
+// A point light, or a spot light when spotCosine is above -1. Positions and
+// directions are in world space; the light fades to nothing at radius.
+struct Light {
+    float position[3];
+    float direction[3];  // Spot axis (unit length), unused for point lights
+    float color[3];
+    float intensity;
+    float radius;
+    float spotCosine;    // Cosine of the cone's half angle, -1 for point lights
+};
@@ -0,0 +1,241 @@
+// LightClusters.cpp
+// Implementation of the light-to-cluster assignment
+
+#include "LightClusters.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define LIGHT_CLUSTERS_SSE 1
+#endif
+
+LightClusters::LightClusters()
+    : mLightCount(0)
+    , mSliceScale(0.0f)
+    , mSliceBias(0.0f)
+    , mBounds(kMaxLights)
+    , mLightData(static_cast<size_t>(kLightRows) * kMaxLights * 4, 0.0f)
+    , mClusters(static_cast<size_t>(kClusterCount) * 2, 0)
+    , mCursors(kClusterCount, 0)
+{
+}
+
+void LightClusters::Build(const std::vector<Light>& lights, const float* view, const float* projection,
+                          float nearPlane, float farPlane) {
+    mLightCount = std::min(static_cast<int>(lights.size()), static_cast<int>(kMaxLights));
+
+    float logRange = std::log(farPlane / nearPlane);
+    mSliceScale = kSlices / logRange;
+    mSliceBias = -kSlices * std::log(nearPlane) / logRange;
+
+    // View-space data and cluster ranges of every light
+    int index = 0;
+    for (; index + 4 <= mLightCount; index += 4) {
+        BoundLights4(lights, index, view, projection, nearPlane, farPlane);
+    }
+    for (; index < mLightCount; index++) {
+        BoundLight(lights[index], index, view, projection, nearPlane, farPlane);
+    }
+
+    // Count the lights of every cluster
+    std::fill(mCursors.begin(), mCursors.end(), 0u);
+    for (int i = 0; i < mLightCount; i++) {
+        const LightBounds& bounds = mBounds[i];
+        for (int slice = bounds.minSlice; slice <= bounds.maxSlice; slice++) {
+            for (int y = bounds.minY; y <= bounds.maxY; y++) {
+                uint32_t* row = &mCursors[(slice * kTilesY + y) * kTilesX];
+                for (int x = bounds.minX; x <= bounds.maxX; x++) {
+                    row[x]++;
+                }
+            }
+        }
+    }
+
+    // Lay the lists out back to back, cutting them once the array is full
+    uint32_t offset = 0;
+    for (int cluster = 0; cluster < kClusterCount; cluster++) {
+        uint32_t count = std::min(mCursors[cluster], static_cast<uint32_t>(kMaxIndices) - offset);
+        mClusters[cluster * 2] = offset;
+        mClusters[cluster * 2 + 1] = count;
+        mCursors[cluster] = offset;
+        offset += count;
+    }
+    mIndices.resize(offset);
+
+    // Fill them in light order
+    for (int i = 0; i < mLightCount; i++) {
+        const LightBounds& bounds = mBounds[i];
+        for (int slice = bounds.minSlice; slice <= bounds.maxSlice; slice++) {
+            for (int y = bounds.minY; y <= bounds.maxY; y++) {
+                for (int x = bounds.minX; x <= bounds.maxX; x++) {
+                    int cluster = (slice * kTilesY + y) * kTilesX + x;
+                    if (mCursors[cluster] < mClusters[cluster * 2] + mClusters[cluster * 2 + 1]) {
+                        mIndices[mCursors[cluster]++] = static_cast<uint32_t>(i);
+                    }
+                }
+            }
+        }
+    }
+}
+
+#ifdef LIGHT_CLUSTERS_SSE
+void LightClusters::BoundLights4(const std::vector<Light>& lights, int first, const float* view,
+                                 const float* projection, float nearPlane, float farPlane) {
+    const Light& l0 = lights[first];
+    const Light& l1 = lights[first + 1];
+    const Light& l2 = lights[first + 2];
+    const Light& l3 = lights[first + 3];
+
+    // Four lights side by side, one lane each
+    __m128 x = _mm_setr_ps(l0.position[0], l1.position[0], l2.position[0], l3.position[0]);
+    __m128 y = _mm_setr_ps(l0.position[1], l1.position[1], l2.position[1], l3.position[1]);
+    __m128 z = _mm_setr_ps(l0.position[2], l1.position[2], l2.position[2], l3.position[2]);
+    __m128 radius = _mm_setr_ps(l0.radius, l1.radius, l2.radius, l3.radius);
+
+    // View-space centers
+    __m128 viewX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(view[0]), x), _mm_mul_ps(_mm_set1_ps(view[4]), y)),
+                              _mm_add_ps(_mm_mul_ps(_mm_set1_ps(view[8]), z), _mm_set1_ps(view[12])));
+    __m128 viewY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(view[1]), x), _mm_mul_ps(_mm_set1_ps(view[5]), y)),
+                              _mm_add_ps(_mm_mul_ps(_mm_set1_ps(view[9]), z), _mm_set1_ps(view[13])));
+    __m128 viewZ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(view[2]), x), _mm_mul_ps(_mm_set1_ps(view[6]), y)),
+                              _mm_add_ps(_mm_mul_ps(_mm_set1_ps(view[10]), z), _mm_set1_ps(view[14])));
+
+    // Depth range of the sphere (the camera looks down -z), clamped to the planes
+    __m128 depth = _mm_sub_ps(_mm_setzero_ps(), viewZ);
+    __m128 nearDepth = _mm_max_ps(_mm_sub_ps(depth, radius), _mm_set1_ps(nearPlane));
+    __m128 farDepth = _mm_min_ps(_mm_add_ps(depth, radius), _mm_set1_ps(farPlane));
+    __m128 inverseNear = _mm_div_ps(_mm_set1_ps(1.0f), nearDepth);
+    __m128 inverseFar = _mm_div_ps(_mm_set1_ps(1.0f), farDepth);
+
+    // Extremes of x / depth over the sphere's view-space box: a positive
+    // edge projects furthest out at the near depth, a negative one at the far
+    __m128 zero = _mm_setzero_ps();
+    __m128 scaleX = _mm_set1_ps(projection[0]);
+    __m128 scaleY = _mm_set1_ps(projection[5]);
+
+    __m128 edge = _mm_add_ps(viewX, radius);
+    __m128 useNear = _mm_cmpgt_ps(edge, zero);
+    __m128 inverse = _mm_or_ps(_mm_and_ps(useNear, inverseNear), _mm_andnot_ps(useNear, inverseFar));
+    __m128 maxNdcX = _mm_mul_ps(_mm_mul_ps(edge, scaleX), inverse);
+
+    edge = _mm_sub_ps(viewX, radius);
+    useNear = _mm_cmplt_ps(edge, zero);
+    inverse = _mm_or_ps(_mm_and_ps(useNear, inverseNear), _mm_andnot_ps(useNear, inverseFar));
+    __m128 minNdcX = _mm_mul_ps(_mm_mul_ps(edge, scaleX), inverse);
+
+    edge = _mm_add_ps(viewY, radius);
+    useNear = _mm_cmpgt_ps(edge, zero);
+    inverse = _mm_or_ps(_mm_and_ps(useNear, inverseNear), _mm_andnot_ps(useNear, inverseFar));
+    __m128 maxNdcY = _mm_mul_ps(_mm_mul_ps(edge, scaleY), inverse);
+
+    edge = _mm_sub_ps(viewY, radius);
+    useNear = _mm_cmplt_ps(edge, zero);
+    inverse = _mm_or_ps(_mm_and_ps(useNear, inverseNear), _mm_andnot_ps(useNear, inverseFar));
+    __m128 minNdcY = _mm_mul_ps(_mm_mul_ps(edge, scaleY), inverse);
+
+    alignas(16) float lanes[9][4];
+    _mm_store_ps(lanes[0], viewX);
+    _mm_store_ps(lanes[1], viewY);
+    _mm_store_ps(lanes[2], viewZ);
+    _mm_store_ps(lanes[3], minNdcX);
+    _mm_store_ps(lanes[4], maxNdcX);
+    _mm_store_ps(lanes[5], minNdcY);
+    _mm_store_ps(lanes[6], maxNdcY);
+    _mm_store_ps(lanes[7], nearDepth);
+    _mm_store_ps(lanes[8], farDepth);
+
+    for (int lane = 0; lane < 4; lane++) {
+        const float viewPosition[3] = { lanes[0][lane], lanes[1][lane], lanes[2][lane] };
+        StoreLight(lights[first + lane], first + lane, viewPosition, view);
+        StoreBounds(first + lane, lanes[3][lane], lanes[4][lane], lanes[5][lane], lanes[6][lane],
+                    lanes[7][lane], lanes[8][lane]);
+    }
+}
+#else
+void LightClusters::BoundLights4(const std::vector<Light>& lights, int first, const float* view,
+                                 const float* projection, float nearPlane, float farPlane) {
+    for (int i = first; i < first + 4; i++) {
+        BoundLight(lights[i], i, view, projection, nearPlane, farPlane);
+    }
+}
+#endif
+
+void LightClusters::BoundLight(const Light& light, int index, const float* view, const float* projection,
+                               float nearPlane, float farPlane) {
+    const float* p = light.position;
+    float viewPosition[3];
+    for (int axis = 0; axis < 3; axis++) {
+        viewPosition[axis] = view[axis] * p[0] + view[4 + axis] * p[1] + view[8 + axis] * p[2] + view[12 + axis];
+    }
+    StoreLight(light, index, viewPosition, view);
+
+    // Same bounds as BoundLights4, one light at a time
+    float depth = -viewPosition[2];
+    float nearDepth = std::max(depth - light.radius, nearPlane);
+    float farDepth = std::min(depth + light.radius, farPlane);
+
+    float edge = viewPosition[0] + light.radius;
+    float maxNdcX = edge * projection[0] / (edge > 0.0f ? nearDepth : farDepth);
+    edge = viewPosition[0] - light.radius;
+    float minNdcX = edge * projection[0] / (edge < 0.0f ? nearDepth : farDepth);
+    edge = viewPosition[1] + light.radius;
+    float maxNdcY = edge * projection[5] / (edge > 0.0f ? nearDepth : farDepth);
+    edge = viewPosition[1] - light.radius;
+    float minNdcY = edge * projection[5] / (edge < 0.0f ? nearDepth : farDepth);
+
+    StoreBounds(index, minNdcX, maxNdcX, minNdcY, maxNdcY, nearDepth, farDepth);
+}
+
+void LightClusters::StoreBounds(int index, float minNdcX, float maxNdcX, float minNdcY, float maxNdcY,
+                                float nearDepth, float farDepth) {
+    LightBounds& bounds = mBounds[index];
+
+    // Behind the camera, past the far plane or off screen: no clusters
+    if (nearDepth > farDepth || minNdcX > 1.0f || maxNdcX < -1.0f || minNdcY > 1.0f || maxNdcY < -1.0f) {
+        bounds.minX = bounds.minY = bounds.minSlice = 0;
+        bounds.maxX = bounds.maxY = bounds.maxSlice = -1;
+        return;
+    }
+
+    // Tile rows count up from the bottom, like gl_FragCoord
+    auto toTile = [](float ndc, int tiles) {
+        int tile = static_cast<int>(std::floor((ndc * 0.5f + 0.5f) * tiles));
+        return std::max(0, std::min(tiles - 1, tile));
+    };
+    auto toSlice = [this](float depth) {
+        int slice = static_cast<int>(std::floor(std::log(depth) * mSliceScale + mSliceBias));
+        return std::max(0, std::min(kSlices - 1, slice));
+    };
+
+    bounds.minX = toTile(minNdcX, kTilesX);
+    bounds.maxX = toTile(maxNdcX, kTilesX);
+    bounds.minY = toTile(minNdcY, kTilesY);
+    bounds.maxY = toTile(maxNdcY, kTilesY);
+    bounds.minSlice = toSlice(nearDepth);
+    bounds.maxSlice = toSlice(farDepth);
+}
+
+void LightClusters::StoreLight(const Light& light, int index, const float* viewPosition, const float* view) {
+    const size_t rowStride = static_cast<size_t>(kMaxLights) * 4;
+    float* position = &mLightData[index * 4];
+    float* color = position + rowStride;
+    float* direction = color + rowStride;
+
+    position[0] = viewPosition[0];
+    position[1] = viewPosition[1];
+    position[2] = viewPosition[2];
+    position[3] = light.radius;
+
+    color[0] = light.color[0] * light.intensity;
+    color[1] = light.color[1] * light.intensity;
+    color[2] = light.color[2] * light.intensity;
+    color[3] = 0.0f;
+
+    // Directions only rotate
+    const float* d = light.direction;
+    for (int axis = 0; axis < 3; axis++) {
+        direction[axis] = view[axis] * d[0] + view[4 + axis] * d[1] + view[8 + axis] * d[2];
+    }
+    direction[3] = light.spotCosine;
+}
@@ -0,0 +1,87 @@
+// LightClusters.h
+// CPU light-to-cluster assignment for clustered forward shading
+
+#pragma once
+
+#include "Light.h"
+#include <cstdint>
+#include <vector>
+
+// Splits a view's frustum into kTilesX x kTilesY screen tiles and kSlices
+// depth slices (exponentially spaced, so near slices stay thin) and lists
+// the lights whose range touches each cluster. The fragment shader looks up
+// its cluster and only shades the lights listed there, so the cost per
+// pixel follows the local light count instead of the scene's.
+//
+// Lights are transformed to view space and bounded four at a time with SSE
+// (scalar on other targets); the lists are then filled by a counting sort
+// into one flat index array.
+class LightClusters {
+public:
+    static const int kTilesX = 16;
+    static const int kTilesY = 9;
+    static const int kSlices = 24;
+    static const int kClusterCount = kTilesX * kTilesY * kSlices;
+
+    // Lights beyond kMaxLights are ignored; index lists are cut at kMaxIndices
+    static const int kMaxLights = 1024;
+    static const int kIndexRowLength = 1024;
+    static const int kMaxIndices = kIndexRowLength * 64;
+
+    // Rows of light data per light (see GetLightData)
+    static const int kLightRows = 3;
+
+    LightClusters();
+
+    // Assign lights for one view. Matrices are column-major OpenGL ones; the
+    // projection must be a symmetric perspective with the given planes.
+    void Build(const std::vector<Light>& lights, const float* view, const float* projection,
+               float nearPlane, float farPlane);
+
+    int GetLightCount() const { return mLightCount; }
+    int GetIndexCount() const { return static_cast<int>(mIndices.size()); }
+
+    // kLightRows rows of kMaxLights RGBA texels, view space:
+    //   row 0: position, radius
+    //   row 1: color * intensity, unused
+    //   row 2: spot direction, spot cosine
+    const std::vector<float>& GetLightData() const { return mLightData; }
+
+    // (offset, count) into the index list per cluster, ordered tile x, then
+    // tile y, then slice
+    const std::vector<uint32_t>& GetClusters() const { return mClusters; }
+    const std::vector<uint32_t>& GetIndices() const { return mIndices; }
+
+    // slice = floor(log(depth) * scale + bias) for a view-space depth
+    float GetSliceScale() const { return mSliceScale; }
+    float GetSliceBias() const { return mSliceBias; }
+
+private:
+    // Cluster ranges of one light; empty (min > max) when it is out of view
+    struct LightBounds {
+        int minX, maxX;
+        int minY, maxY;
+        int minSlice, maxSlice;
+    };
+
+    // Transform lights [first, first + 4) to view space and bound them
+    void BoundLights4(const std::vector<Light>& lights, int first, const float* view, const float* projection,
+                      float nearPlane, float farPlane);
+    void BoundLight(const Light& light, int index, const float* view, const float* projection,
+                    float nearPlane, float farPlane);
+
+    // Screen and depth ranges to cluster ranges (shared by both paths)
+    void StoreBounds(int index, float minNdcX, float maxNdcX, float minNdcY, float maxNdcY,
+                     float nearDepth, float farDepth);
+    void StoreLight(const Light& light, int index, const float* viewPosition, const float* view);
+
+    int mLightCount;
+    float mSliceScale;
+    float mSliceBias;
+
+    std::vector<LightBounds> mBounds;
+    std::vector<float> mLightData;
+    std::vector<uint32_t> mClusters;
+    std::vector<uint32_t> mIndices;
+    std::vector<uint32_t> mCursors;  // Fill position per cluster
+};
@@ -0,0 +1,622 @@
+// Mesh.cpp
+// Implementation of mesh loading, optimization and quantization
+
+#include "Mesh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+
+// Simulated post-transform cache for triangle ordering (Forsyth's scoring)
+static const int kVertexCacheSize = 32;
+static const float kCacheDecayPower = 1.5f;
+static const float kLastTriangleScore = 0.75f;
+static const float kValenceBoostScale = 2.0f;
+static const float kValenceBoostPower = 0.5f;
+
+// FIFO cache size used to find the cluster boundaries for overdraw ordering
+static const int kOverdrawCacheSize = 16;
+
+// Levels of detail: the first coarse level clusters vertices on a grid of
+// kLodBaseGrid cells across the mesh, each further level on half as many.
+// A level is only kept when it has at most kLodMinReduction of the triangles
+// of the previous one.
+static const int kMaxLods = 4;
+static const int kLodBaseGrid = 32;
+static const float kLodMinReduction = 0.75f;
+static const size_t kLodMinTriangles = 8;
+
+static void Subtract(const float* a, const float* b, float* result) {
+    result[0] = a[0] - b[0];
+    result[1] = a[1] - b[1];
+    result[2] = a[2] - b[2];
+}
+
+static void Cross(const float* a, const float* b, float* result) {
+    result[0] = a[1] * b[2] - a[2] * b[1];
+    result[1] = a[2] * b[0] - a[0] * b[2];
+    result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static void Normalize(float* v) {
+    float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (length > 0.0f) {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+}
+
+// Score of a vertex for the cache optimizer: high while it is recently used
+// and when few triangles still need it (so it can leave the cache for good)
+static float VertexCacheScore(int cachePosition, uint32_t remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = kLastTriangleScore;  // Used by the last triangle: fixed score
+        } else {
+            float scale = 1.0f / (kVertexCacheSize - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scale, kCacheDecayPower);
+        }
+    }
+
+    return score + kValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -kValenceBoostPower);
+}
+
+// Reorder triangles so consecutive ones share vertices still in the
+// post-transform cache (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation")
+static void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Triangles using each vertex
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint32_t index : indices) {
+        remaining[index]++;
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++) {
+        adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        vertexScore[v] = VertexCacheScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] +
+                           vertexScore[indices[t * 3 + 2]];
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    int best = -1;
+
+    while (output.size() < indices.size()) {
+        // Nothing in the cache leads on: take the best remaining triangle
+        if (best < 0) {
+            float bestScore = -1e30f;
+            for (size_t t = 0; t < triangleCount; t++) {
+                if (!emitted[t] && triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = static_cast<int>(t);
+                }
+            }
+        }
+
+        const uint32_t* triangle = &indices[best * 3];
+        output.insert(output.end(), triangle, triangle + 3);
+        emitted[best] = true;
+
+        // Drop it from its vertices' lists of remaining triangles
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t v = triangle[corner];
+            uint32_t* list = &adjacency[offsets[v]];
+            for (uint32_t i = 0; i < remaining[v]; i++) {
+                if (list[i] == static_cast<uint32_t>(best)) {
+                    std::swap(list[i], list[remaining[v] - 1]);
+                    break;
+                }
+            }
+            remaining[v]--;
+        }
+
+        // Its vertices move to the front of the cache
+        newCache.assign(triangle, triangle + 3);
+        for (uint32_t v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                newCache.push_back(v);
+            }
+        }
+
+        // Rescore everything that moved (including vertices pushed out) and
+        // the triangles still using them; the best of those goes next
+        best = -1;
+        float bestScore = -1e30f;
+        for (size_t i = 0; i < newCache.size(); i++) {
+            uint32_t v = newCache[i];
+            cachePosition[v] = (i < static_cast<size_t>(kVertexCacheSize)) ? static_cast<int>(i) : -1;
+            vertexScore[v] = VertexCacheScore(cachePosition[v], remaining[v]);
+        }
+        for (uint32_t v : newCache) {
+            for (uint32_t i = 0; i < remaining[v]; i++) {
+                uint32_t t = adjacency[offsets[v] + i];
+                triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] +
+                                   vertexScore[indices[t * 3 + 2]];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = static_cast<int>(t);
+                }
+            }
+        }
+
+        if (newCache.size() > static_cast<size_t>(kVertexCacheSize)) {
+            newCache.resize(kVertexCacheSize);
+        }
+        cache.swap(newCache);
+    }
+
+    indices.swap(output);
+}
+
+// Reorder clusters of the cache-optimized triangles so outward-facing parts
+// of the mesh come first and hide what is behind them (after Sander et al.,
+// "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+// Clusters end where a triangle misses the cache on all three vertices, so
+// cache efficiency is kept within each one.
+static void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<float>& positions) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Cluster boundaries from a simulated FIFO cache
+    std::vector<size_t> clusterStarts;
+    std::vector<uint32_t> stamps(positions.size() / 3, 0);
+    uint32_t time = kOverdrawCacheSize + 1;
+    for (size_t t = 0; t < triangleCount; t++) {
+        int misses = 0;
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t v = indices[t * 3 + corner];
+            if (time - stamps[v] > static_cast<uint32_t>(kOverdrawCacheSize)) {
+                stamps[v] = time++;
+                misses++;
+            }
+        }
+        if (t == 0 || misses == 3) {
+            clusterStarts.push_back(t);
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // Area-weighted centroid and normal of each cluster and of the mesh
+    size_t clusterCount = clusterStarts.size() - 1;
+    std::vector<float> clusterCentroids(clusterCount * 3, 0.0f);
+    std::vector<float> clusterNormals(clusterCount * 3, 0.0f);
+    float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c < clusterCount; c++) {
+        float clusterArea = 0.0f;
+        for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+            const float* p0 = &positions[indices[t * 3] * 3];
+            const float* p1 = &positions[indices[t * 3 + 1] * 3];
+            const float* p2 = &positions[indices[t * 3 + 2] * 3];
+            float edge1[3], edge2[3], normal[3];
+            Subtract(p1, p0, edge1);
+            Subtract(p2, p0, edge2);
+            Cross(edge1, edge2, normal);
+            float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+            for (int axis = 0; axis < 3; axis++) {
+                float center = (p0[axis] + p1[axis] + p2[axis]) / 3.0f;
+                clusterCentroids[c * 3 + axis] += center * area;
+                clusterNormals[c * 3 + axis] += normal[axis];
+                meshCentroid[axis] += center * area;
+            }
+            clusterArea += area;
+        }
+
+        if (clusterArea > 0.0f) {
+            for (int axis = 0; axis < 3; axis++) {
+                clusterCentroids[c * 3 + axis] /= clusterArea;
+            }
+        }
+        Normalize(&clusterNormals[c * 3]);
+        meshArea += clusterArea;
+    }
+    if (meshArea > 0.0f) {
+        for (int axis = 0; axis < 3; axis++) {
+            meshCentroid[axis] /= meshArea;
+        }
+    }
+
+    // Most outward-facing clusters first
+    std::vector<float> sortKeys(clusterCount);
+    std::vector<size_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        float offset[3];
+        Subtract(&clusterCentroids[c * 3], meshCentroid, offset);
+        const float* normal = &clusterNormals[c * 3];
+        sortKeys[c] = offset[0] * normal[0] + offset[1] * normal[1] + offset[2] * normal[2];
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) {
+        return sortKeys[a] > sortKeys[b];
+    });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (size_t c : order) {
+        output.insert(output.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+    }
+    indices.swap(output);
+}
+
+Mesh::Mesh() {
+    Clear();
+}
+
+void Mesh::Clear() {
+    mVertices.clear();
+    mIndices.clear();
+    mLods.clear();
+    mPositionScale = 1.0f;
+    for (int axis = 0; axis < 3; axis++) {
+        mPositionOffset[axis] = 0.0f;
+        mBoundsMin[axis] = 0.0f;
+        mBoundsMax[axis] = 0.0f;
+    }
+}
+
+bool Mesh::LoadObj(const std::string& path) {
+    Clear();
+
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open model: " << path << std::endl;
+        return false;
+    }
+    return LoadObjStream(file, path);
+}
+
+bool Mesh::LoadObjData(const char* data, size_t size, const std::string& name) {
+    Clear();
+
+    std::istringstream stream(std::string(data, size));
+    return LoadObjStream(stream, name);
+}
+
+bool Mesh::LoadObjStream(std::istream& stream, const std::string& name) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    if (!ParseObj(stream, name, vertices, indices)) {
+        return false;
+    }
+
+    // Full-detail bounds, also the reference grid for the coarser levels
+    for (int axis = 0; axis < 3; axis++) {
+        mBoundsMin[axis] = mBoundsMax[axis] = vertices[0].position[axis];
+    }
+    for (const Vertex& vertex : vertices) {
+        for (int axis = 0; axis < 3; axis++) {
+            mBoundsMin[axis] = std::min(mBoundsMin[axis], vertex.position[axis]);
+            mBoundsMax[axis] = std::max(mBoundsMax[axis], vertex.position[axis]);
+        }
+    }
+    float extent = std::max({ mBoundsMax[0] - mBoundsMin[0], mBoundsMax[1] - mBoundsMin[1],
+                              mBoundsMax[2] - mBoundsMin[2] });
+
+    // Levels of detail, each with its own vertices until they are merged
+    std::vector<std::vector<Vertex>> levelVertices(1, vertices);
+    std::vector<std::vector<uint32_t>> levelIndices(1, indices);
+    std::vector<float> levelErrors(1, 0.0f);
+    for (int level = 1, grid = kLodBaseGrid; level < kMaxLods && grid >= 2; grid /= 2) {
+        float cellSize = extent / grid;
+        std::vector<Vertex> lodVertices;
+        std::vector<uint32_t> lodIndices;
+        BuildLod(vertices, indices, cellSize, lodVertices, lodIndices);
+
+        size_t previousTriangles = levelIndices.back().size() / 3;
+        size_t triangles = lodIndices.size() / 3;
+        if (triangles < kLodMinTriangles) {
+            break;
+        }
+        if (triangles > previousTriangles * kLodMinReduction) {
+            continue;  // Too little gained at this grid; try a coarser one
+        }
+
+        levelVertices.push_back(lodVertices);
+        levelIndices.push_back(lodIndices);
+        levelErrors.push_back(cellSize * std::sqrt(3.0f));  // Cell diagonal
+        level++;
+    }
+
+    // Optimize each level, then append it to the shared buffers
+    std::vector<Vertex> allVertices;
+    for (size_t level = 0; level < levelVertices.size(); level++) {
+        std::vector<uint32_t>& lodIndices = levelIndices[level];
+        const std::vector<Vertex>& lodVertices = levelVertices[level];
+
+        std::vector<float> positions(lodVertices.size() * 3);
+        for (size_t v = 0; v < lodVertices.size(); v++) {
+            std::copy(lodVertices[v].position, lodVertices[v].position + 3, &positions[v * 3]);
+        }
+        OptimizeVertexCache(lodIndices, lodVertices.size());
+        OptimizeOverdraw(lodIndices, positions);
+
+        // Vertices in the order the indices first use them, so fetches
+        // walk the buffer forwards; unused vertices are dropped
+        std::vector<uint32_t> remap(lodVertices.size(), UINT32_MAX);
+        uint32_t base = static_cast<uint32_t>(allVertices.size());
+        MeshLod lod;
+        lod.firstIndex = static_cast<uint32_t>(mIndices.size());
+        lod.indexCount = static_cast<uint32_t>(lodIndices.size());
+        lod.error = levelErrors[level];
+        for (uint32_t index : lodIndices) {
+            if (remap[index] == UINT32_MAX) {
+                remap[index] = static_cast<uint32_t>(allVertices.size()) - base;
+                allVertices.push_back(lodVertices[index]);
+            }
+            mIndices.push_back(base + remap[index]);
+        }
+        mLods.push_back(lod);
+    }
+
+    Quantize(allVertices);
+
+    std::cout << "Loaded model " << name << ": " << indices.size() / 3 << " triangles, "
+              << mLods.size() << " levels of detail" << std::endl;
+    return true;
+}
+
+bool Mesh::ParseObj(std::istream& stream, const std::string& name, std::vector<Vertex>& vertices,
+                    std::vector<uint32_t>& indices) {
+    std::vector<float> positions;
+    std::vector<float> normals;
+
+    // Merge corners that repeat a position/normal pair into one vertex
+    std::unordered_map<uint64_t, uint32_t> vertexIds;
+    std::vector<bool> needsNormal;
+
+    std::string line;
+    std::vector<uint32_t> face;
+    while (std::getline(stream, line)) {
+        std::istringstream fields(line);
+        std::string type;
+        fields >> type;
+
+        if (type == "v") {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            fields >> x >> y >> z;
+            positions.insert(positions.end(), { x, y, z });
+        } else if (type == "vn") {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            fields >> x >> y >> z;
+            normals.insert(normals.end(), { x, y, z });
+        } else if (type == "f") {
+            face.clear();
+            std::string corner;
+            while (fields >> corner) {
+                // "p", "p/t", "p//n" or "p/t/n"; 1-based, negative counts back
+                const char* text = corner.c_str();
+                char* end = nullptr;
+                long position = std::strtol(text, &end, 10);
+                long normal = 0;
+                if (*end == '/') {
+                    const char* next = end + 1;
+                    std::strtol(next, &end, 10);
+                    if (*end == '/') {
+                        normal = std::strtol(end + 1, &end, 10);
+                    }
+                }
+
+                long positionCount = static_cast<long>(positions.size() / 3);
+                long normalCount = static_cast<long>(normals.size() / 3);
+                position = position < 0 ? positionCount + position : position - 1;
+                normal = normal < 0 ? normalCount + normal : normal - 1;
+                if (position < 0 || position >= positionCount) {
+                    std::cerr << "Invalid face in model " << name << ": " << line << std::endl;
+                    return false;
+                }
+                if (normal >= normalCount) {
+                    normal = -1;
+                }
+
+                uint64_t key = (static_cast<uint64_t>(position) << 32) | static_cast<uint32_t>(normal + 1);
+                auto found = vertexIds.find(key);
+                if (found == vertexIds.end()) {
+                    Vertex vertex;
+                    std::copy(&positions[position * 3], &positions[position * 3] + 3, vertex.position);
+                    if (normal >= 0) {
+                        std::copy(&normals[normal * 3], &normals[normal * 3] + 3, vertex.normal);
+                    } else {
+                        vertex.normal[0] = vertex.normal[1] = vertex.normal[2] = 0.0f;
+                    }
+                    found = vertexIds.emplace(key, static_cast<uint32_t>(vertices.size())).first;
+                    vertices.push_back(vertex);
+                    needsNormal.push_back(normal < 0);
+                }
+                face.push_back(found->second);
+            }
+
+            // Fan triangulation
+            for (size_t i = 2; i < face.size(); i++) {
+                indices.insert(indices.end(), { face[0], face[i - 1], face[i] });
+            }
+        }
+    }
+
+    if (indices.empty()) {
+        std::cerr << "Model has no faces: " << name << std::endl;
+        return false;
+    }
+
+    // Smooth normals for corners the file gave none
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        float edge1[3], edge2[3], normal[3];
+        Subtract(vertices[indices[i + 1]].position, vertices[indices[i]].position, edge1);
+        Subtract(vertices[indices[i + 2]].position, vertices[indices[i]].position, edge2);
+        Cross(edge1, edge2, normal);
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t v = indices[i + corner];
+            if (needsNormal[v]) {
+                for (int axis = 0; axis < 3; axis++) {
+                    vertices[v].normal[axis] += normal[axis];
+                }
+            }
+        }
+    }
+    for (Vertex& vertex : vertices) {
+        Normalize(vertex.normal);
+    }
+
+    return true;
+}
+
+void Mesh::BuildLod(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, float cellSize,
+                    std::vector<Vertex>& lodVertices, std::vector<uint32_t>& lodIndices) const {
+    // Every vertex snaps to the average position of its grid cell
+    std::unordered_map<uint64_t, uint32_t> cellIds;
+    std::vector<uint32_t> vertexCells(vertices.size());
+    std::vector<float> cellPositions;
+    std::vector<int> cellCounts;
+    for (size_t v = 0; v < vertices.size(); v++) {
+        const float* p = vertices[v].position;
+        uint64_t key = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            uint64_t cell = static_cast<uint64_t>((p[axis] - mBoundsMin[axis]) / cellSize);
+            key |= (cell & 0x1FFFFF) << (axis * 21);
+        }
+
+        auto found = cellIds.find(key);
+        if (found == cellIds.end()) {
+            found = cellIds.emplace(key, static_cast<uint32_t>(cellCounts.size())).first;
+            cellPositions.insert(cellPositions.end(), { 0.0f, 0.0f, 0.0f });
+            cellCounts.push_back(0);
+        }
+        uint32_t cell = found->second;
+        vertexCells[v] = cell;
+        for (int axis = 0; axis < 3; axis++) {
+            cellPositions[cell * 3 + axis] += p[axis];
+        }
+        cellCounts[cell]++;
+    }
+
+    // Within a cell, vertices facing different ways stay apart so creases
+    // keep their hard edges: one output vertex per cell and normal direction
+    std::unordered_map<uint64_t, uint32_t> outputIds;
+    std::vector<uint32_t> remap(vertices.size());
+    for (size_t v = 0; v < vertices.size(); v++) {
+        const float* n = vertices[v].normal;
+        int axis = 0;
+        for (int a = 1; a < 3; a++) {
+            if (std::fabs(n[a]) > std::fabs(n[axis])) {
+                axis = a;
+            }
+        }
+        uint64_t direction = axis * 2 + (n[axis] < 0.0f ? 1 : 0);
+        uint64_t key = static_cast<uint64_t>(vertexCells[v]) * 6 + direction;
+
+        auto found = outputIds.find(key);
+        if (found == outputIds.end()) {
+            found = outputIds.emplace(key, static_cast<uint32_t>(lodVertices.size())).first;
+            Vertex vertex;
+            uint32_t cell = vertexCells[v];
+            for (int a = 0; a < 3; a++) {
+                vertex.position[a] = cellPositions[cell * 3 + a] / cellCounts[cell];
+                vertex.normal[a] = 0.0f;
+            }
+            lodVertices.push_back(vertex);
+        }
+        remap[v] = found->second;
+        for (int a = 0; a < 3; a++) {
+            lodVertices[found->second].normal[a] += n[a];
+        }
+    }
+    for (Vertex& vertex : lodVertices) {
+        Normalize(vertex.normal);
+    }
+
+    // Triangles that collapsed (two corners in one cell) or now repeat go
+    std::set<std::tuple<uint32_t, uint32_t, uint32_t>> seen;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (vertexCells[a] == vertexCells[b] || vertexCells[b] == vertexCells[c] || vertexCells[a] == vertexCells[c]) {
+            continue;
+        }
+
+        // Rotate the smallest index first so repeats compare equal
+        uint32_t corners[3] = { remap[a], remap[b], remap[c] };
+        std::rotate(corners, std::min_element(corners, corners + 3), corners + 3);
+        if (!seen.insert(std::make_tuple(corners[0], corners[1], corners[2])).second) {
+            continue;
+        }
+        lodIndices.insert(lodIndices.end(), corners, corners + 3);
+    }
+}
+
+void Mesh::Quantize(const std::vector<Vertex>& vertices) {
+    // Positions map the bounds of every level onto the 16-bit range, with
+    // one step size (the largest axis) for all three axes
+    float boundsMin[3], boundsMax[3];
+    for (int axis = 0; axis < 3; axis++) {
+        boundsMin[axis] = boundsMax[axis] = vertices[0].position[axis];
+    }
+    for (const Vertex& vertex : vertices) {
+        for (int axis = 0; axis < 3; axis++) {
+            boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+            boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+        }
+    }
+    float extent = std::max({ boundsMax[0] - boundsMin[0], boundsMax[1] - boundsMin[1],
+                              boundsMax[2] - boundsMin[2], 1e-6f });
+    mPositionScale = extent / 65535.0f;
+    for (int axis = 0; axis < 3; axis++) {
+        mPositionOffset[axis] = boundsMin[axis] + 32768.0f * mPositionScale;
+    }
+
+    mVertices.resize(vertices.size());
+    for (size_t v = 0; v < vertices.size(); v++) {
+        QuantizedVertex& quantized = mVertices[v];
+        for (int axis = 0; axis < 3; axis++) {
+            float q = std::round((vertices[v].position[axis] - boundsMin[axis]) / mPositionScale) - 32768.0f;
+            quantized.position[axis] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, q)));
+            quantized.normal[axis] = static_cast<int8_t>(std::round(vertices[v].normal[axis] * 127.0f));
+        }
+        quantized.position[3] = 0;
+        quantized.normal[3] = 0;
+    }
+}
+
+int Mesh::SelectLod(float pixelsPerUnit, float maxPixelError) const {
+    int selected = 0;
+    for (size_t level = 1; level < mLods.size(); level++) {
+        if (mLods[level].error * pixelsPerUnit <= maxPixelError) {
+            selected = static_cast<int>(level);
+        }
+    }
+    return selected;
+}
@@ -0,0 +1,85 @@
+// Mesh.h
+// Triangle meshes loaded from OBJ files, optimized and quantized for drawing
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+// Compact vertex: positions as 16-bit integers within the mesh bounds (see
+// Mesh::GetPositionScale/Offset), normals as signed normalized bytes.
+// The fourth components only pad the attributes to 4-byte boundaries.
+struct QuantizedVertex {
+    int16_t position[4];
+    int8_t normal[4];
+};
+
+// One level of detail: a range of the shared index buffer
+struct MeshLod {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;  // Largest vertex displacement from the full mesh (model units)
+};
+
+// Loads a model and does the work an offline mesh pipeline would: duplicate
+// vertices are merged, coarser levels of detail are built by vertex
+// clustering, each level's triangles are reordered for the post-transform
+// vertex cache and then, in cache-friendly clusters, for less overdraw, and
+// vertices are laid out in fetch order and quantized.
+class Mesh {
+public:
+    Mesh();
+
+    // Wavefront OBJ (v, vn and f records; faces are triangulated as fans).
+    // Returns false when the file cannot be read or holds no triangles.
+    bool LoadObj(const std::string& path);
+    // Same, from a file already in memory (name is only used in messages)
+    bool LoadObjData(const char* data, size_t size, const std::string& name);
+    void Clear();
+
+    bool IsEmpty() const { return mLods.empty(); }
+
+    // Vertices and indices of all levels, finest level first
+    const std::vector<QuantizedVertex>& GetVertices() const { return mVertices; }
+    const std::vector<uint32_t>& GetIndices() const { return mIndices; }
+    const std::vector<MeshLod>& GetLods() const { return mLods; }
+
+    // Model-space position = offset + quantized position * scale. The scale
+    // is the same on every axis, so normals need no correction for it.
+    float GetPositionScale() const { return mPositionScale; }
+    const float* GetPositionOffset() const { return mPositionOffset; }
+
+    // Bounds of the full-detail mesh
+    const float* GetBoundsMin() const { return mBoundsMin; }
+    const float* GetBoundsMax() const { return mBoundsMax; }
+
+    // Coarsest level whose error stays under maxPixelError on screen, given
+    // how many pixels one model unit covers at the mesh's distance
+    int SelectLod(float pixelsPerUnit, float maxPixelError) const;
+
+private:
+    // Full-precision vertex used while building
+    struct Vertex {
+        float position[3];
+        float normal[3];
+    };
+
+    bool LoadObjStream(std::istream& stream, const std::string& name);
+    bool ParseObj(std::istream& stream, const std::string& name, std::vector<Vertex>& vertices,
+                  std::vector<uint32_t>& indices);
+    void BuildLod(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, float cellSize,
+                  std::vector<Vertex>& lodVertices, std::vector<uint32_t>& lodIndices) const;
+    void Quantize(const std::vector<Vertex>& vertices);
+
+    std::vector<QuantizedVertex> mVertices;
+    std::vector<uint32_t> mIndices;
+    std::vector<MeshLod> mLods;
+
+    float mPositionScale;
+    float mPositionOffset[3];
+    float mBoundsMin[3];
+    float mBoundsMax[3];
+};
@@ -0,0 +1,187 @@
+// OcclusionCuller.cpp
+// Implementation of the software occlusion buffer
+
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cmath>
+
+// Points closer than this (clip w) count as crossing the near plane
+static const float kNearW = 0.1f;
+
+// Pyramid level used for a box test covers at most this many texels per side
+static const int kMaxTestTexels = 4;
+
+OcclusionCuller::OcclusionCuller()
+    : mWidth(kWidth)
+    , mHeight(kWidth * 3 / 4)
+{
+    for (int i = 0; i < 16; i++) {
+        mViewProjection[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    }
+}
+
+void OcclusionCuller::Begin(const float* viewProjection, int viewportWidth, int viewportHeight) {
+    std::copy(viewProjection, viewProjection + 16, mViewProjection);
+
+    mWidth = kWidth;
+    mHeight = std::max(1, kWidth * viewportHeight / std::max(1, viewportWidth));
+
+    // Allocate the pyramid on the first frame or after a resize
+    if (mLevelWidths.empty() || mLevelWidths[0] != mWidth || mLevelHeights[0] != mHeight) {
+        mLevels.clear();
+        mLevelWidths.clear();
+        mLevelHeights.clear();
+
+        int width = mWidth;
+        int height = mHeight;
+        for (;;) {
+            mLevels.emplace_back(static_cast<size_t>(width) * height);
+            mLevelWidths.push_back(width);
+            mLevelHeights.push_back(height);
+            if (width == 1 && height == 1) {
+                break;
+            }
+            width = std::max(1, (width + 1) / 2);
+            height = std::max(1, (height + 1) / 2);
+        }
+    }
+
+    // Nothing drawn yet: everything is at the far plane
+    std::fill(mLevels[0].begin(), mLevels[0].end(), 1.0f);
+}
+
+bool OcclusionCuller::Project(float x, float y, float z, float& sx, float& sy, float& depth) const {
+    const float* m = mViewProjection;
+    float cx = m[0] * x + m[4] * y + m[8] * z + m[12];
+    float cy = m[1] * x + m[5] * y + m[9] * z + m[13];
+    float cz = m[2] * x + m[6] * y + m[10] * z + m[14];
+    float cw = m[3] * x + m[7] * y + m[11] * z + m[15];
+    if (cw < kNearW) {
+        return false;
+    }
+
+    // Pixel coordinates with rows from the top; depth mapped to 0..1
+    sx = (cx / cw * 0.5f + 0.5f) * mWidth;
+    sy = (0.5f - cy / cw * 0.5f) * mHeight;
+    depth = cz / cw * 0.5f + 0.5f;
+    return true;
+}
+
+void OcclusionCuller::RasterizeTriangle(const float* v0, const float* v1, const float* v2) {
+    float x[3], y[3], z[3];
+    const float* vertices[3] = { v0, v1, v2 };
+    for (int i = 0; i < 3; i++) {
+        if (!Project(vertices[i][0], vertices[i][1], vertices[i][2], x[i], y[i], z[i])) {
+            return;
+        }
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (std::fabs(area) < 1e-6f) {
+        return;
+    }
+
+    // Bounding box of the pixel centers it can cover
+    int minX = std::max(0, static_cast<int>(std::floor(std::min({ x[0], x[1], x[2] }))));
+    int maxX = std::min(mWidth - 1, static_cast<int>(std::ceil(std::max({ x[0], x[1], x[2] }))));
+    int minY = std::max(0, static_cast<int>(std::floor(std::min({ y[0], y[1], y[2] }))));
+    int maxY = std::min(mHeight - 1, static_cast<int>(std::ceil(std::max({ y[0], y[1], y[2] }))));
+
+    // Edge functions at pixel centers; depth is affine in screen space.
+    // Only pixels the triangle covers entirely are written: each barycentric
+    // must clear the most it changes within half a pixel of the center, and
+    // the depth stored is the farthest over the pixel.
+    std::vector<float>& depth = mLevels[0];
+    float inverseArea = 1.0f / area;
+    float margin0 = 0.5f * (std::fabs(x[2] - x[1]) + std::fabs(y[2] - y[1])) * std::fabs(inverseArea);
+    float margin1 = 0.5f * (std::fabs(x[0] - x[2]) + std::fabs(y[0] - y[2])) * std::fabs(inverseArea);
+    float margin2 = 0.5f * (std::fabs(x[1] - x[0]) + std::fabs(y[1] - y[0])) * std::fabs(inverseArea);
+    float depthX = (-(y[2] - y[1]) * (z[0] - z[2]) - (y[0] - y[2]) * (z[1] - z[2])) * inverseArea;
+    float depthY = ((x[2] - x[1]) * (z[0] - z[2]) + (x[0] - x[2]) * (z[1] - z[2])) * inverseArea;
+    float depthMargin = 0.5f * (std::fabs(depthX) + std::fabs(depthY));
+    for (int py = minY; py <= maxY; py++) {
+        float cy = py + 0.5f;
+        for (int px = minX; px <= maxX; px++) {
+            float cx = px + 0.5f;
+            float w0 = ((x[2] - x[1]) * (cy - y[1]) - (y[2] - y[1]) * (cx - x[1])) * inverseArea;
+            float w1 = ((x[0] - x[2]) * (cy - y[2]) - (y[0] - y[2]) * (cx - x[2])) * inverseArea;
+            float w2 = 1.0f - w0 - w1;
+            if (w0 < margin0 || w1 < margin1 || w2 < margin2) {
+                continue;
+            }
+
+            float d = w0 * z[0] + w1 * z[1] + w2 * z[2] + depthMargin;
+            float& stored = depth[static_cast<size_t>(py) * mWidth + px];
+            stored = std::min(stored, d);
+        }
+    }
+}
+
+void OcclusionCuller::BuildPyramid() {
+    for (size_t level = 1; level < mLevels.size(); level++) {
+        const std::vector<float>& source = mLevels[level - 1];
+        std::vector<float>& target = mLevels[level];
+        int sourceWidth = mLevelWidths[level - 1];
+        int sourceHeight = mLevelHeights[level - 1];
+
+        for (int y = 0; y < mLevelHeights[level]; y++) {
+            int y0 = std::min(sourceHeight - 1, y * 2);
+            int y1 = std::min(sourceHeight - 1, y * 2 + 1);
+            for (int x = 0; x < mLevelWidths[level]; x++) {
+                int x0 = std::min(sourceWidth - 1, x * 2);
+                int x1 = std::min(sourceWidth - 1, x * 2 + 1);
+                target[static_cast<size_t>(y) * mLevelWidths[level] + x] = std::max(
+                    std::max(source[static_cast<size_t>(y0) * sourceWidth + x0], source[static_cast<size_t>(y0) * sourceWidth + x1]),
+                    std::max(source[static_cast<size_t>(y1) * sourceWidth + x0], source[static_cast<size_t>(y1) * sourceWidth + x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::IsBoxVisible(const float* boundsMin, const float* boundsMax) const {
+    // Screen rectangle and nearest depth of the eight corners
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    float nearest = 1.0f;
+    for (int corner = 0; corner < 8; corner++) {
+        float x = (corner & 1) ? boundsMax[0] : boundsMin[0];
+        float y = (corner & 2) ? boundsMax[1] : boundsMin[1];
+        float z = (corner & 4) ? boundsMax[2] : boundsMin[2];
+
+        float sx, sy, depth;
+        if (!Project(x, y, z, sx, sy, depth)) {
+            return true;  // Reaches the camera: cannot be hidden
+        }
+        minX = std::min(minX, sx);
+        maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy);
+        maxY = std::max(maxY, sy);
+        nearest = std::min(nearest, depth);
+    }
+
+    int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+    int x1 = std::min(mWidth - 1, static_cast<int>(std::floor(maxX)));
+    int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+    int y1 = std::min(mHeight - 1, static_cast<int>(std::floor(maxY)));
+    if (x0 > x1 || y0 > y1) {
+        return true;  // Off screen; left to the frustum test
+    }
+
+    // Coarsest level where the rectangle still spans only a few texels
+    int level = 0;
+    while (level + 1 < static_cast<int>(mLevels.size()) &&
+           std::max(x1 - x0, y1 - y0) >> level >= kMaxTestTexels) {
+        level++;
+    }
+
+    const std::vector<float>& depth = mLevels[level];
+    int width = mLevelWidths[level];
+    for (int y = y0 >> level; y <= y1 >> level; y++) {
+        for (int x = x0 >> level; x <= x1 >> level; x++) {
+            if (depth[static_cast<size_t>(y) * width + x] >= nearest) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,49 @@
+// OcclusionCuller.h
+// Software-rasterized occluder depth with a hierarchical-Z pyramid
+
+#pragma once
+
+#include <vector>
+
+// Rasterizes occluder triangles into a small CPU depth buffer, reduces it to
+// a max-depth (Hi-Z) pyramid and tests bounding boxes against it: a box is
+// hidden when its nearest depth lies behind the farthest occluder depth over
+// the whole screen rectangle it covers. The test is conservative: occluders
+// only mark texels they cover entirely, at their farthest depth over the
+// texel, and boxes are only rejected when every covered texel is known to be
+// nearer, so hidden objects may be drawn but visible ones are never dropped.
+class OcclusionCuller {
+public:
+    // Resolution of the depth buffer (height follows the view's aspect)
+    static const int kWidth = 160;
+
+    OcclusionCuller();
+
+    // Start a frame: column-major view-projection (OpenGL clip space) and the
+    // aspect of the viewport it is used with. Clears the depth buffer.
+    void Begin(const float* viewProjection, int viewportWidth, int viewportHeight);
+
+    // Add one occluder triangle (world space, 3 x 3 floats). Triangles that
+    // reach behind the near plane are skipped rather than clipped.
+    void RasterizeTriangle(const float* v0, const float* v1, const float* v2);
+
+    // Reduce the depth buffer once all occluders are in
+    void BuildPyramid();
+
+    // False when the box is certainly hidden behind the occluders
+    bool IsBoxVisible(const float* boundsMin, const float* boundsMax) const;
+
+private:
+    // Clip-space projection into depth-buffer pixels; false behind the near plane
+    bool Project(float x, float y, float z, float& sx, float& sy, float& depth) const;
+
+    float mViewProjection[16];
+    int mWidth;
+    int mHeight;
+
+    // Level 0 is the rasterized depth (0 near .. 1 far); each further level
+    // keeps the farthest depth of a 2x2 block of the previous one
+    std::vector<std::vector<float>> mLevels;
+    std::vector<int> mLevelWidths;
+    std::vector<int> mLevelHeights;
+};
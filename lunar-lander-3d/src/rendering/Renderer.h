@@ -3,12 +3,16 @@
 
 #pragma once
 
+#include "Light.h"
 #include <string>
+#include <vector>
 
 // Forward declarations - make sure these are included before using them
 class Lander;
 class Terrain;
 class Game;
+class TrajectoryPredictor;
+class TerrainOverview;
 
 // Abstract renderer interface
 class Renderer {
@@ -25,16 +29,32 @@ public:
     // Entity rendering methods
     virtual void RenderLander(Lander* lander) = 0;
     virtual void RenderTerrain(Terrain* terrain) = 0;
+    virtual void RenderTrajectory(const TrajectoryPredictor* trajectory) = 0;
     
     // UI rendering methods
     virtual void RenderTelemetry(Game* game) = 0;
     virtual void RenderGameState(Game* game) = 0;
     
+    // Minimap inset: cached terrain overview plus the lander marker
+    virtual void RenderMinimap(const TerrainOverview* overview, const Lander* lander) = 0;
+    
     // Getter methods
     virtual int GetWidth() const = 0;
     virtual int GetHeight() const = 0;
     virtual bool IsInitialized() const = 0;
     
+    // Camera management (for 2D): view center in world units and pixels per unit
+    virtual void SetCamera2D(float centerX, float centerY, float zoom) = 0;
+    
+    // Views: the scene is drawn once per view, between BeginView and EndView
+    // (the 3D renderer adds a landing camera inset; 2D has a single view)
+    virtual int GetViewCount() const = 0;
+    virtual void BeginView(int index) = 0;
+    virtual void EndView(int index) = 0;
+    
+    // Downward-looking landing camera (for 3D), placed at the given point
+    virtual void SetLandingCamera(bool enabled, float x, float y, float z) = 0;
+    
     // Camera management (for 3D)
     virtual void SetCameraPosition(float x, float y, float z) = 0;
     virtual void SetCameraTarget(float x, float y, float z) = 0;
@@ -43,4 +63,7 @@ public:
     // Lighting (for 3D)
     virtual void SetLightPosition(float x, float y, float z) = 0;
     virtual void SetAmbientLight(float r, float g, float b) = 0;
+    
+    // Dynamic point and spot lights (for 3D), replacing the previous set
+    virtual void SetLights(const std::vector<Light>& lights) = 0;
 };
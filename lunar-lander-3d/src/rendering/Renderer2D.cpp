@@ -5,8 +5,14 @@
 #include "../core/Entity.h"
 #include "../core/Terrain.h"
 #include "../core/Game.h"
+#include "../core/TrajectoryPredictor.h"
+#include "../core/TerrainOverview.h"
+#include <algorithm>
 #include <iostream>
 
+// Largest terrain simplification error allowed on screen (pixels)
+static const float kTerrainPixelTolerance = 0.5f;
+
 Renderer2D::Renderer2D()
     : mWindow(nullptr)
     , mRenderer(nullptr)
@@ -14,6 +20,13 @@ Renderer2D::Renderer2D()
     , mHeight(600)
     , mInitialized(false)
     , mPixelsPerMeter(20.0f)
+    , mCameraX(400.0f)
+    , mCameraY(300.0f)
+    , mZoom(1.0f)
+    , mMinimapTexture(nullptr)
+    , mMinimapGeneration(0)
+    , mMinimapWidth(0)
+    , mMinimapHeight(0)
 {
 }
 
@@ -64,6 +77,11 @@ bool Renderer2D::Initialize(int width, int height, const std::string& title) {
 }
 
 void Renderer2D::Shutdown() {
+    if (mMinimapTexture) {
+        SDL_DestroyTexture(mMinimapTexture);
+        mMinimapTexture = nullptr;
+    }
+    
     if (mRenderer) {
         SDL_DestroyRenderer(mRenderer);
         mRenderer = nullptr;
@@ -114,14 +132,17 @@ void Renderer2D::RenderLander(Lander* lander) {
     << " screen pos: " << screenX << "," << screenY << std::endl;
 
     // IMPORTANT: Make lander bigger and use a bright color so it's visible
-    width = 40.0f;  // Increase width
-    height = 60.0f; // Increase height
-
+    // (scaled with the camera zoom, but never smaller than a few pixels)
+    width = std::max(4.0f, 40.0f * mZoom);   // Increase width
+    height = std::max(6.0f, 60.0f * mZoom);  // Increase height
+    
+    float centerX = WorldToScreenX(position[0]);
+    float centerY = WorldToScreenY(position[1]);
     
     // Draw lander body as a rectangle
     DrawRect(
-        position[0] - width / 2, 
-        position[1] - height / 2, 
+        centerX - width / 2, 
+        centerY - height / 2, 
         width, 
         height, 
         255, 0, 0
@@ -130,8 +151,8 @@ void Renderer2D::RenderLander(Lander* lander) {
     // Draw thrust flame if active
     if (lander->IsThrustActive()) {
         DrawRect(
-            position[0] - width / 4,
-            position[1] + height / 2,
+            centerX - width / 4,
+            centerY + height / 2,
             width / 2,
             height / 3,
             255, 165, 0
@@ -143,20 +164,147 @@ void Renderer2D::RenderLander(Lander* lander) {
 void Renderer2D::RenderTerrain(Terrain* terrain) {
     if (!mInitialized || !terrain) return;
     
-    // Get terrain segments
-    const std::vector<TerrainSegment>& segments = terrain->GetSegments2D();
+    // Horizontal world range covered by the screen
+    float halfViewWidth = mWidth / 2 / mZoom;
+    float viewLeft = mCameraX - halfViewWidth;
+    float viewRight = mCameraX + halfViewWidth;
     
-    // Draw each terrain segment
-    for (const auto& segment : segments) {
+    // Coarsest level of detail whose error stays under a fraction of a pixel
+    int levelCount = terrain->GetLodLevelCount2D();
+    float maxError = kTerrainPixelTolerance / mZoom;
+    int level = 0;
+    while (level + 1 < levelCount && terrain->GetLodTolerance2D(level + 1) <= maxError) {
+        level++;
+    }
+    
+    // Segments are sorted by x: binary search for the visible range, and go
+    // coarser while it would need more lines than the screen has columns
+    auto byEnd = [](const TerrainSegment& segment, float x) { return segment.x2 < x; };
+    auto byStart = [](float x, const TerrainSegment& segment) { return x < segment.x1; };
+    const std::vector<TerrainSegment>* segments = &terrain->GetSegments2D(level);
+    auto first = std::lower_bound(segments->begin(), segments->end(), viewLeft, byEnd);
+    auto last = std::upper_bound(first, segments->end(), viewRight, byStart);
+    
+    while (last - first > mWidth && level + 1 < levelCount) {
+        segments = &terrain->GetSegments2D(++level);
+        first = std::lower_bound(segments->begin(), segments->end(), viewLeft, byEnd);
+        last = std::upper_bound(first, segments->end(), viewRight, byStart);
+    }
+    
+    // Draw the visible terrain segments
+    for (auto it = first; it != last; ++it) {
+        const TerrainSegment& segment = *it;
+        float x1 = WorldToScreenX(segment.x1);
+        float y1 = WorldToScreenY(segment.y1);
+        float x2 = WorldToScreenX(segment.x2);
+        float y2 = WorldToScreenY(segment.y2);
+        
         // Use white for normal terrain and green for landing pads
         if (segment.isLandingPad) {
-            DrawLine(segment.x1, segment.y1, segment.x2, segment.y2, 0, 255, 0);
+            DrawLine(x1, y1, x2, y2, 0, 255, 0);
         } else {
-            DrawLine(segment.x1, segment.y1, segment.x2, segment.y2, 200, 200, 200);
+            DrawLine(x1, y1, x2, y2, 200, 200, 200);
         }
     }
 }
 
+void Renderer2D::RenderTrajectory(const TrajectoryPredictor* trajectory) {
+    if (!mInitialized || !trajectory) return;
+    
+    const std::vector<TrajectoryPoint>& points = trajectory->GetPoints();
+    
+    // Predicted path in light blue
+    for (size_t i = trajectory->GetFirstIndex() + 1; i < points.size(); i++) {
+        DrawLine(WorldToScreenX(points[i - 1].position[0]), WorldToScreenY(points[i - 1].position[1]),
+                 WorldToScreenX(points[i].position[0]), WorldToScreenY(points[i].position[1]),
+                 100, 180, 255);
+    }
+    
+    // Predicted touchdown: green on a landing pad, red elsewhere
+    if (trajectory->HasImpact()) {
+        const float* impact = trajectory->GetImpactPoint();
+        float x = WorldToScreenX(impact[0]);
+        float y = WorldToScreenY(impact[1]);
+        Uint8 red = trajectory->IsImpactOnLandingPad() ? 0 : 255;
+        Uint8 green = trajectory->IsImpactOnLandingPad() ? 255 : 0;
+        
+        DrawLine(x - 6, y - 6, x + 6, y + 6, red, green, 0);
+        DrawLine(x - 6, y + 6, x + 6, y - 6, red, green, 0);
+    }
+}
+
+void Renderer2D::RenderMinimap(const TerrainOverview* overview, const Lander* lander) {
+    if (!mInitialized || !overview || !overview->IsReady()) return;
+    
+    int width = overview->GetWidth();
+    int height = overview->GetHeight();
+    
+    // Upload the overview only when a new one has been built
+    if (!mMinimapTexture || mMinimapGeneration != overview->GetGeneration()) {
+        if (mMinimapTexture && (mMinimapWidth != width || mMinimapHeight != height)) {
+            SDL_DestroyTexture(mMinimapTexture);
+            mMinimapTexture = nullptr;
+        }
+        
+        if (!mMinimapTexture) {
+            mMinimapTexture = SDL_CreateTexture(mRenderer, SDL_PIXELFORMAT_RGBA32,
+                                                SDL_TEXTUREACCESS_STATIC, width, height);
+            if (!mMinimapTexture) {
+                std::cerr << "Minimap texture creation failed: " << SDL_GetError() << std::endl;
+                return;
+            }
+            SDL_SetTextureBlendMode(mMinimapTexture, SDL_BLENDMODE_BLEND);
+            mMinimapWidth = width;
+            mMinimapHeight = height;
+        }
+        
+        SDL_UpdateTexture(mMinimapTexture, nullptr, overview->GetPixels().data(), width * 4);
+        mMinimapGeneration = overview->GetGeneration();
+    }
+    
+    // Inset in the top right corner
+    SDL_Rect inset { mWidth - width - 10, 10, width, height };
+    SDL_RenderCopy(mRenderer, mMinimapTexture, nullptr, &inset);
+    
+    SDL_SetRenderDrawColor(mRenderer, 120, 120, 120, 255);
+    SDL_RenderDrawRect(mRenderer, &inset);
+    
+    // Part of the world currently on screen
+    float left = 0.0f, top = 0.0f, right = 0.0f, bottom = 0.0f;
+    overview->WorldToMap(mCameraX - mWidth / 2 / mZoom, mCameraY - mHeight / 2 / mZoom, 0.0f, left, top);
+    overview->WorldToMap(mCameraX + mWidth / 2 / mZoom, mCameraY + mHeight / 2 / mZoom, 0.0f, right, bottom);
+    left = std::max(0.0f, left);
+    top = std::max(0.0f, top);
+    right = std::min(1.0f, right);
+    bottom = std::min(1.0f, bottom);
+    
+    SDL_Rect view {
+        inset.x + static_cast<int>(left * width),
+        inset.y + static_cast<int>(top * height),
+        static_cast<int>((right - left) * width),
+        static_cast<int>((bottom - top) * height)
+    };
+    SDL_SetRenderDrawColor(mRenderer, 100, 180, 255, 255);
+    SDL_RenderDrawRect(mRenderer, &view);
+    
+    // Lander marker (pinned to the edge when it is off the map)
+    if (lander) {
+        const float* position = lander->GetPosition();
+        float u = 0.0f, v = 0.0f;
+        overview->WorldToMap(position[0], position[1], position[2], u, v);
+        u = std::max(0.0f, std::min(1.0f, u));
+        v = std::max(0.0f, std::min(1.0f, v));
+        
+        DrawRect(inset.x + u * width - 2, inset.y + v * height - 2, 4, 4, 255, 0, 0);
+    }
+}
+
+void Renderer2D::SetCamera2D(float centerX, float centerY, float zoom) {
+    mCameraX = centerX;
+    mCameraY = centerY;
+    mZoom = zoom > 0.0f ? zoom : 1.0f;
+}
+
 void Renderer2D::RenderTelemetry(Game* game) {
     if (!mInitialized || !game) return;
     
@@ -19,14 +19,25 @@ public:
     
     void RenderLander(Lander* lander) override;
     void RenderTerrain(Terrain* terrain) override;
+    void RenderTrajectory(const TrajectoryPredictor* trajectory) override;
     
     void RenderTelemetry(Game* game) override;
     void RenderGameState(Game* game) override;
+    void RenderMinimap(const TerrainOverview* overview, const Lander* lander) override;
     
     int GetWidth() const override { return mWidth; }
     int GetHeight() const override { return mHeight; }
     bool IsInitialized() const override { return mInitialized; }
     
+    // 2D camera
+    void SetCamera2D(float centerX, float centerY, float zoom) override;
+    
+    // Single view, no landing camera
+    int GetViewCount() const override { return 1; }
+    void BeginView(int index) override {}
+    void EndView(int index) override {}
+    void SetLandingCamera(bool enabled, float x, float y, float z) override {}
+    
     // 3D camera methods (implemented as no-ops for 2D renderer)
     void SetCameraPosition(float x, float y, float z) override {}
     void SetCameraTarget(float x, float y, float z) override {}
@@ -35,6 +46,7 @@ public:
     // 3D lighting methods (implemented as no-ops for 2D renderer)
     void SetLightPosition(float x, float y, float z) override {}
     void SetAmbientLight(float r, float g, float b) override {}
+    void SetLights(const std::vector<Light>& lights) override {}
     
     // Helper methods for 2D rendering
     void DrawRect(float x, float y, float width, float height, 
@@ -42,6 +54,10 @@ public:
     void DrawLine(float x1, float y1, float x2, float y2, 
                  Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
     
+    // Camera transform from world to screen coordinates
+    float WorldToScreenX(float x) const { return (x - mCameraX) * mZoom + mWidth / 2; }
+    float WorldToScreenY(float y) const { return (y - mCameraY) * mZoom + mHeight / 2; }
+    
 private:
     // SDL rendering variables
     SDL_Window* mWindow;
@@ -54,4 +70,15 @@ private:
     
     // Conversion from world coordinates to screen coordinates
     float mPixelsPerMeter;
+    
+    // 2D camera (view center in world units, zoom in pixels per world unit)
+    float mCameraX;
+    float mCameraY;
+    float mZoom;
+    
+    // Minimap texture, uploaded once per terrain overview generation
+    SDL_Texture* mMinimapTexture;
+    unsigned int mMinimapGeneration;
+    int mMinimapWidth;
+    int mMinimapHeight;
 };
@@ -5,8 +5,13 @@
 #include "../core/Entity.h"
 #include "../core/Terrain.h"
 #include "../core/Game.h"
+#include "../core/TrajectoryPredictor.h"
+#include "../core/TerrainOverview.h"
+#include "ShaderCache.h"
 #include <iostream>
 #include <cmath>
+#include <cstddef>
+#include <algorithm>
 
 // Include OpenGL headers
 #ifdef __APPLE__
@@ -17,53 +22,129 @@
     #include <GL/glu.h>
 #endif
 
-// Simple vertex and fragment shaders for basic lighting
+// Lit shaders for the fixed-function geometry (compatibility profile, so they
+// read glVertex/glNormal/glColor and the matrix stacks). Lighting is done in
+// view space: one main light plus the clustered dynamic lights. With
+// NORMAL_MAP the normals come from the baked terrain normal map instead.
 const char* vertexShaderSource = R"(
-    #version 330 core
-    layout(location = 0) in vec3 aPos;
-    layout(location = 1) in vec3 aNormal;
+    #version 330 compatibility
     
-    uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 projection;
-    
-    out vec3 FragPos;
+    out vec3 ViewPos;
     out vec3 Normal;
+    out vec3 Color;
+    
+    #ifdef NORMAL_MAP
+    uniform vec2 normalMapScale;  // World x, z to texture coordinates
+    out vec2 NormalMapCoord;
+    #endif
     
     void main() {
-        FragPos = vec3(model * vec4(aPos, 1.0));
-        Normal = mat3(transpose(inverse(model))) * aNormal;
-        gl_Position = projection * view * model * vec4(aPos, 1.0);
+        ViewPos = vec3(gl_ModelViewMatrix * gl_Vertex);
+        Normal = gl_NormalMatrix * gl_Normal;
+        Color = gl_Color.rgb;
+    #ifdef NORMAL_MAP
+        NormalMapCoord = gl_Vertex.xz * normalMapScale;
+    #endif
+        gl_Position = gl_ProjectionMatrix * vec4(ViewPos, 1.0);
     }
 )";
 
 const char* fragmentShaderSource = R"(
-    #version 330 core
-    in vec3 FragPos;
+    #version 330 compatibility
+    in vec3 ViewPos;
     in vec3 Normal;
+    in vec3 Color;
     
-    uniform vec3 lightPos;
+    uniform vec3 lightPos;      // View space
     uniform vec3 ambientLight;
-    uniform vec3 objectColor;
+    
+    // Clustered lights (see LightClusters)
+    uniform sampler2D lightData;      // Per light: position/radius, color, spot direction/cosine
+    uniform usampler2D clusterGrid;   // (offset, count) at (tile x + tile y * tiles x, slice)
+    uniform usampler2D lightIndices;  // Light lists back to back, indexRowLength per row
+    uniform vec4 clusterParams;       // Tile width, tile height, slice scale, slice bias
+    uniform ivec3 clusterCounts;      // Tiles x, tiles y, slices
+    uniform int indexRowLength;
+    
+    #ifdef NORMAL_MAP
+    uniform sampler2D normalMap;  // Object-space normals, see TerrainNormalMap
+    in vec2 NormalMapCoord;
+    #endif
     
     out vec4 FragColor;
     
     void main() {
         // Ambient light
-        vec3 ambient = ambientLight * objectColor;
+        vec3 ambient = ambientLight * Color;
         
-        // Diffuse light
+        // Normal facing the viewer (the terrain's from its full-resolution heights)
+    #ifdef NORMAL_MAP
+        vec3 norm = normalize(gl_NormalMatrix * (texture(normalMap, NormalMapCoord).xyz * 2.0 - 1.0));
+    #else
         vec3 norm = normalize(Normal);
-        vec3 lightDir = normalize(lightPos - FragPos);
+    #endif
+        norm = faceforward(norm, ViewPos, norm);
+        
+        // Main light
+        vec3 lightDir = normalize(lightPos - ViewPos);
         float diff = max(dot(norm, lightDir), 0.0);
-        vec3 diffuse = diff * vec3(1.0, 1.0, 1.0) * objectColor;
+        vec3 result = ambient + diff * Color;
+        
+        // Only the lights listed for this fragment's cluster
+        ivec2 tile = min(ivec2(gl_FragCoord.xy / clusterParams.xy), clusterCounts.xy - 1);
+        int slice = clamp(int(floor(log(-ViewPos.z) * clusterParams.z + clusterParams.w)), 0, clusterCounts.z - 1);
+        uvec2 cluster = texelFetch(clusterGrid, ivec2(tile.x + tile.y * clusterCounts.x, slice), 0).xy;
+        
+        for (uint i = 0u; i < cluster.y; i++) {
+            int entry = int(cluster.x + i);
+            int index = int(texelFetch(lightIndices, ivec2(entry % indexRowLength, entry / indexRowLength), 0).r);
+            vec4 position = texelFetch(lightData, ivec2(index, 0), 0);
+            vec3 color = texelFetch(lightData, ivec2(index, 1), 0).rgb;
+            vec4 spot = texelFetch(lightData, ivec2(index, 2), 0);
+            
+            vec3 toLight = position.xyz - ViewPos;
+            float distance = length(toLight);
+            vec3 direction = toLight / max(distance, 0.0001);
+            
+            // Smooth falloff to zero at the light's radius
+            float falloff = clamp(1.0 - (distance * distance) / (position.w * position.w), 0.0, 1.0);
+            falloff *= falloff;
+            
+            // Spot cone with a soft edge; point lights have a cosine of -1
+            float cone = 1.0;
+            if (spot.w > -1.0) {
+                cone = smoothstep(spot.w, mix(spot.w, 1.0, 0.25), dot(-direction, spot.xyz));
+            }
+            
+            result += color * Color * max(dot(norm, direction), 0.0) * falloff * cone;
+        }
         
-        // Combine lights
-        vec3 result = ambient + diffuse;
         FragColor = vec4(result, 1.0);
     }
 )";
 
+// Program variants built from the sources above
+static const ShaderVariant kLitShaderVariant = { "lit", {} };
+static const ShaderVariant kTerrainShaderVariant = { "lit_terrain", { "NORMAL_MAP" } };
+
+// Texture units of the clustered lighting data
+static const int kLightDataUnit = 1;
+static const int kClusterGridUnit = 2;
+static const int kLightIndexUnit = 3;
+
+// Texture unit of the terrain normal map
+static const int kNormalMapUnit = 4;
+
+// Clip planes of every 3D view
+static const float kNearPlane = 0.1f;
+static const float kFarPlane = 1000.0f;
+
+// Models switch to a coarser level once its error stays under this (pixels)
+static const float kModelLodPixelError = 1.0f;
+
+// Time per frame spent finishing asset uploads (seconds)
+static const float kAssetUploadBudget = 0.002f;
+
 Renderer3D::Renderer3D()
     : mWindow(nullptr)
     , mGLContext(nullptr)
@@ -71,14 +152,32 @@ Renderer3D::Renderer3D()
     , mHeight(600)
     , mInitialized(false)
     , mShaderProgram(0)
-    , mModelMatrixLocation(0)
-    , mViewMatrixLocation(0)
-    , mProjectionMatrixLocation(0)
-    , mLightPositionLocation(0)
-    , mAmbientLightLocation(0)
-    , mLanderModel(0)
-    , mLanderVertexCount(0)
+    , mTerrainShaderProgram(0)
+    , mTerrainShaderRequested(false)
+    , mLitUniforms()
+    , mTerrainUniforms()
+    , mLightTexture(0)
+    , mClusterTexture(0)
+    , mLightIndexTexture(0)
+    , mCurrentView(nullptr)
+    , mMinimapTexture(0)
+    , mMinimapGeneration(0)
+    , mMainView()
+    , mInsetView()
+    , mLandingCameraEnabled(false)
+    , mInsetTexture(0)
+    , mInsetDrawn(false)
+    , mCulledTerrain(nullptr)
+    , mCullValid(false)
+    , mTileTerrain(nullptr)
+    , mTileGeneration(0)
+    , mNormalMapTerrain(nullptr)
+    , mNormalMapTerrainGeneration(0)
+    , mNormalMapTexture(0)
+    , mNormalMapGeneration(0)
 {
+    mLandingCamera[0] = mLandingCamera[1] = mLandingCamera[2] = 0.0f;
+    
     // Initialize camera position
     mCameraPosition[0] = 0.0f;
     mCameraPosition[1] = 100.0f;
@@ -123,7 +222,8 @@ bool Renderer3D::Initialize(int width, int height, const std::string& title) {
     // Set OpenGL attributes
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    // Compatibility profile: the scene is drawn with fixed-function calls
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_COMPATIBILITY);
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
     
@@ -188,48 +288,118 @@ bool Renderer3D::InitializeOpenGL() {
     // Create projection matrix
     float aspectRatio = (float)mWidth / (float)mHeight;
     mProjectionMatrix = CreateProjectionMatrix(45.0f, aspectRatio, 0.1f, 1000.0f);
+    SetupViews();
     
     return true;
 }
 
 bool Renderer3D::LoadShaders() {
-    // For a real implementation, this would load and compile shaders
-    // Since we're using a simplified approach, we'll just create a dummy shader program
-    mShaderProgram = 1; // Dummy value, actual implementation would use glCreateProgram()
+    // Linked programs are cached as driver binaries in the preferences directory
+    std::string cacheDirectory;
+    char* prefPath = SDL_GetPrefPath("LunarLander", "LunarLander");
+    if (prefPath) {
+        cacheDirectory = prefPath;
+        SDL_free(prefPath);
+    }
+    
+    // The scene itself is drawn with fixed-function calls, so missing shader
+    // support is reported but not fatal
+    mShaderCache.reset(new ShaderCache());
+    if (!mShaderCache->Initialize(mWindow, mGLContext, cacheDirectory)) {
+        mShaderCache.reset();
+        return true;
+    }
+    
+    mShaderProgram = LoadShader(kLitShaderVariant, vertexShaderSource, fragmentShaderSource);
+    if (!mShaderProgram) {
+        return true;
+    }
+    
+    mLitUniforms = GetLitUniforms(mShaderProgram);
+    CreateLightTextures();
     
-    // Set uniform locations (in a real implementation, these would be real locations)
-    mModelMatrixLocation = 1;
-    mViewMatrixLocation = 2;
-    mProjectionMatrixLocation = 3;
-    mLightPositionLocation = 4;
-    mAmbientLightLocation = 5;
+    // The terrain variant is built in the background on a cold start and
+    // picked up from the cache once that is done (see Clear)
+    mShaderCache->Precompile({ kTerrainShaderVariant }, vertexShaderSource, fragmentShaderSource);
     
     return true;
 }
 
 bool Renderer3D::LoadModels() {
-    // For a real implementation, this would load 3D models from files
-    // For simplicity, we'll just create placeholder values
+    // Assets are installed next to the executable
+    std::string basePath;
+    char* path = SDL_GetBasePath();
+    if (path) {
+        basePath = path;
+        SDL_free(path);
+    }
+    
+    mAssets.reset(new AssetManager());
+    mAssets->Initialize(basePath);
+    auto release = [this](Asset& asset) { ReleaseAsset(asset); };
+    auto uploadTexture = [this](Asset& asset) { return UploadTextureAsset(asset); };
+    mAssets->SetUploader(AssetType::Texture, uploadTexture, release);
+    mAssets->SetUploader(AssetType::Font, uploadTexture, release);
+    
+    // Models need buffer objects; without them the lander stays a box
+    if (!mShaderCache) {
+        return true;
+    }
+    mAssets->SetUploader(AssetType::Model, [this](Asset& asset) { return UploadModelAsset(asset); }, release);
     
-    // Create a simple cube model for the lander
-    mLanderModel = 1; // Dummy value
-    mLanderVertexCount = 36; // A cube has 36 vertices (6 faces, 2 triangles per face, 3 vertices per triangle)
+    // Loads in the background; see Clear for the uploads
+    mLanderModel = mAssets->Load(AssetType::Model, "assets/models/lander.obj");
     
     return true;
 }
 
 void Renderer3D::Shutdown() {
     // Clean up OpenGL resources
-    if (mShaderProgram) {
-        // In a real implementation: glDeleteProgram(mShaderProgram);
-        mShaderProgram = 0;
+    if (mMinimapTexture && mGLContext) {
+        glDeleteTextures(1, &mMinimapTexture);
+        mMinimapTexture = 0;
+    }
+    
+    if (mInsetTexture && mGLContext) {
+        glDeleteTextures(1, &mInsetTexture);
+        mInsetTexture = 0;
+    }
+    
+    if (mNormalMapTexture && mGLContext) {
+        glDeleteTextures(1, &mNormalMapTexture);
+        mNormalMapTexture = 0;
+    }
+    mNormalMapTerrain = nullptr;
+    
+    if (mLightTexture && mGLContext) {
+        GLuint textures[3] = { mLightTexture, mClusterTexture, mLightIndexTexture };
+        glDeleteTextures(3, textures);
+        mLightTexture = mClusterTexture = mLightIndexTexture = 0;
     }
     
-    if (mLanderModel) {
-        // In a real implementation: glDeleteVertexArrays(1, &mLanderModel);
-        mLanderModel = 0;
+    // Dropping the handles lets Shutdown release the GPU objects while the
+    // context is still there
+    mLanderModel.Reset();
+    if (mAssets) {
+        mAssets->Shutdown();
+        mAssets.reset();
     }
     
+    if (mShaderCache) {
+        const GLFunctions& gl = mShaderCache->GetFunctions();
+        if (mShaderProgram) gl.DeleteProgram(mShaderProgram);
+        if (mTerrainShaderProgram) gl.DeleteProgram(mTerrainShaderProgram);
+        
+        // Joins the precompile thread before its shared context goes away
+        mShaderCache->Shutdown();
+        mShaderCache.reset();
+    }
+    mShaderProgram = 0;
+    mTerrainShaderProgram = 0;
+    mTerrainShaderRequested = false;
+    mLitUniforms = LitUniforms();
+    mTerrainUniforms = LitUniforms();
+    
     // Delete OpenGL context
     if (mGLContext) {
         SDL_GL_DeleteContext(mGLContext);
@@ -250,6 +420,342 @@ void Renderer3D::Clear() {
     
     // Clear color and depth buffers
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    
+    // New frame: camera matrices and terrain culling are redone once
+    SetupViews();
+    mCullValid = false;
+    mInsetDrawn = false;
+    
+    // Finish assets the workers have decoded, a few per frame
+    if (mAssets) {
+        mAssets->ProcessUploads(kAssetUploadBudget);
+    }
+    
+    // Terrain program, once the background precompile has cached it
+    if (mShaderCache && !mTerrainShaderRequested && !mShaderCache->IsPrecompiling()) {
+        mTerrainShaderRequested = true;
+        mTerrainShaderProgram = LoadShader(kTerrainShaderVariant, vertexShaderSource, fragmentShaderSource);
+        if (mTerrainShaderProgram) {
+            mTerrainUniforms = GetLitUniforms(mTerrainShaderProgram);
+        }
+    }
+}
+
+void Renderer3D::SetLandingCamera(bool enabled, float x, float y, float z) {
+    mLandingCameraEnabled = enabled;
+    mLandingCamera[0] = x;
+    mLandingCamera[1] = y;
+    mLandingCamera[2] = z;
+}
+
+void Renderer3D::SetupViews() {
+    // Main chase view over the whole window
+    SetupView(mMainView, mCameraPosition, mCameraTarget, mCameraUp, 45.0f, 0, 0, mWidth, mHeight);
+    
+    // Landing camera looking straight down (Y grows towards the ground),
+    // rendered small in the corner of the back buffer and scaled up later
+    if (mLandingCameraEnabled) {
+        const float target[3] = { mLandingCamera[0], mLandingCamera[1] + 100.0f, mLandingCamera[2] };
+        const float up[3] = { 0.0f, 0.0f, -1.0f };
+        SetupView(mInsetView, mLandingCamera, target, up, 60.0f, 0, 0,
+                  kInsetWidth / kInsetDownscale, kInsetHeight / kInsetDownscale);
+    }
+}
+
+void Renderer3D::SetupView(ViewSetup& setup, const float* eye, const float* target, const float* up,
+                           float fov, int x, int y, int width, int height) {
+    setup.projection = CreateProjectionMatrix(fov, (float)width / (float)height, kNearPlane, kFarPlane);
+    setup.view = CreateLookAtMatrix(eye, target, up);
+    std::copy(eye, eye + 3, setup.eye);
+    setup.viewport[0] = x;
+    setup.viewport[1] = y;
+    setup.viewport[2] = width;
+    setup.viewport[3] = height;
+    
+    // Frustum planes from the rows of projection * view
+    MultiplyMatrices(setup.viewProjection, setup.projection, setup.view);
+    const float* m = setup.viewProjection.values;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            setup.frustum[i * 2][j] = m[j * 4 + 3] + m[j * 4 + i];
+            setup.frustum[i * 2 + 1][j] = m[j * 4 + 3] - m[j * 4 + i];
+        }
+    }
+}
+
+void Renderer3D::ApplyView(const ViewSetup& setup) {
+    glViewport(setup.viewport[0], setup.viewport[1], setup.viewport[2], setup.viewport[3]);
+    
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(setup.projection.values);
+    
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixf(setup.view.values);
+}
+
+void Renderer3D::BeginView(int index) {
+    if (!mInitialized) return;
+    
+    if (IsInsetView(index)) {
+        // Clear just the corner the inset is rendered into
+        const int* viewport = mInsetView.viewport;
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glDisable(GL_SCISSOR_TEST);
+        
+        mCurrentView = &mInsetView;
+        ApplyView(mInsetView);
+        UploadLights(mInsetView);
+    } else {
+        // The inset left its pixels in the back buffer: start the main view clean
+        if (mInsetDrawn) {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+        
+        mCurrentView = &mMainView;
+        ApplyView(mMainView);
+        UploadLights(mMainView);
+    }
+}
+
+void Renderer3D::EndView(int index) {
+    if (!mInitialized) return;
+    
+    if (IsInsetView(index)) {
+        const int* viewport = mInsetView.viewport;
+        
+        // Keep the low-resolution inset in a texture
+        if (!mInsetTexture) {
+            glGenTextures(1, &mInsetTexture);
+            glBindTexture(GL_TEXTURE_2D, mInsetTexture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, viewport[2], viewport[3], 0,
+                         GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        } else {
+            glBindTexture(GL_TEXTURE_2D, mInsetTexture);
+        }
+        
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, viewport[0], viewport[1], viewport[2], viewport[3]);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        mInsetDrawn = true;
+    } else if (mInsetDrawn) {
+        DrawInset();
+    }
+    
+    // Later UI drawing uses the whole window
+    glViewport(0, 0, mWidth, mHeight);
+}
+
+void Renderer3D::DrawInset() {
+    // Scale the inset up into the bottom right corner of the window
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0, mWidth, mHeight, 0.0, -1.0, 1.0);
+    
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    
+    glDisable(GL_DEPTH_TEST);
+    
+    float left = static_cast<float>(mWidth - kInsetWidth - 10);
+    float top = static_cast<float>(mHeight - kInsetHeight - 10);
+    float right = left + kInsetWidth;
+    float bottom = top + kInsetHeight;
+    
+    // Texture rows start at the bottom of the window
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, mInsetTexture);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 1.0f); glVertex2f(left, top);
+    glTexCoord2f(1.0f, 1.0f); glVertex2f(right, top);
+    glTexCoord2f(1.0f, 0.0f); glVertex2f(right, bottom);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(left, bottom);
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+    
+    // Frame
+    glColor3f(0.5f, 0.5f, 0.5f);
+    glBegin(GL_LINE_LOOP);
+    glVertex2f(left, top);
+    glVertex2f(right, top);
+    glVertex2f(right, bottom);
+    glVertex2f(left, bottom);
+    glEnd();
+    
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    
+    glEnable(GL_DEPTH_TEST);
+}
+
+bool Renderer3D::IsTriangleVisible(const ViewSetup& setup, const TerrainTriangle& triangle) const {
+    // Outside when all three corners are behind the same plane
+    for (int p = 0; p < 6; p++) {
+        const float* plane = setup.frustum[p];
+        bool allOutside = true;
+        for (int v = 0; v < 3 && allOutside; v++) {
+            const float* vertex = &triangle.vertices[v * 3];
+            if (plane[0] * vertex[0] + plane[1] * vertex[1] + plane[2] * vertex[2] + plane[3] >= 0.0f) {
+                allOutside = false;
+            }
+        }
+        if (allOutside) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+bool Renderer3D::IsBoxInFrustum(const ViewSetup& setup, const float* boundsMin, const float* boundsMax) const {
+    // Outside when even the corner furthest along a plane's normal is behind it
+    for (int p = 0; p < 6; p++) {
+        const float* plane = setup.frustum[p];
+        float x = plane[0] >= 0.0f ? boundsMax[0] : boundsMin[0];
+        float y = plane[1] >= 0.0f ? boundsMax[1] : boundsMin[1];
+        float z = plane[2] >= 0.0f ? boundsMax[2] : boundsMin[2];
+        if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void Renderer3D::BuildTerrainTiles(const Terrain* terrain) {
+    if (mTileTerrain == terrain && mTileGeneration == terrain->GetGeneration()) {
+        return;
+    }
+    
+    mTerrainTiles.assign(kTerrainTilesPerSide * kTerrainTilesPerSide, TerrainTile());
+    mTileTerrain = terrain;
+    mTileGeneration = terrain->GetGeneration();
+    
+    const std::vector<TerrainTriangle>& triangles = terrain->GetTriangles3D();
+    if (triangles.empty()) {
+        return;
+    }
+    
+    // Ground extent on X/Z, split into an even grid
+    float minX = triangles[0].vertices[0], maxX = minX;
+    float minZ = triangles[0].vertices[2], maxZ = minZ;
+    for (const TerrainTriangle& triangle : triangles) {
+        for (int v = 0; v < 3; v++) {
+            minX = std::min(minX, triangle.vertices[v * 3]);
+            maxX = std::max(maxX, triangle.vertices[v * 3]);
+            minZ = std::min(minZ, triangle.vertices[v * 3 + 2]);
+            maxZ = std::max(maxZ, triangle.vertices[v * 3 + 2]);
+        }
+    }
+    float tileWidth = std::max(maxX - minX, 1.0f) / kTerrainTilesPerSide;
+    float tileLength = std::max(maxZ - minZ, 1.0f) / kTerrainTilesPerSide;
+    
+    // Each triangle goes to the tile holding its centroid
+    for (size_t i = 0; i < triangles.size(); i++) {
+        const float* v = triangles[i].vertices;
+        float centerX = (v[0] + v[3] + v[6]) / 3.0f;
+        float centerZ = (v[2] + v[5] + v[8]) / 3.0f;
+        int tileX = std::min(kTerrainTilesPerSide - 1, static_cast<int>((centerX - minX) / tileWidth));
+        int tileZ = std::min(kTerrainTilesPerSide - 1, static_cast<int>((centerZ - minZ) / tileLength));
+        
+        TerrainTile& tile = mTerrainTiles[tileZ * kTerrainTilesPerSide + tileX];
+        if (tile.triangles.empty()) {
+            std::copy(v, v + 3, tile.boundsMin);
+            std::copy(v, v + 3, tile.boundsMax);
+        }
+        for (int corner = 0; corner < 3; corner++) {
+            for (int axis = 0; axis < 3; axis++) {
+                tile.boundsMin[axis] = std::min(tile.boundsMin[axis], v[corner * 3 + axis]);
+                tile.boundsMax[axis] = std::max(tile.boundsMax[axis], v[corner * 3 + axis]);
+            }
+        }
+        tile.triangles.push_back(static_cast<int>(i));
+    }
+}
+
+void Renderer3D::CullTerrain(const Terrain* terrain) {
+    // One visibility pass per frame, shared by every view
+    if (mCullValid && mCulledTerrain == terrain) {
+        return;
+    }
+    
+    BuildTerrainTiles(terrain);
+    const std::vector<TerrainTriangle>& triangles = terrain->GetTriangles3D();
+    
+    // Tiles in the main view, nearest first
+    std::vector<std::pair<float, int>> mainTiles;
+    for (size_t t = 0; t < mTerrainTiles.size(); t++) {
+        const TerrainTile& tile = mTerrainTiles[t];
+        if (tile.triangles.empty() || !IsBoxInFrustum(mMainView, tile.boundsMin, tile.boundsMax)) {
+            continue;
+        }
+        float distance = 0.0f;
+        for (int axis = 0; axis < 3; axis++) {
+            float center = (tile.boundsMin[axis] + tile.boundsMax[axis]) * 0.5f;
+            distance += (center - mCameraPosition[axis]) * (center - mCameraPosition[axis]);
+        }
+        mainTiles.push_back(std::make_pair(distance, static_cast<int>(t)));
+    }
+    std::sort(mainTiles.begin(), mainTiles.end());
+    
+    // The nearest tiles stand in for the whole ridge line: rasterize them
+    // into the occlusion buffer and test every tile's box against it
+    mOcclusion.Begin(mMainView.viewProjection.values, mMainView.viewport[2], mMainView.viewport[3]);
+    int occluderCount = std::min(static_cast<int>(mainTiles.size()), static_cast<int>(kMaxOccluderTiles));
+    for (int i = 0; i < occluderCount; i++) {
+        for (int index : mTerrainTiles[mainTiles[i].second].triangles) {
+            const float* v = triangles[index].vertices;
+            mOcclusion.RasterizeTriangle(&v[0], &v[3], &v[6]);
+        }
+    }
+    mOcclusion.BuildPyramid();
+    
+    std::vector<bool> mainVisible(mTerrainTiles.size(), false);
+    for (const auto& entry : mainTiles) {
+        const TerrainTile& tile = mTerrainTiles[entry.second];
+        mainVisible[entry.second] = mOcclusion.IsBoxVisible(tile.boundsMin, tile.boundsMax);
+    }
+    
+    // Submit front to back so the depth test rejects hidden fragments early;
+    // the inset looks straight down, so it only gets the frustum test
+    mVisibleTriangles.clear();
+    std::vector<int> order;
+    for (const auto& entry : mainTiles) {
+        order.push_back(entry.second);
+    }
+    for (size_t t = 0; t < mTerrainTiles.size(); t++) {
+        if (std::find(order.begin(), order.end(), static_cast<int>(t)) == order.end()) {
+            order.push_back(static_cast<int>(t));
+        }
+    }
+    
+    for (int t : order) {
+        const TerrainTile& tile = mTerrainTiles[t];
+        bool insetVisible = mLandingCameraEnabled && !tile.triangles.empty() &&
+                            IsBoxInFrustum(mInsetView, tile.boundsMin, tile.boundsMax);
+        if (!mainVisible[t] && !insetVisible) {
+            continue;
+        }
+        
+        for (int index : tile.triangles) {
+            if ((mainVisible[t] && IsTriangleVisible(mMainView, triangles[index])) ||
+                (insetVisible && IsTriangleVisible(mInsetView, triangles[index]))) {
+                mVisibleTriangles.push_back(index);
+            }
+        }
+    }
+    
+    mCulledTerrain = terrain;
+    mCullValid = true;
 }
 
 void Renderer3D::Present() {
@@ -267,9 +773,6 @@ void Renderer3D::RenderLander(Lander* lander) {
     const float* rotation = lander->GetRotation();
     const float* scale = lander->GetScale();
     
-    // In a real implementation, this would use modern OpenGL to render the lander model
-    // For this example, we'll use legacy OpenGL functions
-    
     // Save current matrix
     glPushMatrix();
     
@@ -280,8 +783,94 @@ void Renderer3D::RenderLander(Lander* lander) {
     glRotatef(rotation[2], 0.0f, 0.0f, 1.0f);
     glScalef(scale[0], scale[1], scale[2]);
     
-    // Render a simplified lander
-    // In practice, you would bind proper shader, set uniforms, and render a real model
+    if (mLanderModel.IsReady()) {
+        // Fit the model into the lander's box
+        const Mesh& mesh = mLanderModel->GetData().mesh;
+        const float* boundsMin = mesh.GetBoundsMin();
+        const float* boundsMax = mesh.GetBoundsMax();
+        float modelScale = std::min({ lander->GetWidth() / (boundsMax[0] - boundsMin[0]),
+                                      lander->GetHeight() / (boundsMax[1] - boundsMin[1]),
+                                      lander->GetDepth() / (boundsMax[2] - boundsMin[2]) });
+        
+        // Level of detail from how many pixels a model unit covers
+        int lod = 0;
+        if (mCurrentView) {
+            float offset[3];
+            for (int axis = 0; axis < 3; axis++) {
+                offset[axis] = position[axis] - mCurrentView->eye[axis];
+            }
+            float distance = std::sqrt(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+            float pixelsPerUnit = mCurrentView->viewport[3] * 0.5f * mCurrentView->projection.values[5] /
+                                  std::max(distance, kNearPlane);
+            float largestScale = std::max({ scale[0], scale[1], scale[2] });
+            lod = mesh.SelectLod(pixelsPerUnit * modelScale * largestScale, kModelLodPixelError);
+        }
+        
+        // Models are Y up; the world's Y grows towards the ground, so turn it
+        // over (a rotation rather than a mirror keeps the winding)
+        glPushMatrix();
+        glRotatef(180.0f, 1.0f, 0.0f, 0.0f);
+        glScalef(modelScale, modelScale, modelScale);
+        glTranslatef(-(boundsMin[0] + boundsMax[0]) * 0.5f,
+                     -(boundsMin[1] + boundsMax[1]) * 0.5f,
+                     -(boundsMin[2] + boundsMax[2]) * 0.5f);
+        
+        bool lit = mShaderProgram && mLightTexture && mCurrentView;
+        if (lit) {
+            BeginLighting(mShaderProgram, mLitUniforms);
+        }
+        glColor3f(0.9f, 0.88f, 0.8f);
+        RenderModel(mesh, mLanderModel->GetGpuObject(0), mLanderModel->GetGpuObject(1), lod);
+        if (lit) {
+            EndLighting();
+        }
+        
+        glPopMatrix();
+    } else {
+        RenderLanderBox(lander);
+    }
+    
+    float width = lander->GetWidth() / 2.0f;
+    float height = lander->GetHeight() / 2.0f;
+    float depth = lander->GetDepth() / 2.0f;
+    
+    // Draw thrust flame if active
+    if (lander->IsThrustActive()) {
+        glBegin(GL_TRIANGLES);
+        
+        // Flame (orange)
+        glColor3f(1.0f, 0.5f, 0.0f);
+        
+        // Calculate thrust direction based on rotation
+        float rotRad = rotation[2] * M_PI / 180.0f;
+        float thrustDirX = sin(rotRad);
+        float thrustDirY = -cos(rotRad);
+        
+        // Flame position
+        float flameBaseX = 0.0f;
+        float flameBaseY = -height;
+        float flameLength = height * lander->GetThrustLevel();
+        
+        // Draw flame
+        glVertex3f(flameBaseX - width/4, flameBaseY, depth/2);
+        glVertex3f(flameBaseX + width/4, flameBaseY, depth/2);
+        glVertex3f(flameBaseX + thrustDirX * flameLength, 
+                   flameBaseY + thrustDirY * flameLength, 0.0f);
+        
+        glVertex3f(flameBaseX - width/4, flameBaseY, -depth/2);
+        glVertex3f(flameBaseX + width/4, flameBaseY, -depth/2);
+        glVertex3f(flameBaseX + thrustDirX * flameLength, 
+                   flameBaseY + thrustDirY * flameLength, 0.0f);
+        
+        glEnd();
+    }
+    
+    // Restore matrix
+    glPopMatrix();
+}
+
+void Renderer3D::RenderLanderBox(const Lander* lander) {
+    // Stand-in for a missing lander model
     glBegin(GL_QUADS);
     
     // Lander body (white)
@@ -328,53 +917,40 @@ void Renderer3D::RenderLander(Lander* lander) {
     glVertex3f(width, -height, depth);
     
     glEnd();
-    
-    // Draw thrust flame if active
-    if (lander->IsThrustActive()) {
-        glBegin(GL_TRIANGLES);
-        
-        // Flame (orange)
-        glColor3f(1.0f, 0.5f, 0.0f);
-        
-        // Calculate thrust direction based on rotation
-        float rotRad = rotation[2] * M_PI / 180.0f;
-        float thrustDirX = sin(rotRad);
-        float thrustDirY = -cos(rotRad);
-        
-        // Flame position
-        float flameBaseX = 0.0f;
-        float flameBaseY = -height;
-        float flameLength = height * lander->GetThrustLevel();
-        
-        // Draw flame
-        glVertex3f(flameBaseX - width/4, flameBaseY, depth/2);
-        glVertex3f(flameBaseX + width/4, flameBaseY, depth/2);
-        glVertex3f(flameBaseX + thrustDirX * flameLength, 
-                   flameBaseY + thrustDirY * flameLength, 0.0f);
-        
-        glVertex3f(flameBaseX - width/4, flameBaseY, -depth/2);
-        glVertex3f(flameBaseX + width/4, flameBaseY, -depth/2);
-        glVertex3f(flameBaseX + thrustDirX * flameLength, 
-                   flameBaseY + thrustDirY * flameLength, 0.0f);
-        
-        glEnd();
-    }
-    
-    // Restore matrix
-    glPopMatrix();
 }
 
 void Renderer3D::RenderTerrain(Terrain* terrain) {
     if (!mInitialized || !terrain) return;
     
-    // Get terrain triangles
+    // Get terrain triangles and the ones visible in this frame's views
     const std::vector<TerrainTriangle>& triangles = terrain->GetTriangles3D();
+    CullTerrain(terrain);
+    bool normalMapped = UpdateTerrainNormalMap(terrain) && mTerrainShaderProgram;
+    
+    // Lit with the normal-mapped program once it and the map are ready, the
+    // smooth one until then, and fixed-function colors without shader support
+    GLuint program = normalMapped ? mTerrainShaderProgram : mShaderProgram;
+    bool lit = program && mLightTexture && mCurrentView;
+    if (lit) {
+        BeginLighting(program, normalMapped ? mTerrainUniforms : mLitUniforms);
+    }
+    if (lit && normalMapped) {
+        const GLFunctions& gl = mShaderCache->GetFunctions();
+        const float normalMapScale[2] = { 1.0f / terrain->GetWidth(), 1.0f / terrain->GetLength() };
+        gl.Uniform2fv(mTerrainUniforms.normalMapScale, 1, normalMapScale);
+        gl.Uniform1i(mTerrainUniforms.normalMap, kNormalMapUnit);
+        gl.ActiveTexture(GL_TEXTURE0 + kNormalMapUnit);
+        glBindTexture(GL_TEXTURE_2D, mNormalMapTexture);
+        gl.ActiveTexture(GL_TEXTURE0);
+    }
     
     // Begin rendering terrain
     glBegin(GL_TRIANGLES);
     
-    // Render each triangle
-    for (const auto& triangle : triangles) {
+    // Render each visible triangle
+    for (int index : mVisibleTriangles) {
+        const TerrainTriangle& triangle = triangles[index];
+        
         // Set color based on whether it's a landing pad
         if (triangle.isLandingPad) {
             glColor3f(0.0f, 0.8f, 0.0f); // Green for landing pads
@@ -392,6 +968,81 @@ void Renderer3D::RenderTerrain(Terrain* terrain) {
     }
     
     glEnd();
+    
+    if (lit) {
+        EndLighting();
+    }
+}
+
+bool Renderer3D::UpdateTerrainNormalMap(const Terrain* terrain) {
+    // Only the normal-mapped program reads it
+    if (!mShaderCache) {
+        return false;
+    }
+    
+    // Bake again for a new terrain, in the background
+    if (terrain != mNormalMapTerrain || terrain->GetGeneration() != mNormalMapTerrainGeneration) {
+        mNormalMapTerrain = terrain;
+        mNormalMapTerrainGeneration = terrain->GetGeneration();
+        mTerrainNormalMap.Rebuild(terrain);
+    }
+    if (!mTerrainNormalMap.IsReady()) {
+        return false;
+    }
+    
+    // Upload the finished bake once, with its mip levels
+    if (mNormalMapGeneration != mTerrainNormalMap.GetGeneration() || !mNormalMapTexture) {
+        if (!mNormalMapTexture) {
+            glGenTextures(1, &mNormalMapTexture);
+        }
+        glBindTexture(GL_TEXTURE_2D, mNormalMapTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int level = 0; level < mTerrainNormalMap.GetLevelCount(); level++) {
+            int size = mTerrainNormalMap.GetLevelSize(level);
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                         mTerrainNormalMap.GetLevel(level).data());
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        mNormalMapGeneration = mTerrainNormalMap.GetGeneration();
+    }
+    
+    return true;
+}
+
+void Renderer3D::RenderTrajectory(const TrajectoryPredictor* trajectory) {
+    if (!mInitialized || !trajectory) return;
+    
+    const std::vector<TrajectoryPoint>& points = trajectory->GetPoints();
+    
+    // Predicted path in light blue
+    glBegin(GL_LINE_STRIP);
+    glColor3f(0.4f, 0.7f, 1.0f);
+    for (size_t i = trajectory->GetFirstIndex(); i < points.size(); i++) {
+        glVertex3fv(points[i].position);
+    }
+    glEnd();
+    
+    // Predicted touchdown: green on a landing pad, red elsewhere
+    if (trajectory->HasImpact()) {
+        const float* impact = trajectory->GetImpactPoint();
+        const float size = 8.0f;
+        
+        glBegin(GL_LINES);
+        if (trajectory->IsImpactOnLandingPad()) {
+            glColor3f(0.0f, 1.0f, 0.0f);
+        } else {
+            glColor3f(1.0f, 0.0f, 0.0f);
+        }
+        glVertex3f(impact[0] - size, impact[1], impact[2]);
+        glVertex3f(impact[0] + size, impact[1], impact[2]);
+        glVertex3f(impact[0], impact[1], impact[2] - size);
+        glVertex3f(impact[0], impact[1], impact[2] + size);
+        glEnd();
+    }
 }
 
 void Renderer3D::RenderTelemetry(Game* game) {
@@ -481,6 +1132,87 @@ void Renderer3D::RenderTelemetry(Game* game) {
     glEnable(GL_DEPTH_TEST);
 }
 
+void Renderer3D::RenderMinimap(const TerrainOverview* overview, const Lander* lander) {
+    if (!mInitialized || !overview || !overview->IsReady()) return;
+    
+    int width = overview->GetWidth();
+    int height = overview->GetHeight();
+    
+    // Upload the overview only when a new one has been built
+    if (!mMinimapTexture) {
+        glGenTextures(1, &mMinimapTexture);
+        mMinimapGeneration = overview->GetGeneration() - 1;
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, mMinimapTexture);
+    if (mMinimapGeneration != overview->GetGeneration()) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, overview->GetPixels().data());
+        mMinimapGeneration = overview->GetGeneration();
+    }
+    
+    // Set up orthographic projection for 2D UI
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0, mWidth, mHeight, 0.0, -1.0, 1.0);
+    
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    
+    // Inset in the top right corner
+    float left = static_cast<float>(mWidth - width - 10);
+    float top = 10.0f;
+    
+    glEnable(GL_TEXTURE_2D);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(left, top);
+    glTexCoord2f(1.0f, 0.0f); glVertex2f(left + width, top);
+    glTexCoord2f(1.0f, 1.0f); glVertex2f(left + width, top + height);
+    glTexCoord2f(0.0f, 1.0f); glVertex2f(left, top + height);
+    glEnd();
+    glDisable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    // Lander marker (pinned to the edge when it is off the map)
+    if (lander) {
+        const float* position = lander->GetPosition();
+        float u = 0.0f, v = 0.0f;
+        overview->WorldToMap(position[0], position[1], position[2], u, v);
+        float x = left + std::max(0.0f, std::min(1.0f, u)) * width;
+        float y = top + std::max(0.0f, std::min(1.0f, v)) * height;
+        
+        glBegin(GL_QUADS);
+        glColor3f(1.0f, 0.0f, 0.0f);
+        glVertex2f(x - 2, y - 2);
+        glVertex2f(x + 2, y - 2);
+        glVertex2f(x + 2, y + 2);
+        glVertex2f(x - 2, y + 2);
+        glEnd();
+    }
+    
+    glDisable(GL_BLEND);
+    
+    // Restore projection matrix
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    
+    // Re-enable depth testing
+    glEnable(GL_DEPTH_TEST);
+}
+
 void Renderer3D::RenderGameState(Game* game) {
     if (!mInitialized || !game) return;
     
@@ -588,16 +1320,236 @@ void Renderer3D::SetAmbientLight(float r, float g, float b) {
     mAmbientLight[2] = b;
 }
 
-GLuint Renderer3D::LoadShader(const char* vertexShaderSource, const char* fragmentShaderSource) {
-    // This would compile and link shaders in a real implementation
-    // For now, just return a dummy shader program ID
-    return 1;
+GLuint Renderer3D::LoadShader(const ShaderVariant& variant, const char* vertexShaderSource, const char* fragmentShaderSource) {
+    // From the program binary cache, compiling only on a miss
+    GLuint program = mShaderCache->GetProgram(variant, vertexShaderSource, fragmentShaderSource);
+    if (!program) {
+        std::cerr << "Shader program '" << variant.name << "' unavailable" << std::endl;
+    }
+    return program;
+}
+
+bool Renderer3D::UploadModel(const Mesh& mesh, GLuint& vertexBuffer, GLuint& indexBuffer) {
+    const GLFunctions& gl = mShaderCache->GetFunctions();
+    const std::vector<QuantizedVertex>& vertices = mesh.GetVertices();
+    const std::vector<uint32_t>& indices = mesh.GetIndices();
+    
+    gl.GenBuffers(1, &vertexBuffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    gl.BufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(QuantizedVertex), vertices.data(), GL_STATIC_DRAW);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    gl.GenBuffers(1, &indexBuffer);
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    gl.BufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    
+    return vertexBuffer && indexBuffer;
+}
+
+bool Renderer3D::UploadModelAsset(Asset& asset) {
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+    bool success = UploadModel(asset.GetData().mesh, vertexBuffer, indexBuffer);
+    asset.SetGpuObject(0, vertexBuffer);
+    asset.SetGpuObject(1, indexBuffer);
+    return success;
+}
+
+bool Renderer3D::UploadTextureAsset(Asset& asset) {
+    const AssetData& data = asset.GetData();
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, data.width, data.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 data.pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    asset.SetGpuObject(0, texture);
+    return texture != 0;
+}
+
+void Renderer3D::ReleaseAsset(Asset& asset) {
+    if (asset.GetType() == AssetType::Model) {
+        const GLFunctions& gl = mShaderCache->GetFunctions();
+        for (int i = 0; i < Asset::kMaxGpuObjects; i++) {
+            GLuint buffer = asset.GetGpuObject(i);
+            if (buffer) gl.DeleteBuffers(1, &buffer);
+        }
+    } else {
+        GLuint texture = asset.GetGpuObject(0);
+        if (texture) glDeleteTextures(1, &texture);
+    }
+}
+
+void Renderer3D::RenderModel(const Mesh& mesh, GLuint vertexBuffer, GLuint indexBuffer, int lod) {
+    const GLFunctions& gl = mShaderCache->GetFunctions();
+    const MeshLod& level = mesh.GetLods()[lod];
+    
+    // Undo the position quantization
+    const float* offset = mesh.GetPositionOffset();
+    float positionScale = mesh.GetPositionScale();
+    glPushMatrix();
+    glTranslatef(offset[0], offset[1], offset[2]);
+    glScalef(positionScale, positionScale, positionScale);
+    
+    // 16-bit positions and byte normals straight from the buffer
+    gl.BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_SHORT, sizeof(QuantizedVertex),
+                    reinterpret_cast<const void*>(offsetof(QuantizedVertex, position)));
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glNormalPointer(GL_BYTE, sizeof(QuantizedVertex),
+                    reinterpret_cast<const void*>(offsetof(QuantizedVertex, normal)));
+    
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glDrawElements(GL_TRIANGLES, level.indexCount, GL_UNSIGNED_INT,
+                   reinterpret_cast<const void*>(level.firstIndex * sizeof(uint32_t)));
+    
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    glPopMatrix();
+}
+
+Renderer3D::LitUniforms Renderer3D::GetLitUniforms(GLuint program) const {
+    const GLFunctions& gl = mShaderCache->GetFunctions();
+    LitUniforms uniforms;
+    uniforms.lightPosition = gl.GetUniformLocation(program, "lightPos");
+    uniforms.ambientLight = gl.GetUniformLocation(program, "ambientLight");
+    uniforms.lightData = gl.GetUniformLocation(program, "lightData");
+    uniforms.clusterGrid = gl.GetUniformLocation(program, "clusterGrid");
+    uniforms.lightIndices = gl.GetUniformLocation(program, "lightIndices");
+    uniforms.clusterParams = gl.GetUniformLocation(program, "clusterParams");
+    uniforms.clusterCounts = gl.GetUniformLocation(program, "clusterCounts");
+    uniforms.indexRowLength = gl.GetUniformLocation(program, "indexRowLength");
+    uniforms.normalMap = gl.GetUniformLocation(program, "normalMap");
+    uniforms.normalMapScale = gl.GetUniformLocation(program, "normalMapScale");
+    return uniforms;
+}
+
+void Renderer3D::CreateLightTextures() {
+    GLuint textures[3];
+    glGenTextures(3, textures);
+    mLightTexture = textures[0];
+    mClusterTexture = textures[1];
+    mLightIndexTexture = textures[2];
+    
+    // Read with texelFetch only: no filtering
+    for (GLuint texture : textures) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    
+    // Sized for the most LightClusters can produce; each frame updates a part
+    glBindTexture(GL_TEXTURE_2D, mLightTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, LightClusters::kMaxLights, LightClusters::kLightRows, 0,
+                 GL_RGBA, GL_FLOAT, nullptr);
+    
+    glBindTexture(GL_TEXTURE_2D, mClusterTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, LightClusters::kTilesX * LightClusters::kTilesY,
+                 LightClusters::kSlices, 0, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+    
+    glBindTexture(GL_TEXTURE_2D, mLightIndexTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, LightClusters::kIndexRowLength,
+                 LightClusters::kMaxIndices / LightClusters::kIndexRowLength, 0,
+                 GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Renderer3D::UploadLights(const ViewSetup& setup) {
+    if (!mLightTexture) return;
+    
+    // Bin the lights into this view's clusters
+    mLightClusters.Build(mLights, setup.view.values, setup.projection.values, kNearPlane, kFarPlane);
+    
+    // Light data: the used columns of every row
+    int lightCount = mLightClusters.GetLightCount();
+    if (lightCount > 0) {
+        glBindTexture(GL_TEXTURE_2D, mLightTexture);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, LightClusters::kMaxLights);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, lightCount, LightClusters::kLightRows,
+                        GL_RGBA, GL_FLOAT, mLightClusters.GetLightData().data());
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+    
+    // Every cluster's (offset, count), empty ones included
+    glBindTexture(GL_TEXTURE_2D, mClusterTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LightClusters::kTilesX * LightClusters::kTilesY,
+                    LightClusters::kSlices, GL_RG_INTEGER, GL_UNSIGNED_INT,
+                    mLightClusters.GetClusters().data());
+    
+    // Index lists: whole rows, then what is left in a partial one
+    const std::vector<uint32_t>& indices = mLightClusters.GetIndices();
+    int rowLength = LightClusters::kIndexRowLength;
+    int fullRows = mLightClusters.GetIndexCount() / rowLength;
+    int remainder = mLightClusters.GetIndexCount() % rowLength;
+    glBindTexture(GL_TEXTURE_2D, mLightIndexTexture);
+    if (fullRows > 0) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, rowLength, fullRows,
+                        GL_RED_INTEGER, GL_UNSIGNED_INT, indices.data());
+    }
+    if (remainder > 0) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, fullRows, remainder, 1,
+                        GL_RED_INTEGER, GL_UNSIGNED_INT, indices.data() + fullRows * rowLength);
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Renderer3D::BeginLighting(GLuint program, const LitUniforms& uniforms) {
+    const GLFunctions& gl = mShaderCache->GetFunctions();
+    gl.UseProgram(program);
+    
+    // Main light in view space, like the clustered ones
+    const float* view = mCurrentView->view.values;
+    float lightPosition[3];
+    for (int axis = 0; axis < 3; axis++) {
+        lightPosition[axis] = view[axis] * mLightPosition[0] + view[4 + axis] * mLightPosition[1] +
+                              view[8 + axis] * mLightPosition[2] + view[12 + axis];
+    }
+    gl.Uniform3fv(uniforms.lightPosition, 1, lightPosition);
+    gl.Uniform3fv(uniforms.ambientLight, 1, mAmbientLight);
+    
+    // Cluster lookup for this view
+    const float clusterParams[4] = {
+        static_cast<float>(mCurrentView->viewport[2]) / LightClusters::kTilesX,
+        static_cast<float>(mCurrentView->viewport[3]) / LightClusters::kTilesY,
+        mLightClusters.GetSliceScale(),
+        mLightClusters.GetSliceBias()
+    };
+    gl.Uniform4fv(uniforms.clusterParams, 1, clusterParams);
+    gl.Uniform3i(uniforms.clusterCounts, LightClusters::kTilesX, LightClusters::kTilesY, LightClusters::kSlices);
+    gl.Uniform1i(uniforms.indexRowLength, LightClusters::kIndexRowLength);
+    
+    gl.Uniform1i(uniforms.lightData, kLightDataUnit);
+    gl.Uniform1i(uniforms.clusterGrid, kClusterGridUnit);
+    gl.Uniform1i(uniforms.lightIndices, kLightIndexUnit);
+    gl.ActiveTexture(GL_TEXTURE0 + kLightDataUnit);
+    glBindTexture(GL_TEXTURE_2D, mLightTexture);
+    gl.ActiveTexture(GL_TEXTURE0 + kClusterGridUnit);
+    glBindTexture(GL_TEXTURE_2D, mClusterTexture);
+    gl.ActiveTexture(GL_TEXTURE0 + kLightIndexUnit);
+    glBindTexture(GL_TEXTURE_2D, mLightIndexTexture);
+    gl.ActiveTexture(GL_TEXTURE0);
+}
+
+void Renderer3D::EndLighting() {
+    mShaderCache->GetFunctions().UseProgram(0);
 }
 
 Matrix4x4 Renderer3D::CreateProjectionMatrix(float fov, float aspect, float near, float far) {
     Matrix4x4 result;
     
-    float tanHalfFovy = tan(fov / 2.0f);
+    // Field of view is given in degrees
+    float tanHalfFovy = tan(fov * static_cast<float>(M_PI) / 360.0f);
     
     result.values[0] = 1.0f / (aspect * tanHalfFovy);
     result.values[1] = 0.0f;
@@ -623,14 +1575,48 @@ Matrix4x4 Renderer3D::CreateProjectionMatrix(float fov, float aspect, float near
 }
 
 Matrix4x4 Renderer3D::CreateViewMatrix() {
+    return CreateLookAtMatrix(mCameraPosition, mCameraTarget, mCameraUp);
+}
+
+Matrix4x4 Renderer3D::CreateLookAtMatrix(const float* eye, const float* target, const float* up) {
     Matrix4x4 result;
     
-    // This would normally compute a view matrix from camera parameters
-    // For simplicity, we're just returning an identity matrix
-    for (int i = 0; i < 16; i++) {
-        result.values[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    // Forward, side and recomputed up axes of the camera
+    float f[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+    float fLength = std::sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    if (fLength > 0.0f) {
+        f[0] /= fLength; f[1] /= fLength; f[2] /= fLength;
     }
     
+    float s[3] = { f[1] * up[2] - f[2] * up[1], f[2] * up[0] - f[0] * up[2], f[0] * up[1] - f[1] * up[0] };
+    float sLength = std::sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+    if (sLength > 0.0f) {
+        s[0] /= sLength; s[1] /= sLength; s[2] /= sLength;
+    }
+    
+    float u[3] = { s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0] };
+    
+    // Column-major, as OpenGL expects
+    result.values[0] = s[0];
+    result.values[1] = u[0];
+    result.values[2] = -f[0];
+    result.values[3] = 0.0f;
+    
+    result.values[4] = s[1];
+    result.values[5] = u[1];
+    result.values[6] = -f[1];
+    result.values[7] = 0.0f;
+    
+    result.values[8] = s[2];
+    result.values[9] = u[2];
+    result.values[10] = -f[2];
+    result.values[11] = 0.0f;
+    
+    result.values[12] = -(s[0] * eye[0] + s[1] * eye[1] + s[2] * eye[2]);
+    result.values[13] = -(u[0] * eye[0] + u[1] * eye[1] + u[2] * eye[2]);
+    result.values[14] = f[0] * eye[0] + f[1] * eye[1] + f[2] * eye[2];
+    result.values[15] = 1.0f;
+    
     return result;
 }
 
@@ -647,9 +1633,14 @@ Matrix4x4 Renderer3D::CreateModelMatrix(float* position, float* rotation, float*
 }
 
 void Renderer3D::MultiplyMatrices(Matrix4x4& result, const Matrix4x4& a, const Matrix4x4& b) {
-    // This would normally multiply two matrices
-    // For simplicity, we're just copying the first matrix
-    for (int i = 0; i < 16; i++) {
-        result.values[i] = a.values[i];
+    // result = a * b, all column-major
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                sum += a.values[k * 4 + row] * b.values[column * 4 + k];
+            }
+            result.values[column * 4 + row] = sum;
+        }
     }
 }
\ No newline at end of file
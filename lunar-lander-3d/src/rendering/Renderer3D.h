@@ -4,7 +4,13 @@
 #pragma once
 
 #include "Renderer.h"
+#include "../core/AssetManager.h"
+#include "LightClusters.h"
+#include "Mesh.h"
+#include "OcclusionCuller.h"
+#include "../core/TerrainNormalMap.h"
 #include <SDL2/SDL.h>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -18,6 +24,10 @@ struct Matrix4x4 {
     float values[16];
 };
 
+struct TerrainTriangle;
+struct ShaderVariant;
+class ShaderCache;
+
 class Renderer3D : public Renderer {
 public:
     Renderer3D();
@@ -31,14 +41,26 @@ public:
     
     void RenderLander(Lander* lander) override;
     void RenderTerrain(Terrain* terrain) override;
+    void RenderTrajectory(const TrajectoryPredictor* trajectory) override;
     
     void RenderTelemetry(Game* game) override;
     void RenderGameState(Game* game) override;
+    void RenderMinimap(const TerrainOverview* overview, const Lander* lander) override;
     
     int GetWidth() const override { return mWidth; }
     int GetHeight() const override { return mHeight; }
     bool IsInitialized() const override { return mInitialized; }
     
+    // 2D camera (not used by the 3D renderer)
+    void SetCamera2D(float centerX, float centerY, float zoom) override {}
+    
+    // Views: the landing camera inset (when enabled) is drawn first at
+    // reduced resolution, then the main chase view
+    int GetViewCount() const override { return mLandingCameraEnabled ? 2 : 1; }
+    void BeginView(int index) override;
+    void EndView(int index) override;
+    void SetLandingCamera(bool enabled, float x, float y, float z) override;
+    
     // 3D camera methods
     void SetCameraPosition(float x, float y, float z) override;
     void SetCameraTarget(float x, float y, float z) override;
@@ -47,6 +69,7 @@ public:
     // 3D lighting methods
     void SetLightPosition(float x, float y, float z) override;
     void SetAmbientLight(float r, float g, float b) override;
+    void SetLights(const std::vector<Light>& lights) override { mLights = lights; }
     
 private:
     // Initialize OpenGL
@@ -58,16 +81,84 @@ private:
     // Load models
     bool LoadModels();
     
+    // Uniform locations of a program built from the lit shader sources
+    // (-1 until the program is loaded)
+    struct LitUniforms {
+        int lightPosition = -1;
+        int ambientLight = -1;
+        int lightData = -1;
+        int clusterGrid = -1;
+        int lightIndices = -1;
+        int clusterParams = -1;
+        int clusterCounts = -1;
+        int indexRowLength = -1;
+        int normalMap = -1;
+        int normalMapScale = -1;
+    };
+    
+    // Camera, viewport and frustum of one view
+    struct ViewSetup {
+        Matrix4x4 projection;
+        Matrix4x4 view;
+        Matrix4x4 viewProjection;  // projection * view
+        float eye[3];
+        float frustum[6][4];  // Planes as (a, b, c, d), inside where ax+by+cz+d >= 0
+        int viewport[4];      // x, y, width, height in window pixels
+    };
+    
+    // Inset size on screen and the factor it is rendered below that
+    static const int kInsetWidth = 240;
+    static const int kInsetHeight = 180;
+    static const int kInsetDownscale = 2;
+    
+    // Terrain triangles grouped by area for box culling; the nearest tiles
+    // in view are rasterized as occluders for the rest
+    struct TerrainTile {
+        std::vector<int> triangles;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+    static const int kTerrainTilesPerSide = 5;
+    static const int kMaxOccluderTiles = 16;
+    
     // Helper methods for 3D rendering
     void SetupMVP();
-    void RenderModel(GLuint modelVAO, int vertexCount, float* position, float* rotation, float* scale);
+    void SetupViews();
+    void SetupView(ViewSetup& setup, const float* eye, const float* target, const float* up,
+                   float fov, int x, int y, int width, int height);
+    void ApplyView(const ViewSetup& setup);
+    bool IsTriangleVisible(const ViewSetup& setup, const TerrainTriangle& triangle) const;
+    bool IsBoxInFrustum(const ViewSetup& setup, const float* boundsMin, const float* boundsMax) const;
+    void BuildTerrainTiles(const Terrain* terrain);
+    void CullTerrain(const Terrain* terrain);
+    bool UpdateTerrainNormalMap(const Terrain* terrain);
+    void DrawInset();
+    bool IsInsetView(int index) const { return mLandingCameraEnabled && index == 0; }
+    
+    // Models in buffer objects, drawn at a level of detail from their screen size
+    bool UploadModel(const Mesh& mesh, GLuint& vertexBuffer, GLuint& indexBuffer);
+    void RenderModel(const Mesh& mesh, GLuint vertexBuffer, GLuint indexBuffer, int lod);
+    void RenderLanderBox(const Lander* lander);
+    
+    // GPU side of assets loaded by mAssets (called on this thread by ProcessUploads)
+    bool UploadModelAsset(Asset& asset);
+    bool UploadTextureAsset(Asset& asset);
+    void ReleaseAsset(Asset& asset);
     
     // OpenGL shader methods
-    GLuint LoadShader(const char* vertexShaderSource, const char* fragmentShaderSource);
+    GLuint LoadShader(const ShaderVariant& variant, const char* vertexShaderSource, const char* fragmentShaderSource);
+    LitUniforms GetLitUniforms(GLuint program) const;
+    
+    // Clustered lighting: textures, per-view light assignment and program setup
+    void CreateLightTextures();
+    void UploadLights(const ViewSetup& setup);
+    void BeginLighting(GLuint program, const LitUniforms& uniforms);
+    void EndLighting();
     
     // 3D math helpers
     Matrix4x4 CreateProjectionMatrix(float fov, float aspect, float near, float far);
     Matrix4x4 CreateViewMatrix();
+    Matrix4x4 CreateLookAtMatrix(const float* eye, const float* target, const float* up);
     Matrix4x4 CreateModelMatrix(float* position, float* rotation, float* scale);
     void MultiplyMatrices(Matrix4x4& result, const Matrix4x4& a, const Matrix4x4& b);
     
@@ -80,19 +171,20 @@ private:
     int mHeight;
     bool mInitialized;
     
-    // OpenGL shader program
+    // OpenGL shader programs (cached on disk as driver binaries)
+    std::unique_ptr<ShaderCache> mShaderCache;
     GLuint mShaderProgram;
+    GLuint mTerrainShaderProgram;
+    bool mTerrainShaderRequested;
     
     // Uniform locations
-    GLuint mModelMatrixLocation;
-    GLuint mViewMatrixLocation;
-    GLuint mProjectionMatrixLocation;
-    GLuint mLightPositionLocation;
-    GLuint mAmbientLightLocation;
+    LitUniforms mLitUniforms;
+    LitUniforms mTerrainUniforms;
     
-    // Models
-    GLuint mLanderModel;
-    int mLanderVertexCount;
+    // Assets loaded in the background; the lander is drawn as a box until
+    // its model is ready (or when it is missing)
+    std::unique_ptr<AssetManager> mAssets;
+    AssetHandle mLanderModel;
     
     // Camera properties
     float mCameraPosition[3];
@@ -103,7 +195,48 @@ private:
     float mLightPosition[3];
     float mAmbientLight[3];
     
+    // Dynamic lights, binned into clusters of the view being drawn
+    std::vector<Light> mLights;
+    LightClusters mLightClusters;
+    GLuint mLightTexture;       // LightClusters::GetLightData()
+    GLuint mClusterTexture;     // LightClusters::GetClusters()
+    GLuint mLightIndexTexture;  // LightClusters::GetIndices()
+    
+    // View between BeginView and EndView
+    const ViewSetup* mCurrentView;
+    
     // Matrices
     Matrix4x4 mProjectionMatrix;
     Matrix4x4 mViewMatrix;
+    
+    // Minimap texture, uploaded once per terrain overview generation
+    GLuint mMinimapTexture;
+    unsigned int mMinimapGeneration;
+    
+    // Views for this frame
+    ViewSetup mMainView;
+    ViewSetup mInsetView;
+    bool mLandingCameraEnabled;
+    float mLandingCamera[3];
+    GLuint mInsetTexture;
+    bool mInsetDrawn;
+    
+    // Terrain triangles visible in any view, computed once per frame
+    std::vector<int> mVisibleTriangles;
+    const Terrain* mCulledTerrain;
+    bool mCullValid;
+    
+    // Tiles of the current terrain and the occluder depth of the main view
+    std::vector<TerrainTile> mTerrainTiles;
+    const Terrain* mTileTerrain;
+    unsigned int mTileGeneration;
+    OcclusionCuller mOcclusion;
+    
+    // Normal map of the terrain's full-resolution heights, baked in the
+    // background whenever the terrain changes, and its texture
+    TerrainNormalMap mTerrainNormalMap;
+    const Terrain* mNormalMapTerrain;
+    unsigned int mNormalMapTerrainGeneration;
+    GLuint mNormalMapTexture;
+    unsigned int mNormalMapGeneration;
 };
\ No newline at end of file
@@ -0,0 +1,2046 @@
+// RendererVulkan.cpp
+// Implementation of the Vulkan renderer
+
+#include "RendererVulkan.h"
+#include "../core/Entity.h"
+#include "../core/Terrain.h"
+#include "../core/Game.h"
+#include "../core/TrajectoryPredictor.h"
+#include "../core/TerrainOverview.h"
+#include <SDL2/SDL_vulkan.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Returned by WriteRing when the frame's staging ring is full
+static const VkDeviceSize kRingFull = ~static_cast<VkDeviceSize>(0);
+
+// Alignment of every allocation in the staging ring (vertex data and texel copies)
+static const VkDeviceSize kRingAlignment = 16;
+
+// Column-major 4x4 matrix helpers
+static void MatrixIdentity(float* m) {
+    for (int i = 0; i < 16; i++) {
+        m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    }
+}
+
+static void MatrixMultiply(float* result, const float* a, const float* b) {
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                sum += a[k * 4 + row] * b[column * 4 + k];
+            }
+            result[column * 4 + row] = sum;
+        }
+    }
+}
+
+static void MatrixLookAt(float* m, const float* eye, const float* target, const float* up) {
+    float f[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+    float fLength = std::sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    if (fLength > 0.0f) {
+        f[0] /= fLength; f[1] /= fLength; f[2] /= fLength;
+    }
+
+    float s[3] = { f[1] * up[2] - f[2] * up[1], f[2] * up[0] - f[0] * up[2], f[0] * up[1] - f[1] * up[0] };
+    float sLength = std::sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+    if (sLength > 0.0f) {
+        s[0] /= sLength; s[1] /= sLength; s[2] /= sLength;
+    }
+
+    float u[3] = { s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0] };
+
+    m[0] = s[0]; m[4] = s[1]; m[8] = s[2];
+    m[1] = u[0]; m[5] = u[1]; m[9] = u[2];
+    m[2] = -f[0]; m[6] = -f[1]; m[10] = -f[2];
+    m[3] = 0.0f; m[7] = 0.0f; m[11] = 0.0f;
+    m[12] = -(s[0] * eye[0] + s[1] * eye[1] + s[2] * eye[2]);
+    m[13] = -(u[0] * eye[0] + u[1] * eye[1] + u[2] * eye[2]);
+    m[14] = f[0] * eye[0] + f[1] * eye[1] + f[2] * eye[2];
+    m[15] = 1.0f;
+}
+
+// Perspective projection for Vulkan clip space (Y down, depth 0..1)
+static void MatrixPerspective(float* m, float fovDegrees, float aspect, float nearPlane, float farPlane) {
+    float tanHalfFov = std::tan(fovDegrees * static_cast<float>(M_PI) / 360.0f);
+    for (int i = 0; i < 16; i++) {
+        m[i] = 0.0f;
+    }
+
+    m[0] = 1.0f / (aspect * tanHalfFov);
+    m[5] = -1.0f / tanHalfFov;
+    m[10] = farPlane / (nearPlane - farPlane);
+    m[11] = -1.0f;
+    m[14] = nearPlane * farPlane / (nearPlane - farPlane);
+}
+
+// Model matrix with the same order as the OpenGL renderer:
+// translate, rotate X, Y, Z (degrees), then scale
+static void MatrixModel(float* m, const float* position, const float* rotation, const float* scale) {
+    float radians[3];
+    for (int i = 0; i < 3; i++) {
+        radians[i] = rotation[i] * static_cast<float>(M_PI) / 180.0f;
+    }
+
+    float rx[16], ry[16], rz[16], temp[16], rotationMatrix[16];
+    MatrixIdentity(rx);
+    MatrixIdentity(ry);
+    MatrixIdentity(rz);
+    rx[5] = std::cos(radians[0]); rx[6] = std::sin(radians[0]);
+    rx[9] = -std::sin(radians[0]); rx[10] = std::cos(radians[0]);
+    ry[0] = std::cos(radians[1]); ry[2] = -std::sin(radians[1]);
+    ry[8] = std::sin(radians[1]); ry[10] = std::cos(radians[1]);
+    rz[0] = std::cos(radians[2]); rz[1] = std::sin(radians[2]);
+    rz[4] = -std::sin(radians[2]); rz[5] = std::cos(radians[2]);
+
+    MatrixMultiply(temp, rx, ry);
+    MatrixMultiply(rotationMatrix, temp, rz);
+
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            m[column * 4 + row] = rotationMatrix[column * 4 + row] * scale[column];
+        }
+        m[column * 4 + 3] = 0.0f;
+    }
+    m[12] = position[0];
+    m[13] = position[1];
+    m[14] = position[2];
+    m[15] = 1.0f;
+}
+
+// Transform a point by a column-major matrix (w assumed 1)
+static void TransformPoint(const float* m, float x, float y, float z, float* out) {
+    for (int row = 0; row < 3; row++) {
+        out[row] = m[row] * x + m[4 + row] * y + m[8 + row] * z + m[12 + row];
+    }
+}
+
+RendererVulkan::RendererVulkan()
+    : mWindow(nullptr)
+    , mInstance(VK_NULL_HANDLE)
+    , mSurface(VK_NULL_HANDLE)
+    , mPhysicalDevice(VK_NULL_HANDLE)
+    , mDeviceProperties()
+    , mDevice(VK_NULL_HANDLE)
+    , mQueue(VK_NULL_HANDLE)
+    , mQueueFamily(0)
+    , mSwapchain(VK_NULL_HANDLE)
+    , mSwapchainFormat(VK_FORMAT_UNDEFINED)
+    , mSwapchainExtent()
+    , mDepthFormat(VK_FORMAT_UNDEFINED)
+    , mDepthImage(VK_NULL_HANDLE)
+    , mDepthMemory(VK_NULL_HANDLE)
+    , mDepthView(VK_NULL_HANDLE)
+    , mRenderPass(VK_NULL_HANDLE)
+    , mPipelineCache(VK_NULL_HANDLE)
+    , mColorLayout(VK_NULL_HANDLE)
+    , mTexturedLayout(VK_NULL_HANDLE)
+    , mTextureSetLayout(VK_NULL_HANDLE)
+    , mTrianglePipeline(VK_NULL_HANDLE)
+    , mLinePipeline(VK_NULL_HANDLE)
+    , mLanderPipeline(VK_NULL_HANDLE)
+    , mHudPipeline(VK_NULL_HANDLE)
+    , mMinimapPipeline(VK_NULL_HANDLE)
+    , mFrameIndex(0)
+    , mImageIndex(0)
+    , mTerrainBuffer(VK_NULL_HANDLE)
+    , mTerrainMemory(VK_NULL_HANDLE)
+    , mTerrainSource(nullptr)
+    , mTerrainGeneration(0)
+    , mDrawTerrain(false)
+    , mMinimapImage(VK_NULL_HANDLE)
+    , mMinimapMemory(VK_NULL_HANDLE)
+    , mMinimapView(VK_NULL_HANDLE)
+    , mMinimapSampler(VK_NULL_HANDLE)
+    , mDescriptorPool(VK_NULL_HANDLE)
+    , mMinimapSet(VK_NULL_HANDLE)
+    , mMinimapWidth(0)
+    , mMinimapHeight(0)
+    , mMinimapGeneration(0)
+    , mMinimapSource(nullptr)
+    , mDrawMinimap(false)
+    , mMinimapLayoutReady(false)
+    , mGeometry()
+    , mRecordGeneration(0)
+    , mRecordPending(0)
+    , mRecordFrame(0)
+    , mRecordStop(false)
+    , mWidth(800)
+    , mHeight(600)
+    , mInitialized(false)
+{
+    std::memset(mFrames, 0, sizeof(mFrames));
+    std::memset(mMinimapRect, 0, sizeof(mMinimapRect));
+
+    // Same defaults as the OpenGL renderer
+    mCameraPosition[0] = 0.0f;
+    mCameraPosition[1] = 100.0f;
+    mCameraPosition[2] = 200.0f;
+
+    mCameraTarget[0] = mCameraTarget[1] = mCameraTarget[2] = 0.0f;
+
+    mCameraUp[0] = 0.0f;
+    mCameraUp[1] = 1.0f;
+    mCameraUp[2] = 0.0f;
+
+    mLightPosition[0] = 500.0f;
+    mLightPosition[1] = 1000.0f;
+    mLightPosition[2] = 500.0f;
+
+    mAmbientLight[0] = mAmbientLight[1] = mAmbientLight[2] = 0.3f;
+
+    MatrixIdentity(mViewProjection);
+    MatrixIdentity(mHudProjection);
+    std::memset(mFrustum, 0, sizeof(mFrustum));
+}
+
+RendererVulkan::~RendererVulkan() {
+    Shutdown();
+}
+
+bool RendererVulkan::Initialize(int width, int height, const std::string& title) {
+    // Store dimensions
+    mWidth = width;
+    mHeight = height;
+
+    // Initialize SDL
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    // Create window with Vulkan support
+    mWindow = SDL_CreateWindow(
+        title.c_str(),
+        SDL_WINDOWPOS_CENTERED,
+        SDL_WINDOWPOS_CENTERED,
+        mWidth,
+        mHeight,
+        SDL_WINDOW_VULKAN | SDL_WINDOW_SHOWN
+    );
+
+    if (!mWindow) {
+        std::cerr << "Window creation failed: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    if (!CreateInstance() || !PickPhysicalDevice() || !CreateDevice()) {
+        return false;
+    }
+
+    LoadPipelineCache();
+
+    if (!CreateSwapchain() || !CreateRenderPass() || !CreateFramebuffers() ||
+        !CreatePipelines() || !CreateFrameResources() || !CreateMinimapResources()) {
+        return false;
+    }
+
+    // Lander model: unit cube, scaled to the lander's size per instance
+    static const float kCubeCorners[8][3] = {
+        { -0.5f, -0.5f,  0.5f }, { 0.5f, -0.5f,  0.5f }, { 0.5f, 0.5f,  0.5f }, { -0.5f, 0.5f,  0.5f },
+        { -0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, -0.5f }, { -0.5f, 0.5f, -0.5f }
+    };
+    static const int kCubeFaces[6][4] = {
+        { 0, 1, 2, 3 }, { 5, 4, 7, 6 }, { 4, 0, 3, 7 }, { 1, 5, 6, 2 }, { 3, 2, 6, 7 }, { 4, 5, 1, 0 }
+    };
+    mLanderMesh.clear();
+    for (const auto& face : kCubeFaces) {
+        const int order[6] = { face[0], face[1], face[2], face[0], face[2], face[3] };
+        for (int corner : order) {
+            ColorVertex vertex = {
+                { kCubeCorners[corner][0], kCubeCorners[corner][1], kCubeCorners[corner][2] },
+                { 1.0f, 1.0f, 1.0f, 1.0f }
+            };
+            mLanderMesh.push_back(vertex);
+        }
+    }
+
+    // Command recording threads (one command pool each per frame)
+    unsigned int threadCount = std::thread::hardware_concurrency();
+    threadCount = std::max(1u, std::min<unsigned int>(kMaxRecordThreads, threadCount > 1 ? threadCount - 1 : 1));
+    for (unsigned int i = 0; i < threadCount; i++) {
+        mRecordThreads.emplace_back(&RendererVulkan::RecordWorker, this, static_cast<int>(i));
+    }
+
+    UpdateMatrices();
+
+    std::cout << "Vulkan renderer on " << mDeviceProperties.deviceName
+              << " (" << threadCount << " recording threads)" << std::endl;
+
+    mInitialized = true;
+    return true;
+}
+
+bool RendererVulkan::CreateInstance() {
+    // Extensions SDL needs for the window surface
+    unsigned int extensionCount = 0;
+    if (!SDL_Vulkan_GetInstanceExtensions(mWindow, &extensionCount, nullptr)) {
+        std::cerr << "Vulkan surface extensions unavailable: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    std::vector<const char*> extensions(extensionCount);
+    SDL_Vulkan_GetInstanceExtensions(mWindow, &extensionCount, extensions.data());
+
+    VkApplicationInfo appInfo = {};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "Lunar Lander Simulator";
+    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.pEngineName = "LunarLander";
+    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.apiVersion = VK_API_VERSION_1_0;
+
+    VkInstanceCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    createInfo.pApplicationInfo = &appInfo;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
+
+    if (vkCreateInstance(&createInfo, nullptr, &mInstance) != VK_SUCCESS) {
+        std::cerr << "Vulkan instance creation failed!" << std::endl;
+        mInstance = VK_NULL_HANDLE;
+        return false;
+    }
+
+    if (!SDL_Vulkan_CreateSurface(mWindow, mInstance, &mSurface)) {
+        std::cerr << "Vulkan surface creation failed: " << SDL_GetError() << std::endl;
+        mSurface = VK_NULL_HANDLE;
+        return false;
+    }
+
+    return true;
+}
+
+bool RendererVulkan::PickPhysicalDevice() {
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(mInstance, &deviceCount, nullptr);
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(mInstance, &deviceCount, devices.data());
+
+    // Prefer real GPUs, but accept software drivers such as lavapipe
+    int bestScore = -1;
+    for (VkPhysicalDevice device : devices) {
+        // Needs the swapchain extension
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+        bool hasSwapchain = false;
+        for (const auto& extension : extensions) {
+            if (std::strcmp(extension.extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0) {
+                hasSwapchain = true;
+            }
+        }
+        if (!hasSwapchain) {
+            continue;
+        }
+
+        // ... and one queue family that can draw and present
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families.data());
+
+        for (uint32_t family = 0; family < familyCount; family++) {
+            VkBool32 canPresent = VK_FALSE;
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, family, mSurface, &canPresent);
+            if (!(families[family].queueFlags & VK_QUEUE_GRAPHICS_BIT) || !canPresent) {
+                continue;
+            }
+
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device, &properties);
+
+            int score = 0;
+            switch (properties.deviceType) {
+                case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   score = 4; break;
+                case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: score = 3; break;
+                case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    score = 2; break;
+                case VK_PHYSICAL_DEVICE_TYPE_CPU:            score = 1; break;
+                default:                                     score = 0; break;
+            }
+
+            if (score > bestScore) {
+                bestScore = score;
+                mPhysicalDevice = device;
+                mDeviceProperties = properties;
+                mQueueFamily = family;
+            }
+            break;
+        }
+    }
+
+    if (mPhysicalDevice == VK_NULL_HANDLE) {
+        std::cerr << "No Vulkan device can render to this window!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool RendererVulkan::CreateDevice() {
+    float queuePriority = 1.0f;
+    VkDeviceQueueCreateInfo queueInfo = {};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = mQueueFamily;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &queuePriority;
+
+    const char* extensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+
+    VkDeviceCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.queueCreateInfoCount = 1;
+    createInfo.pQueueCreateInfos = &queueInfo;
+    createInfo.enabledExtensionCount = 1;
+    createInfo.ppEnabledExtensionNames = extensions;
+
+    if (vkCreateDevice(mPhysicalDevice, &createInfo, nullptr, &mDevice) != VK_SUCCESS) {
+        std::cerr << "Vulkan device creation failed!" << std::endl;
+        mDevice = VK_NULL_HANDLE;
+        return false;
+    }
+
+    vkGetDeviceQueue(mDevice, mQueueFamily, 0, &mQueue);
+
+    // Depth format: first one the device supports as an attachment
+    const VkFormat depthFormats[] = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM };
+    for (VkFormat format : depthFormats) {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, format, &properties);
+        if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+            mDepthFormat = format;
+            break;
+        }
+    }
+
+    if (mDepthFormat == VK_FORMAT_UNDEFINED) {
+        std::cerr << "No supported Vulkan depth format!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool RendererVulkan::CreateSwapchain() {
+    VkSurfaceCapabilitiesKHR capabilities;
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(mPhysicalDevice, mSurface, &capabilities);
+
+    // Surface format: plain 8-bit BGRA when available
+    uint32_t formatCount = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(mPhysicalDevice, mSurface, &formatCount, nullptr);
+    std::vector<VkSurfaceFormatKHR> formats(formatCount);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(mPhysicalDevice, mSurface, &formatCount, formats.data());
+    if (formats.empty()) {
+        std::cerr << "Vulkan surface has no formats!" << std::endl;
+        return false;
+    }
+
+    VkSurfaceFormatKHR surfaceFormat = formats[0];
+    for (const auto& format : formats) {
+        if (format.format == VK_FORMAT_B8G8R8A8_UNORM && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+            surfaceFormat = format;
+        }
+    }
+    mSwapchainFormat = surfaceFormat.format;
+
+    // Size follows the window
+    if (capabilities.currentExtent.width != 0xFFFFFFFF) {
+        mSwapchainExtent = capabilities.currentExtent;
+    } else {
+        int drawableWidth = mWidth, drawableHeight = mHeight;
+        SDL_Vulkan_GetDrawableSize(mWindow, &drawableWidth, &drawableHeight);
+        mSwapchainExtent.width = std::max(capabilities.minImageExtent.width,
+            std::min(capabilities.maxImageExtent.width, static_cast<uint32_t>(drawableWidth)));
+        mSwapchainExtent.height = std::max(capabilities.minImageExtent.height,
+            std::min(capabilities.maxImageExtent.height, static_cast<uint32_t>(drawableHeight)));
+    }
+
+    if (mSwapchainExtent.width == 0 || mSwapchainExtent.height == 0) {
+        return false;  // Minimized; try again later
+    }
+
+    uint32_t imageCount = capabilities.minImageCount + 1;
+    if (capabilities.maxImageCount > 0) {
+        imageCount = std::min(imageCount, capabilities.maxImageCount);
+    }
+
+    VkCompositeAlphaFlagBitsKHR compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    if (!(capabilities.supportedCompositeAlpha & compositeAlpha)) {
+        compositeAlpha = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
+    }
+
+    VkSwapchainCreateInfoKHR createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    createInfo.surface = mSurface;
+    createInfo.minImageCount = imageCount;
+    createInfo.imageFormat = surfaceFormat.format;
+    createInfo.imageColorSpace = surfaceFormat.colorSpace;
+    createInfo.imageExtent = mSwapchainExtent;
+    createInfo.imageArrayLayers = 1;
+    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    createInfo.preTransform = capabilities.currentTransform;
+    createInfo.compositeAlpha = compositeAlpha;
+    createInfo.presentMode = VK_PRESENT_MODE_FIFO_KHR;  // Always available, vsynced
+    createInfo.clipped = VK_TRUE;
+
+    if (vkCreateSwapchainKHR(mDevice, &createInfo, nullptr, &mSwapchain) != VK_SUCCESS) {
+        std::cerr << "Vulkan swapchain creation failed!" << std::endl;
+        mSwapchain = VK_NULL_HANDLE;
+        return false;
+    }
+
+    vkGetSwapchainImagesKHR(mDevice, mSwapchain, &imageCount, nullptr);
+    mSwapchainImages.resize(imageCount);
+    vkGetSwapchainImagesKHR(mDevice, mSwapchain, &imageCount, mSwapchainImages.data());
+
+    // Views and present semaphores for each image
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    mSwapchainViews.resize(imageCount);
+    mRenderFinished.resize(imageCount);
+    for (uint32_t i = 0; i < imageCount; i++) {
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = mSwapchainImages[i];
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = mSwapchainFormat;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(mDevice, &viewInfo, nullptr, &mSwapchainViews[i]) != VK_SUCCESS ||
+            vkCreateSemaphore(mDevice, &semaphoreInfo, nullptr, &mRenderFinished[i]) != VK_SUCCESS) {
+            std::cerr << "Vulkan swapchain view creation failed!" << std::endl;
+            return false;
+        }
+    }
+
+    // Depth buffer to match
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = mDepthFormat;
+    imageInfo.extent.width = mSwapchainExtent.width;
+    imageInfo.extent.height = mSwapchainExtent.height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(mDevice, &imageInfo, nullptr, &mDepthImage) != VK_SUCCESS) {
+        std::cerr << "Vulkan depth image creation failed!" << std::endl;
+        return false;
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(mDevice, mDepthImage, &requirements);
+
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &mDepthMemory) != VK_SUCCESS) {
+        std::cerr << "Vulkan depth memory allocation failed!" << std::endl;
+        return false;
+    }
+    vkBindImageMemory(mDevice, mDepthImage, mDepthMemory, 0);
+
+    VkImageViewCreateInfo depthViewInfo = {};
+    depthViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    depthViewInfo.image = mDepthImage;
+    depthViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    depthViewInfo.format = mDepthFormat;
+    depthViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    depthViewInfo.subresourceRange.levelCount = 1;
+    depthViewInfo.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(mDevice, &depthViewInfo, nullptr, &mDepthView) != VK_SUCCESS) {
+        std::cerr << "Vulkan depth view creation failed!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void RendererVulkan::DestroySwapchain() {
+    for (VkFramebuffer framebuffer : mFramebuffers) {
+        vkDestroyFramebuffer(mDevice, framebuffer, nullptr);
+    }
+    mFramebuffers.clear();
+
+    for (VkImageView view : mSwapchainViews) {
+        if (view) {
+            vkDestroyImageView(mDevice, view, nullptr);
+        }
+    }
+    mSwapchainViews.clear();
+
+    for (VkSemaphore semaphore : mRenderFinished) {
+        if (semaphore) {
+            vkDestroySemaphore(mDevice, semaphore, nullptr);
+        }
+    }
+    mRenderFinished.clear();
+    mSwapchainImages.clear();
+
+    if (mDepthView) {
+        vkDestroyImageView(mDevice, mDepthView, nullptr);
+        mDepthView = VK_NULL_HANDLE;
+    }
+    if (mDepthImage) {
+        vkDestroyImage(mDevice, mDepthImage, nullptr);
+        mDepthImage = VK_NULL_HANDLE;
+    }
+    if (mDepthMemory) {
+        vkFreeMemory(mDevice, mDepthMemory, nullptr);
+        mDepthMemory = VK_NULL_HANDLE;
+    }
+
+    if (mSwapchain) {
+        vkDestroySwapchainKHR(mDevice, mSwapchain, nullptr);
+        mSwapchain = VK_NULL_HANDLE;
+    }
+}
+
+bool RendererVulkan::RecreateSwapchain() {
+    vkDeviceWaitIdle(mDevice);
+    DestroySwapchain();
+    return CreateSwapchain() && CreateFramebuffers();
+}
+
+bool RendererVulkan::CreateRenderPass() {
+    VkAttachmentDescription attachments[2] = {};
+
+    // Color: cleared, then handed to the presentation engine
+    attachments[0].format = mSwapchainFormat;
+    attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    // Depth: only needed during the pass
+    attachments[1].format = mDepthFormat;
+    attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    VkAttachmentReference depthReference = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorReference;
+    subpass.pDepthStencilAttachment = &depthReference;
+
+    // Wait for the acquired image and the previous frame's depth use
+    VkSubpassDependency dependency = {};
+    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass = 0;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                              VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                              VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    VkRenderPassCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    createInfo.attachmentCount = 2;
+    createInfo.pAttachments = attachments;
+    createInfo.subpassCount = 1;
+    createInfo.pSubpasses = &subpass;
+    createInfo.dependencyCount = 1;
+    createInfo.pDependencies = &dependency;
+
+    if (vkCreateRenderPass(mDevice, &createInfo, nullptr, &mRenderPass) != VK_SUCCESS) {
+        std::cerr << "Vulkan render pass creation failed!" << std::endl;
+        mRenderPass = VK_NULL_HANDLE;
+        return false;
+    }
+
+    return true;
+}
+
+bool RendererVulkan::CreateFramebuffers() {
+    mFramebuffers.resize(mSwapchainViews.size(), VK_NULL_HANDLE);
+    for (size_t i = 0; i < mSwapchainViews.size(); i++) {
+        VkImageView attachments[2] = { mSwapchainViews[i], mDepthView };
+
+        VkFramebufferCreateInfo createInfo = {};
+        createInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        createInfo.renderPass = mRenderPass;
+        createInfo.attachmentCount = 2;
+        createInfo.pAttachments = attachments;
+        createInfo.width = mSwapchainExtent.width;
+        createInfo.height = mSwapchainExtent.height;
+        createInfo.layers = 1;
+
+        if (vkCreateFramebuffer(mDevice, &createInfo, nullptr, &mFramebuffers[i]) != VK_SUCCESS) {
+            std::cerr << "Vulkan framebuffer creation failed!" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+VkShaderModule RendererVulkan::LoadShaderModule(const char* name) {
+    // SPIR-V is compiled at build time into shaders/ next to the executable
+    std::string path = std::string("shaders/") + name + ".spv";
+    char* basePath = SDL_GetBasePath();
+    if (basePath) {
+        path = std::string(basePath) + path;
+        SDL_free(basePath);
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Failed to open shader: " << path << std::endl;
+        return VK_NULL_HANDLE;
+    }
+
+    std::streamsize size = file.tellg();
+    std::vector<uint32_t> code(static_cast<size_t>(size + 3) / 4);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(code.data()), size);
+
+    VkShaderModuleCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = static_cast<size_t>(size);
+    createInfo.pCode = code.data();
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(mDevice, &createInfo, nullptr, &module) != VK_SUCCESS) {
+        std::cerr << "Failed to create shader module: " << path << std::endl;
+        return VK_NULL_HANDLE;
+    }
+
+    return module;
+}
+
+void RendererVulkan::LoadPipelineCache() {
+    char* prefPath = SDL_GetPrefPath("LunarLander", "LunarLander");
+    if (prefPath) {
+        mPipelineCachePath = std::string(prefPath) + "vulkan_pipeline_cache.bin";
+        SDL_free(prefPath);
+    }
+
+    // Reuse the saved cache only if it was written by this device and driver
+    std::vector<char> data;
+    if (!mPipelineCachePath.empty()) {
+        std::ifstream file(mPipelineCachePath, std::ios::binary);
+        if (file) {
+            data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+    }
+
+    const size_t headerSize = 16 + VK_UUID_SIZE;
+    if (data.size() >= headerSize) {
+        uint32_t header[4];
+        std::memcpy(header, data.data(), sizeof(header));
+        bool matches = header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                       header[2] == mDeviceProperties.vendorID &&
+                       header[3] == mDeviceProperties.deviceID &&
+                       std::memcmp(data.data() + 16, mDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        if (!matches) {
+            data.clear();
+        }
+    } else {
+        data.clear();
+    }
+
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(mDevice, &createInfo, nullptr, &mPipelineCache) != VK_SUCCESS) {
+        mPipelineCache = VK_NULL_HANDLE;  // Pipelines still work without a cache
+    } else if (!data.empty()) {
+        std::cout << "Loaded Vulkan pipeline cache (" << data.size() << " bytes)" << std::endl;
+    }
+}
+
+void RendererVulkan::SavePipelineCache() {
+    if (!mPipelineCache || mPipelineCachePath.empty()) {
+        return;
+    }
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(mDevice, mPipelineCache, &size, nullptr) != VK_SUCCESS || size == 0) {
+        return;
+    }
+
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(mDevice, mPipelineCache, &size, data.data()) != VK_SUCCESS) {
+        return;
+    }
+
+    std::ofstream file(mPipelineCachePath, std::ios::binary | std::ios::trunc);
+    if (!file.write(data.data(), static_cast<std::streamsize>(size))) {
+        std::cerr << "Failed to save pipeline cache: " << mPipelineCachePath << std::endl;
+    }
+}
+
+bool RendererVulkan::CreatePipelines() {
+    // Layouts: a view-projection matrix push constant, plus a texture for the minimap
+    VkPushConstantRange pushRange = {};
+    pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(float) * 16;
+
+    VkDescriptorSetLayoutBinding samplerBinding = {};
+    samplerBinding.binding = 0;
+    samplerBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    samplerBinding.descriptorCount = 1;
+    samplerBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo = {};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.bindingCount = 1;
+    setLayoutInfo.pBindings = &samplerBinding;
+
+    if (vkCreateDescriptorSetLayout(mDevice, &setLayoutInfo, nullptr, &mTextureSetLayout) != VK_SUCCESS) {
+        std::cerr << "Vulkan descriptor set layout creation failed!" << std::endl;
+        return false;
+    }
+
+    VkPipelineLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges = &pushRange;
+
+    if (vkCreatePipelineLayout(mDevice, &layoutInfo, nullptr, &mColorLayout) != VK_SUCCESS) {
+        std::cerr << "Vulkan pipeline layout creation failed!" << std::endl;
+        return false;
+    }
+
+    layoutInfo.setLayoutCount = 1;
+    layoutInfo.pSetLayouts = &mTextureSetLayout;
+    if (vkCreatePipelineLayout(mDevice, &layoutInfo, nullptr, &mTexturedLayout) != VK_SUCCESS) {
+        std::cerr << "Vulkan pipeline layout creation failed!" << std::endl;
+        return false;
+    }
+
+    VkShaderModule sceneVertex = LoadShaderModule("scene.vert");
+    VkShaderModule landerVertex = LoadShaderModule("lander.vert");
+    VkShaderModule colorFragment = LoadShaderModule("color.frag");
+    VkShaderModule minimapVertex = LoadShaderModule("minimap.vert");
+    VkShaderModule minimapFragment = LoadShaderModule("minimap.frag");
+
+    bool success = sceneVertex && landerVertex && colorFragment && minimapVertex && minimapFragment;
+
+    // Vertex layouts
+    VkVertexInputBindingDescription colorBinding = { 0, sizeof(ColorVertex), VK_VERTEX_INPUT_RATE_VERTEX };
+    VkVertexInputAttributeDescription colorAttributes[2] = {
+        { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(ColorVertex, position) },
+        { 1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(ColorVertex, color) }
+    };
+
+    VkVertexInputBindingDescription landerBindings[2] = {
+        { 0, sizeof(ColorVertex), VK_VERTEX_INPUT_RATE_VERTEX },
+        { 1, sizeof(LanderInstance), VK_VERTEX_INPUT_RATE_INSTANCE }
+    };
+    VkVertexInputAttributeDescription landerAttributes[7] = {
+        { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(ColorVertex, position) },
+        { 1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(ColorVertex, color) },
+        { 2, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(LanderInstance, model) },
+        { 3, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(LanderInstance, model) + sizeof(float) * 4 },
+        { 4, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(LanderInstance, model) + sizeof(float) * 8 },
+        { 5, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(LanderInstance, model) + sizeof(float) * 12 },
+        { 6, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(LanderInstance, color) }
+    };
+
+    VkVertexInputBindingDescription texturedBinding = { 0, sizeof(TexturedVertex), VK_VERTEX_INPUT_RATE_VERTEX };
+    VkVertexInputAttributeDescription texturedAttributes[2] = {
+        { 0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(TexturedVertex, position) },
+        { 1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(TexturedVertex, uv) }
+    };
+
+    // Builds one pipeline; everything not passed in is shared
+    auto createPipeline = [&](VkShaderModule vertexModule, VkShaderModule fragmentModule,
+                              VkPipelineLayout layout, VkPrimitiveTopology topology,
+                              uint32_t bindingCount, const VkVertexInputBindingDescription* bindings,
+                              uint32_t attributeCount, const VkVertexInputAttributeDescription* attributes,
+                              bool depthTest, bool blend, VkPipeline& pipeline) {
+        if (!success) {
+            return;
+        }
+
+        VkPipelineShaderStageCreateInfo stages[2] = {};
+        stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        stages[0].module = vertexModule;
+        stages[0].pName = "main";
+        stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[1].module = fragmentModule;
+        stages[1].pName = "main";
+
+        VkPipelineVertexInputStateCreateInfo vertexInput = {};
+        vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInput.vertexBindingDescriptionCount = bindingCount;
+        vertexInput.pVertexBindingDescriptions = bindings;
+        vertexInput.vertexAttributeDescriptionCount = attributeCount;
+        vertexInput.pVertexAttributeDescriptions = attributes;
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+        inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        inputAssembly.topology = topology;
+
+        VkPipelineViewportStateCreateInfo viewportState = {};
+        viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportState.viewportCount = 1;
+        viewportState.scissorCount = 1;
+
+        VkPipelineRasterizationStateCreateInfo rasterization = {};
+        rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+        rasterization.cullMode = VK_CULL_MODE_NONE;
+        rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        rasterization.lineWidth = 1.0f;
+
+        VkPipelineMultisampleStateCreateInfo multisample = {};
+        multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencil.depthTestEnable = depthTest ? VK_TRUE : VK_FALSE;
+        depthStencil.depthWriteEnable = depthTest ? VK_TRUE : VK_FALSE;
+        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+        VkPipelineColorBlendAttachmentState blendAttachment = {};
+        blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                         VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        if (blend) {
+            blendAttachment.blendEnable = VK_TRUE;
+            blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+            blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            blendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+            blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            blendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+        }
+
+        VkPipelineColorBlendStateCreateInfo colorBlend = {};
+        colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        colorBlend.attachmentCount = 1;
+        colorBlend.pAttachments = &blendAttachment;
+
+        const VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+        VkPipelineDynamicStateCreateInfo dynamicState = {};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = 2;
+        dynamicState.pDynamicStates = dynamicStates;
+
+        VkGraphicsPipelineCreateInfo createInfo = {};
+        createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        createInfo.stageCount = 2;
+        createInfo.pStages = stages;
+        createInfo.pVertexInputState = &vertexInput;
+        createInfo.pInputAssemblyState = &inputAssembly;
+        createInfo.pViewportState = &viewportState;
+        createInfo.pRasterizationState = &rasterization;
+        createInfo.pMultisampleState = &multisample;
+        createInfo.pDepthStencilState = &depthStencil;
+        createInfo.pColorBlendState = &colorBlend;
+        createInfo.pDynamicState = &dynamicState;
+        createInfo.layout = layout;
+        createInfo.renderPass = mRenderPass;
+        createInfo.subpass = 0;
+
+        if (vkCreateGraphicsPipelines(mDevice, mPipelineCache, 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            std::cerr << "Vulkan pipeline creation failed!" << std::endl;
+            pipeline = VK_NULL_HANDLE;
+            success = false;
+        }
+    };
+
+    createPipeline(sceneVertex, colorFragment, mColorLayout, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+                   1, &colorBinding, 2, colorAttributes, true, false, mTrianglePipeline);
+    createPipeline(sceneVertex, colorFragment, mColorLayout, VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
+                   1, &colorBinding, 2, colorAttributes, true, false, mLinePipeline);
+    createPipeline(landerVertex, colorFragment, mColorLayout, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+                   2, landerBindings, 7, landerAttributes, true, false, mLanderPipeline);
+    createPipeline(sceneVertex, colorFragment, mColorLayout, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+                   1, &colorBinding, 2, colorAttributes, false, true, mHudPipeline);
+    createPipeline(minimapVertex, minimapFragment, mTexturedLayout, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+                   1, &texturedBinding, 2, texturedAttributes, false, true, mMinimapPipeline);
+
+    // Modules are baked into the pipelines
+    VkShaderModule modules[] = { sceneVertex, landerVertex, colorFragment, minimapVertex, minimapFragment };
+    for (VkShaderModule module : modules) {
+        if (module) {
+            vkDestroyShaderModule(mDevice, module, nullptr);
+        }
+    }
+
+    return success;
+}
+
+bool RendererVulkan::CreateFrameResources() {
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = mQueueFamily;
+
+    for (FrameResources& frame : mFrames) {
+        if (vkCreateSemaphore(mDevice, &semaphoreInfo, nullptr, &frame.imageAvailable) != VK_SUCCESS ||
+            vkCreateFence(mDevice, &fenceInfo, nullptr, &frame.inFlight) != VK_SUCCESS ||
+            vkCreateCommandPool(mDevice, &poolInfo, nullptr, &frame.commandPool) != VK_SUCCESS) {
+            std::cerr << "Vulkan frame resource creation failed!" << std::endl;
+            return false;
+        }
+
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = frame.commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(mDevice, &allocInfo, &frame.commandBuffer) != VK_SUCCESS) {
+            std::cerr << "Vulkan command buffer allocation failed!" << std::endl;
+            return false;
+        }
+
+        // Command pools are single-threaded: one per recording thread
+        for (int thread = 0; thread < kMaxRecordThreads; thread++) {
+            if (vkCreateCommandPool(mDevice, &poolInfo, nullptr, &frame.workerPools[thread]) != VK_SUCCESS) {
+                std::cerr << "Vulkan command pool creation failed!" << std::endl;
+                return false;
+            }
+
+            allocInfo.commandPool = frame.workerPools[thread];
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = kMaxRecordTasks;
+            if (vkAllocateCommandBuffers(mDevice, &allocInfo, frame.workerCommandBuffers[thread]) != VK_SUCCESS) {
+                std::cerr << "Vulkan command buffer allocation failed!" << std::endl;
+                return false;
+            }
+        }
+
+        // Persistently mapped staging ring, also read directly as vertex data
+        if (!CreateBuffer(kStagingRingSize,
+                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          frame.ringBuffer, frame.ringMemory)) {
+            return false;
+        }
+
+        void* mapped = nullptr;
+        if (vkMapMemory(mDevice, frame.ringMemory, 0, kStagingRingSize, 0, &mapped) != VK_SUCCESS) {
+            std::cerr << "Vulkan staging ring mapping failed!" << std::endl;
+            return false;
+        }
+        frame.ringData = static_cast<uint8_t*>(mapped);
+        frame.ringOffset = 0;
+    }
+
+    return true;
+}
+
+bool RendererVulkan::CreateMinimapResources() {
+    VkSamplerCreateInfo samplerInfo = {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(mDevice, &samplerInfo, nullptr, &mMinimapSampler) != VK_SUCCESS) {
+        std::cerr << "Vulkan sampler creation failed!" << std::endl;
+        return false;
+    }
+
+    VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 };
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(mDevice, &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) {
+        std::cerr << "Vulkan descriptor pool creation failed!" << std::endl;
+        return false;
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = mDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &mTextureSetLayout;
+
+    if (vkAllocateDescriptorSets(mDevice, &allocInfo, &mMinimapSet) != VK_SUCCESS) {
+        std::cerr << "Vulkan descriptor set allocation failed!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+uint32_t RendererVulkan::FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) const {
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &memoryProperties);
+
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if ((typeBits & (1u << i)) &&
+            (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+
+    // Fall back to any allowed type (e.g. no separate device-local heap)
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if (typeBits & (1u << i)) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+bool RendererVulkan::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                                  VkBuffer& buffer, VkDeviceMemory& memory) {
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(mDevice, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+        std::cerr << "Vulkan buffer creation failed!" << std::endl;
+        buffer = VK_NULL_HANDLE;
+        return false;
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(mDevice, buffer, &requirements);
+
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, properties);
+
+    if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        std::cerr << "Vulkan buffer memory allocation failed!" << std::endl;
+        vkDestroyBuffer(mDevice, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+        memory = VK_NULL_HANDLE;
+        return false;
+    }
+
+    vkBindBufferMemory(mDevice, buffer, memory, 0);
+    return true;
+}
+
+VkDeviceSize RendererVulkan::WriteRing(FrameResources& frame, const void* data, VkDeviceSize size) {
+    VkDeviceSize offset = (frame.ringOffset + kRingAlignment - 1) & ~(kRingAlignment - 1);
+    if (offset + size > kStagingRingSize) {
+        return kRingFull;
+    }
+
+    if (size > 0) {
+        std::memcpy(frame.ringData + offset, data, static_cast<size_t>(size));
+    }
+    frame.ringOffset = offset + size;
+    return offset;
+}
+
+void RendererVulkan::Shutdown() {
+    if (mDevice) {
+        vkDeviceWaitIdle(mDevice);
+    }
+
+    // Stop the recording threads
+    {
+        std::lock_guard<std::mutex> lock(mRecordMutex);
+        mRecordStop = true;
+    }
+    mRecordStart.notify_all();
+    for (std::thread& thread : mRecordThreads) {
+        thread.join();
+    }
+    mRecordThreads.clear();
+    mRecordStop = false;
+
+    if (mDevice) {
+        SavePipelineCache();
+
+        if (mTerrainBuffer) vkDestroyBuffer(mDevice, mTerrainBuffer, nullptr);
+        if (mTerrainMemory) vkFreeMemory(mDevice, mTerrainMemory, nullptr);
+        mTerrainBuffer = VK_NULL_HANDLE;
+        mTerrainMemory = VK_NULL_HANDLE;
+        mTerrainSource = nullptr;
+
+        if (mMinimapView) vkDestroyImageView(mDevice, mMinimapView, nullptr);
+        if (mMinimapImage) vkDestroyImage(mDevice, mMinimapImage, nullptr);
+        if (mMinimapMemory) vkFreeMemory(mDevice, mMinimapMemory, nullptr);
+        if (mMinimapSampler) vkDestroySampler(mDevice, mMinimapSampler, nullptr);
+        if (mDescriptorPool) vkDestroyDescriptorPool(mDevice, mDescriptorPool, nullptr);
+        mMinimapView = VK_NULL_HANDLE;
+        mMinimapImage = VK_NULL_HANDLE;
+        mMinimapMemory = VK_NULL_HANDLE;
+        mMinimapSampler = VK_NULL_HANDLE;
+        mDescriptorPool = VK_NULL_HANDLE;
+        mMinimapSet = VK_NULL_HANDLE;
+
+        for (FrameResources& frame : mFrames) {
+            if (frame.ringMemory) vkFreeMemory(mDevice, frame.ringMemory, nullptr);
+            if (frame.ringBuffer) vkDestroyBuffer(mDevice, frame.ringBuffer, nullptr);
+            for (VkCommandPool pool : frame.workerPools) {
+                if (pool) vkDestroyCommandPool(mDevice, pool, nullptr);
+            }
+            if (frame.commandPool) vkDestroyCommandPool(mDevice, frame.commandPool, nullptr);
+            if (frame.inFlight) vkDestroyFence(mDevice, frame.inFlight, nullptr);
+            if (frame.imageAvailable) vkDestroySemaphore(mDevice, frame.imageAvailable, nullptr);
+        }
+        std::memset(mFrames, 0, sizeof(mFrames));
+
+        VkPipeline pipelines[] = { mTrianglePipeline, mLinePipeline, mLanderPipeline, mHudPipeline, mMinimapPipeline };
+        for (VkPipeline pipeline : pipelines) {
+            if (pipeline) vkDestroyPipeline(mDevice, pipeline, nullptr);
+        }
+        mTrianglePipeline = mLinePipeline = mLanderPipeline = mHudPipeline = mMinimapPipeline = VK_NULL_HANDLE;
+
+        if (mColorLayout) vkDestroyPipelineLayout(mDevice, mColorLayout, nullptr);
+        if (mTexturedLayout) vkDestroyPipelineLayout(mDevice, mTexturedLayout, nullptr);
+        if (mTextureSetLayout) vkDestroyDescriptorSetLayout(mDevice, mTextureSetLayout, nullptr);
+        if (mPipelineCache) vkDestroyPipelineCache(mDevice, mPipelineCache, nullptr);
+        mColorLayout = mTexturedLayout = VK_NULL_HANDLE;
+        mTextureSetLayout = VK_NULL_HANDLE;
+        mPipelineCache = VK_NULL_HANDLE;
+
+        DestroySwapchain();
+        if (mRenderPass) vkDestroyRenderPass(mDevice, mRenderPass, nullptr);
+        mRenderPass = VK_NULL_HANDLE;
+
+        vkDestroyDevice(mDevice, nullptr);
+        mDevice = VK_NULL_HANDLE;
+    }
+
+    if (mSurface) {
+        vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+        mSurface = VK_NULL_HANDLE;
+    }
+
+    if (mInstance) {
+        vkDestroyInstance(mInstance, nullptr);
+        mInstance = VK_NULL_HANDLE;
+    }
+
+    // Destroy window
+    if (mWindow) {
+        SDL_DestroyWindow(mWindow);
+        mWindow = nullptr;
+    }
+
+    mInitialized = false;
+}
+
+void RendererVulkan::Clear() {
+    if (!mInitialized) return;
+
+    // Start collecting a new frame
+    mSceneTriangles.clear();
+    mSceneLines.clear();
+    mLanderInstances.clear();
+    mHudTriangles.clear();
+    mOverlayTriangles.clear();
+    mDrawTerrain = false;
+    mDrawMinimap = false;
+
+    UpdateMatrices();
+}
+
+void RendererVulkan::UpdateMatrices() {
+    float view[16], projection[16];
+    float aspect = mSwapchainExtent.height > 0 ?
+        (float)mSwapchainExtent.width / (float)mSwapchainExtent.height : (float)mWidth / (float)mHeight;
+    MatrixLookAt(view, mCameraPosition, mCameraTarget, mCameraUp);
+    MatrixPerspective(projection, 45.0f, aspect, 0.1f, 1000.0f);
+    MatrixMultiply(mViewProjection, projection, view);
+
+    // Frustum planes (Vulkan clip space: -w <= x, y <= w and 0 <= z <= w)
+    const float* m = mViewProjection;
+    for (int j = 0; j < 4; j++) {
+        mFrustum[0][j] = m[j * 4 + 3] + m[j * 4 + 0];
+        mFrustum[1][j] = m[j * 4 + 3] - m[j * 4 + 0];
+        mFrustum[2][j] = m[j * 4 + 3] + m[j * 4 + 1];
+        mFrustum[3][j] = m[j * 4 + 3] - m[j * 4 + 1];
+        mFrustum[4][j] = m[j * 4 + 2];
+        mFrustum[5][j] = m[j * 4 + 3] - m[j * 4 + 2];
+    }
+
+    // HUD in window pixels, origin at the top left
+    MatrixIdentity(mHudProjection);
+    mHudProjection[0] = 2.0f / mWidth;
+    mHudProjection[5] = 2.0f / mHeight;
+    mHudProjection[12] = -1.0f;
+    mHudProjection[13] = -1.0f;
+}
+
+void RendererVulkan::RenderLander(Lander* lander) {
+    if (!mInitialized || !lander) return;
+
+    const float* position = lander->GetPosition();
+    const float* rotation = lander->GetRotation();
+    const float* scale = lander->GetScale();
+
+    // One instance of the shared cube, sized to the lander
+    LanderInstance instance;
+    float size[3] = {
+        scale[0] * lander->GetWidth(),
+        scale[1] * lander->GetHeight(),
+        scale[2] * lander->GetDepth()
+    };
+    MatrixModel(instance.model, position, rotation, size);
+    instance.color[0] = instance.color[1] = instance.color[2] = instance.color[3] = 1.0f;
+    mLanderInstances.push_back(instance);
+
+    // Thrust flame as world-space triangles, shaped like the OpenGL one
+    if (lander->IsThrustActive()) {
+        float model[16];
+        MatrixModel(model, position, rotation, scale);
+
+        float width = lander->GetWidth() / 2.0f;
+        float height = lander->GetHeight() / 2.0f;
+        float depth = lander->GetDepth() / 2.0f;
+        float rotRad = rotation[2] * static_cast<float>(M_PI) / 180.0f;
+        float flameLength = height * lander->GetThrustLevel();
+        float tipX = std::sin(rotRad) * flameLength;
+        float tipY = -height - std::cos(rotRad) * flameLength;
+
+        const float local[6][3] = {
+            { -width / 4, -height, depth / 2 }, { width / 4, -height, depth / 2 }, { tipX, tipY, 0.0f },
+            { -width / 4, -height, -depth / 2 }, { width / 4, -height, -depth / 2 }, { tipX, tipY, 0.0f }
+        };
+
+        for (const auto& point : local) {
+            ColorVertex vertex;
+            TransformPoint(model, point[0], point[1], point[2], vertex.position);
+            vertex.color[0] = 1.0f;
+            vertex.color[1] = 0.5f;
+            vertex.color[2] = 0.0f;
+            vertex.color[3] = 1.0f;
+            mSceneTriangles.push_back(vertex);
+        }
+    }
+}
+
+void RendererVulkan::RenderTerrain(Terrain* terrain) {
+    if (!mInitialized || !terrain) return;
+
+    // Terrain lives on the GPU; Present() re-uploads it when it changes
+    mTerrainSource = terrain;
+    mDrawTerrain = true;
+}
+
+void RendererVulkan::RenderTrajectory(const TrajectoryPredictor* trajectory) {
+    if (!mInitialized || !trajectory) return;
+
+    const std::vector<TrajectoryPoint>& points = trajectory->GetPoints();
+
+    auto addLine = [this](const float* a, const float* b, float r, float g, float bl) {
+        ColorVertex from = { { a[0], a[1], a[2] }, { r, g, bl, 1.0f } };
+        ColorVertex to = { { b[0], b[1], b[2] }, { r, g, bl, 1.0f } };
+        mSceneLines.push_back(from);
+        mSceneLines.push_back(to);
+    };
+
+    // Predicted path in light blue
+    for (size_t i = trajectory->GetFirstIndex() + 1; i < points.size(); i++) {
+        addLine(points[i - 1].position, points[i].position, 0.4f, 0.7f, 1.0f);
+    }
+
+    // Predicted touchdown: green on a landing pad, red elsewhere
+    if (trajectory->HasImpact()) {
+        const float* impact = trajectory->GetImpactPoint();
+        const float size = 8.0f;
+        float r = trajectory->IsImpactOnLandingPad() ? 0.0f : 1.0f;
+        float g = trajectory->IsImpactOnLandingPad() ? 1.0f : 0.0f;
+
+        const float xa[3] = { impact[0] - size, impact[1], impact[2] };
+        const float xb[3] = { impact[0] + size, impact[1], impact[2] };
+        const float za[3] = { impact[0], impact[1], impact[2] - size };
+        const float zb[3] = { impact[0], impact[1], impact[2] + size };
+        addLine(xa, xb, r, g, 0.0f);
+        addLine(za, zb, r, g, 0.0f);
+    }
+}
+
+void RendererVulkan::AddHudQuad(std::vector<ColorVertex>& vertices, float x, float y, float width, float height,
+                                float r, float g, float b, float a) {
+    const float corners[6][2] = {
+        { x, y }, { x + width, y }, { x + width, y + height },
+        { x, y }, { x + width, y + height }, { x, y + height }
+    };
+
+    for (const auto& corner : corners) {
+        ColorVertex vertex = { { corner[0], corner[1], 0.0f }, { r, g, b, a } };
+        vertices.push_back(vertex);
+    }
+}
+
+void RendererVulkan::RenderTelemetry(Game* game) {
+    if (!mInitialized || !game) return;
+
+    // Get lander
+    Lander* lander = game->GetLander();
+    if (!lander) return;
+
+    // Get lander properties
+    const float* position = lander->GetPosition();
+    const float* velocity = lander->GetVelocity();
+    float fuel = lander->GetFuel();
+    float maxFuel = lander->GetMaxFuel();
+
+    // Background for telemetry panel
+    AddHudQuad(mHudTriangles, 10, 10, 200, 100, 0.2f, 0.2f, 0.2f, 0.8f);
+
+    // Altitude bar
+    float altitudePct = std::min(1.0f, position[1] / 500.0f);
+    AddHudQuad(mHudTriangles, 20, 20, altitudePct * 180.0f, 20, 0.0f, 1.0f, 0.0f);
+
+    // Velocity indicator: blue for downward, red for upward
+    float velocityPct = std::min(1.0f, std::abs(velocity[1]) / 10.0f);
+    if (velocity[1] <= 0) {
+        AddHudQuad(mHudTriangles, 20, 50, velocityPct * 180.0f, 20, 0.0f, 0.0f, 1.0f);
+    } else {
+        AddHudQuad(mHudTriangles, 20, 50, velocityPct * 180.0f, 20, 1.0f, 0.0f, 0.0f);
+    }
+
+    // Fuel indicator
+    float fuelPct = fuel / maxFuel;
+    AddHudQuad(mHudTriangles, 20, 80, fuelPct * 180.0f, 20, 1.0f, 1.0f, 0.0f);
+}
+
+void RendererVulkan::RenderGameState(Game* game) {
+    if (!mInitialized || !game) return;
+
+    // State message box
+    switch (game->GetGameState()) {
+        case GameState::READY:
+            AddHudQuad(mHudTriangles, mWidth / 2 - 100, mHeight / 2, 200, 30, 1.0f, 1.0f, 1.0f);
+            break;
+
+        case GameState::LANDED:
+            AddHudQuad(mHudTriangles, mWidth / 2 - 100, mHeight / 2, 200, 30, 0.0f, 1.0f, 0.0f);
+            break;
+
+        case GameState::CRASHED:
+            AddHudQuad(mHudTriangles, mWidth / 2 - 100, mHeight / 2, 200, 30, 1.0f, 0.0f, 0.0f);
+            break;
+
+        default:
+            // No message for other states
+            break;
+    }
+}
+
+void RendererVulkan::RenderMinimap(const TerrainOverview* overview, const Lander* lander) {
+    if (!mInitialized || !overview || !overview->IsReady()) return;
+
+    // Inset in the top right corner; Present() uploads the overview if it is new
+    int width = overview->GetWidth();
+    int height = overview->GetHeight();
+    mMinimapRect[0] = static_cast<float>(mWidth - width - 10);
+    mMinimapRect[1] = 10.0f;
+    mMinimapRect[2] = static_cast<float>(width);
+    mMinimapRect[3] = static_cast<float>(height);
+    mMinimapSource = overview;
+    mDrawMinimap = true;
+
+    // Lander marker (pinned to the edge when it is off the map)
+    if (lander) {
+        const float* position = lander->GetPosition();
+        float u = 0.0f, v = 0.0f;
+        overview->WorldToMap(position[0], position[1], position[2], u, v);
+        float x = mMinimapRect[0] + std::max(0.0f, std::min(1.0f, u)) * width;
+        float y = mMinimapRect[1] + std::max(0.0f, std::min(1.0f, v)) * height;
+        AddHudQuad(mOverlayTriangles, x - 2, y - 2, 4, 4, 1.0f, 0.0f, 0.0f);
+    }
+}
+
+void RendererVulkan::UploadTerrain(FrameResources& frame, const Terrain* terrain) {
+    // Buffers may still be read by the other frame in flight
+    vkDeviceWaitIdle(mDevice);
+    if (mTerrainBuffer) vkDestroyBuffer(mDevice, mTerrainBuffer, nullptr);
+    if (mTerrainMemory) vkFreeMemory(mDevice, mTerrainMemory, nullptr);
+    mTerrainBuffer = VK_NULL_HANDLE;
+    mTerrainMemory = VK_NULL_HANDLE;
+    mTerrainChunks.clear();
+
+    mTerrainSource = terrain;
+    mTerrainGeneration = terrain->GetGeneration();
+
+    const std::vector<TerrainTriangle>& triangles = terrain->GetTriangles3D();
+    if (triangles.empty()) {
+        return;
+    }
+
+    // Colored vertices, same colors as the OpenGL renderer
+    std::vector<ColorVertex> vertices;
+    vertices.reserve(triangles.size() * 3);
+    for (const auto& triangle : triangles) {
+        float r = triangle.isLandingPad ? 0.0f : 0.5f;
+        float g = triangle.isLandingPad ? 0.8f : 0.5f;
+        float b = triangle.isLandingPad ? 0.0f : 0.5f;
+        for (int v = 0; v < 3; v++) {
+            ColorVertex vertex = {
+                { triangle.vertices[v * 3], triangle.vertices[v * 3 + 1], triangle.vertices[v * 3 + 2] },
+                { r, g, b, 1.0f }
+            };
+            vertices.push_back(vertex);
+        }
+    }
+
+    // Split into chunks of whole triangles (the grid is stored row by row,
+    // so each chunk is a compact strip) and record their bounds for culling
+    uint32_t triangleCount = static_cast<uint32_t>(triangles.size());
+    uint32_t chunkTriangles = std::max(1u, (triangleCount + kTerrainChunkCount - 1) / kTerrainChunkCount);
+    for (uint32_t first = 0; first < triangleCount; first += chunkTriangles) {
+        TerrainChunk chunk;
+        chunk.firstVertex = first * 3;
+        chunk.vertexCount = std::min(chunkTriangles, triangleCount - first) * 3;
+        for (int axis = 0; axis < 3; axis++) {
+            chunk.boundsMin[axis] = vertices[chunk.firstVertex].position[axis];
+            chunk.boundsMax[axis] = chunk.boundsMin[axis];
+        }
+        for (uint32_t v = chunk.firstVertex; v < chunk.firstVertex + chunk.vertexCount; v++) {
+            for (int axis = 0; axis < 3; axis++) {
+                chunk.boundsMin[axis] = std::min(chunk.boundsMin[axis], vertices[v].position[axis]);
+                chunk.boundsMax[axis] = std::max(chunk.boundsMax[axis], vertices[v].position[axis]);
+            }
+        }
+        mTerrainChunks.push_back(chunk);
+    }
+
+    VkDeviceSize size = vertices.size() * sizeof(ColorVertex);
+    VkDeviceSize offset = WriteRing(frame, vertices.data(), size);
+
+    if (offset != kRingFull &&
+        CreateBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mTerrainBuffer, mTerrainMemory)) {
+        // Copy from the staging ring into device-local memory before the pass
+        VkBufferCopy region = { offset, 0, size };
+        vkCmdCopyBuffer(frame.commandBuffer, frame.ringBuffer, mTerrainBuffer, 1, &region);
+
+        VkBufferMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = mTerrainBuffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(frame.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+        return;
+    }
+
+    // Too large for the staging ring: keep the terrain in host-visible memory
+    if (!CreateBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                      mTerrainBuffer, mTerrainMemory)) {
+        mTerrainChunks.clear();
+        return;
+    }
+
+    void* mapped = nullptr;
+    if (vkMapMemory(mDevice, mTerrainMemory, 0, size, 0, &mapped) == VK_SUCCESS) {
+        std::memcpy(mapped, vertices.data(), static_cast<size_t>(size));
+        vkUnmapMemory(mDevice, mTerrainMemory);
+    }
+}
+
+void RendererVulkan::UploadMinimap(FrameResources& frame) {
+    const TerrainOverview* overview = mMinimapSource;
+    int width = overview->GetWidth();
+    int height = overview->GetHeight();
+
+    // (Re)create the image when the size changes
+    if (!mMinimapImage || width != mMinimapWidth || height != mMinimapHeight) {
+        vkDeviceWaitIdle(mDevice);
+        if (mMinimapView) vkDestroyImageView(mDevice, mMinimapView, nullptr);
+        if (mMinimapImage) vkDestroyImage(mDevice, mMinimapImage, nullptr);
+        if (mMinimapMemory) vkFreeMemory(mDevice, mMinimapMemory, nullptr);
+        mMinimapView = VK_NULL_HANDLE;
+        mMinimapImage = VK_NULL_HANDLE;
+        mMinimapMemory = VK_NULL_HANDLE;
+        mMinimapLayoutReady = false;
+
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+        imageInfo.extent.width = static_cast<uint32_t>(width);
+        imageInfo.extent.height = static_cast<uint32_t>(height);
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(mDevice, &imageInfo, nullptr, &mMinimapImage) != VK_SUCCESS) {
+            mMinimapImage = VK_NULL_HANDLE;
+            return;
+        }
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(mDevice, mMinimapImage, &requirements);
+
+        VkMemoryAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = requirements.size;
+        allocInfo.memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &mMinimapMemory) != VK_SUCCESS) {
+            vkDestroyImage(mDevice, mMinimapImage, nullptr);
+            mMinimapImage = VK_NULL_HANDLE;
+            mMinimapMemory = VK_NULL_HANDLE;
+            return;
+        }
+        vkBindImageMemory(mDevice, mMinimapImage, mMinimapMemory, 0);
+
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = mMinimapImage;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.layerCount = 1;
+        vkCreateImageView(mDevice, &viewInfo, nullptr, &mMinimapView);
+
+        VkDescriptorImageInfo descriptorImage = {};
+        descriptorImage.sampler = mMinimapSampler;
+        descriptorImage.imageView = mMinimapView;
+        descriptorImage.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkWriteDescriptorSet write = {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = mMinimapSet;
+        write.dstBinding = 0;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &descriptorImage;
+        vkUpdateDescriptorSets(mDevice, 1, &write, 0, nullptr);
+
+        mMinimapWidth = width;
+        mMinimapHeight = height;
+    }
+
+    const std::vector<uint8_t>& pixels = overview->GetPixels();
+    VkDeviceSize offset = WriteRing(frame, pixels.data(), pixels.size());
+    if (offset == kRingFull) {
+        return;
+    }
+
+    // Earlier frames may still sample the old contents: the barrier orders the
+    // copy after them on the queue
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = mMinimapLayoutReady ? VK_ACCESS_SHADER_READ_BIT : 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = mMinimapLayoutReady ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = mMinimapImage;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(frame.commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = offset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent.width = static_cast<uint32_t>(width);
+    region.imageExtent.height = static_cast<uint32_t>(height);
+    region.imageExtent.depth = 1;
+    vkCmdCopyBufferToImage(frame.commandBuffer, frame.ringBuffer, mMinimapImage,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    vkCmdPipelineBarrier(frame.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    mMinimapLayoutReady = true;
+    mMinimapGeneration = overview->GetGeneration();
+}
+
+void RendererVulkan::CullTerrainChunks() {
+    mVisibleChunks.clear();
+    if (!mDrawTerrain || !mTerrainBuffer) {
+        return;
+    }
+
+    // A chunk is hidden when its box is entirely behind one frustum plane
+    for (uint32_t i = 0; i < mTerrainChunks.size(); i++) {
+        const TerrainChunk& chunk = mTerrainChunks[i];
+        bool visible = true;
+        for (int p = 0; p < 6 && visible; p++) {
+            const float* plane = mFrustum[p];
+            float distance = plane[3];
+            for (int axis = 0; axis < 3; axis++) {
+                distance += plane[axis] * (plane[axis] >= 0.0f ? chunk.boundsMax[axis] : chunk.boundsMin[axis]);
+            }
+            visible = distance >= 0.0f;
+        }
+
+        if (visible) {
+            mVisibleChunks.push_back(i);
+        }
+    }
+}
+
+void RendererVulkan::BuildRecordTasks() {
+    mRecordTasks.clear();
+
+    // Spread the visible terrain chunks over several tasks
+    uint32_t chunkCount = static_cast<uint32_t>(mVisibleChunks.size());
+    if (chunkCount > 0) {
+        uint32_t taskCount = std::min<uint32_t>(kMaxTerrainTasks, chunkCount);
+        uint32_t perTask = (chunkCount + taskCount - 1) / taskCount;
+        for (uint32_t first = 0; first < chunkCount; first += perTask) {
+            RecordTask task = { RecordPass::TERRAIN, first, std::min(perTask, chunkCount - first), VK_NULL_HANDLE };
+            mRecordTasks.push_back(task);
+        }
+    }
+
+    RecordTask objects = { RecordPass::OBJECTS, 0, 0, VK_NULL_HANDLE };
+    RecordTask hud = { RecordPass::HUD, 0, 0, VK_NULL_HANDLE };
+    mRecordTasks.push_back(objects);
+    mRecordTasks.push_back(hud);
+}
+
+void RendererVulkan::RecordInParallel(int frameIndex) {
+    // Wake the workers and wait until every task is recorded
+    std::unique_lock<std::mutex> lock(mRecordMutex);
+    mRecordFrame = frameIndex;
+    mRecordPending = static_cast<int>(mRecordThreads.size());
+    mRecordGeneration++;
+    mRecordStart.notify_all();
+    mRecordDone.wait(lock, [this]() { return mRecordPending == 0; });
+}
+
+void RendererVulkan::RecordWorker(int threadIndex) {
+    uint64_t seenGeneration = 0;
+
+    for (;;) {
+        int frameIndex = 0;
+        {
+            std::unique_lock<std::mutex> lock(mRecordMutex);
+            mRecordStart.wait(lock, [&]() { return mRecordStop || mRecordGeneration != seenGeneration; });
+            if (mRecordStop) {
+                return;
+            }
+            seenGeneration = mRecordGeneration;
+            frameIndex = mRecordFrame;
+        }
+
+        // Tasks are dealt out round-robin; each thread records into
+        // secondary buffers from its own command pool
+        FrameResources& frame = mFrames[frameIndex];
+        int slot = 0;
+        int threadCount = static_cast<int>(mRecordThreads.size());
+        for (size_t task = threadIndex; task < mRecordTasks.size(); task += threadCount) {
+            VkCommandBuffer commandBuffer = frame.workerCommandBuffers[threadIndex][slot++];
+            RecordTaskCommands(mRecordTasks[task], commandBuffer);
+            mRecordTasks[task].commandBuffer = commandBuffer;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mRecordMutex);
+            if (--mRecordPending == 0) {
+                mRecordDone.notify_one();
+            }
+        }
+    }
+}
+
+void RendererVulkan::SetViewportAndScissor(VkCommandBuffer commandBuffer) const {
+    VkViewport viewport = {};
+    viewport.width = static_cast<float>(mSwapchainExtent.width);
+    viewport.height = static_cast<float>(mSwapchainExtent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor = {};
+    scissor.extent = mSwapchainExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void RendererVulkan::RecordTaskCommands(const RecordTask& task, VkCommandBuffer commandBuffer) {
+    const FrameResources& frame = mFrames[mRecordFrame];
+
+    VkCommandBufferInheritanceInfo inheritance = {};
+    inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.renderPass = mRenderPass;
+    inheritance.subpass = 0;
+    inheritance.framebuffer = mFramebuffers[mImageIndex];
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+                      VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritance;
+
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    SetViewportAndScissor(commandBuffer);
+
+    // Draw a run of vertices straight from this frame's ring
+    auto drawRing = [&](VkPipeline pipeline, const float* matrix, VkDeviceSize offset, size_t vertexCount) {
+        if (vertexCount == 0 || offset == kRingFull) {
+            return;
+        }
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdPushConstants(commandBuffer, mColorLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 16, matrix);
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &frame.ringBuffer, &offset);
+        vkCmdDraw(commandBuffer, static_cast<uint32_t>(vertexCount), 1, 0, 0);
+    };
+
+    switch (task.pass) {
+        case RecordPass::TERRAIN: {
+            VkDeviceSize offset = 0;
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mTrianglePipeline);
+            vkCmdPushConstants(commandBuffer, mColorLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                               sizeof(float) * 16, mViewProjection);
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mTerrainBuffer, &offset);
+            for (uint32_t i = task.firstChunk; i < task.firstChunk + task.chunkCount; i++) {
+                const TerrainChunk& chunk = mTerrainChunks[mVisibleChunks[i]];
+                vkCmdDraw(commandBuffer, chunk.vertexCount, 1, chunk.firstVertex, 0);
+            }
+            break;
+        }
+
+        case RecordPass::OBJECTS:
+            // All landers in one instanced draw of the shared cube
+            if (!mLanderInstances.empty() && mGeometry.landerVertices != kRingFull &&
+                mGeometry.landerInstances != kRingFull) {
+                VkBuffer buffers[2] = { frame.ringBuffer, frame.ringBuffer };
+                VkDeviceSize offsets[2] = { mGeometry.landerVertices, mGeometry.landerInstances };
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mLanderPipeline);
+                vkCmdPushConstants(commandBuffer, mColorLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                                   sizeof(float) * 16, mViewProjection);
+                vkCmdBindVertexBuffers(commandBuffer, 0, 2, buffers, offsets);
+                vkCmdDraw(commandBuffer, static_cast<uint32_t>(mLanderMesh.size()),
+                          static_cast<uint32_t>(mLanderInstances.size()), 0, 0);
+            }
+
+            drawRing(mTrianglePipeline, mViewProjection, mGeometry.sceneTriangles, mSceneTriangles.size());
+            drawRing(mLinePipeline, mViewProjection, mGeometry.sceneLines, mSceneLines.size());
+            break;
+
+        case RecordPass::HUD:
+            drawRing(mHudPipeline, mHudProjection, mGeometry.hudTriangles, mHudTriangles.size());
+
+            if (mDrawMinimap && mMinimapLayoutReady && mGeometry.minimapQuad != kRingFull) {
+                VkDeviceSize offset = mGeometry.minimapQuad;
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mMinimapPipeline);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mTexturedLayout,
+                                        0, 1, &mMinimapSet, 0, nullptr);
+                vkCmdPushConstants(commandBuffer, mTexturedLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                                   sizeof(float) * 16, mHudProjection);
+                vkCmdBindVertexBuffers(commandBuffer, 0, 1, &frame.ringBuffer, &offset);
+                vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+            }
+
+            drawRing(mHudPipeline, mHudProjection, mGeometry.overlayTriangles, mOverlayTriangles.size());
+            break;
+    }
+
+    vkEndCommandBuffer(commandBuffer);
+}
+
+void RendererVulkan::Present() {
+    if (!mInitialized) return;
+
+    // The swapchain is gone while the window has no area
+    if (!mSwapchain && !RecreateSwapchain()) return;
+
+    FrameResources& frame = mFrames[mFrameIndex];
+
+    // Wait until this frame's previous use is finished before reusing its ring and pools
+    vkWaitForFences(mDevice, 1, &frame.inFlight, VK_TRUE, UINT64_MAX);
+
+    VkResult result = vkAcquireNextImageKHR(mDevice, mSwapchain, UINT64_MAX, frame.imageAvailable,
+                                            VK_NULL_HANDLE, &mImageIndex);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+        RecreateSwapchain();
+        return;
+    }
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+        std::cerr << "Vulkan image acquisition failed!" << std::endl;
+        return;
+    }
+
+    vkResetFences(mDevice, 1, &frame.inFlight);
+    vkResetCommandPool(mDevice, frame.commandPool, 0);
+    for (VkCommandPool pool : frame.workerPools) {
+        vkResetCommandPool(mDevice, pool, 0);
+    }
+    frame.ringOffset = 0;
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(frame.commandBuffer, &beginInfo);
+
+    // Uploads go before the render pass
+    if (mDrawTerrain && mTerrainSource &&
+        (!mTerrainBuffer || mTerrainGeneration != mTerrainSource->GetGeneration())) {
+        UploadTerrain(frame, mTerrainSource);
+    }
+    if (mDrawMinimap && (!mMinimapLayoutReady || mMinimapGeneration != mMinimapSource->GetGeneration())) {
+        UploadMinimap(frame);
+    }
+
+    // This frame's geometry into the staging ring
+    mGeometry.landerVertices = WriteRing(frame, mLanderMesh.data(), mLanderMesh.size() * sizeof(ColorVertex));
+    mGeometry.landerInstances = WriteRing(frame, mLanderInstances.data(), mLanderInstances.size() * sizeof(LanderInstance));
+    mGeometry.sceneTriangles = WriteRing(frame, mSceneTriangles.data(), mSceneTriangles.size() * sizeof(ColorVertex));
+    mGeometry.sceneLines = WriteRing(frame, mSceneLines.data(), mSceneLines.size() * sizeof(ColorVertex));
+    mGeometry.hudTriangles = WriteRing(frame, mHudTriangles.data(), mHudTriangles.size() * sizeof(ColorVertex));
+    mGeometry.overlayTriangles = WriteRing(frame, mOverlayTriangles.data(), mOverlayTriangles.size() * sizeof(ColorVertex));
+
+    const float left = mMinimapRect[0];
+    const float top = mMinimapRect[1];
+    const float right = left + mMinimapRect[2];
+    const float bottom = top + mMinimapRect[3];
+    const TexturedVertex quad[6] = {
+        { { left, top }, { 0.0f, 0.0f } }, { { right, top }, { 1.0f, 0.0f } }, { { right, bottom }, { 1.0f, 1.0f } },
+        { { left, top }, { 0.0f, 0.0f } }, { { right, bottom }, { 1.0f, 1.0f } }, { { left, bottom }, { 0.0f, 1.0f } }
+    };
+    mGeometry.minimapQuad = WriteRing(frame, quad, sizeof(quad));
+
+    // Record the passes in parallel
+    CullTerrainChunks();
+    BuildRecordTasks();
+    RecordInParallel(mFrameIndex);
+
+    VkClearValue clearValues[2] = {};
+    clearValues[0].color.float32[0] = 0.0f;
+    clearValues[0].color.float32[1] = 0.0f;
+    clearValues[0].color.float32[2] = 0.1f;
+    clearValues[0].color.float32[3] = 1.0f;
+    clearValues[1].depthStencil.depth = 1.0f;
+
+    VkRenderPassBeginInfo passInfo = {};
+    passInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    passInfo.renderPass = mRenderPass;
+    passInfo.framebuffer = mFramebuffers[mImageIndex];
+    passInfo.renderArea.extent = mSwapchainExtent;
+    passInfo.clearValueCount = 2;
+    passInfo.pClearValues = clearValues;
+
+    std::vector<VkCommandBuffer> secondaries;
+    for (const RecordTask& task : mRecordTasks) {
+        secondaries.push_back(task.commandBuffer);
+    }
+
+    vkCmdBeginRenderPass(frame.commandBuffer, &passInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(frame.commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+    vkCmdEndRenderPass(frame.commandBuffer);
+    vkEndCommandBuffer(frame.commandBuffer);
+
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &frame.imageAvailable;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &frame.commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &mRenderFinished[mImageIndex];
+
+    if (vkQueueSubmit(mQueue, 1, &submitInfo, frame.inFlight) != VK_SUCCESS) {
+        std::cerr << "Vulkan queue submission failed!" << std::endl;
+        return;
+    }
+
+    VkPresentInfoKHR presentInfo = {};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &mRenderFinished[mImageIndex];
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &mSwapchain;
+    presentInfo.pImageIndices = &mImageIndex;
+
+    result = vkQueuePresentKHR(mQueue, &presentInfo);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+        RecreateSwapchain();
+    }
+
+    mFrameIndex = (mFrameIndex + 1) % kFramesInFlight;
+}
+
+void RendererVulkan::SetCameraPosition(float x, float y, float z) {
+    mCameraPosition[0] = x;
+    mCameraPosition[1] = y;
+    mCameraPosition[2] = z;
+}
+
+void RendererVulkan::SetCameraTarget(float x, float y, float z) {
+    mCameraTarget[0] = x;
+    mCameraTarget[1] = y;
+    mCameraTarget[2] = z;
+}
+
+void RendererVulkan::SetCameraUp(float x, float y, float z) {
+    mCameraUp[0] = x;
+    mCameraUp[1] = y;
+    mCameraUp[2] = z;
+}
+
+void RendererVulkan::SetLightPosition(float x, float y, float z) {
+    mLightPosition[0] = x;
+    mLightPosition[1] = y;
+    mLightPosition[2] = z;
+}
+
+void RendererVulkan::SetAmbientLight(float r, float g, float b) {
+    mAmbientLight[0] = r;
+    mAmbientLight[1] = g;
+    mAmbientLight[2] = b;
+}
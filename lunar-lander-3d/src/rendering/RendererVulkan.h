@@ -0,0 +1,270 @@
+// RendererVulkan.h
+// 3D rendering implementation using Vulkan and SDL2
+
+#pragma once
+
+#include "Renderer.h"
+#include <SDL2/SDL.h>
+#include <vulkan/vulkan.h>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Vulkan backend for the 3D view. Draw calls made during a frame only collect
+// geometry; Present() writes it into a persistently mapped staging ring and
+// records the passes (terrain chunks, instanced landers and other scene
+// objects, HUD) into secondary command buffers on worker threads, which the
+// primary command buffer then executes. Compiled pipelines are kept in a
+// pipeline cache saved between runs.
+class RendererVulkan : public Renderer {
+public:
+    RendererVulkan();
+    virtual ~RendererVulkan();
+
+    // Implement Renderer interface
+    bool Initialize(int width, int height, const std::string& title) override;
+    void Shutdown() override;
+    void Clear() override;
+    void Present() override;
+
+    void RenderLander(Lander* lander) override;
+    void RenderTerrain(Terrain* terrain) override;
+    void RenderTrajectory(const TrajectoryPredictor* trajectory) override;
+
+    void RenderTelemetry(Game* game) override;
+    void RenderGameState(Game* game) override;
+    void RenderMinimap(const TerrainOverview* overview, const Lander* lander) override;
+
+    int GetWidth() const override { return mWidth; }
+    int GetHeight() const override { return mHeight; }
+    bool IsInitialized() const override { return mInitialized; }
+
+    // 2D camera (not used by the 3D renderer)
+    void SetCamera2D(float centerX, float centerY, float zoom) override {}
+
+    // Single view (the landing camera inset is only available with OpenGL)
+    int GetViewCount() const override { return 1; }
+    void BeginView(int index) override {}
+    void EndView(int index) override {}
+    void SetLandingCamera(bool enabled, float x, float y, float z) override {}
+
+    // 3D camera methods
+    void SetCameraPosition(float x, float y, float z) override;
+    void SetCameraTarget(float x, float y, float z) override;
+    void SetCameraUp(float x, float y, float z) override;
+
+    // 3D lighting methods
+    void SetLightPosition(float x, float y, float z) override;
+    void SetAmbientLight(float r, float g, float b) override;
+
+    // Clustered dynamic lights are only shaded by the OpenGL renderer so far
+    void SetLights(const std::vector<Light>& lights) override {}
+
+private:
+    static const int kFramesInFlight = 2;
+    static const int kMaxRecordThreads = 4;
+    static const int kTerrainChunkCount = 16;
+    static const int kMaxTerrainTasks = 8;
+    static const int kMaxRecordTasks = kMaxTerrainTasks + 2;
+    static const VkDeviceSize kStagingRingSize = 8 * 1024 * 1024;
+
+    // Vertex formats (must match the shaders in assets/shaders/vulkan)
+    struct ColorVertex {
+        float position[3];
+        float color[4];
+    };
+
+    struct TexturedVertex {
+        float position[2];
+        float uv[2];
+    };
+
+    struct LanderInstance {
+        float model[16];
+        float color[4];
+    };
+
+    // A range of terrain vertices with its bounding box
+    struct TerrainChunk {
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    // One secondary command buffer's worth of work
+    enum class RecordPass { TERRAIN, OBJECTS, HUD };
+    struct RecordTask {
+        RecordPass pass;
+        uint32_t firstChunk;   // Into mVisibleChunks (terrain tasks only)
+        uint32_t chunkCount;
+        VkCommandBuffer commandBuffer;
+    };
+
+    // Per frame-in-flight resources
+    struct FrameResources {
+        VkCommandPool commandPool;
+        VkCommandBuffer commandBuffer;
+        VkCommandPool workerPools[kMaxRecordThreads];
+        VkCommandBuffer workerCommandBuffers[kMaxRecordThreads][kMaxRecordTasks];
+        VkSemaphore imageAvailable;
+        VkFence inFlight;
+
+        // Persistently mapped ring for this frame's dynamic vertices and uploads
+        VkBuffer ringBuffer;
+        VkDeviceMemory ringMemory;
+        uint8_t* ringData;
+        VkDeviceSize ringOffset;
+    };
+
+    // Offsets of this frame's geometry in the ring
+    struct FrameGeometry {
+        VkDeviceSize sceneTriangles;
+        VkDeviceSize sceneLines;
+        VkDeviceSize landerVertices;
+        VkDeviceSize landerInstances;
+        VkDeviceSize hudTriangles;
+        VkDeviceSize overlayTriangles;
+        VkDeviceSize minimapQuad;
+    };
+
+    // Setup
+    bool CreateInstance();
+    bool PickPhysicalDevice();
+    bool CreateDevice();
+    bool CreateSwapchain();
+    void DestroySwapchain();
+    bool RecreateSwapchain();
+    bool CreateRenderPass();
+    bool CreateFramebuffers();
+    bool CreatePipelines();
+    bool CreateFrameResources();
+    bool CreateMinimapResources();
+    void LoadPipelineCache();
+    void SavePipelineCache();
+    VkShaderModule LoadShaderModule(const char* name);
+
+    // Resource helpers
+    uint32_t FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) const;
+    bool CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                      VkBuffer& buffer, VkDeviceMemory& memory);
+    VkDeviceSize WriteRing(FrameResources& frame, const void* data, VkDeviceSize size);
+    void UploadTerrain(FrameResources& frame, const Terrain* terrain);
+    void UploadMinimap(FrameResources& frame);
+
+    // Per-frame work
+    void CullTerrainChunks();
+    void BuildRecordTasks();
+    void RecordInParallel(int frameIndex);
+    void RecordWorker(int threadIndex);
+    void RecordTaskCommands(const RecordTask& task, VkCommandBuffer commandBuffer);
+    void SetViewportAndScissor(VkCommandBuffer commandBuffer) const;
+
+    // Geometry helpers
+    void AddHudQuad(std::vector<ColorVertex>& vertices, float x, float y, float width, float height,
+                    float r, float g, float b, float a = 1.0f);
+    void UpdateMatrices();
+
+    // SDL and Vulkan objects
+    SDL_Window* mWindow;
+    VkInstance mInstance;
+    VkSurfaceKHR mSurface;
+    VkPhysicalDevice mPhysicalDevice;
+    VkPhysicalDeviceProperties mDeviceProperties;
+    VkDevice mDevice;
+    VkQueue mQueue;
+    uint32_t mQueueFamily;
+
+    // Swapchain
+    VkSwapchainKHR mSwapchain;
+    VkFormat mSwapchainFormat;
+    VkExtent2D mSwapchainExtent;
+    std::vector<VkImage> mSwapchainImages;
+    std::vector<VkImageView> mSwapchainViews;
+    std::vector<VkFramebuffer> mFramebuffers;
+    std::vector<VkSemaphore> mRenderFinished;  // One per swapchain image
+    VkFormat mDepthFormat;
+    VkImage mDepthImage;
+    VkDeviceMemory mDepthMemory;
+    VkImageView mDepthView;
+    VkRenderPass mRenderPass;
+
+    // Pipelines
+    VkPipelineCache mPipelineCache;
+    std::string mPipelineCachePath;
+    VkPipelineLayout mColorLayout;
+    VkPipelineLayout mTexturedLayout;
+    VkDescriptorSetLayout mTextureSetLayout;
+    VkPipeline mTrianglePipeline;
+    VkPipeline mLinePipeline;
+    VkPipeline mLanderPipeline;
+    VkPipeline mHudPipeline;
+    VkPipeline mMinimapPipeline;
+
+    // Frames
+    FrameResources mFrames[kFramesInFlight];
+    int mFrameIndex;
+    uint32_t mImageIndex;
+
+    // Terrain in device-local memory, uploaded once per terrain generation
+    VkBuffer mTerrainBuffer;
+    VkDeviceMemory mTerrainMemory;
+    const Terrain* mTerrainSource;
+    unsigned int mTerrainGeneration;
+    std::vector<TerrainChunk> mTerrainChunks;
+    std::vector<uint32_t> mVisibleChunks;
+    bool mDrawTerrain;
+
+    // Minimap texture
+    VkImage mMinimapImage;
+    VkDeviceMemory mMinimapMemory;
+    VkImageView mMinimapView;
+    VkSampler mMinimapSampler;
+    VkDescriptorPool mDescriptorPool;
+    VkDescriptorSet mMinimapSet;
+    int mMinimapWidth;
+    int mMinimapHeight;
+    unsigned int mMinimapGeneration;
+    const TerrainOverview* mMinimapSource;
+    bool mDrawMinimap;
+    bool mMinimapLayoutReady;
+    float mMinimapRect[4];
+
+    // Geometry collected during the frame
+    std::vector<ColorVertex> mSceneTriangles;
+    std::vector<ColorVertex> mSceneLines;
+    std::vector<LanderInstance> mLanderInstances;
+    std::vector<ColorVertex> mHudTriangles;
+    std::vector<ColorVertex> mOverlayTriangles;
+    std::vector<ColorVertex> mLanderMesh;
+    FrameGeometry mGeometry;
+
+    // Parallel command recording
+    std::vector<std::thread> mRecordThreads;
+    std::vector<RecordTask> mRecordTasks;
+    std::mutex mRecordMutex;
+    std::condition_variable mRecordStart;
+    std::condition_variable mRecordDone;
+    uint64_t mRecordGeneration;
+    int mRecordPending;
+    int mRecordFrame;
+    bool mRecordStop;
+
+    // Renderer properties
+    int mWidth;
+    int mHeight;
+    bool mInitialized;
+
+    // Camera, light and matrices (column-major, Vulkan clip space)
+    float mCameraPosition[3];
+    float mCameraTarget[3];
+    float mCameraUp[3];
+    float mLightPosition[3];
+    float mAmbientLight[3];
+    float mViewProjection[16];
+    float mHudProjection[16];
+    float mFrustum[6][4];
+};
@@ -0,0 +1,331 @@
+// ShaderCache.cpp
+// Implementation of the OpenGL program binary cache
+
+#include "ShaderCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Header written in front of every cached program binary
+struct ProgramBinaryHeader {
+    char magic[4];     // "LLPB"
+    uint32_t version;
+    uint64_t key;      // ComputeKey() of the sources and driver
+    uint32_t format;   // Driver-specific binary format
+    uint32_t length;   // Bytes of binary data that follow
+};
+
+static const char kBinaryMagic[4] = { 'L', 'L', 'P', 'B' };
+static const uint32_t kBinaryVersion = 1;
+
+// FNV-1a, continued from a previous hash
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t HashString(uint64_t hash, const std::string& text) {
+    // Include the terminator so "ab"+"c" and "a"+"bc" differ
+    return HashBytes(hash, text.c_str(), text.size() + 1);
+}
+
+ShaderCache::ShaderCache()
+    : mBinariesSupported(false)
+    , mWindow(nullptr)
+    , mWorkerContext(nullptr)
+    , mPrecompiling(false)
+{
+}
+
+ShaderCache::~ShaderCache() {
+    Shutdown();
+}
+
+bool ShaderCache::Initialize(SDL_Window* window, SDL_GLContext context, const std::string& directory) {
+    mWindow = window;
+    mDirectory = directory;
+
+    if (!mGL.Load()) {
+        std::cerr << "OpenGL shader functions unavailable!" << std::endl;
+        return false;
+    }
+    mBinariesSupported = mGL.HasProgramBinary();
+
+    // Binaries are only valid for the driver that produced them
+    const GLubyte* vendor = glGetString(GL_VENDOR);
+    const GLubyte* renderer = glGetString(GL_RENDERER);
+    const GLubyte* version = glGetString(GL_VERSION);
+    mDriver.clear();
+    for (const GLubyte* text : { vendor, renderer, version }) {
+        mDriver += text ? reinterpret_cast<const char*>(text) : "";
+        mDriver += '\n';
+    }
+
+    if (!mBinariesSupported) {
+        std::cout << "OpenGL program binaries unsupported; shaders are compiled at every start" << std::endl;
+        return true;
+    }
+
+    // Context for the precompile thread, sharing programs with the main one
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    mWorkerContext = SDL_GL_CreateContext(window);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    SDL_GL_MakeCurrent(window, context);
+
+    if (!mWorkerContext) {
+        std::cerr << "Shared OpenGL context creation failed, no background shader compilation: "
+                  << SDL_GetError() << std::endl;
+    }
+
+    return true;
+}
+
+void ShaderCache::Shutdown() {
+    WaitForWorker();
+
+    if (mWorkerContext) {
+        SDL_GL_DeleteContext(mWorkerContext);
+        mWorkerContext = nullptr;
+    }
+}
+
+void ShaderCache::WaitForWorker() {
+    if (mWorker.joinable()) {
+        mWorker.join();
+    }
+}
+
+uint64_t ShaderCache::ComputeKey(const ShaderVariant& variant, const std::string& vertexSource,
+                                 const std::string& fragmentSource) const {
+    uint64_t hash = 14695981039346656037ull;
+    hash = HashString(hash, mDriver);
+    hash = HashString(hash, vertexSource);
+    hash = HashString(hash, fragmentSource);
+    for (const auto& define : variant.defines) {
+        hash = HashString(hash, define);
+    }
+    return hash;
+}
+
+std::string ShaderCache::GetCachePath(const ShaderVariant& variant) const {
+    return mDirectory + "shader_" + variant.name + ".bin";
+}
+
+GLuint ShaderCache::GetProgram(const ShaderVariant& variant, const char* vertexSource, const char* fragmentSource) {
+    std::string vertex(vertexSource);
+    std::string fragment(fragmentSource);
+    uint64_t key = ComputeKey(variant, vertex, fragment);
+    std::string path = GetCachePath(variant);
+
+    if (mBinariesSupported) {
+        GLuint program = LoadBinary(path, key);
+        if (program) {
+            return program;
+        }
+    }
+
+    GLuint program = CompileProgram(variant, vertex, fragment);
+    if (program && mBinariesSupported) {
+        SaveBinary(program, path, key);
+    }
+
+    return program;
+}
+
+void ShaderCache::Precompile(const std::vector<ShaderVariant>& variants, const char* vertexSource,
+                             const char* fragmentSource) {
+    // Without binaries there is nothing to keep for later
+    WaitForWorker();
+    if (!mWorkerContext) {
+        return;
+    }
+
+    mPrecompiling.store(true, std::memory_order_release);
+    std::string vertex(vertexSource);
+    std::string fragment(fragmentSource);
+
+    mWorker = std::thread([this, variants, vertex, fragment]() {
+        if (SDL_GL_MakeCurrent(mWindow, mWorkerContext) == 0) {
+            for (const auto& variant : variants) {
+                uint64_t key = ComputeKey(variant, vertex, fragment);
+                std::string path = GetCachePath(variant);
+                if (HasBinary(path, key)) {
+                    continue;
+                }
+
+                GLuint program = CompileProgram(variant, vertex, fragment);
+                if (program) {
+                    SaveBinary(program, path, key);
+                    mGL.DeleteProgram(program);
+                }
+            }
+
+            glFinish();
+            SDL_GL_MakeCurrent(mWindow, nullptr);
+        }
+
+        mPrecompiling.store(false, std::memory_order_release);
+    });
+}
+
+bool ShaderCache::HasBinary(const std::string& path, uint64_t key) const {
+    std::lock_guard<std::mutex> lock(mFileMutex);
+
+    std::ifstream file(path, std::ios::binary);
+    ProgramBinaryHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+
+    return std::memcmp(header.magic, kBinaryMagic, sizeof(kBinaryMagic)) == 0 &&
+           header.version == kBinaryVersion && header.key == key;
+}
+
+GLuint ShaderCache::LoadBinary(const std::string& path, uint64_t key) const {
+    ProgramBinaryHeader header;
+    std::vector<char> data;
+    {
+        std::lock_guard<std::mutex> lock(mFileMutex);
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            return 0;
+        }
+        if (std::memcmp(header.magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0 ||
+            header.version != kBinaryVersion || header.key != key) {
+            return 0;  // Stale: sources or driver changed
+        }
+
+        data.resize(header.length);
+        if (!file.read(data.data(), header.length)) {
+            return 0;
+        }
+    }
+
+    GLuint program = mGL.CreateProgram();
+    mGL.ProgramBinary(program, header.format, data.data(), static_cast<GLsizei>(header.length));
+
+    // The driver may still reject a binary it produced (e.g. after an update)
+    GLint linked = GL_FALSE;
+    mGL.GetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        mGL.DeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+bool ShaderCache::SaveBinary(GLuint program, const std::string& path, uint64_t key) const {
+    GLint length = 0;
+    mGL.GetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return false;
+    }
+
+    std::vector<char> data(static_cast<size_t>(length));
+    GLsizei written = 0;
+    GLenum format = 0;
+    mGL.GetProgramBinary(program, length, &written, &format, data.data());
+    if (written <= 0) {
+        return false;
+    }
+
+    ProgramBinaryHeader header;
+    std::memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+    header.version = kBinaryVersion;
+    header.key = key;
+    header.format = format;
+    header.length = static_cast<uint32_t>(written);
+
+    // Write to a temporary file and rename, so readers never see half a file
+    std::lock_guard<std::mutex> lock(mFileMutex);
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+            !file.write(data.data(), written)) {
+            std::cerr << "Failed to write shader cache: " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+
+    std::remove(path.c_str());
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+GLuint ShaderCache::CompileShader(GLenum type, const std::string& source, const std::vector<std::string>& defines) const {
+    // Defines go right after the #version line, which must stay first
+    std::string text = source;
+    std::string defineBlock;
+    for (const auto& define : defines) {
+        defineBlock += "#define " + define + "\n";
+    }
+
+    size_t version = text.find("#version");
+    size_t insertAt = (version == std::string::npos) ? 0 : text.find('\n', version);
+    insertAt = (insertAt == std::string::npos) ? text.size() : insertAt + 1;
+    text.insert(insertAt, defineBlock);
+
+    GLuint shader = mGL.CreateShader(type);
+    const char* textPointer = text.c_str();
+    mGL.ShaderSource(shader, 1, &textPointer, nullptr);
+    mGL.CompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    mGL.GetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        GLint logLength = 0;
+        mGL.GetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> log(static_cast<size_t>(std::max(logLength, 1)));
+        mGL.GetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::cerr << "Shader compilation failed: " << log.data() << std::endl;
+        mGL.DeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+GLuint ShaderCache::CompileProgram(const ShaderVariant& variant, const std::string& vertexSource,
+                                   const std::string& fragmentSource) const {
+    GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, vertexSource, variant.defines);
+    GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentSource, variant.defines);
+    if (!vertexShader || !fragmentShader) {
+        if (vertexShader) mGL.DeleteShader(vertexShader);
+        if (fragmentShader) mGL.DeleteShader(fragmentShader);
+        return 0;
+    }
+
+    GLuint program = mGL.CreateProgram();
+    if (mBinariesSupported) {
+        mGL.ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    mGL.AttachShader(program, vertexShader);
+    mGL.AttachShader(program, fragmentShader);
+    mGL.LinkProgram(program);
+    mGL.DetachShader(program, vertexShader);
+    mGL.DetachShader(program, fragmentShader);
+    mGL.DeleteShader(vertexShader);
+    mGL.DeleteShader(fragmentShader);
+
+    GLint linked = GL_FALSE;
+    mGL.GetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        GLint logLength = 0;
+        mGL.GetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> log(static_cast<size_t>(std::max(logLength, 1)));
+        mGL.GetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::cerr << "Shader program '" << variant.name << "' failed to link: " << log.data() << std::endl;
+        mGL.DeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
@@ -0,0 +1,77 @@
+// ShaderCache.h
+// On-disk cache of linked OpenGL programs, with background precompilation
+
+#pragma once
+
+#include "GLFunctions.h"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One compiled form of a shader pair: the sources with a set of #defines
+struct ShaderVariant {
+    std::string name;                  // Used in the cache file name
+    std::vector<std::string> defines;  // Inserted after the #version line
+};
+
+// Saves linked programs with glGetProgramBinary and restores them with
+// glProgramBinary, so warm starts skip compiling and linking. Each entry is
+// keyed by a hash of the sources, the defines and the driver's vendor,
+// renderer and version strings; a driver update simply misses the cache (and
+// a rejected binary falls back to compiling). Precompile() builds variants
+// on a worker thread with its own context sharing objects with the main one,
+// writing them to disk for later GetProgram() calls.
+class ShaderCache {
+public:
+    ShaderCache();
+    ~ShaderCache();
+
+    // Call with the main context current. Creates the worker's shared context.
+    bool Initialize(SDL_Window* window, SDL_GLContext context, const std::string& directory);
+    void Shutdown();
+
+    // Program for a variant: from the cache when possible, otherwise compiled
+    // (and saved). Main thread only. Returns 0 on failure.
+    GLuint GetProgram(const ShaderVariant& variant, const char* vertexSource, const char* fragmentSource);
+
+    // Compile and save variants in the background (skips those already cached)
+    void Precompile(const std::vector<ShaderVariant>& variants, const char* vertexSource, const char* fragmentSource);
+    bool IsPrecompiling() const { return mPrecompiling.load(std::memory_order_acquire); }
+
+    // Functions loaded for the main context
+    const GLFunctions& GetFunctions() const { return mGL; }
+
+private:
+    // Cache file of a variant, and the hash that identifies its contents
+    uint64_t ComputeKey(const ShaderVariant& variant, const std::string& vertexSource,
+                        const std::string& fragmentSource) const;
+    std::string GetCachePath(const ShaderVariant& variant) const;
+
+    // Disk cache (program binaries)
+    bool HasBinary(const std::string& path, uint64_t key) const;
+    GLuint LoadBinary(const std::string& path, uint64_t key) const;
+    bool SaveBinary(GLuint program, const std::string& path, uint64_t key) const;
+
+    // Compile from source. The binary hint is set so the result can be saved.
+    GLuint CompileProgram(const ShaderVariant& variant, const std::string& vertexSource,
+                          const std::string& fragmentSource) const;
+    GLuint CompileShader(GLenum type, const std::string& source, const std::vector<std::string>& defines) const;
+
+    void WaitForWorker();
+
+    GLFunctions mGL;
+    bool mBinariesSupported;
+    std::string mDirectory;
+    std::string mDriver;  // Vendor, renderer and version strings
+
+    // Worker thread and its shared context
+    SDL_Window* mWindow;
+    SDL_GLContext mWorkerContext;
+    std::thread mWorker;
+    std::atomic<bool> mPrecompiling;
+    mutable std::mutex mFileMutex;  // Cache files are written by both threads
+};